@@ -6,13 +6,40 @@
 #include <string>
 #include <string_view>
 #include <variant>
+#include <stdexcept>
+#include <array>
+#include <memory>
+#include <functional>
+#include <span>
 #include "./Quickbase_types.hpp"
+#include "./Quickbase_stats.hpp"
+#include "./Quickbase_querylog.hpp"
+#include "./Quickbase_cdc.hpp"
+#include "./Quickbase_view.hpp"
+#include "./Quickbase_wal.hpp"
+#include "./Quickbase_ttl.hpp"
+#include "./Quickbase_txn.hpp"
+#include "./Quickbase_unique.hpp"
+#include "./Quickbase_composite.hpp"
+#include "./Quickbase_cracking.hpp"
+#include "./Quickbase_fulltext.hpp"
 
 // Quickbase static database declarations
 namespace db
 {
+    // RecordVisitor - receives records in place from table storage, see forEachMatching()
+    using RecordVisitor = std::function<void(const db::QBRecord &)>;
+    // BatchLookupVisitor - receives the position of a key in the batch and its record, nullptr when not found
+    using BatchLookupVisitor = std::function<void(size_t, const db::QBRecord *)>;
+    // ScanVisitor - receives every active record in storage order, returns false to stop the scan
+    using ScanVisitor = std::function<bool(const db::QBRecord &)>;
+    // QBTableStats - statistics snapshot of a QBTable, keyed by column
+    using QBTableStats = db::TableStatsSnapshot<db::ColumnType>;
 
     // QBTable class represents a collection of records with optimized indexing and deletion handling
+    // Thread safety: const queries may run concurrently, their statistics are relaxed atomics. Range queries on
+    // column2 (findInRange(), forEachInRange(), explainRange()) are the exception, as they refine the adaptive
+    // index. Mutations need exclusive access, and so do the indexes, views and expiry wheel the table drives.
     class QBTable
     {
     private:
@@ -28,14 +55,85 @@ namespace db
         std::set<db::ColumnType> secondaryIndexedColumns_;
         // secondaryIndexes_ - index for secondary-indexed columns: (columnID, FieldType) -> record indices
         std::map<std::pair<db::ColumnType, db::FieldType>, std::vector<size_t>> secondaryIndexes_;
+        // uniqueIndexes_ - columns indexed with IndexKind::Unique, each key -> its one active record
+        // these columns are not in secondaryIndexedColumns_
+        std::map<db::ColumnType, db::UniqueIndex> uniqueIndexes_;
+        // compositeIndexes_ - indexes over an ordered list of columns, keyed by that list
+        std::map<std::vector<db::ColumnType>, db::CompositeIndex> compositeIndexes_;
+        // cracker_ - adaptive index on column2, copied by the first range query and reorganized by every later one
+        // mutable as queries refine it; column2 changes in place and record moves are applied to it as they happen
+        mutable db::CrackerColumn cracker_;
+        bool adaptiveIndexing_ = true;
+        // fullText_ - optional full-text index on column3, see searchText()
+        std::unique_ptr<db::FullTextIndex> fullText_;
+
+        // query statistics per column - mutable and atomic as they are updated from const query paths
+        mutable std::array<db::AtomicAccessPathCounters, 4> columnStats_{};
+        // indexUsage_ - usage of the index on each column, COLUMN0 is the primary key index
+        mutable std::array<db::AtomicIndexUsage, 4> indexUsage_{};
+        // compositeUsage_ - usage of each composite index, keyed like compositeIndexes_
+        mutable std::map<std::vector<db::ColumnType>, db::AtomicIndexUsage> compositeUsage_;
+        // scanStats_ - full table scans from forEachRecord(), not attributed to a column
+        mutable db::AtomicAccessPathCounters scanStats_{};
+        // mutations_ - records inserted, updated or deleted since the last resetStats()
+        uint64_t mutations_ = 0;
+        // queryLog_ - optional per query shape statistics and slow query log, shared between tables
+        std::shared_ptr<db::QueryLog> queryLog_;
+        std::string queryLogTable_;
+        // changeStream_ - optional change data capture of every mutation
+        std::shared_ptr<db::QBChangeStream> changeStream_;
+        // wal_ - optional write-ahead log shipped to read replicas
+        std::shared_ptr<db::wal::LogWriter> wal_;
+        // views_ - materialized views maintained on every mutation
+        std::vector<std::shared_ptr<db::QBMaterializedView>> views_;
+        // expiresAt_ - parallel vector to records_ of expiry deadlines in TtlClock ticks, max for none
+        // empty until the first time to live is set, so tables without one pay nothing on queries
+        std::vector<db::TtlClock::rep> expiresAt_;
+        // expiryWheel_ - primary keys by deadline, stale entries are skipped when they come due
+        db::TimerWheel expiryWheel_;
 
         // helper methods for indexing
         db::FieldType getColumnField(size_t recordIdx, db::ColumnType columnID) const;
         void rebuildPrimaryKeyIndex();
         void rebuildSecondaryIndexForColumn(db::ColumnType columnID);
         void removeSecondaryIndexForColumn(db::ColumnType columnID);
+        void moveSecondaryIndexEntry(db::ColumnType columnID, const db::FieldType &from, const db::FieldType &to, size_t recordIdx);
+        void applySecondaryIndexDeltas(db::ColumnType columnID, std::map<db::FieldType, std::vector<size_t>> &removals,
+                                       std::map<db::FieldType, std::vector<size_t>> &additions);
+        void populateView(db::QBMaterializedView &view) const;
+        // unique index helpers - uniqueKeysFree() collects expired holders of the record's keys in stale
+        // columns/changed - bit 1 << column set for each column whose value changes, all columns by default
+        bool uniqueKeysFree(const db::QBRecord &record, size_t self, db::TtlClock::rep now, std::vector<size_t> &stale) const;
+        void addUniqueEntries(size_t recordIdx, unsigned columns = ~0u);
+        void removeUniqueEntries(size_t recordIdx, unsigned columns = ~0u);
+        void rebuildUniqueIndexes();
+        // composite index helpers - remove a record's entries before its values change, add them after;
+        // indexes without a changed column keep their entries
+        void addCompositeEntries(size_t recordIdx, unsigned changed = ~0u);
+        void removeCompositeEntries(size_t recordIdx, unsigned changed = ~0u);
+        void rebuildCompositeIndexes();
+        void rebuildFullTextIndex();
+        db::TtlClock::rep expiryNow() const noexcept;
+        bool expired(size_t recordIdx, db::TtlClock::rep now) const noexcept;
+        void softDeleteRecords(std::vector<size_t> &recordIdxs);
         // kept private to prevent accidental linear scans - only used internally for non-indexed queries
-        std::vector<db::QBRecord> linearScan(db::ColumnType columnID, std::string_view matchString) const;
+        template <typename Visitor>
+        size_t linearScan(db::ColumnType columnID, std::string_view matchString, Visitor &&visit) const;
+        // query execution - calls visit(record) for each match, defined and instantiated in Quickbase.cpp only
+        template <typename Visitor>
+        size_t visitMatching(db::ColumnType columnID, std::string_view matchString, Visitor &&visit) const;
+        template <typename Visitor>
+        size_t loggedVisitMatching(db::ColumnType columnID, std::string_view matchString, Visitor &&visit) const;
+        // conjunctive query execution, see forEachMatchingAll()
+        template <typename Visitor>
+        size_t visitMatchingAll(std::span<const db::ColumnMatch> conditions, Visitor &&visit) const;
+        template <typename Visitor>
+        size_t loggedVisitMatchingAll(std::span<const db::ColumnMatch> conditions, Visitor &&visit) const;
+        // range query execution on column2, see forEachInRange()
+        template <typename Visitor>
+        size_t visitRange(long low, long high, Visitor &&visit) const;
+        template <typename Visitor>
+        size_t loggedVisitRange(long low, long high, Visitor &&visit) const;
 
     public:
         QBTable() = default;
@@ -48,19 +146,90 @@ namespace db
         ~QBTable() = default;
 
         // index management - create/drop indexes on demand
-        void createIndex(db::ColumnType columnID);
+        // a Unique index fails with std::runtime_error when the column already holds a duplicate
+        void createIndex(db::ColumnType columnID, db::IndexKind kind = db::IndexKind::General);
         void dropIndex(db::ColumnType columnID);
         bool isColumnIndexed(db::ColumnType columnID) const;
+        // composite index over two or more non-key columns in order - serves findMatchingAll() on all of them or
+        // on a leading prefix of them; fails with std::runtime_error for a repeated column or an existing index
+        void createCompositeIndex(std::vector<db::ColumnType> columns);
+        void dropCompositeIndex(const std::vector<db::ColumnType> &columns);
+        bool hasCompositeIndex(const std::vector<db::ColumnType> &columns) const;
+        // full-text index over the words of column3 - serves searchText(), not findMatching(); fails with
+        // std::runtime_error when one exists
+        void createFullTextIndex(db::TokenizerOptions tokenizer = {}, db::Bm25Options bm25 = {});
+        void dropFullTextIndex();
+        bool hasFullTextIndex() const noexcept { return fullText_ != nullptr; }
+        const db::FullTextIndex *fullTextIndex() const noexcept { return fullText_.get(); }
 
         // core operations
-        void addRecord(const QBRecord &record);
+        // false when a unique index already holds one of the record's keys
+        bool addRecord(const QBRecord &record);
+        // false for an unknown id and for an expired record, which is purged instead
         bool deleteRecordByID(db::uint id, bool hardDelete = false);
+        // change an active record in place - only the index entries of columns whose value changed are touched;
+        // false for an unknown id or a value a unique index holds for another record
+        bool updateRecord(db::uint id, const db::QBRecordUpdate &changes);
+        // merge a batch keyed on column0 - active records are updated in place, others appended; a key repeated in
+        // the batch ends with its last values, records clashing with a unique index are rejected
+        db::UpsertResult upsertRecords(std::span<const db::QBRecord> records);
+        // apply a transaction atomically - every operation is checked, unique keys included, before the first one
+        // applies; secondary indexes are maintained once per column and the write-ahead log gets a single Batch entry
+        db::CommitResult commit(const db::QBTransaction &txn);
         void compactRecords();
+        // time to live - an expired record is hidden from queries at once and soft deleted by expireRecords()
+        // false for an unknown or already expired id; the deadline survives updates
+        bool expireRecordAt(db::uint id, db::TtlClock::time_point deadline);
+        bool expireRecordAfter(db::uint id, db::TtlClock::duration ttl);
+        bool clearRecordExpiry(db::uint id);
+        // soft delete expired records, examining at most budget due deadlines - call it from a periodic tick
+        size_t expireRecords(size_t budget = db::kDefaultExpiryBudget);
+        // deadlines scheduled or due, including those of records deleted or rescheduled since
+        size_t pendingExpiries() const noexcept;
         std::vector<QBRecord> findMatching(db::ColumnType column, std::string_view matchString) const;
+        size_t forEachMatching(db::ColumnType column, std::string_view matchString, const db::RecordVisitor &visitor) const;
+        // records equal to every condition - string columns compare exactly here, unlike findMatching()
+        std::vector<QBRecord> findMatchingAll(std::span<const db::ColumnMatch> conditions) const;
+        size_t forEachMatchingAll(std::span<const db::ColumnMatch> conditions, const db::RecordVisitor &visitor) const;
+        // records with low <= column2 <= high, in no particular order - served by a general index on column2, else
+        // by the adaptive index each range query refines, or by a linear scan with adaptive indexing off
+        std::vector<QBRecord> findInRange(long low, long high) const;
+        size_t forEachInRange(long low, long high, const db::RecordVisitor &visitor) const;
+        // adaptive indexing of column2 for range queries - on by default, turning it off frees the copy
+        void setAdaptiveIndexing(bool enabled);
+        bool adaptiveIndexing() const noexcept { return adaptiveIndexing_; }
+        // the k records whose column3 best matches the words of query by BM25, best first - needs the full-text index
+        std::vector<db::TextMatch> searchText(std::string_view query, size_t k = 10) const;
+        // batched primary key lookups - probes all keys first, then visits each key in the order of ids with its position
+        size_t lookupBatch(std::span<const db::uint> ids, const db::BatchLookupVisitor &visitor) const;
+        // full table scan over active records - the visitor may stop it early
+        size_t forEachRecord(const db::ScanVisitor &visitor) const;
 
         // get record counts
         size_t activeRecordsCount() const noexcept;
         size_t totalRecordsCount() const noexcept;
+
+        // access path and index usage statistics
+        db::QBTableStats stats() const;
+        void resetStats() noexcept;
+        // size of the general index on a column - measured when it exists, otherwise estimated from about
+        // sampleSize active records; see db::IndexAdvisor
+        db::IndexEstimate estimateIndex(db::ColumnType columnID, size_t sampleSize = 1024) const;
+
+        // query shape statistics and slow query log - pass nullptr to detach
+        void setQueryLog(std::shared_ptr<db::QueryLog> queryLog, std::string tableName);
+        // change data capture of addRecord, deletes and compaction - pass nullptr to detach
+        void setChangeStream(std::shared_ptr<db::QBChangeStream> changeStream);
+        // log every mutation and index change from now on - attach to an empty table so replicas can replay it
+        void setWriteAheadLog(std::shared_ptr<db::wal::LogWriter> wal);
+        // materialized views - addView() evaluates the existing records, later mutations update the view incrementally
+        void addView(std::shared_ptr<db::QBMaterializedView> view);
+        bool removeView(const std::shared_ptr<db::QBMaterializedView> &view);
+        // describe the access path findMatching() would take for this query
+        std::string explain(db::ColumnType column, std::string_view matchString) const;
+        std::string explain(std::span<const db::ColumnMatch> conditions) const;
+        std::string explainRange(long low, long high) const;
+        std::string explainText(std::string_view query) const;
     };
 
 }
\ No newline at end of file
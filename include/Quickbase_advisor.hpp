@@ -0,0 +1,76 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "./Quickbase.hpp"
+#include "./Quickbase_querylog.hpp"
+
+// Quickbase index advisor declarations - general QBTable indexes chosen from the observed workload
+namespace db
+{
+    struct IndexAdvisorOptions
+    {
+        size_t memoryBudget = size_t(64) << 20; // bytes the general secondary indexes may hold together
+        double writeCostRows = 16;              // rows examined a mutation is worth, per index it maintains
+        double minBenefitRows = 10000;          // net rows saved per window a new index must bring
+        double decay = 0.5;                     // weight of earlier windows in the smoothed workload
+        size_t sampleSize = 1024;               // records sampled to estimate an index that does not exist
+    };
+
+    enum class IndexAdvice : uint8_t
+    {
+        Create,
+        Drop,
+        Keep
+    };
+
+    // IndexRecommendation - verdict on one column, benefit and cost in rows examined per window
+    struct IndexRecommendation
+    {
+        db::ColumnType column;
+        db::IndexAdvice advice;
+        double benefitRows = 0; // scan work the index saves
+        double costRows = 0;    // maintenance work on the table's mutations
+        size_t memoryBytes = 0;
+        std::string reason;
+    };
+
+    // IndexAdvisor - watches a table's access path statistics between calls and picks its general indexes
+    // Each recommend() or apply() closes a window: equality lookups per column (full scans on unindexed columns,
+    // index hits on indexed ones) and mutations are folded into decayed averages. A column's benefit is its
+    // lookups times the rows a scan examines beyond one index key, its cost the mutations times writeCostRows;
+    // indexes are granted greedily by net benefit per byte within memoryBudget. An existing index is kept while
+    // its net benefit stays positive, a new one must bring minBenefitRows.
+    // Unique indexes enforce a constraint and are never touched, composite indexes are left alone. An index on a
+    // string column turns its substring matches into exact ones, so string columns are only indexed with a query
+    // log showing equality queries on them and no substring ones.
+    class IndexAdvisor
+    {
+    private:
+        db::QBTable &table_;
+        db::IndexAdvisorOptions options_;
+        std::shared_ptr<db::QueryLog> queryLog_;
+        std::string tableName_;
+        db::QBTableStats last_;
+        std::array<double, 4> lookups_{};
+        double mutations_ = 0;
+        // string columns that served substring matches - never indexed
+        std::array<bool, 4> substring_{};
+        std::array<bool, 4> equality_{};
+
+        void observe();
+
+    public:
+        // queryLog and tableName as passed to table.setQueryLog()
+        explicit IndexAdvisor(db::QBTable &table, db::IndexAdvisorOptions options = {},
+                              std::shared_ptr<db::QueryLog> queryLog = nullptr, std::string tableName = {});
+
+        // close the window and judge every non-key column, the table is not changed
+        std::vector<db::IndexRecommendation> recommend();
+        // close the window and carry out the recommendations, drops first - returns them
+        std::vector<db::IndexRecommendation> apply();
+    };
+}
@@ -0,0 +1,70 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+
+// Quickbase benchmark reporting declarations - machine readable output and run comparison
+namespace db::bench
+{
+    // BenchmarkStats - all timed trials of one benchmark case, one sample per trial in milliseconds
+    struct BenchmarkStats
+    {
+        std::string test; // benchmark group, e.g. "TEST 1"
+        std::string name; // implementation under test, e.g. "QBTable"
+        std::vector<double> samplesMs;
+    };
+
+    // Summary - descriptive statistics of a sample set
+    struct Summary
+    {
+        double mean = 0;
+        double stddev = 0;
+        double ci95 = 0; // half-width of the 95% confidence interval of the mean
+        double min = 0;
+        double max = 0;
+        size_t count = 0;
+    };
+
+    // RunMetadata - environment a benchmark run was produced in
+    struct RunMetadata
+    {
+        std::string compiler;
+        std::string flags;
+        std::string buildType;
+        std::string cpu;
+        std::string commit;
+        std::string timestamp;
+        unsigned hardwareThreads = 0;
+        size_t dataSize = 0;
+        size_t iterations = 0;
+        size_t trials = 0;
+    };
+
+    // Comparison - one benchmark case matched between a baseline and a current run
+    struct Comparison
+    {
+        std::string test;
+        std::string name;
+        Summary baseline;
+        Summary current;
+        double changePct = 0;     // relative change of the mean, positive is slower
+        bool significant = false; // Welch t-test at 95% confidence
+        bool regression = false;  // significant and slower by more than the threshold
+    };
+
+    Summary summarize(const std::vector<double> &samples);
+    RunMetadata collectMetadata();
+
+    // output formats
+    void writeJson(std::ostream &out, const RunMetadata &meta, const std::vector<BenchmarkStats> &results);
+    void writeCsv(std::ostream &out, const RunMetadata &meta, const std::vector<BenchmarkStats> &results);
+    // reads back a document produced by writeJson, throws std::runtime_error on malformed input
+    std::vector<BenchmarkStats> readJson(std::istream &in, RunMetadata *meta = nullptr);
+
+    // regression comparison - thresholdPct is the minimal slowdown that counts as a regression
+    std::vector<Comparison> compareRuns(const std::vector<BenchmarkStats> &baseline,
+                                        const std::vector<BenchmarkStats> &current,
+                                        double thresholdPct);
+    void printComparison(std::ostream &out, const std::vector<Comparison> &comparisons, double thresholdPct);
+}
@@ -0,0 +1,153 @@
+#ifndef QUICKBASE_C_H
+#define QUICKBASE_C_H
+
+/*
+ * Quickbase C API - stable C ABI over QBTable and QBTableDynamic for embedding in non-C++ code.
+ *
+ * Tables are opaque handles. Functions report failures as a qb_status; qb_last_error() returns the
+ * message of the last failure on the calling thread. Like the C++ tables, a handle must not be used
+ * from several threads at once.
+ *
+ * Query results are columnar: every column is one contiguous buffer of values (uint32_t, int64_t, or
+ * string bytes with rows + 1 offsets), so callers read them in place. The buffers stay valid until the
+ * result is released with qb_result_free(), independent of later changes to the table.
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(QB_C_BUILD)
+#define QB_C_API __declspec(dllexport)
+#else
+#define QB_C_API __declspec(dllimport)
+#endif
+#else
+#define QB_C_API __attribute__((visibility("default")))
+#endif
+
+#define QB_C_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    typedef struct qb_table qb_table;
+    typedef struct qb_result qb_result;
+
+    typedef enum qb_status
+    {
+        QB_OK = 0,
+        QB_NOT_FOUND = 1,        /* no record with that id */
+        QB_INVALID_ARGUMENT = 2,    /* bad column, type or table kind */
+        QB_ERROR = 3,               /* operation failed, see qb_last_error() */
+        QB_CONSTRAINT_VIOLATION = 4 /* an id or unique key is already taken, nothing was changed */
+    } qb_status;
+
+    typedef enum qb_field_type
+    {
+        QB_FIELD_UINT = 0,  /* uint32_t */
+        QB_FIELD_LONG = 1,  /* int64_t */
+        QB_FIELD_STRING = 2 /* bytes + length, not NUL terminated */
+    } qb_field_type;
+
+    /* qb_value - a typed field value for QBTableDynamic, strings are borrowed for the duration of the call */
+    typedef struct qb_value
+    {
+        qb_field_type type;
+        union
+        {
+            uint32_t u;
+            int64_t l;
+            struct
+            {
+                const char *data;
+                size_t length;
+            } s;
+        } as;
+    } qb_value;
+
+    typedef struct qb_field
+    {
+        const char *name;
+        qb_value value;
+    } qb_field;
+
+    /* qb_record - a QBTable record, strings are borrowed for the duration of the call */
+    typedef struct qb_record
+    {
+        uint32_t column0; /* primary key */
+        const char *column1;
+        size_t column1_length;
+        int64_t column2;
+        const char *column3;
+        size_t column3_length;
+    } qb_record;
+
+    typedef struct qb_dynamic_record
+    {
+        uint32_t id;
+        const qb_field *fields;
+        size_t field_count;
+    } qb_dynamic_record;
+
+    /*
+     * qb_column - one result column
+     * QB_FIELD_UINT / QB_FIELD_LONG: values points to rows uint32_t / int64_t values
+     * QB_FIELD_STRING: values points to the concatenated bytes, row i spans [offsets[i], offsets[i + 1])
+     * validity is NULL when every row has a value, otherwise validity[i] == 0 marks a missing value
+     * (a dynamic record without the field, or a field whose type differs from the column type)
+     */
+    typedef struct qb_column
+    {
+        const char *name;
+        qb_field_type type;
+        const void *values;
+        const uint64_t *offsets;
+        const uint8_t *validity;
+    } qb_column;
+
+    QB_C_API int qb_abi_version(void);
+    QB_C_API const char *qb_last_error(void);
+
+    /* table lifetime */
+    QB_C_API qb_table *qb_table_create(void);         /* QBTable with column0..column3 */
+    QB_C_API qb_table *qb_table_create_dynamic(void); /* QBTableDynamic, columns added with qb_dynamic_add_column */
+    QB_C_API void qb_table_destroy(qb_table *table);
+    QB_C_API size_t qb_table_active_count(const qb_table *table);
+
+    /* QBTable operations - column is 0..3 */
+    QB_C_API qb_status qb_add_record(qb_table *table, const qb_record *record);
+    /* all or nothing - a record whose id or unique key is taken fails the batch with QB_CONSTRAINT_VIOLATION */
+    QB_C_API qb_status qb_add_records(qb_table *table, const qb_record *records, size_t count);
+    QB_C_API qb_status qb_create_index(qb_table *table, int column);
+    /* later records with a key already present are rejected with QB_CONSTRAINT_VIOLATION */
+    QB_C_API qb_status qb_create_unique_index(qb_table *table, int column);
+    QB_C_API qb_status qb_drop_index(qb_table *table, int column);
+    QB_C_API qb_status qb_find(const qb_table *table, int column, const char *match, size_t match_length, qb_result **result);
+
+    /* QBTableDynamic operations - the primary key column is "id" */
+    QB_C_API qb_status qb_dynamic_add_column(qb_table *table, const char *name, qb_value default_value);
+    QB_C_API qb_status qb_dynamic_add_record(qb_table *table, const qb_dynamic_record *record);
+    /* all or nothing - a record naming an unknown column fails the batch with QB_INVALID_ARGUMENT */
+    QB_C_API qb_status qb_dynamic_add_records(qb_table *table, const qb_dynamic_record *records, size_t count);
+    QB_C_API qb_status qb_dynamic_create_index(qb_table *table, const char *column);
+    QB_C_API qb_status qb_dynamic_drop_index(qb_table *table, const char *column);
+    QB_C_API qb_status qb_dynamic_find(const qb_table *table, const char *column, qb_value value, qb_result **result);
+
+    /* both table kinds */
+    QB_C_API qb_status qb_delete_record(qb_table *table, uint32_t id, int hard_delete);
+    QB_C_API qb_status qb_compact(qb_table *table);
+
+    /* results */
+    QB_C_API size_t qb_result_rows(const qb_result *result);
+    QB_C_API size_t qb_result_column_count(const qb_result *result);
+    QB_C_API const qb_column *qb_result_column(const qb_result *result, size_t index);
+    QB_C_API void qb_result_free(qb_result *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QUICKBASE_C_H */
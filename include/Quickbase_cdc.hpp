@@ -0,0 +1,277 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "./Quickbase_types.hpp"
+
+// Quickbase change data capture declarations - stream of table mutations to subscribers
+namespace db
+{
+    enum class ChangeType : uint8_t
+    {
+        Insert,     // addRecord - record holds the new record
+        SoftDelete, // record marked deleted, its position stays occupied until compaction
+        HardDelete, // record removed, moves holds the last record swapped into its position
+        Compaction, // soft deleted records purged, moves holds every surviving record whose position changed
+        Update,     // record changed in place at position, record holds its new values
+        Resync      // events were dropped for this subscriber, sequence is the first one lost
+    };
+
+    // RecordMove - storage position of a record before and after a hard delete or compaction
+    struct RecordMove
+    {
+        size_t from;
+        size_t to;
+    };
+
+    // ChangeEvent - one table mutation, sequence numbers are consecutive per stream starting at 1
+    template <typename Record>
+    struct ChangeEvent
+    {
+        uint64_t sequence = 0;
+        db::ChangeType type = db::ChangeType::Insert;
+        db::uint id = 0;     // primary key, unused for Compaction and Resync
+        size_t position = 0; // storage position of the inserted or deleted record
+        Record record{};     // Insert and Update only
+        std::vector<db::RecordMove> moves;
+    };
+
+    // OverflowPolicy - what the writer does when a subscriber's ring is full
+    enum class OverflowPolicy : uint8_t
+    {
+        Block, // the writer waits until the subscriber makes room (backpressure)
+        Resync // events are dropped until the subscriber polls, it then receives one Resync event
+    };
+
+    struct ChangeSubscriptionStats
+    {
+        uint64_t delivered = 0; // events written to the ring
+        uint64_t dropped = 0;   // events lost under OverflowPolicy::Resync
+        uint64_t resyncs = 0;   // Resync events handed to the subscriber
+        uint64_t stalls = 0;    // publishes that waited for room under OverflowPolicy::Block
+    };
+
+    // ChangeSubscription - bounded single producer / single consumer ring of change events
+    // The table's writer thread produces, one consumer thread polls. Both sides are lock-free.
+    template <typename Record>
+    class ChangeSubscription
+    {
+    private:
+        std::vector<db::ChangeEvent<Record>> slots_;
+        size_t mask_;
+        db::OverflowPolicy policy_;
+        // head_ is written by the consumer only, tail_ by the producer only - each side keeps a cached copy of
+        // the other's index and rereads it only when the ring looks full or empty
+        alignas(64) std::atomic<uint64_t> head_{0};
+        uint64_t cachedTail_ = 0;
+        std::atomic<uint64_t> resyncs_{0};
+        alignas(64) std::atomic<uint64_t> tail_{0};
+        uint64_t cachedHead_ = 0;
+        std::atomic<uint64_t> delivered_{0};
+        std::atomic<uint64_t> dropped_{0};
+        std::atomic<uint64_t> stalls_{0};
+        // set by the producer when the ring overflowed under OverflowPolicy::Resync, cleared by the consumer
+        alignas(64) std::atomic<bool> lost_{false};
+        uint64_t firstLost_ = 0;
+        std::atomic<bool> closed_{false};
+
+        // single writer counters - no read-modify-write needed
+        static void increment(std::atomic<uint64_t> &counter) noexcept
+        {
+            counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+
+        static size_t roundCapacity(size_t capacity)
+        {
+            size_t rounded = 2;
+            while (rounded < capacity)
+                rounded <<= 1;
+            return rounded;
+        }
+
+    public:
+        ChangeSubscription(size_t capacity, db::OverflowPolicy policy)
+            : slots_(roundCapacity(capacity)), mask_(slots_.size() - 1), policy_(policy) {}
+        ChangeSubscription(const ChangeSubscription &) = delete;
+        ChangeSubscription &operator=(const ChangeSubscription &) = delete;
+
+        // producer - copy or move the event into the ring according to the overflow policy
+        template <typename Event>
+        void push(Event &&event)
+        {
+            if (closed_.load(std::memory_order_relaxed))
+                return;
+            // once events are lost nothing is delivered until the consumer has seen the Resync event
+            if (lost_.load(std::memory_order_acquire))
+            {
+                increment(dropped_);
+                return;
+            }
+
+            const uint64_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - cachedHead_ == slots_.size())
+            {
+                cachedHead_ = head_.load(std::memory_order_acquire);
+                if (tail - cachedHead_ == slots_.size() && policy_ == db::OverflowPolicy::Resync)
+                {
+                    firstLost_ = event.sequence;
+                    increment(dropped_);
+                    lost_.store(true, std::memory_order_release);
+                    return;
+                }
+                if (tail - cachedHead_ == slots_.size())
+                    increment(stalls_);
+                while (tail - cachedHead_ == slots_.size())
+                {
+                    if (closed_.load(std::memory_order_relaxed))
+                        return;
+                    std::this_thread::yield();
+                    cachedHead_ = head_.load(std::memory_order_acquire);
+                }
+            }
+            slots_[tail & mask_] = std::forward<Event>(event);
+            tail_.store(tail + 1, std::memory_order_release);
+            increment(delivered_);
+        }
+
+        // consumer - take the next event, false when none is pending
+        bool poll(db::ChangeEvent<Record> &event)
+        {
+            // lost_ is read before the ring so every event published before the loss is delivered first
+            const bool lost = lost_.load(std::memory_order_acquire);
+            const uint64_t head = head_.load(std::memory_order_relaxed);
+            if (head == cachedTail_)
+                cachedTail_ = tail_.load(std::memory_order_acquire);
+            if (head != cachedTail_)
+            {
+                event = std::move(slots_[head & mask_]);
+                head_.store(head + 1, std::memory_order_release);
+                return true;
+            }
+            if (!lost)
+                return false;
+            event = db::ChangeEvent<Record>{};
+            event.type = db::ChangeType::Resync;
+            event.sequence = firstLost_;
+            increment(resyncs_);
+            lost_.store(false, std::memory_order_release);
+            return true;
+        }
+
+        // consumer - poll up to maxEvents events into visit(event), returns the number visited
+        template <typename Visitor>
+        size_t drain(Visitor &&visit, size_t maxEvents = SIZE_MAX)
+        {
+            db::ChangeEvent<Record> event;
+            size_t visited = 0;
+            while (visited < maxEvents && poll(event))
+            {
+                visit(event);
+                ++visited;
+            }
+            return visited;
+        }
+
+        size_t pending() const noexcept
+        {
+            return static_cast<size_t>(tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire));
+        }
+        size_t capacity() const noexcept { return slots_.size(); }
+        db::OverflowPolicy policy() const noexcept { return policy_; }
+
+        // stop delivery - also releases a writer blocked on this subscriber
+        void close() noexcept { closed_.store(true, std::memory_order_relaxed); }
+        bool closed() const noexcept { return closed_.load(std::memory_order_relaxed); }
+
+        db::ChangeSubscriptionStats stats() const noexcept
+        {
+            return {delivered_.load(std::memory_order_relaxed), dropped_.load(std::memory_order_relaxed),
+                    resyncs_.load(std::memory_order_relaxed), stalls_.load(std::memory_order_relaxed)};
+        }
+    };
+
+    // ChangeStream - fans the mutations of one table out to its subscribers
+    // Attach it with setChangeStream() on a single table. publish() runs on the table's writer thread and
+    // takes no lock unless the set of subscribers changed; subscribe() and unsubscribe() may run anywhere.
+    // A consumer (re)building its state from a snapshot reads lastSequence() while the writer is paused and
+    // skips events up to that sequence.
+    template <typename Record>
+    class ChangeStream
+    {
+    public:
+        using Subscription = db::ChangeSubscription<Record>;
+
+    private:
+        mutable std::mutex mutex_;
+        std::vector<std::shared_ptr<Subscription>> subscribers_;
+        std::atomic<uint64_t> generation_{0};
+        std::atomic<uint64_t> sequence_{0};
+        // writer side copy of subscribers_, refreshed when generation_ moves
+        std::vector<std::shared_ptr<Subscription>> active_;
+        uint64_t activeGeneration_ = 0;
+
+        void refresh()
+        {
+            const uint64_t generation = generation_.load(std::memory_order_acquire);
+            if (generation == activeGeneration_)
+                return;
+            std::lock_guard lock(mutex_);
+            active_ = subscribers_;
+            activeGeneration_ = generation_.load(std::memory_order_relaxed);
+        }
+
+    public:
+        std::shared_ptr<Subscription> subscribe(size_t capacity = 4096, db::OverflowPolicy policy = db::OverflowPolicy::Resync)
+        {
+            auto subscription = std::make_shared<Subscription>(capacity, policy);
+            std::lock_guard lock(mutex_);
+            subscribers_.push_back(subscription);
+            generation_.fetch_add(1, std::memory_order_release);
+            return subscription;
+        }
+
+        void unsubscribe(const std::shared_ptr<Subscription> &subscription)
+        {
+            subscription->close();
+            std::lock_guard lock(mutex_);
+            std::erase(subscribers_, subscription);
+            generation_.fetch_add(1, std::memory_order_release);
+        }
+
+        size_t subscriberCount() const
+        {
+            std::lock_guard lock(mutex_);
+            return subscribers_.size();
+        }
+
+        // sequence number of the last published event, 0 before the first one
+        uint64_t lastSequence() const noexcept { return sequence_.load(std::memory_order_acquire); }
+
+        // writer - assign the next sequence number and deliver the event, the record is only copied with subscribers
+        void publish(db::ChangeType type, db::uint id, size_t position, const Record *record = nullptr,
+                     std::vector<db::RecordMove> moves = {})
+        {
+            const uint64_t sequence = sequence_.load(std::memory_order_relaxed) + 1;
+            sequence_.store(sequence, std::memory_order_release);
+            refresh();
+            if (active_.empty())
+                return;
+
+            db::ChangeEvent<Record> event{sequence, type, id, position, record ? *record : Record{}, std::move(moves)};
+            for (size_t i = 0; i + 1 < active_.size(); ++i)
+                active_[i]->push(event);
+            active_.back()->push(std::move(event));
+        }
+    };
+
+    using QBChangeEvent = db::ChangeEvent<db::QBRecord>;
+    using QBDynamicChangeEvent = db::ChangeEvent<db::QBRecordDynamic>;
+    // QBChangeStream - change stream of a QBTable
+    using QBChangeStream = db::ChangeStream<db::QBRecord>;
+    // QBDynamicChangeStream - change stream of a QBTableDynamic, schema changes are not captured
+    using QBDynamicChangeStream = db::ChangeStream<db::QBRecordDynamic>;
+}
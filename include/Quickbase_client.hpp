@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "./Quickbase_protocol.hpp"
+
+// Quickbase table server client declarations - blocking client for the wire protocol (POSIX sockets)
+namespace db
+{
+    // ClientResponse - one decoded response frame
+    struct ClientResponse
+    {
+        db::wire::Status status = db::wire::Status::Error;
+        uint32_t requestId = 0;
+        std::vector<char> payload;
+
+        db::wire::Reader reader() const { return {payload.data(), payload.size()}; }
+    };
+
+    class QBClient
+    {
+    private:
+        int fd_ = -1;
+        uint32_t nextRequestId_ = 1;
+        std::vector<char> in_;
+        size_t inOffset_ = 0;
+
+        void sendAll(const char *data, size_t size);
+
+    public:
+        QBClient() = default;
+        QBClient(const QBClient &) = delete;
+        QBClient &operator=(const QBClient &) = delete;
+        QBClient(QBClient &&other) noexcept;
+        QBClient &operator=(QBClient &&other) noexcept;
+        ~QBClient();
+
+        // connect, throws std::runtime_error on failure
+        void connectTcp(const std::string &host, uint16_t port);
+        void connectUnix(const std::string &path);
+        void close() noexcept;
+
+        // append one request frame to out and return its request id - the payload is written by body
+        uint32_t encodeRequest(std::vector<char> &out, db::wire::Opcode opcode, const std::function<void(db::wire::Writer &)> &body);
+        // send already encoded frames, e.g. several pipelined requests
+        void send(const std::vector<char> &frames);
+        // block until the next response frame arrives
+        db::ClientResponse receive();
+        // true when receive() can return without reading from the socket
+        bool hasBufferedResponse() const;
+        // send one request and wait for its response
+        db::ClientResponse call(db::wire::Opcode opcode, const std::function<void(db::wire::Writer &)> &body);
+
+        // convenience wrappers for QBTable hosted tables
+        db::wire::Status createTable(const std::string &name);
+        db::wire::Status addRecord(const std::string &name, const db::QBRecord &record);
+        db::wire::Status createIndex(const std::string &name, db::ColumnType column);
+        db::wire::Status deleteRecord(const std::string &name, db::uint id, bool hardDelete = false);
+        std::vector<db::QBRecord> findMatching(const std::string &name, db::ColumnType column, std::string_view matchString);
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+#include "./Quickbase_types.hpp"
+
+// Quickbase composite index declarations - postings keyed by the values of several columns
+namespace db
+{
+    // CompositeIndex - postings per key of column values, keys in lexicographic order
+    // The keys starting with the values of the leading k columns form one contiguous range, so the index serves
+    // equality on the full key and on every leading prefix of it. Postings of a key are in storage order.
+    class CompositeIndex
+    {
+    public:
+        using Key = std::vector<db::FieldType>;
+
+    private:
+        std::map<Key, std::vector<size_t>> postings_;
+
+    public:
+        void add(Key key, size_t recordIdx);
+        void remove(const Key &key, size_t recordIdx);
+        void clear() noexcept { postings_.clear(); }
+
+        // visit the postings of every key that starts with prefix, in key order
+        template <typename Visitor>
+        void forEachPrefix(const Key &prefix, Visitor &&visit) const
+        {
+            for (auto it = postings_.lower_bound(prefix); it != postings_.end(); ++it)
+            {
+                if (it->first.size() < prefix.size() || !std::equal(prefix.begin(), prefix.end(), it->first.begin()))
+                    break;
+                visit(it->second);
+            }
+        }
+
+        size_t keyCount() const noexcept { return postings_.size(); }
+    };
+
+    // the index of a map keyed by column lists whose leading run of constrained columns is longest, and that run's
+    // length - end() when no index leads with a constrained column
+    template <typename Indexes, typename Constrained>
+    std::pair<typename Indexes::const_iterator, size_t> longestCompositePrefix(const Indexes &indexes, Constrained &&constrained)
+    {
+        auto best = indexes.end();
+        size_t bestLength = 0;
+        for (auto it = indexes.begin(); it != indexes.end(); ++it)
+        {
+            size_t length = 0;
+            while (length < it->first.size() && constrained(it->first[length]))
+                ++length;
+            if (length > bestLength)
+            {
+                best = it;
+                bestLength = length;
+            }
+        }
+        return {best, bestLength};
+    }
+}
@@ -0,0 +1,84 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Quickbase adaptive indexing declarations - a column copy reorganized by the range queries it serves
+namespace db
+{
+    // CrackerColumn - (value, row) copy of an integer column, partitioned around the bounds of past range queries
+    // A query cracks the piece holding each of its bounds in two with one partitioning pass over that piece, and
+    // remembers the split as a pivot: the first position holding the pivot value or a larger one. Rows between two
+    // pivots are unordered, yet every query only touches the pieces holding its bounds, so repeated queries shrink
+    // the pieces and converge toward the cost of an index lookup without an upfront sort.
+    // Values appended after the copy was made wait in a pending list every query scans, and are merged into their
+    // pieces in one pass once the list outgrows a sixteenth of the column. A value changed in place marks the row's
+    // entry in the pieces stale and goes to the pending list too; stale entries are skipped until the merge drops
+    // them. Rows are not checked for deletion, the owner filters them and remaps the rows when it moves records.
+    class CrackerColumn
+    {
+    public:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+        struct Entry
+        {
+            long value;
+            size_t row;
+        };
+
+    private:
+        std::vector<Entry> entries_;
+        std::map<long, size_t> pivots_;
+        std::vector<Entry> pending_;
+        // pendingRows_ - position of each pending row in pending_; stale_ - rows whose entry in entries_ is outdated
+        std::unordered_map<size_t, size_t> pendingRows_;
+        std::unordered_set<size_t> stale_;
+        bool built_ = false;
+
+        // position of the first entry not below pivot, cracking its piece - adds the entries moved to examined
+        size_t crack(long pivot, size_t &examined);
+        void mergePending();
+
+    public:
+        void build(std::vector<Entry> entries);
+        void append(long value, size_t row);
+        // the value of row changed in place
+        void update(long value, size_t row);
+        // records moved in storage - newRows[row] is the entry's new row, npos drops it; the pieces stay cracked
+        void remapRows(const std::vector<size_t> &newRows);
+        // forget the copy, the next query builds it again
+        void clear() noexcept;
+
+        // visit(row) for every entry with low <= value <= high, in no particular order - returns the entries examined
+        template <typename Visitor>
+        size_t forEachInRange(long low, long high, Visitor &&visit)
+        {
+            if (low > high)
+                return 0;
+            if (pending_.size() > std::max<size_t>(entries_.size() / 16, 64))
+                mergePending();
+            size_t examined = pending_.size();
+            const size_t begin = crack(low, examined);
+            const size_t end = high == std::numeric_limits<long>::max() ? entries_.size() : crack(high + 1, examined);
+            examined += end - begin;
+            for (size_t i = begin; i < end; ++i)
+                if (stale_.empty() || !stale_.contains(entries_[i].row))
+                    visit(entries_[i].row);
+            for (const Entry &entry : pending_)
+                if (entry.value >= low && entry.value <= high)
+                    visit(entry.row);
+            return examined;
+        }
+
+        // entries a query for [low, high] would examine: the pieces holding the range and the pending list
+        size_t candidates(long low, long high) const;
+        bool built() const noexcept { return built_; }
+        size_t size() const noexcept { return entries_.size() + pending_.size() - stale_.size(); }
+        size_t pieceCount() const noexcept { return built_ ? pivots_.size() + 1 : 0; }
+        size_t memoryUsage() const noexcept;
+    };
+}
@@ -4,11 +4,32 @@
 #include <set>
 #include <map>
 #include <stdexcept>
+#include <string>
+#include <memory>
+#include <functional>
+#include <span>
 #include "./Quickbase_types.hpp"
+#include "./Quickbase_stats.hpp"
+#include "./Quickbase_querylog.hpp"
+#include "./Quickbase_cdc.hpp"
+#include "./Quickbase_view.hpp"
+#include "./Quickbase_ttl.hpp"
+#include "./Quickbase_txn.hpp"
+#include "./Quickbase_composite.hpp"
 
 // Quickbase dynamic database declarations
 namespace db
 {
+    // DynamicRecordVisitor - receives records in place from table storage, see forEachMatching()
+    using DynamicRecordVisitor = std::function<void(const db::QBRecordDynamic&)>;
+    // DynamicScanVisitor - receives every active record in storage order, returns false to stop the scan
+    using DynamicScanVisitor = std::function<bool(const db::QBRecordDynamic&)>;
+    // QBTableDynamicStats - statistics snapshot of a QBTableDynamic, keyed by column name ("id" is the primary key)
+    using QBTableDynamicStats = db::TableStatsSnapshot<std::string>;
+
+    // QBTableDynamic - records with named columns added at runtime, each with a default value
+    // Thread safety: const queries may run concurrently, their statistics are relaxed atomics. Mutations need
+    // exclusive access, and so do the indexes, views and expiry wheel the table drives.
     class QBTableDynamic
     {
     private:
@@ -28,11 +49,65 @@ namespace db
         std::set<std::string> secondaryIndexedColumns_;
         // secondaryIndexes_ - index for secondary-indexed columns: (column, FieldType) -> record indices
         std::map<std::pair<std::string, db::FieldType>, std::vector<size_t>> secondaryIndexes_;
+        // compositeIndexes_ - indexes over an ordered list of columns, keyed by that list
+        std::map<std::vector<std::string>, db::CompositeIndex> compositeIndexes_;
+
+        // query statistics per column name - mutable and atomic as they are updated from const query paths,
+        // which only bump existing entries; one entry per column, added and removed with the schema
+        mutable std::unordered_map<std::string, db::AtomicAccessPathCounters> columnStats_{{"id", {}}};
+        // indexUsage_ - usage of the primary key ("id") and every secondary index
+        mutable std::unordered_map<std::string, db::AtomicIndexUsage> indexUsage_{{"id", {}}};
+        // compositeUsage_ - usage of each composite index, keyed like compositeIndexes_
+        mutable std::map<std::vector<std::string>, db::AtomicIndexUsage> compositeUsage_;
+        // scanStats_ - full table scans from forEachRecord(), not attributed to a column
+        mutable db::AtomicAccessPathCounters scanStats_{};
+        // mutations_ - records inserted, updated or deleted since the last resetStats()
+        uint64_t mutations_ = 0;
+        // queryLog_ - optional per query shape statistics and slow query log, shared between tables
+        std::shared_ptr<db::QueryLog> queryLog_;
+        std::string queryLogTable_;
+        // changeStream_ - optional change data capture of every record mutation
+        std::shared_ptr<db::QBDynamicChangeStream> changeStream_;
+        // views_ - materialized views maintained on every mutation
+        std::vector<std::shared_ptr<db::QBDynamicMaterializedView>> views_;
+        // expiresAt_ - parallel vector to records_ of expiry deadlines in TtlClock ticks, max for none, empty
+        // until the first time to live is set
+        std::vector<db::TtlClock::rep> expiresAt_;
+        // expiryWheel_ - ids by deadline, stale entries are skipped when they come due
+        db::TimerWheel expiryWheel_;
 
         // helper methods for indexing
         void rebuildPrimaryIndex();
         void rebuildSecondaryIndex(const std::string& column);
         db::FieldType getField(size_t recordIdx, const std::string& column) const;
+        // compare a column with a value without copying it - false when the record lacks the column
+        bool fieldEquals(size_t recordIdx, const std::string& column, const db::FieldType& value) const;
+        // composite index helpers - remove a record's entries before its values change, add them after; given
+        // the changed fields, indexes over neither a changed nor a derived column keep their entries
+        db::CompositeIndex::Key compositeKey(size_t recordIdx, const std::vector<std::string>& columns) const;
+        bool compositeChanges(const std::vector<std::string>& columns, const std::unordered_map<std::string, db::FieldType>* changes) const;
+        void addCompositeEntries(size_t recordIdx, const std::unordered_map<std::string, db::FieldType>* changes = nullptr);
+        void removeCompositeEntries(size_t recordIdx, const std::unordered_map<std::string, db::FieldType>* changes = nullptr);
+        void rebuildCompositeIndexes();
+        void populateView(db::QBDynamicMaterializedView& view) const;
+        db::TtlClock::rep expiryNow() const noexcept;
+        bool expired(size_t recordIdx, db::TtlClock::rep now) const noexcept;
+        // statistics of a queried column, a scratch entry that stats() never reports for names outside the schema
+        db::AtomicAccessPathCounters& countersFor(const std::string& column) const;
+        void touchIndex(const std::string& column) const noexcept;
+        void softDeleteRecords(std::vector<size_t>& recordIdxs);
+        void moveSecondaryIndexEntry(const std::string& column, const db::FieldType& from, const db::FieldType& to, size_t recordIdx);
+        void applySecondaryIndexDeltas(const std::string& column, std::map<db::FieldType, std::vector<size_t>>& removals,
+                                       std::map<db::FieldType, std::vector<size_t>>& additions);
+        // query execution - calls visit(record) for each match, defined and instantiated in Quickbase_dynamic.cpp only
+        template <typename Visitor>
+        size_t visitMatching(const std::string& column, const db::FieldType& value, Visitor&& visit) const;
+        template <typename Visitor>
+        size_t loggedVisitMatching(const std::string& column, const db::FieldType& value, Visitor&& visit) const;
+        template <typename Visitor>
+        size_t visitMatchingAll(std::span<const db::DynamicColumnMatch> conditions, Visitor&& visit) const;
+        template <typename Visitor>
+        size_t loggedVisitMatchingAll(std::span<const db::DynamicColumnMatch> conditions, Visitor&& visit) const;
 
     public:
         QBTableDynamic() = default;
@@ -48,20 +123,64 @@ namespace db
         bool addColumn(const std::string& name, db::FieldType defaultValue = std::string{});
         void removeColumn(const std::string& name);
         bool addDerivedColumn(const std::string& name, db::DerivedFunc func);
+        // physical columns, "id" included - derived columns are not listed
+        std::vector<std::string> columnNames() const;
+        bool hasColumn(const std::string& name) const;
 
         // index management - create/drop indexes on demand
         void createIndex(const std::string& column);
         void dropIndex(const std::string& column);
+        bool isColumnIndexed(const std::string& column) const;
+        // composite index over two or more physical or derived columns in order, see QBTable::createCompositeIndex()
+        void createCompositeIndex(std::vector<std::string> columns);
+        void dropCompositeIndex(const std::vector<std::string>& columns);
+        bool hasCompositeIndex(const std::vector<std::string>& columns) const;
 
         // core operations
         bool addRecord(const db::QBRecordDynamic& record);
+        // false for an unknown id and for an expired record, which is purged instead
         bool deleteRecordByID(db::uint id, bool hardDelete = false);
+        // change fields of an active record in place - false for an unknown id or column, "id" cannot change
+        bool updateRecord(db::uint id, const std::unordered_map<std::string, db::FieldType>& changes);
+        // merge a batch keyed on id - fields of an active record are overwritten like updateRecord(), other records
+        // appended; records with a column missing from the schema are skipped and counted as rejected
+        db::UpsertResult upsertRecords(std::span<const db::QBRecordDynamic> records);
+        // apply a transaction atomically - schema and keys are checked for every operation before the first one
+        // applies, secondary indexes are maintained once per column
+        db::CommitResult commit(const db::QBDynamicTransaction& txn);
         void compactRecords();
+        // time to live - an expired record is hidden from queries at once and soft deleted by expireRecords()
+        bool expireRecordAt(db::uint id, db::TtlClock::time_point deadline);
+        bool expireRecordAfter(db::uint id, db::TtlClock::duration ttl);
+        bool clearRecordExpiry(db::uint id);
+        // soft delete expired records, examining at most budget due deadlines
+        size_t expireRecords(size_t budget = db::kDefaultExpiryBudget);
+        size_t pendingExpiries() const noexcept;
         std::vector<db::QBRecordDynamic> findMatching(std::string column, db::FieldType value) const;
+        size_t forEachMatching(const std::string& column, const db::FieldType& value, const db::DynamicRecordVisitor& visitor) const;
+        // records equal to every condition, see QBTable::findMatchingAll()
+        std::vector<db::QBRecordDynamic> findMatchingAll(std::span<const db::DynamicColumnMatch> conditions) const;
+        size_t forEachMatchingAll(std::span<const db::DynamicColumnMatch> conditions, const db::DynamicRecordVisitor& visitor) const;
+        // full table scan over active records - the visitor may stop it early
+        size_t forEachRecord(const db::DynamicScanVisitor& visitor) const;
 
         // get record counts
         size_t activeRecordsCount() const noexcept;
         size_t totalRecordsCount() const noexcept;
-        
+
+        // access path and index usage statistics
+        db::QBTableDynamicStats stats() const;
+        void resetStats() noexcept;
+
+        // query shape statistics and slow query log - pass nullptr to detach
+        void setQueryLog(std::shared_ptr<db::QueryLog> queryLog, std::string tableName);
+        // change data capture of addRecord, deletes and compaction - pass nullptr to detach
+        void setChangeStream(std::shared_ptr<db::QBDynamicChangeStream> changeStream);
+        // materialized views - addView() evaluates the existing records, later mutations update the view incrementally
+        void addView(std::shared_ptr<db::QBDynamicMaterializedView> view);
+        bool removeView(const std::shared_ptr<db::QBDynamicMaterializedView>& view);
+        // describe the access path findMatching() would take for this query
+        std::string explain(const std::string& column, const db::FieldType& value) const;
+        std::string explain(std::span<const db::DynamicColumnMatch> conditions) const;
     };
 }
@@ -0,0 +1,494 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "./Quickbase_schema.hpp"
+
+// Quickbase query expression declarations - predicates over a SchemaTable written as C++ expressions
+//   db::expr::countWhere(table, col<2> == 42L && contains(col<1>, "acme"))
+// An expression's type is its syntax tree. It is bound to the table's schema once per query, converting every
+// literal to its column's member type, and then inlined into a single scan loop - there is no per row
+// dispatch on operators or column numbers.
+namespace db::expr
+{
+    // ColumnRef - column of the queried schema by position, written col<2> or col<db::ColumnType::COLUMN2>
+    template <size_t I>
+    struct ColumnRef
+    {
+        static constexpr size_t index = I;
+    };
+
+    template <auto C>
+    inline constexpr db::expr::ColumnRef<static_cast<size_t>(C)> col{};
+
+    enum class Op : uint8_t
+    {
+        Equal,
+        NotEqual,
+        Less,
+        LessEqual,
+        Greater,
+        GreaterEqual
+    };
+
+    // expression nodes - unbound, literals still have the type they were written with
+
+    template <db::expr::Op O, size_t I, typename V>
+    struct Compare
+    {
+        V value;
+    };
+
+    template <size_t I>
+    struct Contains
+    {
+        std::string needle;
+    };
+
+    template <typename L, typename R>
+    struct And
+    {
+        L left;
+        R right;
+    };
+
+    template <typename L, typename R>
+    struct Or
+    {
+        L left;
+        R right;
+    };
+
+    template <typename E>
+    struct Not
+    {
+        E operand;
+    };
+
+    // Constant - always or never, folded away when combined with another expression
+    template <bool B>
+    struct Constant
+    {
+    };
+
+    inline constexpr db::expr::Constant<true> always{};
+    inline constexpr db::expr::Constant<false> never{};
+
+    template <typename T>
+    struct IsExpression : std::false_type
+    {
+    };
+    template <db::expr::Op O, size_t I, typename V>
+    struct IsExpression<db::expr::Compare<O, I, V>> : std::true_type
+    {
+    };
+    template <size_t I>
+    struct IsExpression<db::expr::Contains<I>> : std::true_type
+    {
+    };
+    template <typename L, typename R>
+    struct IsExpression<db::expr::And<L, R>> : std::true_type
+    {
+    };
+    template <typename L, typename R>
+    struct IsExpression<db::expr::Or<L, R>> : std::true_type
+    {
+    };
+    template <typename E>
+    struct IsExpression<db::expr::Not<E>> : std::true_type
+    {
+    };
+    template <bool B>
+    struct IsExpression<db::expr::Constant<B>> : std::true_type
+    {
+    };
+
+    template <typename T>
+    concept Expression = IsExpression<std::remove_cvref_t<T>>::value;
+
+    template <typename T>
+    struct IsColumnRef : std::false_type
+    {
+    };
+    template <size_t I>
+    struct IsColumnRef<db::expr::ColumnRef<I>> : std::true_type
+    {
+    };
+
+    // Literal - anything compared with a column that is not itself a column or an expression
+    template <typename T>
+    concept Literal = !Expression<T> && !IsColumnRef<std::remove_cvref_t<T>>::value;
+
+    // string literals are kept as std::string so an expression owns its values
+    template <typename V>
+    using Stored = std::conditional_t<std::is_convertible_v<V, std::string_view> && !std::is_arithmetic_v<std::remove_cvref_t<V>>,
+                                      std::string, std::remove_cvref_t<V>>;
+
+    constexpr db::expr::Op mirrored(db::expr::Op op)
+    {
+        switch (op)
+        {
+        case db::expr::Op::Less:
+            return db::expr::Op::Greater;
+        case db::expr::Op::LessEqual:
+            return db::expr::Op::GreaterEqual;
+        case db::expr::Op::Greater:
+            return db::expr::Op::Less;
+        case db::expr::Op::GreaterEqual:
+            return db::expr::Op::LessEqual;
+        default:
+            return op;
+        }
+    }
+
+    constexpr db::expr::Op negated(db::expr::Op op)
+    {
+        switch (op)
+        {
+        case db::expr::Op::Equal:
+            return db::expr::Op::NotEqual;
+        case db::expr::Op::NotEqual:
+            return db::expr::Op::Equal;
+        case db::expr::Op::Less:
+            return db::expr::Op::GreaterEqual;
+        case db::expr::Op::LessEqual:
+            return db::expr::Op::Greater;
+        case db::expr::Op::Greater:
+            return db::expr::Op::LessEqual;
+        case db::expr::Op::GreaterEqual:
+            return db::expr::Op::Less;
+        }
+        return op;
+    }
+
+    // column op literal, and literal op column with the operator mirrored
+
+    template <db::expr::Op O, size_t I, typename V>
+    auto compare(V &&value)
+    {
+        return db::expr::Compare<O, I, db::expr::Stored<V>>{db::expr::Stored<V>(std::forward<V>(value))};
+    }
+
+#define QB_EXPR_COMPARISON(op, kind)                                                          \
+    template <size_t I, db::expr::Literal V>                                                  \
+    auto operator op(db::expr::ColumnRef<I>, V &&value)                                       \
+    {                                                                                         \
+        return db::expr::compare<kind, I>(std::forward<V>(value));                            \
+    }                                                                                         \
+    template <size_t I, db::expr::Literal V>                                                  \
+    auto operator op(V &&value, db::expr::ColumnRef<I>)                                       \
+    {                                                                                         \
+        return db::expr::compare<db::expr::mirrored(kind), I>(std::forward<V>(value));        \
+    }
+
+    QB_EXPR_COMPARISON(==, db::expr::Op::Equal)
+    QB_EXPR_COMPARISON(!=, db::expr::Op::NotEqual)
+    QB_EXPR_COMPARISON(<, db::expr::Op::Less)
+    QB_EXPR_COMPARISON(<=, db::expr::Op::LessEqual)
+    QB_EXPR_COMPARISON(>, db::expr::Op::Greater)
+    QB_EXPR_COMPARISON(>=, db::expr::Op::GreaterEqual)
+#undef QB_EXPR_COMPARISON
+
+    // substring match on a string column
+    template <size_t I>
+    db::expr::Contains<I> contains(db::expr::ColumnRef<I>, std::string needle)
+    {
+        return {std::move(needle)};
+    }
+
+    // logical operators - constants and double negation fold at compile time, a negated comparison becomes the
+    // opposite comparison
+
+    template <Expression L, Expression R>
+    auto operator&&(L &&left, R &&right)
+    {
+        using Left = std::remove_cvref_t<L>;
+        using Right = std::remove_cvref_t<R>;
+        if constexpr (std::is_same_v<Left, db::expr::Constant<true>>)
+            return Right(std::forward<R>(right));
+        else if constexpr (std::is_same_v<Right, db::expr::Constant<true>>)
+            return Left(std::forward<L>(left));
+        else if constexpr (std::is_same_v<Left, db::expr::Constant<false>> || std::is_same_v<Right, db::expr::Constant<false>>)
+            return db::expr::never;
+        else
+            return db::expr::And<Left, Right>{std::forward<L>(left), std::forward<R>(right)};
+    }
+
+    template <Expression L, Expression R>
+    auto operator||(L &&left, R &&right)
+    {
+        using Left = std::remove_cvref_t<L>;
+        using Right = std::remove_cvref_t<R>;
+        if constexpr (std::is_same_v<Left, db::expr::Constant<false>>)
+            return Right(std::forward<R>(right));
+        else if constexpr (std::is_same_v<Right, db::expr::Constant<false>>)
+            return Left(std::forward<L>(left));
+        else if constexpr (std::is_same_v<Left, db::expr::Constant<true>> || std::is_same_v<Right, db::expr::Constant<true>>)
+            return db::expr::always;
+        else
+            return db::expr::Or<Left, Right>{std::forward<L>(left), std::forward<R>(right)};
+    }
+
+    template <typename T>
+    struct IsFoldableNegation : std::false_type
+    {
+    };
+    template <typename E>
+    struct IsFoldableNegation<db::expr::Not<E>> : std::true_type
+    {
+    };
+    template <db::expr::Op O, size_t I, typename V>
+    struct IsFoldableNegation<db::expr::Compare<O, I, V>> : std::true_type
+    {
+    };
+
+    template <Expression E>
+        requires(!IsFoldableNegation<std::remove_cvref_t<E>>::value)
+    auto operator!(E &&operand)
+    {
+        using Operand = std::remove_cvref_t<E>;
+        if constexpr (std::is_same_v<Operand, db::expr::Constant<true>>)
+            return db::expr::never;
+        else if constexpr (std::is_same_v<Operand, db::expr::Constant<false>>)
+            return db::expr::always;
+        else
+            return db::expr::Not<Operand>{std::forward<E>(operand)};
+    }
+
+    template <typename E>
+    auto operator!(const db::expr::Not<E> &negation)
+    {
+        return negation.operand;
+    }
+
+    template <db::expr::Op O, size_t I, typename V>
+    auto operator!(const db::expr::Compare<O, I, V> &comparison)
+    {
+        return db::expr::Compare<db::expr::negated(O), I, V>{comparison.value};
+    }
+
+    // Integer - the integer types std::cmp_equal() and friends accept, bool and character types excluded
+    template <typename T>
+    concept Integer = std::is_integral_v<T> && !std::is_same_v<T, bool> && !std::is_same_v<T, char> && !std::is_same_v<T, wchar_t> &&
+                      !std::is_same_v<T, char8_t> && !std::is_same_v<T, char16_t> && !std::is_same_v<T, char32_t>;
+
+    // ConvertsWithoutNarrowing - To{from} is well-formed, e.g. long from int but not long from double
+    template <typename To, typename From>
+    concept ConvertsWithoutNarrowing = requires(const From &from) { To{from}; };
+
+    // bound nodes - literals converted to the member type of their column, evaluated on a record
+
+    template <typename Column, db::expr::Op O, typename Literal>
+    struct BoundCompare
+    {
+        using Type = typename Column::Type;
+        // integers compare by value in their own types, so col<0> > -5 holds for every unsigned id
+        static constexpr bool integers = db::expr::Integer<Type> && db::expr::Integer<Literal>;
+        // strings compare through a view of the literal, other values as the member type
+        using Value = std::conditional_t<integers, Literal, std::conditional_t<std::is_same_v<Type, std::string>, std::string, Type>>;
+        Value value;
+        static constexpr bool cheap = std::is_arithmetic_v<Type>;
+        static constexpr int cost = cheap ? 1 : 4;
+
+        template <typename Record>
+        bool operator()(const Record &record) const
+        {
+            const auto &field = record.*(Column::member);
+            if constexpr (integers)
+            {
+                if constexpr (O == db::expr::Op::Equal)
+                    return std::cmp_equal(field, value);
+                else if constexpr (O == db::expr::Op::NotEqual)
+                    return std::cmp_not_equal(field, value);
+                else if constexpr (O == db::expr::Op::Less)
+                    return std::cmp_less(field, value);
+                else if constexpr (O == db::expr::Op::LessEqual)
+                    return std::cmp_less_equal(field, value);
+                else if constexpr (O == db::expr::Op::Greater)
+                    return std::cmp_greater(field, value);
+                else
+                    return std::cmp_greater_equal(field, value);
+            }
+            else if constexpr (O == db::expr::Op::Equal)
+                return field == value;
+            else if constexpr (O == db::expr::Op::NotEqual)
+                return field != value;
+            else if constexpr (O == db::expr::Op::Less)
+                return field < value;
+            else if constexpr (O == db::expr::Op::LessEqual)
+                return field <= value;
+            else if constexpr (O == db::expr::Op::Greater)
+                return field > value;
+            else
+                return field >= value;
+        }
+    };
+
+    template <typename Column>
+    struct BoundContains
+    {
+        std::string needle;
+        static constexpr bool cheap = false;
+        static constexpr int cost = 16;
+
+        template <typename Record>
+        bool operator()(const Record &record) const
+        {
+            const std::string_view field = record.*(Column::member);
+            if (needle.size() == 1)
+                return field.find(needle.front()) != std::string_view::npos;
+            return field.find(needle) != std::string_view::npos;
+        }
+    };
+
+    // And and Or run the cheaper side first; two cheap comparisons are combined without a branch
+    template <typename L, typename R>
+    struct BoundAnd
+    {
+        L left;
+        R right;
+        static constexpr bool cheap = L::cheap && R::cheap;
+        static constexpr int cost = L::cost + R::cost;
+
+        template <typename Record>
+        bool operator()(const Record &record) const
+        {
+            if constexpr (cheap)
+                return bool(left(record)) & bool(right(record));
+            else if constexpr (R::cost < L::cost)
+                return right(record) && left(record);
+            else
+                return left(record) && right(record);
+        }
+    };
+
+    template <typename L, typename R>
+    struct BoundOr
+    {
+        L left;
+        R right;
+        static constexpr bool cheap = L::cheap && R::cheap;
+        static constexpr int cost = L::cost + R::cost;
+
+        template <typename Record>
+        bool operator()(const Record &record) const
+        {
+            if constexpr (cheap)
+                return bool(left(record)) | bool(right(record));
+            else if constexpr (R::cost < L::cost)
+                return right(record) || left(record);
+            else
+                return left(record) || right(record);
+        }
+    };
+
+    template <typename E>
+    struct BoundNot
+    {
+        E operand;
+        static constexpr bool cheap = E::cheap;
+        static constexpr int cost = E::cost;
+
+        template <typename Record>
+        bool operator()(const Record &record) const { return !operand(record); }
+    };
+
+    template <bool B>
+    struct BoundConstant
+    {
+        static constexpr bool cheap = true;
+        static constexpr int cost = 0;
+
+        template <typename Record>
+        constexpr bool operator()(const Record &) const { return B; }
+    };
+
+    // bind an expression to a schema - column types are checked here, at compile time
+
+    template <typename Schema, db::expr::Op O, size_t I, typename V>
+    auto bind(const db::expr::Compare<O, I, V> &node)
+    {
+        using Column = typename db::SchemaTable<Schema>::template ColumnAt<I>;
+        using Bound = db::expr::BoundCompare<Column, O, V>;
+        static_assert(Bound::integers || db::expr::ConvertsWithoutNarrowing<typename Bound::Value, V>,
+                      "literal does not convert to the column's type without narrowing");
+        return Bound{typename Bound::Value(node.value)};
+    }
+
+    template <typename Schema, size_t I>
+    auto bind(const db::expr::Contains<I> &node)
+    {
+        using Column = typename db::SchemaTable<Schema>::template ColumnAt<I>;
+        static_assert(std::is_convertible_v<const typename Column::Type &, std::string_view>, "contains() needs a string column");
+        return db::expr::BoundContains<Column>{node.needle};
+    }
+
+    template <typename Schema, typename L, typename R>
+    auto bind(const db::expr::And<L, R> &node)
+    {
+        auto left = db::expr::bind<Schema>(node.left);
+        auto right = db::expr::bind<Schema>(node.right);
+        return db::expr::BoundAnd<decltype(left), decltype(right)>{std::move(left), std::move(right)};
+    }
+
+    template <typename Schema, typename L, typename R>
+    auto bind(const db::expr::Or<L, R> &node)
+    {
+        auto left = db::expr::bind<Schema>(node.left);
+        auto right = db::expr::bind<Schema>(node.right);
+        return db::expr::BoundOr<decltype(left), decltype(right)>{std::move(left), std::move(right)};
+    }
+
+    template <typename Schema, typename E>
+    auto bind(const db::expr::Not<E> &node)
+    {
+        auto operand = db::expr::bind<Schema>(node.operand);
+        return db::expr::BoundNot<decltype(operand)>{std::move(operand)};
+    }
+
+    template <typename Schema, bool B>
+    auto bind(const db::expr::Constant<B> &)
+    {
+        return db::expr::BoundConstant<B>{};
+    }
+
+    // queries - one scan over the active records with the bound expression inlined into the loop
+
+    template <typename Schema, Expression E, typename Visitor>
+    size_t forEachWhere(const db::SchemaTable<Schema> &table, const E &expression, Visitor &&visit)
+    {
+        const auto bound = db::expr::bind<Schema>(expression);
+        size_t matches = 0;
+        if constexpr (std::is_same_v<E, db::expr::Constant<false>>)
+            return matches;
+        else
+            table.forEachRecord([&](const typename Schema::Record &record)
+                            {
+                                if (bound(record))
+                                {
+                                    visit(record);
+                                    ++matches;
+                                }
+                                return true; });
+        return matches;
+    }
+
+    template <typename Schema, Expression E>
+    size_t countWhere(const db::SchemaTable<Schema> &table, const E &expression)
+    {
+        return db::expr::forEachWhere(table, expression, [](const typename Schema::Record &) {});
+    }
+
+    template <typename Schema, Expression E>
+    std::vector<typename Schema::Record> findWhere(const db::SchemaTable<Schema> &table, const E &expression)
+    {
+        std::vector<typename Schema::Record> result;
+        db::expr::forEachWhere(table, expression, [&](const typename Schema::Record &record)
+                               { result.push_back(record); });
+        return result;
+    }
+}
@@ -0,0 +1,129 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Quickbase full-text index declarations - tokenizer, compressed inverted index and BM25 ranked retrieval
+namespace db
+{
+    // TokenizerOptions - how text is split into terms; a token is a run of ASCII letters and digits and of bytes
+    // above 0x7f, so UTF-8 words stay whole
+    struct TokenizerOptions
+    {
+        bool lowercase = true;   // fold ASCII letters to lower case
+        bool keepDigits = true;  // false drops tokens made of digits only
+        size_t minLength = 1;    // shorter tokens are dropped
+        size_t maxLength = 32;   // longer tokens are truncated
+        std::vector<std::string> stopWords; // dropped after normalization
+    };
+
+    class Tokenizer
+    {
+    private:
+        db::TokenizerOptions options_;
+        std::unordered_set<std::string> stopWords_;
+
+    public:
+        explicit Tokenizer(db::TokenizerOptions options = {});
+
+        // terms of text in order, repeated terms included
+        std::vector<std::string> tokenize(std::string_view text) const;
+        const db::TokenizerOptions &options() const noexcept { return options_; }
+    };
+
+    // Bm25Options - term frequency saturation k1 and document length normalization b
+    struct Bm25Options
+    {
+        double k1 = 1.2;
+        double b = 0.75;
+    };
+
+    struct ScoredRow
+    {
+        size_t row;
+        double score;
+    };
+
+    // FullTextHits - best rows first, with the work the search did
+    struct FullTextHits
+    {
+        std::vector<db::ScoredRow> rows;
+        size_t postingsDecoded = 0;
+        size_t candidates = 0; // rows whose score was computed in full
+    };
+
+    // FullTextIndex - inverted index from terms to the rows holding them, with term frequencies
+    // Posting lists are delta and varint coded in blocks of 128 postings; a skip entry per block holds its last
+    // row, so a cursor seeks past whole blocks without decoding them. Rows are appended in increasing order;
+    // replacing a row's text rewrites the lists of its old and new terms. Removed rows stay in the lists until
+    // their dead postings outnumber the live ones, and a removed row is not added again before clear().
+    // search() ranks by BM25 and skips postings with MaxScore: terms are ordered by their score upper bound, and
+    // once k rows are held, the terms whose bounds together cannot beat the k-th score are only probed for rows
+    // the others produce, seeking rather than scanning. Scores are identical with early termination off.
+    class FullTextIndex
+    {
+    public:
+        static constexpr size_t kBlockSize = 128;
+
+        struct Block
+        {
+            size_t lastRow;
+            size_t offset; // first byte of the block in bytes
+            uint32_t count;
+        };
+
+        struct PostingList
+        {
+            std::vector<uint8_t> bytes;
+            std::vector<Block> blocks;
+            uint32_t live = 0; // document frequency
+            uint32_t dead = 0; // postings of removed rows
+            uint32_t maxTf = 0;
+            uint32_t minLength = UINT32_MAX; // shortest document holding the term, bounds the score with maxTf
+        };
+
+    private:
+        db::Tokenizer tokenizer_;
+        db::Bm25Options bm25_;
+        std::unordered_map<std::string, PostingList> terms_;
+        // per row: token count, 0 for rows never added, and whether it is live or removed
+        std::vector<uint32_t> lengths_;
+        std::vector<uint8_t> states_;
+        size_t documents_ = 0;
+        uint64_t totalLength_ = 0;
+
+        // distinct terms of text with their frequency, and the token count
+        std::vector<std::pair<std::string, uint32_t>> termFrequencies(std::string_view text, uint32_t &length) const;
+        void insertPosting(PostingList &list, size_t row, uint32_t tf);
+        // re-encode a list without the postings of rows that are not live, or without one row
+        void rewrite(PostingList &list, size_t droppedRow);
+
+    public:
+        explicit FullTextIndex(db::TokenizerOptions tokenizer = {}, db::Bm25Options bm25 = {});
+
+        void add(size_t row, std::string_view text);
+        // text is what the row holds in the index
+        void remove(size_t row, std::string_view text);
+        void replace(size_t row, std::string_view oldText, std::string_view newText);
+        void clear() noexcept;
+
+        // best k live rows for the terms of query, accept filters candidates before they are ranked
+        db::FullTextHits search(std::string_view query, size_t k, const std::function<bool(size_t)> &accept = {},
+                                bool earlyTermination = true) const;
+
+        const db::Tokenizer &tokenizer() const noexcept { return tokenizer_; }
+        size_t documentCount() const noexcept { return documents_; }
+        size_t termCount() const noexcept { return terms_.size(); }
+        // live postings of a term after tokenizing it, 0 when absent
+        size_t documentFrequency(std::string_view term) const;
+        size_t postingCount() const noexcept;
+        // bytes of the coded postings and their skip entries
+        size_t postingBytes() const noexcept;
+        size_t memoryUsage() const noexcept;
+    };
+}
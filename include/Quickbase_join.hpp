@@ -0,0 +1,329 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <variant>
+#include <vector>
+#include "./Quickbase.hpp"
+#include "./Quickbase_dynamic.hpp"
+
+// Quickbase join declarations - equi-joins between QBTable and QBTableDynamic instances
+// A join reads both tables in place: the tables must not be modified while a Join over them is open.
+namespace db::join
+{
+    // JoinKey - normalized key value, numbers of either column type compare equal by value
+    using JoinKey = std::variant<long, std::string>;
+
+    enum class Strategy : uint8_t
+    {
+        Auto,            // index probe when the inner key is indexed and unfiltered by where(), else hash join
+        HashBuildLeft,   // hash the left candidates, probe with the right
+        HashBuildRight,  // hash the right candidates, probe with the left
+        IndexProbeLeft,  // scan the right, look every key up in the left table's primary key or secondary index
+        IndexProbeRight  // scan the left, look every key up in the right table's primary key or secondary index
+    };
+
+    // StaticSide - a QBTable input: its join key column and the predicates pushed down into its scan
+    // where() predicates follow forEachMatching() rules, the first one drives the scan through the column's index
+    struct StaticSide
+    {
+        using Record = db::QBRecord;
+
+        const db::QBTable *table = nullptr;
+        db::ColumnType key = db::ColumnType::COLUMN0;
+        std::vector<std::pair<db::ColumnType, std::string>> predicates;
+        std::function<bool(const db::QBRecord &)> filter; // residual predicate, evaluated on every candidate
+
+        StaticSide &where(db::ColumnType column, std::string matchString);
+        StaticSide &where(std::function<bool(const db::QBRecord &)> predicate);
+    };
+
+    // DynamicSide - a QBTableDynamic input, key and where() columns are "id" or physical columns
+    struct DynamicSide
+    {
+        using Record = db::QBRecordDynamic;
+
+        const db::QBTableDynamic *table = nullptr;
+        std::string key = "id";
+        std::vector<std::pair<std::string, db::FieldType>> predicates;
+        std::function<bool(const db::QBRecordDynamic &)> filter;
+
+        DynamicSide &where(std::string column, db::FieldType value);
+        DynamicSide &where(std::function<bool(const db::QBRecordDynamic &)> predicate);
+    };
+
+    db::join::StaticSide side(const db::QBTable &table, db::ColumnType key);
+    db::join::DynamicSide side(const db::QBTableDynamic &table, std::string key);
+
+    // per side access, overloaded for both side types
+    // scan - visit every active record passing the pushed down predicates
+    size_t scan(const db::join::StaticSide &side, const std::function<void(const db::QBRecord &)> &visit);
+    size_t scan(const db::join::DynamicSide &side, const std::function<void(const db::QBRecordDynamic &)> &visit);
+    std::optional<db::join::JoinKey> keyOf(const db::join::StaticSide &side, const db::QBRecord &record);
+    std::optional<db::join::JoinKey> keyOf(const db::join::DynamicSide &side, const db::QBRecordDynamic &record);
+    // whether probe() can look keys up through the primary key or a secondary index of the key column
+    bool indexed(const db::join::StaticSide &side);
+    bool indexed(const db::join::DynamicSide &side);
+    // look up a batch of keys, visit(position in keys, record) for every active match passing the predicates
+    void probe(const db::join::StaticSide &side, std::span<const db::join::JoinKey> keys,
+               const std::function<void(size_t, const db::QBRecord &)> &visit);
+    void probe(const db::join::DynamicSide &side, std::span<const db::join::JoinKey> keys,
+               const std::function<void(size_t, const db::QBRecordDynamic &)> &visit);
+    std::string describe(const db::join::StaticSide &side);
+    std::string describe(const db::join::DynamicSide &side);
+
+    struct JoinStats
+    {
+        size_t leftCandidates = 0;  // rows read from the left after pushdown, 0 when it is index probed
+        size_t rightCandidates = 0; // rows read from the right after pushdown, 0 when it is index probed
+        size_t probes = 0;          // hash table or index lookups
+        size_t pairs = 0;           // joined pairs returned so far
+    };
+
+    // Join - inner equi-join of two sides, producing (left, right) record pairs one at a time
+    // Candidates are collected as record pointers on the first next(); pairs are generated on demand, the
+    // hash join in probe side order and the index probe in batches of kProbeBatch outer rows.
+    template <typename LeftSide, typename RightSide>
+    class Join
+    {
+    public:
+        using Left = typename LeftSide::Record;
+        using Right = typename RightSide::Record;
+        static constexpr size_t kProbeBatch = 256;
+
+    private:
+        LeftSide left_;
+        RightSide right_;
+        db::join::Strategy strategy_;
+        bool started_ = false;
+        db::join::JoinStats stats_;
+
+        std::vector<const Left *> leftRows_;
+        std::vector<const Right *> rightRows_;
+        // hash join - build rows chained per key by position, heads and next_ hold position + 1
+        // numeric keys use open addressing with linear probing, string keys a node map
+        std::vector<std::pair<long, uint32_t>> numericHeads_;
+        size_t numericMask_ = 0;
+        std::unordered_map<std::string, uint32_t> stringHeads_;
+        std::vector<uint32_t> next_;
+        size_t probePos_ = 0;
+        uint32_t chain_ = 0;
+        // index probe - pairs of the current outer batch
+        std::vector<std::pair<const Left *, const Right *>> pending_;
+        size_t pendingPos_ = 0;
+
+        size_t numericSlot(long key) const
+        {
+            size_t i = (static_cast<size_t>(key) * 0x9E3779B97F4A7C15ull) >> 20 & numericMask_;
+            while (numericHeads_[i].second != 0 && numericHeads_[i].first != key)
+                i = (i + 1) & numericMask_;
+            return i;
+        }
+
+        uint32_t head(const db::join::JoinKey &key) const
+        {
+            if (const long *number = std::get_if<long>(&key))
+                return numericHeads_[numericSlot(*number)].second;
+            auto it = stringHeads_.find(std::get<std::string>(key));
+            return it == stringHeads_.end() ? 0 : it->second;
+        }
+
+        template <typename BuildSide, typename BuildRecord>
+        void build(const BuildSide &side, const std::vector<const BuildRecord *> &rows)
+        {
+            size_t buckets = 16;
+            while (buckets < rows.size() * 2)
+                buckets *= 2;
+            numericHeads_.assign(buckets, {0, 0});
+            numericMask_ = buckets - 1;
+            next_.assign(rows.size(), 0);
+            // insert backwards so every chain lists its rows in storage order
+            for (size_t i = rows.size(); i-- > 0;)
+            {
+                auto key = db::join::keyOf(side, *rows[i]);
+                if (!key)
+                    continue;
+                uint32_t *first = nullptr;
+                if (const long *number = std::get_if<long>(&*key))
+                {
+                    auto &slot = numericHeads_[numericSlot(*number)];
+                    slot.first = *number;
+                    first = &slot.second;
+                }
+                else
+                    first = &stringHeads_[std::move(std::get<std::string>(*key))];
+                next_[i] = *first;
+                *first = uint32_t(i + 1);
+            }
+        }
+
+        void start()
+        {
+            started_ = true;
+            if (strategy_ != db::join::Strategy::IndexProbeLeft)
+                stats_.leftCandidates = db::join::scan(left_, [&](const Left &rec)
+                                                       { leftRows_.push_back(&rec); });
+            if (strategy_ != db::join::Strategy::IndexProbeRight)
+                stats_.rightCandidates = db::join::scan(right_, [&](const Right &rec)
+                                                        { rightRows_.push_back(&rec); });
+            if (strategy_ == db::join::Strategy::Auto)
+                strategy_ = leftRows_.size() < rightRows_.size() ? db::join::Strategy::HashBuildLeft : db::join::Strategy::HashBuildRight;
+            if (strategy_ == db::join::Strategy::HashBuildLeft)
+                build(left_, leftRows_);
+            else if (strategy_ == db::join::Strategy::HashBuildRight)
+                build(right_, rightRows_);
+        }
+
+        // next pair of the hash join, walking the probe rows and the build chain of each
+        template <typename ProbeSide, typename ProbeRecord, typename BuildRecord, typename Emit>
+        bool nextHashed(const ProbeSide &side, const std::vector<const ProbeRecord *> &probeRows,
+                        const std::vector<const BuildRecord *> &buildRows, Emit &&emit)
+        {
+            while (chain_ == 0)
+            {
+                if (probePos_ >= probeRows.size())
+                    return false;
+                auto key = db::join::keyOf(side, *probeRows[probePos_++]);
+                if (!key)
+                    continue;
+                ++stats_.probes;
+                chain_ = head(*key);
+            }
+            emit(*probeRows[probePos_ - 1], *buildRows[chain_ - 1]);
+            chain_ = next_[chain_ - 1];
+            return true;
+        }
+
+        // refill pending_ with the pairs of the next batch of outer rows
+        template <typename OuterSide, typename OuterRecord, typename InnerSide, typename Emit>
+        bool nextProbeBatch(const OuterSide &outer, const std::vector<const OuterRecord *> &outerRows, const InnerSide &inner, Emit &&emit)
+        {
+            std::vector<const OuterRecord *> batchRows;
+            std::vector<db::join::JoinKey> keys;
+            while (pending_.empty() && probePos_ < outerRows.size())
+            {
+                batchRows.clear();
+                keys.clear();
+                for (; probePos_ < outerRows.size() && keys.size() < kProbeBatch; ++probePos_)
+                {
+                    auto key = db::join::keyOf(outer, *outerRows[probePos_]);
+                    if (!key)
+                        continue;
+                    batchRows.push_back(outerRows[probePos_]);
+                    keys.push_back(std::move(*key));
+                }
+                stats_.probes += keys.size();
+                db::join::probe(inner, keys, [&](size_t i, const auto &match)
+                                { emit(*batchRows[i], match); });
+            }
+            pendingPos_ = 0;
+            return !pending_.empty();
+        }
+
+    public:
+        Join(LeftSide left, RightSide right, db::join::Strategy strategy = db::join::Strategy::Auto)
+            : left_(std::move(left)), right_(std::move(right)), strategy_(strategy)
+        {
+            if (strategy_ == db::join::Strategy::Auto)
+            {
+                // probe into an indexed side whose rows are not narrowed by where() - a filtered side is usually
+                // small enough to hash; with both sides indexed the smaller table drives
+                const bool probeLeft = db::join::indexed(left_) && left_.predicates.empty();
+                const bool probeRight = db::join::indexed(right_) && right_.predicates.empty();
+                if (probeLeft && probeRight)
+                    strategy_ = left_.table->totalRecordsCount() > right_.table->totalRecordsCount() ? db::join::Strategy::IndexProbeLeft
+                                                                                                    : db::join::Strategy::IndexProbeRight;
+                else if (probeLeft || probeRight)
+                    strategy_ = probeLeft ? db::join::Strategy::IndexProbeLeft : db::join::Strategy::IndexProbeRight;
+            }
+            else if ((strategy_ == db::join::Strategy::IndexProbeLeft && !db::join::indexed(left_)) ||
+                     (strategy_ == db::join::Strategy::IndexProbeRight && !db::join::indexed(right_)))
+                throw std::invalid_argument("Index probe join requires an indexed key column on the probed side");
+        }
+
+        // next joined pair, false when the join is exhausted
+        bool next(const Left *&left, const Right *&right)
+        {
+            if (!started_)
+                start();
+            bool found = false;
+            switch (strategy_)
+            {
+            case db::join::Strategy::HashBuildLeft:
+                found = nextHashed(right_, rightRows_, leftRows_, [&](const Right &r, const Left &l)
+                                   { left = &l; right = &r; });
+                break;
+            case db::join::Strategy::HashBuildRight:
+                found = nextHashed(left_, leftRows_, rightRows_, [&](const Left &l, const Right &r)
+                                   { left = &l; right = &r; });
+                break;
+            case db::join::Strategy::IndexProbeLeft:
+            case db::join::Strategy::IndexProbeRight:
+                if (pendingPos_ >= pending_.size())
+                {
+                    pending_.clear();
+                    if (strategy_ == db::join::Strategy::IndexProbeRight)
+                        nextProbeBatch(left_, leftRows_, right_, [&](const Left &l, const Right &r)
+                                       { pending_.emplace_back(&l, &r); });
+                    else
+                        nextProbeBatch(right_, rightRows_, left_, [&](const Right &r, const Left &l)
+                                       { pending_.emplace_back(&l, &r); });
+                }
+                if (pendingPos_ < pending_.size())
+                {
+                    std::tie(left, right) = pending_[pendingPos_++];
+                    found = true;
+                }
+                break;
+            case db::join::Strategy::Auto:
+                break;
+            }
+            stats_.pairs += found ? 1 : 0;
+            return found;
+        }
+
+        // visit every remaining pair, returns the number visited
+        template <typename Visitor>
+        size_t forEach(Visitor &&visit)
+        {
+            const Left *left = nullptr;
+            const Right *right = nullptr;
+            size_t visited = 0;
+            while (next(left, right))
+            {
+                visit(*left, *right);
+                ++visited;
+            }
+            return visited;
+        }
+
+        // chosen strategy - Auto resolves to a hash join side on the first next()
+        db::join::Strategy strategy() const noexcept { return strategy_; }
+        const db::join::JoinStats &stats() const noexcept { return stats_; }
+
+        std::string explain() const
+        {
+            switch (strategy_)
+            {
+            case db::join::Strategy::HashBuildLeft:
+                return "hash join: build " + db::join::describe(left_) + ", probe " + db::join::describe(right_);
+            case db::join::Strategy::HashBuildRight:
+                return "hash join: build " + db::join::describe(right_) + ", probe " + db::join::describe(left_);
+            case db::join::Strategy::IndexProbeLeft:
+                return "index nested loop: scan " + db::join::describe(right_) + ", look up " + db::join::describe(left_);
+            case db::join::Strategy::IndexProbeRight:
+                return "index nested loop: scan " + db::join::describe(left_) + ", look up " + db::join::describe(right_);
+            case db::join::Strategy::Auto:
+                break;
+            }
+            return "hash join on the smaller of " + db::join::describe(left_) + " and " + db::join::describe(right_);
+        }
+    };
+
+    template <typename LeftSide, typename RightSide>
+    Join(LeftSide, RightSide, db::join::Strategy = db::join::Strategy::Auto) -> Join<LeftSide, RightSide>;
+}
@@ -0,0 +1,249 @@
+#pragma once
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "./Quickbase_types.hpp"
+
+// Quickbase table server wire protocol
+// Every frame is | u32 length | u8 code | u32 request id | payload |, length counts code + id + payload.
+// Requests carry an Opcode as code, responses a Status. Integers are little-endian (host order on all
+// supported targets), strings are length-prefixed (u16 for names, u32 for values) and fields are
+// | u8 tag | value |.
+namespace db::wire
+{
+    constexpr size_t kHeaderSize = 9;
+    constexpr uint32_t kMaxFrameSize = 64u << 20;
+    constexpr size_t kMaxNameSize = 0xFFFF; // longer names (error messages quoting a client's input) are cut
+
+    enum class Opcode : uint8_t
+    {
+        CreateTable = 1, // name, engine [dynamic: u16 columns, (name, default field)*]
+        Find = 2,        // name, [static: u8 column, u32 string literal] [dynamic: column name, field]
+        Add = 3,         // name, record
+        Delete = 4,      // name, u32 id, u8 hard delete
+        CreateIndex = 5  // name, [static: u8 column] [dynamic: column name]
+    };
+
+    enum class Status : uint8_t
+    {
+        Ok = 0,         // Find: u32 row count, rows
+        NotFound = 1,   // unknown table or record
+        BadRequest = 2, // malformed frame or rejected record, payload is a message
+        Error = 3       // operation failed, payload is a message
+    };
+
+    enum class Engine : uint8_t
+    {
+        Static = 0, // QBTable
+        Dynamic = 1 // QBTableDynamic
+    };
+
+    enum class FieldTag : uint8_t
+    {
+        Uint = 0,
+        Long = 1,
+        String = 2
+    };
+
+    class ProtocolError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // FrameHeader - decoded fixed part of a frame
+    struct FrameHeader
+    {
+        uint32_t length;
+        uint8_t code;
+        uint32_t requestId;
+
+        size_t frameSize() const noexcept { return sizeof(uint32_t) + length; }
+    };
+
+    /**
+     * Decode a frame header if a complete frame is buffered, throws ProtocolError on oversized frames
+     */
+    inline bool peekFrame(const char *data, size_t size, FrameHeader &header)
+    {
+        if (size < kHeaderSize)
+            return false;
+        std::memcpy(&header.length, data, sizeof(uint32_t));
+        if (header.length < kHeaderSize - sizeof(uint32_t) || header.length > kMaxFrameSize)
+            throw ProtocolError("Invalid frame length " + std::to_string(header.length));
+        header.code = static_cast<uint8_t>(data[4]);
+        std::memcpy(&header.requestId, data + 5, sizeof(uint32_t));
+        return size >= header.frameSize();
+    }
+
+    // Writer - appends encoded values to a buffer, beginFrame()/endFrame() patch the frame length
+    class Writer
+    {
+    private:
+        std::vector<char> &buf_;
+
+    public:
+        explicit Writer(std::vector<char> &buf) : buf_(buf) {}
+
+        void putBytes(const void *data, size_t size)
+        {
+            const char *bytes = static_cast<const char *>(data);
+            buf_.insert(buf_.end(), bytes, bytes + size);
+        }
+        void putU8(uint8_t v) { buf_.push_back(static_cast<char>(v)); }
+        void putU16(uint16_t v) { putBytes(&v, sizeof(v)); }
+        void putU32(uint32_t v) { putBytes(&v, sizeof(v)); }
+        void putU64(uint64_t v) { putBytes(&v, sizeof(v)); }
+        void putI64(int64_t v) { putBytes(&v, sizeof(v)); }
+        void putName(std::string_view v)
+        {
+            v = v.substr(0, kMaxNameSize);
+            putU16(static_cast<uint16_t>(v.size()));
+            putBytes(v.data(), v.size());
+        }
+        void putString(std::string_view v)
+        {
+            putU32(static_cast<uint32_t>(v.size()));
+            putBytes(v.data(), v.size());
+        }
+        void putField(const db::FieldType &field)
+        {
+            if (const auto *u = std::get_if<db::uint>(&field))
+            {
+                putU8(static_cast<uint8_t>(FieldTag::Uint));
+                putU32(*u);
+            }
+            else if (const auto *l = std::get_if<long>(&field))
+            {
+                putU8(static_cast<uint8_t>(FieldTag::Long));
+                putI64(*l);
+            }
+            else
+            {
+                putU8(static_cast<uint8_t>(FieldTag::String));
+                putString(std::get<std::string>(field));
+            }
+        }
+        void putRecord(const db::QBRecord &rec)
+        {
+            putU32(rec.column0);
+            putString(rec.column1);
+            putI64(rec.column2);
+            putString(rec.column3);
+        }
+        void putDynamicRecord(const db::QBRecordDynamic &rec)
+        {
+            putU32(rec.id);
+            putU16(static_cast<uint16_t>(rec.fields.size()));
+            for (const auto &[name, field] : rec.fields)
+            {
+                putName(name);
+                putField(field);
+            }
+        }
+
+        // start a frame, returns its offset for endFrame()
+        size_t beginFrame(uint8_t code, uint32_t requestId)
+        {
+            size_t start = buf_.size();
+            putU32(0);
+            putU8(code);
+            putU32(requestId);
+            return start;
+        }
+        void endFrame(size_t start)
+        {
+            uint32_t length = static_cast<uint32_t>(buf_.size() - start - sizeof(uint32_t));
+            std::memcpy(buf_.data() + start, &length, sizeof(length));
+        }
+        // reserve a u32 to be filled in later, e.g. a row count
+        size_t reserveU32()
+        {
+            size_t pos = buf_.size();
+            putU32(0);
+            return pos;
+        }
+        void patchU32(size_t pos, uint32_t v) { std::memcpy(buf_.data() + pos, &v, sizeof(v)); }
+    };
+
+    // Reader - decodes values from a frame payload, strings are returned as views into the frame
+    class Reader
+    {
+    private:
+        const char *pos_;
+        const char *end_;
+
+        const char *take(size_t size)
+        {
+            if (size_t(end_ - pos_) < size)
+                throw ProtocolError("Truncated frame");
+            const char *at = pos_;
+            pos_ += size;
+            return at;
+        }
+        template <typename T>
+        T get()
+        {
+            T v;
+            std::memcpy(&v, take(sizeof(T)), sizeof(T));
+            return v;
+        }
+
+    public:
+        Reader(const char *data, size_t size) : pos_(data), end_(data + size) {}
+
+        bool empty() const noexcept { return pos_ == end_; }
+        uint8_t getU8() { return get<uint8_t>(); }
+        uint16_t getU16() { return get<uint16_t>(); }
+        uint32_t getU32() { return get<uint32_t>(); }
+        uint64_t getU64() { return get<uint64_t>(); }
+        int64_t getI64() { return get<int64_t>(); }
+        std::string_view getName()
+        {
+            uint16_t size = getU16();
+            return {take(size), size};
+        }
+        std::string_view getString()
+        {
+            uint32_t size = getU32();
+            return {take(size), size};
+        }
+        db::FieldType getField()
+        {
+            switch (static_cast<FieldTag>(getU8()))
+            {
+            case FieldTag::Uint:
+                return db::FieldType(static_cast<db::uint>(getU32()));
+            case FieldTag::Long:
+                return db::FieldType(static_cast<long>(getI64()));
+            case FieldTag::String:
+                return db::FieldType(std::string(getString()));
+            }
+            throw ProtocolError("Unknown field tag");
+        }
+        db::QBRecord getRecord()
+        {
+            db::QBRecord rec;
+            rec.column0 = getU32();
+            rec.column1 = std::string(getString());
+            rec.column2 = static_cast<long>(getI64());
+            rec.column3 = std::string(getString());
+            return rec;
+        }
+        db::QBRecordDynamic getDynamicRecord()
+        {
+            db::QBRecordDynamic rec;
+            rec.id = getU32();
+            uint16_t count = getU16();
+            for (uint16_t i = 0; i < count; ++i)
+            {
+                std::string name(getName());
+                rec.fields.emplace(std::move(name), getField());
+            }
+            return rec;
+        }
+    };
+}
@@ -0,0 +1,157 @@
+#pragma once
+#include <cstdint>
+#include <list>
+#include <map>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <variant>
+#include <vector>
+#include "./Quickbase.hpp"
+#include "./Quickbase_dynamic.hpp"
+
+// Quickbase query language declarations - a SQL subset over QBTable and QBTableDynamic
+//   SELECT * | COUNT(*) | column [, column ...] FROM table
+//     [WHERE column = literal | column LIKE 'pattern' [AND ...]] [LIMIT n]
+// Keywords are case insensitive, literals are integers or single quoted strings ('' escapes a quote),
+// LIKE patterns use % for any sequence and _ for any single character.
+namespace db::query
+{
+    class QueryError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    enum class CompareOp : uint8_t
+    {
+        Equal,
+        Like
+    };
+
+    // Literal - integer or string constant from the query text
+    struct Literal
+    {
+        bool isNumber = false;
+        long number = 0;
+        std::string text;
+    };
+
+    struct Predicate
+    {
+        std::string column;
+        CompareOp op = CompareOp::Equal;
+        db::query::Literal value;
+    };
+
+    // SelectStatement - parsed query, not yet bound to a table
+    struct SelectStatement
+    {
+        std::string table;
+        bool count = false;
+        std::vector<std::string> columns; // empty selects every column
+        std::vector<db::query::Predicate> where;
+        std::optional<size_t> limit;
+    };
+
+    // parse a query, throws QueryError with the offending position on syntax errors
+    db::query::SelectStatement parse(std::string_view text);
+    // plan cache key - trims the text and collapses whitespace outside string literals
+    std::string normalize(std::string_view text);
+    // SQL LIKE matching
+    bool likeMatch(std::string_view value, std::string_view pattern);
+
+    enum class AccessPath : uint8_t
+    {
+        PrimaryKey,  // primary key lookup
+        IndexLookup, // secondary index lookup
+        ColumnScan,  // table scan on one column through forEachMatching (substring or exact compare)
+        FullScan     // forEachRecord, every predicate is evaluated per record
+    };
+
+    // Plan - a statement bound to a table with its access path chosen
+    // Every predicate is re-checked on the rows the access path produces, so a plan stays correct if the
+    // table's indexes change after planning - it is only slower until replanned.
+    struct Plan
+    {
+        db::query::SelectStatement statement;
+        db::query::AccessPath access = db::query::AccessPath::FullScan;
+        bool dynamic = false;
+        size_t driving = 0; // index of the predicate driving the access path, unless FullScan
+        // whether each predicate's column was indexed at planning time, compared by prepare() to replan
+        std::vector<bool> indexSignature;
+
+        // QBTable binding
+        db::ColumnType drivingColumn = db::ColumnType::COLUMN0;
+        std::string drivingLiteral; // matchString passed to forEachMatching
+        std::vector<db::ColumnType> predicateColumns;
+        std::vector<db::ColumnType> projection;
+
+        // QBTableDynamic binding - an integer literal probes both the uint and long representation
+        std::vector<db::FieldType> probes;
+        std::vector<std::string> projectionNames;
+
+        std::vector<std::string> columnNames() const;
+        std::string explain() const;
+    };
+
+    // QueryResult - cells are stored row-major, a missing field of a dynamic record is std::nullopt
+    struct QueryResult
+    {
+        std::vector<std::string> columns;
+        std::vector<std::optional<db::FieldType>> cells;
+
+        size_t rowCount() const noexcept { return columns.empty() ? 0 : cells.size() / columns.size(); }
+        const std::optional<db::FieldType> &at(size_t row, size_t column) const { return cells[row * columns.size() + column]; }
+    };
+
+    struct PlanCacheStats
+    {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        uint64_t replans = 0; // cached plans rebuilt because an index was created or dropped
+        size_t size = 0;
+    };
+
+    // QueryEngine - resolves table names, plans statements and caches plans by normalized query text
+    // Tables are referenced, not owned, and must outlive the engine. Not thread safe: prepare() and execute() of
+    // a statement update the plan cache.
+    class QueryEngine
+    {
+    private:
+        using TableRef = std::variant<const db::QBTable *, const db::QBTableDynamic *>;
+        using CacheEntry = std::pair<std::string, std::shared_ptr<const db::query::Plan>>;
+
+        std::map<std::string, TableRef, std::less<>> tables_;
+        size_t cacheCapacity_;
+        // plan cache - least recently used entry at the back of lru_
+        std::list<CacheEntry> lru_;
+        std::unordered_map<std::string, std::list<CacheEntry>::iterator> cache_;
+        db::query::PlanCacheStats cacheStats_;
+
+        const TableRef &resolve(std::string_view table) const;
+        std::shared_ptr<const db::query::Plan> plan(db::query::SelectStatement statement) const;
+        std::vector<bool> indexSignature(const db::query::Plan &plan) const;
+
+    public:
+        explicit QueryEngine(size_t planCacheCapacity = 256);
+
+        // register a table under a name, replacing any table of that name - clears the plan cache
+        void registerTable(const std::string &name, const db::QBTable &table);
+        void registerTable(const std::string &name, const db::QBTableDynamic &table);
+
+        // parse and plan, or reuse the cached plan for the same normalized text
+        std::shared_ptr<const db::query::Plan> prepare(std::string_view sql);
+        db::query::QueryResult execute(std::string_view sql);
+        db::query::QueryResult execute(const db::query::Plan &plan) const;
+        // plan description followed by the table's own explain() of the driving access path
+        std::string explain(std::string_view sql);
+
+        db::query::PlanCacheStats cacheStats() const;
+        void clearCache();
+    };
+}
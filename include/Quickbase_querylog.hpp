@@ -0,0 +1,99 @@
+#pragma once
+#include <cstdint>
+#include <chrono>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "./Quickbase_types.hpp"
+
+// Quickbase query log declarations - per query shape statistics and slow query log
+namespace db
+{
+    // MatchMode - how a query compares the literal against the column
+    enum class MatchMode : uint8_t
+    {
+        PrimaryKey, // equality on the primary key
+        Exact,      // equality on a non-key column
+        Substring,  // substring match (linear scan of string columns in QBTable)
+        Range,      // inclusive range of an integer column
+        FullText    // ranked search for the words of the literal
+    };
+
+    // QueryShape - a query with its literal removed, e.g. "users.column1 LIKE '%?%'"
+    struct QueryShape
+    {
+        std::string table;
+        std::string column;
+        db::MatchMode mode;
+
+        auto operator<=>(const QueryShape &) const = default;
+        std::string toString() const;
+    };
+
+    // QueryShapeStats - aggregated statistics for one query shape
+    struct QueryShapeStats
+    {
+        db::QueryShape shape;
+        uint64_t calls = 0;
+        double totalMs = 0;
+        double maxMs = 0;
+        uint64_t rowsExamined = 0;
+        uint64_t rowsReturned = 0;
+
+        double meanMs() const noexcept { return calls ? totalMs / double(calls) : 0.0; }
+    };
+
+    // SlowQueryEntry - one query that exceeded the slow query threshold
+    struct SlowQueryEntry
+    {
+        db::QueryShape shape;
+        std::string literal;
+        double durationMs = 0;
+        uint64_t rowsExamined = 0;
+        uint64_t rowsReturned = 0;
+        std::string explain;
+        std::chrono::system_clock::time_point when;
+    };
+
+    // QueryLogOptions - bounds of the query log
+    struct QueryLogOptions
+    {
+        size_t maxShapes = 1000;                                  // least called shape is evicted when full
+        size_t slowLogCapacity = 128;                             // ring buffer of slow queries, oldest dropped
+        std::chrono::microseconds slowThreshold{10000};           // queries slower than this are logged
+    };
+
+    // render a field value for logs and explain output
+    std::string fieldToString(const db::FieldType &value);
+
+    // QueryLog - pg_stat_statements-like facility, can be shared by several tables (internally synchronized)
+    class QueryLog
+    {
+    private:
+        db::QueryLogOptions options_;
+        mutable std::mutex mutex_;
+        std::map<db::QueryShape, db::QueryShapeStats> shapes_;
+        std::deque<db::SlowQueryEntry> slowQueries_;
+        uint64_t evictedShapes_ = 0;
+
+    public:
+        explicit QueryLog(db::QueryLogOptions options = {});
+
+        // record one executed query - explain is only invoked when the query is logged as slow
+        void record(const db::QueryShape &shape, std::string_view literal, std::chrono::nanoseconds duration,
+                    uint64_t rowsExamined, uint64_t rowsReturned, const std::function<std::string()> &explain);
+
+        void setSlowThreshold(std::chrono::microseconds threshold);
+        std::chrono::microseconds slowThreshold() const;
+
+        // snapshots - shapes are sorted by total time, most expensive first; slow queries oldest first
+        std::vector<db::QueryShapeStats> shapes() const;
+        std::vector<db::SlowQueryEntry> slowQueries() const;
+        uint64_t evictedShapes() const;
+        void reset();
+    };
+}
@@ -0,0 +1,100 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "./Quickbase.hpp"
+#include "./Quickbase_wal.hpp"
+
+// Quickbase read replica declarations - a QBTable kept up to date by tailing a primary's write-ahead log
+namespace db::replica
+{
+    struct FollowerOptions
+    {
+        std::chrono::microseconds pollInterval{200}; // sleep of the tailing thread when the log has nothing new
+        size_t maxBatch = 4096;                      // entries applied per table lock, readers wait at most one batch
+    };
+
+    // ReplicationError - a logged operation the replica's table refused, so it no longer matches the primary
+    class ReplicationError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // ReplicationStatus - progress of a follower
+    struct ReplicationStatus
+    {
+        uint64_t appliedLsn = 0;
+        uint64_t bytesApplied = 0;
+        double lastLagMs = 0; // primary append to follower apply, for the newest applied entry
+        double maxLagMs = 0;
+        // last time the follower had applied everything the primary had flushed
+        std::chrono::system_clock::time_point caughtUpAt{};
+        bool running = false;
+        std::string error; // set when tailing stopped on a corrupt log or an entry the replica could not apply
+    };
+
+    // Follower - applies a write-ahead log to its own QBTable, on a background thread or through poll()
+    // Queries see the table only between batches. Reads are serialized like on the table server, as
+    // QBTable updates its access path statistics on every query. Once an entry fails to decode or apply
+    // the follower stops: poll() applies nothing more and read() refuses, as the table has diverged.
+    class Follower
+    {
+    private:
+        db::replica::FollowerOptions options_;
+        db::wal::LogReader reader_;
+        db::QBTable table_;
+        mutable std::mutex tableMutex_;
+
+        std::atomic<uint64_t> appliedLsn_{0};
+        std::atomic<uint64_t> bytesApplied_{0};
+        std::atomic<int64_t> caughtUpNs_{0};
+        std::atomic<int64_t> lastLagNs_{0};
+        std::atomic<int64_t> maxLagNs_{0};
+        mutable std::mutex errorMutex_;
+        std::string error_;
+        std::atomic<bool> failed_{false};
+
+        std::thread thread_;
+        std::atomic<bool> stop_{false};
+
+        void apply(const db::wal::LogEntry &entry);
+        void fail(const std::string &error);
+        void run();
+
+    public:
+        explicit Follower(const std::string &walPath, db::replica::FollowerOptions options = {});
+        ~Follower();
+        Follower(const Follower &) = delete;
+        Follower &operator=(const Follower &) = delete;
+
+        // apply flushed entries in batches until the end of the log, returns the number applied
+        // throws db::wal::WalError on a corrupt entry and ReplicationError on one the table refused
+        size_t poll();
+        // tail the log on a background thread
+        void start();
+        void stop();
+
+        db::replica::ReplicationStatus status() const;
+        // wait until the entry with this lsn has been applied
+        bool waitForLsn(uint64_t lsn, std::chrono::milliseconds timeout) const;
+
+        // run fn(table) if the follower caught up with the log within maxStaleness, false otherwise
+        // The bound covers flushed entries only - entries still buffered by the primary's LogWriter are not
+        // counted, so a primary that stops writing must flush() to bound what readers miss
+        template <typename Fn>
+        bool read(Fn &&fn, std::chrono::milliseconds maxStaleness) const
+        {
+            const int64_t oldest = db::wal::wallClockNs() - std::chrono::nanoseconds(maxStaleness).count();
+            if (failed_.load(std::memory_order_acquire) || caughtUpNs_.load(std::memory_order_acquire) < oldest)
+                return false;
+            std::lock_guard lock(tableMutex_);
+            fn(static_cast<const db::QBTable &>(table_));
+            return true;
+        }
+    };
+}
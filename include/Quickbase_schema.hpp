@@ -0,0 +1,338 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./Quickbase_types.hpp"
+
+// Quickbase schema table declarations - tables over a user record type whose columns are described at compile time
+namespace db
+{
+    // ColumnName - string literal usable as a template argument
+    template <size_t N>
+    struct ColumnName
+    {
+        char text[N]{};
+        constexpr ColumnName(const char (&name)[N]) { std::copy_n(name, N, text); }
+        constexpr std::string_view view() const { return {text, N - 1}; }
+    };
+
+    enum class ColumnRole : uint8_t
+    {
+        Key,       // primary key - unique, always indexed
+        Indexable, // may get a secondary index with createIndex()
+        Plain      // scanned only
+    };
+
+    template <typename>
+    struct MemberTraits;
+
+    template <typename Record, typename Type>
+    struct MemberTraits<Type Record::*>
+    {
+        using RecordType = Record;
+        using ValueType = Type;
+    };
+
+    // Column - one data member of a record, e.g. Column<&QBRecord::column0, "column0", ColumnRole::Key>
+    template <auto Member, db::ColumnName Name, db::ColumnRole Role = db::ColumnRole::Indexable>
+    struct Column
+    {
+        using Record = typename db::MemberTraits<decltype(Member)>::RecordType;
+        using Type = typename db::MemberTraits<decltype(Member)>::ValueType;
+        static constexpr auto member = Member;
+        static constexpr std::string_view name = Name.view();
+        static constexpr db::ColumnRole role = Role;
+    };
+
+    // SchemaTable - QBTable's storage and indexing for any record type described by a schema
+    // A schema names the record type and lists its columns as a std::tuple of Column, exactly one of them the key:
+    //     struct Schema { using Record = R; using Columns = std::tuple<Column<&R::id, "id", ColumnRole::Key>, ...>; };
+    // Columns are chosen by their position as a template argument - a number or an enum such as db::ColumnType -
+    // so every column access is a member pointer resolved at compile time, and keys are the member types
+    // themselves rather than db::FieldType. Matches compare values with ==, there is no substring matching.
+    template <typename Schema>
+    class SchemaTable
+    {
+    public:
+        using Record = typename Schema::Record;
+        using Columns = typename Schema::Columns;
+        static constexpr size_t columnCount = std::tuple_size_v<Columns>;
+
+        template <auto C>
+        using ColumnAt = std::tuple_element_t<static_cast<size_t>(C), Columns>;
+        template <auto C>
+        using ValueType = typename ColumnAt<C>::Type;
+
+    private:
+        template <typename F, size_t... I>
+        static constexpr void forEachColumnIndex(F &&visit, std::index_sequence<I...>)
+        {
+            (visit(std::integral_constant<size_t, I>{}), ...);
+        }
+
+        template <typename F>
+        static constexpr void forEachColumn(F &&visit)
+        {
+            forEachColumnIndex(std::forward<F>(visit), std::make_index_sequence<columnCount>{});
+        }
+
+        static constexpr size_t findKeyColumn()
+        {
+            size_t keys = 0, key = 0;
+            forEachColumn([&](auto c)
+                          {
+                              if (ColumnAt<c()>::role == db::ColumnRole::Key)
+                              {
+                                  ++keys;
+                                  key = c();
+                              } });
+            return keys == 1 ? key : columnCount;
+        }
+
+        static constexpr bool columnsOfRecord()
+        {
+            bool same = true;
+            forEachColumn([&](auto c)
+                          { same = same && std::is_same_v<typename ColumnAt<c()>::Record, Record>; });
+            return same;
+        }
+
+        static constexpr size_t keyColumn = findKeyColumn();
+        static_assert(keyColumn < columnCount, "a schema needs exactly one ColumnRole::Key column");
+        static_assert(columnsOfRecord(), "every column must be a member of the schema's record type");
+
+    public:
+        using Key = ValueType<keyColumn>;
+
+    private:
+        // Index - postings per native value in storage order, empty optional while the column is not indexed
+        template <typename Col>
+        using Index = std::optional<std::map<typename Col::Type, std::vector<size_t>>>;
+        template <typename Tuple>
+        struct IndexesOf;
+        template <typename... Cols>
+        struct IndexesOf<std::tuple<Cols...>>
+        {
+            using type = std::tuple<Index<Cols>...>;
+        };
+
+        std::vector<Record> records_;
+        // deleted_ - parallel vector to records_ for soft deletion tracking
+        std::vector<bool> deleted_;
+        std::unordered_map<Key, size_t> pkIndex_;
+        // indexes_ - one optional index per column, the key column's stays empty
+        typename IndexesOf<Columns>::type indexes_;
+
+        template <size_t I>
+        static const auto &field(const Record &record) { return record.*(ColumnAt<I>::member); }
+
+        void rebuildIndexes()
+        {
+            pkIndex_.clear();
+            forEachColumn([&](auto c)
+                          {
+                              if (auto &index = std::get<c()>(indexes_))
+                                  index->clear(); });
+            for (size_t i = 0; i < records_.size(); ++i)
+            {
+                if (deleted_[i])
+                    continue;
+                pkIndex_[field<keyColumn>(records_[i])] = i;
+                forEachColumn([&](auto c)
+                              {
+                                  if (auto &index = std::get<c()>(indexes_))
+                                      (*index)[field<c()>(records_[i])].push_back(i); });
+            }
+        }
+
+    public:
+        SchemaTable() = default;
+        // move only, like QBTable
+        SchemaTable(const SchemaTable &) = delete;
+        SchemaTable &operator=(const SchemaTable &) = delete;
+        SchemaTable(SchemaTable &&) noexcept = default;
+        SchemaTable &operator=(SchemaTable &&) noexcept = default;
+        ~SchemaTable() = default;
+
+        template <auto C>
+        static constexpr std::string_view columnName() { return ColumnAt<C>::name; }
+
+        // index management
+
+        template <auto C>
+        void createIndex()
+        {
+            constexpr size_t I = static_cast<size_t>(C);
+            static_assert(ColumnAt<I>::role == db::ColumnRole::Indexable, "only ColumnRole::Indexable columns take an index");
+            auto &index = std::get<I>(indexes_);
+            if (index)
+                throw std::runtime_error("Cannot create index on already indexed or primary key column");
+            index.emplace();
+            for (size_t i = 0; i < records_.size(); ++i)
+                if (!deleted_[i])
+                    (*index)[field<I>(records_[i])].push_back(i);
+        }
+
+        template <auto C>
+        void dropIndex()
+        {
+            constexpr size_t I = static_cast<size_t>(C);
+            static_assert(I != keyColumn, "Cannot drop index on primary key column");
+            std::get<I>(indexes_).reset();
+        }
+
+        template <auto C>
+        bool isColumnIndexed() const
+        {
+            constexpr size_t I = static_cast<size_t>(C);
+            return I == keyColumn || std::get<I>(indexes_).has_value();
+        }
+
+        // core operations
+
+        void addRecord(const Record &record)
+        {
+            const size_t idx = records_.size();
+            records_.push_back(record);
+            deleted_.push_back(false);
+            pkIndex_[field<keyColumn>(record)] = idx;
+            forEachColumn([&](auto c)
+                          {
+                              if (auto &index = std::get<c()>(indexes_))
+                                  (*index)[field<c()>(record)].push_back(idx); });
+        }
+
+        // soft delete - each index loses one posting, found from the record's own value
+        bool deleteRecordByID(const Key &key)
+        {
+            auto pkIt = pkIndex_.find(key);
+            if (pkIt == pkIndex_.end())
+                return false;
+            const size_t idx = pkIt->second;
+            deleted_[idx] = true;
+            pkIndex_.erase(pkIt);
+            forEachColumn([&](auto c)
+                          {
+                              auto &index = std::get<c()>(indexes_);
+                              if (!index)
+                                  return;
+                              auto it = index->find(field<c()>(records_[idx]));
+                              if (it == index->end())
+                                  return;
+                              auto &postings = it->second;
+                              auto pos = std::lower_bound(postings.begin(), postings.end(), idx);
+                              if (pos != postings.end() && *pos == idx)
+                                  postings.erase(pos);
+                              if (postings.empty())
+                                  index->erase(it); });
+            return true;
+        }
+
+        void compactRecords()
+        {
+            std::vector<Record> compacted;
+            compacted.reserve(activeRecordsCount());
+            for (size_t i = 0; i < records_.size(); ++i)
+                if (!deleted_[i])
+                    compacted.push_back(std::move(records_[i]));
+            records_ = std::move(compacted);
+            deleted_.assign(records_.size(), false);
+            rebuildIndexes();
+        }
+
+        // queries - the key column probes the primary key index, an indexed column its index, others are scanned
+
+        template <auto C, typename Visitor>
+        size_t forEachMatching(const ValueType<C> &value, Visitor &&visit) const
+        {
+            constexpr size_t I = static_cast<size_t>(C);
+            if constexpr (I == keyColumn)
+            {
+                auto it = pkIndex_.find(value);
+                if (it == pkIndex_.end())
+                    return 0;
+                visit(records_[it->second]);
+                return 1;
+            }
+            else
+            {
+                size_t matches = 0;
+                if (const auto &index = std::get<I>(indexes_))
+                {
+                    auto it = index->find(value);
+                    if (it == index->end())
+                        return 0;
+                    for (size_t idx : it->second)
+                    {
+                        visit(records_[idx]);
+                        ++matches;
+                    }
+                    return matches;
+                }
+                for (size_t i = 0; i < records_.size(); ++i)
+                {
+                    if (!deleted_[i] && field<I>(records_[i]) == value)
+                    {
+                        visit(records_[i]);
+                        ++matches;
+                    }
+                }
+                return matches;
+            }
+        }
+
+        template <auto C>
+        std::vector<Record> findMatching(const ValueType<C> &value) const
+        {
+            std::vector<Record> result;
+            forEachMatching<C>(value, [&](const Record &record)
+                               { result.push_back(record); });
+            return result;
+        }
+
+        // full table scan over active records - the visitor may stop it early by returning false
+        template <typename Visitor>
+        size_t forEachRecord(Visitor &&visit) const
+        {
+            size_t visited = 0;
+            for (size_t i = 0; i < records_.size(); ++i)
+            {
+                if (deleted_[i])
+                    continue;
+                ++visited;
+                if (!visit(records_[i]))
+                    break;
+            }
+            return visited;
+        }
+
+        size_t activeRecordsCount() const noexcept
+        {
+            return static_cast<size_t>(std::count(deleted_.begin(), deleted_.end(), false));
+        }
+        size_t totalRecordsCount() const noexcept { return records_.size(); }
+    };
+
+    // QBRecordSchema - QBRecord described as a schema, column0 is the key
+    struct QBRecordSchema
+    {
+        using Record = db::QBRecord;
+        using Columns = std::tuple<db::Column<&db::QBRecord::column0, "column0", db::ColumnRole::Key>,
+                                   db::Column<&db::QBRecord::column1, "column1">,
+                                   db::Column<&db::QBRecord::column2, "column2">,
+                                   db::Column<&db::QBRecord::column3, "column3">>;
+    };
+
+    // QBSchemaTable - QBTable's columns with compile-time dispatch, columns selected with db::ColumnType
+    using QBSchemaTable = db::SchemaTable<db::QBRecordSchema>;
+}
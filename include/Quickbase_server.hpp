@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <variant>
+#include <vector>
+#include "./Quickbase.hpp"
+#include "./Quickbase_dynamic.hpp"
+#include "./Quickbase_protocol.hpp"
+
+// Quickbase table server declarations - hosts named tables behind a TCP or Unix socket (Linux, epoll)
+namespace db
+{
+    // ServerOptions - listener and threading configuration
+    struct ServerOptions
+    {
+        std::string host = "127.0.0.1";
+        uint16_t port = 7070;
+        std::string unixPath; // listen on a Unix socket instead of TCP when set
+        unsigned threads = 0; // event loops, 0 = one per hardware thread
+    };
+
+    // HostedTable - a named table with its lock - Find and primary key batches share it, since queries only
+    // bump the tables' atomic statistics, while writes take it exclusively
+    struct HostedTable
+    {
+        std::shared_mutex mutex;
+        std::variant<db::QBTable, db::QBTableDynamic> table;
+    };
+
+    class QBServer
+    {
+    private:
+        struct Connection;
+        struct Worker;
+
+        db::ServerOptions options_;
+        int listenFd_ = -1;
+        int stopFd_ = -1; // eventfd shared by all event loops, signalled by stop()
+        std::vector<std::unique_ptr<Worker>> workers_;
+        std::vector<std::thread> threads_;
+
+        // table registry - tables are never removed, so a HostedTable pointer stays valid
+        std::shared_mutex tablesMutex_;
+        std::map<std::string, std::unique_ptr<db::HostedTable>, std::less<>> tables_;
+
+        void openListener();
+        void runWorker(Worker &worker);
+        void acceptConnections(Worker &worker);
+        bool readConnection(Worker &worker, Connection &conn);
+        bool flushConnection(Worker &worker, Connection &conn);
+        bool sendOutput(Connection &conn);
+        size_t processFrames(Connection &conn);
+        void closeConnection(Worker &worker, int fd);
+
+        // request handling - appends one response frame to out
+        void handleFrame(const db::wire::FrameHeader &header, const char *payload, size_t size, std::vector<char> &out);
+        db::wire::Status handleCreateTable(db::wire::Reader &in, db::wire::Writer &out);
+        db::wire::Status handleFind(db::wire::Reader &in, db::wire::Writer &out);
+        db::wire::Status handleAdd(db::wire::Reader &in, db::wire::Writer &out);
+        db::wire::Status handleDelete(db::wire::Reader &in, db::wire::Writer &out);
+        db::wire::Status handleCreateIndex(db::wire::Reader &in, db::wire::Writer &out);
+        // answers a run of pipelined primary key finds with one batched probe, returns the frames consumed
+        size_t handlePrimaryKeyBatch(Connection &conn);
+        db::HostedTable *findTable(std::string_view name);
+
+    public:
+        explicit QBServer(db::ServerOptions options);
+        QBServer(const QBServer &) = delete;
+        QBServer &operator=(const QBServer &) = delete;
+        ~QBServer();
+
+        // host a table created in-process, returns false if the name is taken
+        bool hostTable(const std::string &name, std::variant<db::QBTable, db::QBTableDynamic> table);
+
+        // bind the listener and start the event loops, throws std::runtime_error on socket errors
+        void start();
+        // ask all event loops to exit - async-signal-safe
+        void stop() noexcept;
+        // wait for the event loops to exit
+        void wait();
+    };
+}
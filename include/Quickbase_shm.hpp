@@ -0,0 +1,136 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include "./Quickbase_types.hpp"
+
+// Quickbase shared memory table declarations (POSIX) - one writer process, any number of read-only attachers
+// The segment holds a fixed-capacity copy of a QBTable: a header, an array of records, an open addressing
+// primary key index and an append-only string heap. Everything inside refers to other parts by offset from
+// the segment start, so each process may map it at a different address.
+// Consistency is a seqlock: the writer makes the header version odd while it modifies the segment, readers
+// retry a query whose version changed. Records and strings are never moved or reused, so the string views a
+// query returns stay valid for as long as the reader is attached.
+namespace db::shm
+{
+    constexpr char kMagic[8] = {'Q', 'B', 'S', 'H', 'M', '0', '0', '1'};
+    constexpr uint32_t kFormatVersion = 1;
+
+    class ShmError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    // SegmentHeader - first bytes of the segment, offsets are relative to the segment start
+    struct SegmentHeader
+    {
+        char magic[8];
+        uint32_t formatVersion;
+        uint32_t reserved;
+        std::atomic<uint64_t> version; // seqlock - odd while the writer modifies the segment
+        uint64_t segmentSize;
+        uint64_t recordCapacity;
+        uint64_t stringCapacity;
+        uint64_t bucketCount; // power of two
+        uint64_t recordsOffset;
+        uint64_t bucketsOffset;
+        uint64_t stringsOffset;
+        std::atomic<uint64_t> recordCount;
+        std::atomic<uint64_t> stringBytes;
+        std::atomic<uint64_t> activeCount;
+    };
+    static_assert(std::atomic<uint64_t>::is_always_lock_free, "shared memory counters must be lock-free");
+
+    // SharedRecord - a record in the segment, strings are (offset, length) in the string heap
+    struct SharedRecord
+    {
+        uint32_t column0;
+        uint32_t deleted;
+        int64_t column2;
+        uint64_t column1Offset;
+        uint64_t column3Offset;
+        uint32_t column1Length;
+        uint32_t column3Length;
+    };
+
+    // RecordView - a record read in place, the strings point into the segment
+    struct RecordView
+    {
+        db::uint column0;
+        std::string_view column1;
+        long column2;
+        std::string_view column3;
+    };
+
+    using RecordViewVisitor = std::function<void(const db::shm::RecordView &)>;
+
+    // SharedTableWriter - creates the segment (replacing one of the same name) and removes it when destroyed
+    class SharedTableWriter
+    {
+    private:
+        std::string name_;
+        char *base_ = nullptr;
+        size_t size_ = 0;
+        db::shm::SegmentHeader *header_ = nullptr;
+
+        void beginWrite() noexcept;
+        void endWrite() noexcept;
+        void insert(const db::QBRecord &record);
+        uint32_t *bucketFor(db::uint id, bool forInsert);
+
+    public:
+        // name is a POSIX shared memory name such as "/quickbase", capacities are fixed for the segment's lifetime
+        SharedTableWriter(std::string name, size_t recordCapacity, size_t stringCapacity);
+        ~SharedTableWriter();
+        SharedTableWriter(const SharedTableWriter &) = delete;
+        SharedTableWriter &operator=(const SharedTableWriter &) = delete;
+
+        // throws ShmError when the segment is full - a later record with an existing id replaces it for lookups, as in QBTable
+        void addRecord(const db::QBRecord &record);
+        // one version change for the whole batch
+        void addRecords(std::span<const db::QBRecord> records);
+        // soft delete
+        bool deleteRecordByID(db::uint id);
+
+        size_t activeRecordsCount() const noexcept;
+        size_t segmentSize() const noexcept { return size_; }
+        const std::string &name() const noexcept { return name_; }
+    };
+
+    // SharedTableReader - maps an existing segment read-only, queries never copy record data
+    class SharedTableReader
+    {
+    private:
+        const char *base_ = nullptr;
+        size_t size_ = 0;
+        const db::shm::SegmentHeader *header_ = nullptr;
+        mutable std::atomic<uint64_t> retries_{0};
+
+        db::shm::RecordView view(const db::shm::SharedRecord &record) const;
+        template <typename Query>
+        auto consistent(Query &&query) const;
+
+    public:
+        explicit SharedTableReader(const std::string &name);
+        ~SharedTableReader();
+        SharedTableReader(const SharedTableReader &) = delete;
+        SharedTableReader &operator=(const SharedTableReader &) = delete;
+
+        std::optional<db::shm::RecordView> findByPrimaryKey(db::uint id) const;
+        // same matching rules as QBTable::findMatching - substring on string columns, equality on numbers
+        // each chunk of records is read consistently, records appended after the scan started are not visited
+        size_t forEachMatching(db::ColumnType column, std::string_view matchString, const db::shm::RecordViewVisitor &visitor) const;
+
+        size_t activeRecordsCount() const noexcept;
+        uint64_t version() const noexcept;
+        // queries repeated because the writer modified the segment meanwhile
+        uint64_t retries() const noexcept { return retries_.load(std::memory_order_relaxed); }
+        size_t segmentSize() const noexcept { return size_; }
+    };
+}
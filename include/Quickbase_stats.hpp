@@ -0,0 +1,145 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <chrono>
+#include <map>
+#include <vector>
+
+// Quickbase table statistics declarations
+namespace db
+{
+    // AccessPathCounters - how queries were served and how much work each access path did
+    struct AccessPathCounters
+    {
+        uint64_t pkLookups = 0;             // queries served by the primary key index
+        uint64_t secondaryIndexLookups = 0; // queries served by a secondary index
+        uint64_t linearScans = 0;           // queries that fell back to a full scan
+        uint64_t crackerLookups = 0;        // range queries served by an adaptive index (QBTable column2)
+        uint64_t rowsExamined = 0;          // record slots visited (scanned rows or index postings)
+        uint64_t rowsReturned = 0;
+        uint64_t deletedFiltered = 0; // index postings skipped because deleted_ was set
+
+        AccessPathCounters &operator+=(const AccessPathCounters &other) noexcept
+        {
+            pkLookups += other.pkLookups;
+            secondaryIndexLookups += other.secondaryIndexLookups;
+            linearScans += other.linearScans;
+            crackerLookups += other.crackerLookups;
+            rowsExamined += other.rowsExamined;
+            rowsReturned += other.rowsReturned;
+            deletedFiltered += other.deletedFiltered;
+            return *this;
+        }
+    };
+
+    // IndexUsage - per-index hit count, used to find unused indexes worth dropping
+    struct IndexUsage
+    {
+        uint64_t hits = 0;
+        // time of the last hit, time_point{} (epoch) when never used since creation or reset
+        std::chrono::system_clock::time_point lastUsed{};
+
+        void touch() noexcept
+        {
+            ++hits;
+            lastUsed = std::chrono::system_clock::now();
+        }
+    };
+
+    // RelaxedCounter - counter bumped from const query paths, which may run concurrently under a shared lock;
+    // relaxed because a count is only read back by stats() and never orders other memory
+    class RelaxedCounter
+    {
+    public:
+        RelaxedCounter() noexcept = default;
+        RelaxedCounter(const RelaxedCounter &other) noexcept : value_(other.load()) {}
+        RelaxedCounter &operator=(const RelaxedCounter &other) noexcept
+        {
+            value_.store(other.load(), std::memory_order_relaxed);
+            return *this;
+        }
+
+        RelaxedCounter &operator++() noexcept
+        {
+            value_.fetch_add(1, std::memory_order_relaxed);
+            return *this;
+        }
+        RelaxedCounter &operator+=(uint64_t n) noexcept
+        {
+            value_.fetch_add(n, std::memory_order_relaxed);
+            return *this;
+        }
+        uint64_t load() const noexcept { return value_.load(std::memory_order_relaxed); }
+        operator uint64_t() const noexcept { return load(); }
+
+    private:
+        std::atomic<uint64_t> value_{0};
+    };
+
+    // AtomicAccessPathCounters - the AccessPathCounters a table keeps, safe to bump from concurrent readers
+    struct AtomicAccessPathCounters
+    {
+        RelaxedCounter pkLookups;
+        RelaxedCounter secondaryIndexLookups;
+        RelaxedCounter linearScans;
+        RelaxedCounter crackerLookups;
+        RelaxedCounter rowsExamined;
+        RelaxedCounter rowsReturned;
+        RelaxedCounter deletedFiltered;
+
+        AccessPathCounters snapshot() const noexcept
+        {
+            return {pkLookups, secondaryIndexLookups, linearScans, crackerLookups, rowsExamined, rowsReturned, deletedFiltered};
+        }
+    };
+
+    // AtomicIndexUsage - the IndexUsage a table keeps, safe to touch from concurrent readers
+    struct AtomicIndexUsage
+    {
+        RelaxedCounter hits;
+        std::atomic<std::chrono::system_clock::rep> lastUsed{0}; // ticks since the epoch, 0 when never used
+
+        AtomicIndexUsage() noexcept = default;
+        AtomicIndexUsage(const AtomicIndexUsage &other) noexcept
+            : hits(other.hits), lastUsed(other.lastUsed.load(std::memory_order_relaxed)) {}
+        AtomicIndexUsage &operator=(const AtomicIndexUsage &other) noexcept
+        {
+            hits = other.hits;
+            lastUsed.store(other.lastUsed.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            return *this;
+        }
+
+        void touch() noexcept
+        {
+            ++hits;
+            lastUsed.store(std::chrono::system_clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+        }
+        IndexUsage snapshot() const noexcept
+        {
+            using Clock = std::chrono::system_clock;
+            return {hits, Clock::time_point{Clock::duration{lastUsed.load(std::memory_order_relaxed)}}};
+        }
+    };
+
+    // TableStatsSnapshot - point in time copy of a table's counters, keyed by the table's column identifier
+    template <typename ColumnKey>
+    struct TableStatsSnapshot
+    {
+        AccessPathCounters table;                     // sum over all columns and full table scans
+        std::map<ColumnKey, AccessPathCounters> columns; // only columns that were queried
+        std::map<ColumnKey, IndexUsage> indexes;      // primary key and every existing secondary index
+        std::map<std::vector<ColumnKey>, IndexUsage> compositeIndexes; // every existing composite index, by its columns
+        uint64_t mutations = 0;                       // records inserted, updated or deleted
+    };
+
+    // IndexEstimate - size of the index on one column, measured when it exists and estimated from a sample otherwise
+    struct IndexEstimate
+    {
+        size_t keys = 0;        // distinct values
+        size_t postings = 0;    // indexed records
+        size_t memoryBytes = 0; // heap held by the index
+        bool exists = false;
+        bool unique = false;    // an IndexKind::Unique index
+    };
+}
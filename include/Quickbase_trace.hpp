@@ -0,0 +1,70 @@
+#pragma once
+#include <cstdint>
+#include <ostream>
+
+// Quickbase tracing declarations - scoped spans around long-running table operations
+// Spans are recorded into per-thread ring buffers (single writer, no locks on the hot path)
+// and dumped in Chrome trace-event JSON, loadable in chrome://tracing or Perfetto.
+// Recording is off until enabled at runtime; building with QB_ENABLE_TRACING=OFF removes it entirely.
+namespace db::trace
+{
+    // capacity of each thread's ring buffer, older events are overwritten
+    constexpr uint32_t kThreadBufferEvents = 16384;
+
+    // TraceEvent - one completed span, name must be a string literal
+    struct TraceEvent
+    {
+        const char *name;
+        uint64_t startNs;
+        uint64_t durationNs;
+        uint64_t rows; // records affected, shown as an argument in the trace viewer
+    };
+
+    void setEnabled(bool enabled) noexcept;
+    bool enabled() noexcept;
+
+    // monotonic timestamp in nanoseconds (steady_clock epoch)
+    uint64_t nowNs() noexcept;
+    void record(const char *name, uint64_t startNs, uint64_t durationNs, uint64_t rows) noexcept;
+
+    // dump every thread's buffered events as {"traceEvents": [...]}
+    // best effort while other threads keep tracing - disable tracing first for an exact snapshot
+    void writeChromeTrace(std::ostream &out);
+    // drop all buffered events
+    void clear();
+
+    // Span - RAII span, inactive when tracing is disabled or name is nullptr
+    class Span
+    {
+    private:
+        const char *name_;
+        uint64_t startNs_;
+        uint64_t rows_;
+
+    public:
+        explicit Span(const char *name, uint64_t rows = 0) noexcept
+            : name_(name != nullptr && enabled() ? name : nullptr), startNs_(name_ ? nowNs() : 0), rows_(rows) {}
+        ~Span()
+        {
+            if (name_)
+                record(name_, startNs_, nowNs() - startNs_, rows_);
+        }
+        Span(const Span &) = delete;
+        Span &operator=(const Span &) = delete;
+
+        void setRows(uint64_t rows) noexcept { rows_ = rows; }
+    };
+}
+
+#define QB_TRACE_CONCAT_INNER(a, b) a##b
+#define QB_TRACE_CONCAT(a, b) QB_TRACE_CONCAT_INNER(a, b)
+
+#ifdef QB_ENABLE_TRACING
+// QB_TRACE_SPAN(name, rows) - span until the end of the enclosing scope
+#define QB_TRACE_SPAN(name, rows) ::db::trace::Span QB_TRACE_CONCAT(qbTraceSpan, __LINE__)(name, rows)
+// QB_TRACE_SPAN_IF(cond, name, rows) - span only when cond holds, e.g. before a vector reallocation
+#define QB_TRACE_SPAN_IF(cond, name, rows) ::db::trace::Span QB_TRACE_CONCAT(qbTraceSpan, __LINE__)((cond) ? (name) : nullptr, rows)
+#else
+#define QB_TRACE_SPAN(name, rows) ((void)0)
+#define QB_TRACE_SPAN_IF(cond, name, rows) ((void)0)
+#endif
@@ -0,0 +1,70 @@
+#pragma once
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "./Quickbase_types.hpp"
+
+// Quickbase time to live declarations - record expiry deadlines kept in a hierarchical timer wheel
+namespace db
+{
+    // TtlClock - clock of record expiry deadlines
+    using TtlClock = std::chrono::steady_clock;
+
+    // kDefaultExpiryBudget - due entries expireRecords() handles per call unless told otherwise
+    inline constexpr size_t kDefaultExpiryBudget = 1024;
+
+    struct TimerWheelStats
+    {
+        uint64_t scheduled = 0; // schedule() calls
+        uint64_t cascaded = 0;  // entries moved down a level
+        uint64_t fired = 0;     // entries handed out by drain()
+    };
+
+    // TimerWheel - primary keys due at a deadline, in 4 levels of 64 slots covering 64 ms, 4 s, 4.4 min and 4.7 h
+    // schedule() is O(1). advance() jumps between occupied slots using one occupancy bitmap per level, so idle
+    // time costs nothing, and each entry is cascaded at most once per level before it becomes due. Deadlines
+    // beyond the top level wait in it and are rescheduled each time their slot comes round. Entries are never
+    // removed - the owner skips ids whose deadline changed when they come due.
+    class TimerWheel
+    {
+    public:
+        struct Entry
+        {
+            db::uint id;
+            uint64_t tick; // deadline in whole milliseconds of TtlClock, rounded up
+        };
+
+    private:
+        static constexpr unsigned kLevelBits = 6;
+        static constexpr unsigned kLevels = 4;
+        static constexpr uint64_t kSlots = uint64_t(1) << kLevelBits;
+
+        std::array<std::array<std::vector<Entry>, kSlots>, kLevels> slots_;
+        // occupied_ - bit s of level l is set while slot s of that level holds entries
+        std::array<uint64_t, kLevels> occupied_{};
+        size_t scheduled_ = 0;
+        std::deque<Entry> due_;
+        uint64_t now_;
+        db::TimerWheelStats stats_;
+
+        void place(const Entry &entry);
+        uint64_t nextEvent() const noexcept;
+
+    public:
+        TimerWheel();
+
+        void schedule(db::uint id, db::TtlClock::time_point deadline);
+        // move every entry whose deadline has passed by now to the due queue
+        void advance(db::TtlClock::time_point now);
+        // hand up to budget due entries to visit, oldest millisecond first, returns how many were handed out
+        size_t drain(size_t budget, const std::function<void(db::uint)> &visit);
+        void clear() noexcept;
+
+        size_t size() const noexcept { return scheduled_ + due_.size(); }
+        size_t due() const noexcept { return due_.size(); }
+        const db::TimerWheelStats &stats() const noexcept { return stats_; }
+    };
+}
@@ -0,0 +1,81 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./Quickbase_types.hpp"
+
+// Quickbase transaction declarations - mutations buffered on the client side and applied by one commit()
+namespace db
+{
+    enum class TransactionOp : uint8_t
+    {
+        Insert,
+        Update,
+        Delete // soft delete
+    };
+
+    // CommitResult - outcome of commit(); when not committed the table is unchanged
+    struct CommitResult
+    {
+        bool committed = false;
+        size_t failedOperation = 0; // position of the first operation that could not apply
+        size_t inserted = 0;
+        size_t updated = 0;
+        size_t deleted = 0;
+
+        explicit operator bool() const noexcept { return committed; }
+    };
+
+    // Transaction - inserts, updates and deletes of one table, applied in order by the table's commit(), all or none
+    // Key is the record's primary key member. Building a transaction touches no table, so it can be prepared
+    // without holding any lock and committed later; an operation fails the whole commit when it cannot apply
+    // at that point of the sequence - an insert of a live key, an update or delete of a missing one, or a
+    // column the schema does not have.
+    template <typename Record, typename Changes, auto Key>
+    class Transaction
+    {
+    public:
+        struct Operation
+        {
+            db::TransactionOp op;
+            db::uint id;
+            Record record{};   // Insert only
+            Changes changes{}; // Update only
+        };
+
+    private:
+        std::vector<Operation> operations_;
+
+    public:
+        Transaction &insert(Record record)
+        {
+            const db::uint id = record.*Key;
+            operations_.push_back({db::TransactionOp::Insert, id, std::move(record), {}});
+            return *this;
+        }
+        Transaction &update(db::uint id, Changes changes)
+        {
+            operations_.push_back({db::TransactionOp::Update, id, {}, std::move(changes)});
+            return *this;
+        }
+        Transaction &erase(db::uint id)
+        {
+            operations_.push_back({db::TransactionOp::Delete, id, {}, {}});
+            return *this;
+        }
+
+        const std::vector<Operation> &operations() const noexcept { return operations_; }
+        size_t size() const noexcept { return operations_.size(); }
+        bool empty() const noexcept { return operations_.empty(); }
+        void reserve(size_t count) { operations_.reserve(count); }
+        void clear() noexcept { operations_.clear(); }
+    };
+
+    // QBTransaction - transaction of a QBTable, see QBTable::commit()
+    using QBTransaction = db::Transaction<db::QBRecord, db::QBRecordUpdate, &db::QBRecord::column0>;
+    // QBDynamicTransaction - transaction of a QBTableDynamic, updates name the fields to change
+    using QBDynamicTransaction = db::Transaction<db::QBRecordDynamic, std::unordered_map<std::string, db::FieldType>, &db::QBRecordDynamic::id>;
+}
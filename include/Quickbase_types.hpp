@@ -2,7 +2,10 @@
 #include <cstdint>
 #include <variant>
 #include <functional>
+#include <optional>
 #include <string>
+#include <string_view>
+#include <unordered_map>
 
 namespace db {
     using uint = unsigned int;
@@ -18,6 +21,27 @@ namespace db {
         long column2;
         std::string column3;
     };
+    // QBRecordUpdate - new values of the columns to change, unset columns keep their value; the primary key never changes
+    struct QBRecordUpdate
+    {
+        std::optional<std::string> column1;
+        std::optional<long> column2;
+        std::optional<std::string> column3;
+    };
+    // UpsertResult - what upsertRecords() did with each record of the batch
+    struct UpsertResult
+    {
+        size_t inserted = 0;
+        size_t updated = 0;
+        size_t unchanged = 0;
+        size_t rejected = 0; // records with a column missing from the schema, or a key a unique index already holds
+    };
+    // TextMatch - a record found by QBTable::searchText() with its BM25 score
+    struct TextMatch
+    {
+        QBRecord record;
+        double score;
+    };
     // ColumnType - static table column identifier enum
     enum class ColumnType : uint8_t
     {
@@ -26,10 +50,28 @@ namespace db {
         COLUMN2,
         COLUMN3
     };
+    // IndexKind - a General index maps a key to a posting list, a Unique one to a single row and rejects duplicates
+    enum class IndexKind : uint8_t
+    {
+        General,
+        Unique
+    };
+    // ColumnMatch - one equality condition of QBTable::findMatchingAll(), the value in the text form findMatching() takes
+    struct ColumnMatch
+    {
+        ColumnType column;
+        std::string_view value;
+    };
     // QBRecordDynamic  - record can hold an arbitrary number of fields in a map
     struct QBRecordDynamic
     {
         uint id; // primary key
         std::unordered_map<std::string, FieldType> fields;
     };
+    // DynamicColumnMatch - one equality condition of QBTableDynamic::findMatchingAll()
+    struct DynamicColumnMatch
+    {
+        std::string column;
+        FieldType value;
+    };
 }
\ No newline at end of file
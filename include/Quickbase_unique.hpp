@@ -0,0 +1,62 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Quickbase unique index declarations - flat hash table from a key to the one row holding it
+namespace db
+{
+    // UniqueIndex - open addressing with linear probing over 8 byte slots, at most 3/4 full
+    // Keys are not stored: a slot holds 32 bits of the key's hash and the row, and the owner passes a predicate
+    // telling whether a row holds the key being probed. An entry costs 11 to 21 bytes and no allocation of its
+    // own. Erasing shifts the following entries back, so there are no tombstones. Rows must fit in 32 bits.
+    class UniqueIndex
+    {
+    public:
+        static constexpr size_t npos = static_cast<size_t>(-1);
+
+    private:
+        static constexpr uint32_t kEmpty = UINT32_MAX;
+
+        struct Slot
+        {
+            uint32_t tag;            // folded hash, its low bits are the home slot
+            uint32_t row = kEmpty;
+        };
+
+        std::vector<Slot> slots_;
+        size_t mask_ = 0;
+        size_t size_ = 0;
+
+        static uint32_t tagOf(uint64_t hash) noexcept { return static_cast<uint32_t>(hash ^ (hash >> 32)); }
+        void rehash(size_t capacity);
+
+    public:
+        // row holding the key, npos when none - holds(row) compares the key with that row's value
+        template <typename Holds>
+        size_t find(uint64_t hash, Holds &&holds) const
+        {
+            if (size_ == 0)
+                return npos;
+            const uint32_t tag = tagOf(hash);
+            for (size_t i = tag & mask_;; i = (i + 1) & mask_)
+            {
+                const Slot &slot = slots_[i];
+                if (slot.row == kEmpty)
+                    return npos;
+                if (slot.tag == tag && holds(size_t(slot.row)))
+                    return slot.row;
+            }
+        }
+
+        // add a key that find() did not find
+        void insert(uint64_t hash, size_t row);
+        // remove the entry of row, false when the key's chain does not hold it
+        bool erase(uint64_t hash, size_t row);
+        void reserve(size_t count);
+        void clear() noexcept;
+
+        size_t size() const noexcept { return size_; }
+        size_t memoryUsage() const noexcept { return slots_.capacity() * sizeof(Slot); }
+    };
+}
@@ -0,0 +1,174 @@
+#pragma once
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "./Quickbase_types.hpp"
+
+// Quickbase materialized view declarations - query results kept up to date by the table on every mutation
+namespace db
+{
+    enum class ViewAggregate : uint8_t
+    {
+        None, // row view - keeps the matching records, projected
+        Count,
+        Sum,
+        Min,
+        Max
+    };
+
+    struct ViewStats
+    {
+        uint64_t evaluated = 0; // inserted records the predicate was evaluated on
+        uint64_t added = 0;     // records that entered the view
+        uint64_t removed = 0;   // records that left the view on delete
+        uint64_t moved = 0;     // storage position changes from hard deletes and compaction
+        uint64_t rebuilds = 0;  // full re-evaluations, on attach and after schema changes
+    };
+
+    // MaterializedView - records of a table matching a predicate, or an aggregate over them
+    // Attached to a table with addView(), which evaluates every existing record once; from then on the table
+    // hands it each inserted record and each deleted or moved storage position, so maintenance costs one
+    // predicate evaluation per insert and reads never touch the table.
+    // Time to live: queries hide an expired record at once, but the view keeps it until the table's
+    // expireRecords() purges it - call expireRecords() before reading a view that must not lag.
+    template <typename Record>
+    class MaterializedView
+    {
+    public:
+        using Predicate = std::function<bool(const Record &)>;
+        // Projection - the part of a matching record the view keeps, e.g. a copy with unused strings cleared
+        using Projection = std::function<Record(const Record &)>;
+        // Measure - the number a Sum, Min or Max aggregates
+        using Measure = std::function<long(const Record &)>;
+
+    private:
+        struct Member
+        {
+            size_t slot; // position in rows_, unused by aggregate views
+            long measure;
+        };
+
+        Predicate predicate_;
+        Projection projection_;
+        db::ViewAggregate aggregate_;
+        Measure measure_;
+
+        // members_ - storage position of every matching record in the table
+        std::unordered_map<size_t, Member> members_;
+        // row view - rows_ and rowPositions_ are parallel, a removed row is replaced by the last one
+        std::vector<Record> rows_;
+        std::vector<size_t> rowPositions_;
+        // aggregate view - Sum keeps a running total, Min and Max a count per measured value
+        long sum_ = 0;
+        std::map<long, size_t> values_;
+        db::ViewStats stats_;
+
+    public:
+        // row view of the records matching predicate, an empty predicate matches every record
+        explicit MaterializedView(Predicate predicate, Projection projection = {})
+            : predicate_(std::move(predicate)), projection_(std::move(projection)), aggregate_(db::ViewAggregate::None) {}
+
+        // aggregate view, measure is required for Sum, Min and Max
+        MaterializedView(Predicate predicate, db::ViewAggregate aggregate, Measure measure = {})
+            : predicate_(std::move(predicate)), aggregate_(aggregate), measure_(std::move(measure))
+        {
+            if (aggregate_ != db::ViewAggregate::None && aggregate_ != db::ViewAggregate::Count && !measure_)
+                throw std::invalid_argument("Sum, Min and Max views need a measure");
+        }
+
+        // maintenance - called by the table that owns the records
+
+        void insert(size_t position, const Record &record)
+        {
+            ++stats_.evaluated;
+            if (predicate_ && !predicate_(record))
+                return;
+            Member member{0, measure_ ? measure_(record) : 0};
+            if (aggregate_ == db::ViewAggregate::None)
+            {
+                member.slot = rows_.size();
+                rows_.push_back(projection_ ? projection_(record) : record);
+                rowPositions_.push_back(position);
+            }
+            else if (aggregate_ == db::ViewAggregate::Sum)
+                sum_ += member.measure;
+            else if (aggregate_ != db::ViewAggregate::Count)
+                ++values_[member.measure];
+            members_.emplace(position, member);
+            ++stats_.added;
+        }
+
+        void erase(size_t position)
+        {
+            auto it = members_.find(position);
+            if (it == members_.end())
+                return;
+            const Member member = it->second;
+            members_.erase(it);
+            if (aggregate_ == db::ViewAggregate::None)
+            {
+                if (member.slot + 1 != rows_.size())
+                {
+                    rows_[member.slot] = std::move(rows_.back());
+                    rowPositions_[member.slot] = rowPositions_.back();
+                    members_.find(rowPositions_[member.slot])->second.slot = member.slot;
+                }
+                rows_.pop_back();
+                rowPositions_.pop_back();
+            }
+            else if (aggregate_ == db::ViewAggregate::Sum)
+                sum_ -= member.measure;
+            else if (aggregate_ != db::ViewAggregate::Count)
+            {
+                auto value = values_.find(member.measure);
+                if (--value->second == 0)
+                    values_.erase(value);
+            }
+            ++stats_.removed;
+        }
+
+        // the record at from now lives at to, whose previous record already left the view
+        void move(size_t from, size_t to)
+        {
+            auto node = members_.extract(from);
+            if (node.empty())
+                return;
+            node.key() = to;
+            if (aggregate_ == db::ViewAggregate::None)
+                rowPositions_[node.mapped().slot] = to;
+            members_.insert(std::move(node));
+            ++stats_.moved;
+        }
+
+        // forget everything before the table re-inserts all of its records
+        void clear()
+        {
+            members_.clear();
+            rows_.clear();
+            rowPositions_.clear();
+            sum_ = 0;
+            values_.clear();
+            ++stats_.rebuilds;
+        }
+
+        // reads - O(1) for aggregates, rows() is the stored result in no particular order
+
+        const std::vector<Record> &rows() const noexcept { return rows_; }
+        size_t count() const noexcept { return members_.size(); }
+        long sum() const noexcept { return sum_; }
+        std::optional<long> min() const { return values_.empty() ? std::nullopt : std::optional(values_.begin()->first); }
+        std::optional<long> max() const { return values_.empty() ? std::nullopt : std::optional(values_.rbegin()->first); }
+        db::ViewAggregate aggregate() const noexcept { return aggregate_; }
+        const db::ViewStats &stats() const noexcept { return stats_; }
+    };
+
+    // QBMaterializedView - view over a QBTable
+    using QBMaterializedView = db::MaterializedView<db::QBRecord>;
+    // QBDynamicMaterializedView - view over a QBTableDynamic, re-evaluated in full after schema changes
+    using QBDynamicMaterializedView = db::MaterializedView<db::QBRecordDynamic>;
+}
@@ -0,0 +1,142 @@
+#pragma once
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "./Quickbase_types.hpp"
+
+// Quickbase write-ahead log declarations - logical log of QBTable mutations for log shipping
+// File layout: 8 byte magic, then entries | u32 length | u32 checksum | u64 lsn | i64 timestamp ns | u8 type | payload |
+// where length counts lsn .. payload and checksum is FNV-1a over the same bytes. Payloads use the wire
+// protocol encoding: Insert and Update a record, deletes a u32 id, index changes a u8 column, Compaction nothing,
+// Batch a u32 count followed by that many | u8 type | payload | of Insert, Update and SoftDelete entries,
+// composite index changes a u8 count followed by that many u8 columns.
+// Replaying the entries in order on an empty QBTable reproduces the primary's storage positions.
+namespace db::wal
+{
+    constexpr char kMagic[8] = {'Q', 'B', 'W', 'A', 'L', '0', '0', '1'};
+    constexpr size_t kEntryHeaderSize = 8;  // length + checksum
+    constexpr size_t kEntryFixedSize = 17;  // lsn + timestamp + type
+
+    class WalError : public std::runtime_error
+    {
+    public:
+        using std::runtime_error::runtime_error;
+    };
+
+    enum class EntryType : uint8_t
+    {
+        Insert = 1,
+        SoftDelete = 2,
+        HardDelete = 3,
+        Compaction = 4,
+        CreateIndex = 5,
+        DropIndex = 6,
+        Update = 7,
+        Batch = 8, // one committed transaction, replayed as a whole
+        CreateUniqueIndex = 9,
+        CreateCompositeIndex = 10,
+        DropCompositeIndex = 11
+    };
+
+    // LogEntry - one decoded mutation
+    struct LogEntry
+    {
+        uint64_t lsn = 0;
+        int64_t timestampNs = 0; // primary's system_clock when the entry was appended
+        db::wal::EntryType type = db::wal::EntryType::Insert;
+        db::uint id = 0;
+        db::ColumnType column = db::ColumnType::COLUMN0;
+        db::QBRecord record{};
+        // Batch only - the transaction's entries in order, without lsn or timestamp of their own
+        std::vector<db::wal::LogEntry> batch{};
+        // composite index changes only - the indexed columns in order
+        std::vector<db::ColumnType> columns{};
+    };
+
+    struct LogWriterOptions
+    {
+        size_t bufferSize = 64 << 10;                // buffered bytes written out in one call
+        std::chrono::microseconds flushInterval{1000}; // an append flushes when the last flush is older than this
+    };
+
+    // system_clock in nanoseconds, comparable between processes on one host
+    int64_t wallClockNs() noexcept;
+
+    // LogWriter - appends entries to a new log file, owned by the table's writer thread
+    // Entries are buffered and reach the file when the buffer fills, on an append after flushInterval, or on
+    // flush(). Followers only see flushed entries. There is no background flush, so a writer that goes idle
+    // calls flush() first - otherwise its last entries stay buffered until the next append.
+    class LogWriter
+    {
+    private:
+        std::FILE *file_ = nullptr;
+        std::vector<char> buffer_;
+        db::wal::LogWriterOptions options_;
+        uint64_t lastLsn_ = 0;
+        uint64_t flushedLsn_ = 0;
+        int64_t lastFlushNs_ = 0;
+        uint64_t bytesWritten_ = 0;
+
+        void append(db::wal::EntryType type, db::uint id, db::ColumnType column, const db::QBRecord *record,
+                    std::span<const db::wal::LogEntry> batch = {}, std::span<const db::ColumnType> columns = {});
+
+    public:
+        explicit LogWriter(const std::string &path, db::wal::LogWriterOptions options = {});
+        ~LogWriter();
+        LogWriter(const LogWriter &) = delete;
+        LogWriter &operator=(const LogWriter &) = delete;
+
+        void appendInsert(const db::QBRecord &record) { append(db::wal::EntryType::Insert, record.column0, db::ColumnType::COLUMN0, &record); }
+        // the whole updated record, replayed as an update of every non-key column
+        void appendUpdate(const db::QBRecord &record) { append(db::wal::EntryType::Update, record.column0, db::ColumnType::COLUMN0, &record); }
+        void appendDelete(db::uint id, bool hardDelete) { append(hardDelete ? db::wal::EntryType::HardDelete : db::wal::EntryType::SoftDelete, id, db::ColumnType::COLUMN0, nullptr); }
+        void appendCompaction() { append(db::wal::EntryType::Compaction, 0, db::ColumnType::COLUMN0, nullptr); }
+        void appendIndexChange(db::ColumnType column, bool created, db::IndexKind kind = db::IndexKind::General)
+        {
+            append(!created ? db::wal::EntryType::DropIndex : kind == db::IndexKind::Unique ? db::wal::EntryType::CreateUniqueIndex : db::wal::EntryType::CreateIndex,
+                   0, column, nullptr);
+        }
+        void appendCompositeIndexChange(std::span<const db::ColumnType> columns, bool created)
+        {
+            append(created ? db::wal::EntryType::CreateCompositeIndex : db::wal::EntryType::DropCompositeIndex, 0, db::ColumnType::COLUMN0, nullptr, {}, columns);
+        }
+        // one entry for a whole transaction - Insert, Update and SoftDelete entries, applied by followers at once
+        void appendBatch(std::span<const db::wal::LogEntry> entries) { append(db::wal::EntryType::Batch, 0, db::ColumnType::COLUMN0, nullptr, entries); }
+        void flush();
+
+        uint64_t lastLsn() const noexcept { return lastLsn_; }
+        uint64_t flushedLsn() const noexcept { return flushedLsn_; }
+        uint64_t bytesWritten() const noexcept { return bytesWritten_; }
+    };
+
+    // LogReader - decodes entries from a log file that may still be growing
+    // next() returns false at the end of the flushed data, including a partially written last entry;
+    // call it again later to continue. Throws WalError on a bad magic, checksum or sequence gap.
+    class LogReader
+    {
+    private:
+        std::FILE *file_ = nullptr;
+        std::vector<char> buffer_;
+        size_t begin_ = 0; // first unread byte of buffer_
+        bool headerRead_ = false;
+        uint64_t lastLsn_ = 0;
+        uint64_t bytesRead_ = 0;
+
+        bool fill(size_t needed);
+
+    public:
+        explicit LogReader(const std::string &path);
+        ~LogReader();
+        LogReader(const LogReader &) = delete;
+        LogReader &operator=(const LogReader &) = delete;
+
+        bool next(db::wal::LogEntry &entry);
+        uint64_t lastLsn() const noexcept { return lastLsn_; }
+        // bytes consumed by complete entries, including the magic
+        uint64_t bytesRead() const noexcept { return bytesRead_; }
+    };
+}
@@ -1,39 +1,713 @@
 #include "../include/Quickbase.hpp"
+#include "../include/Quickbase_trace.hpp"
 #include <algorithm>
 #include <charconv>
+#include <chrono>
+#include <cmath>
+#include <limits>
 
 // Quickbase database definitions
 namespace db
 {
+    namespace
+    {
+        /**
+         * Finalizer of MurmurHash3 - spreads keys over all bits, std::hash of an integer is the identity
+         */
+        uint64_t mixHash(uint64_t h) noexcept
+        {
+            h ^= h >> 33;
+            h *= 0xff51afd7ed558ccdULL;
+            h ^= h >> 33;
+            h *= 0xc4ceb9fe1a85ec53ULL;
+            h ^= h >> 33;
+            return h;
+        }
+
+        uint64_t keyHash(std::string_view key) noexcept { return mixHash(std::hash<std::string_view>{}(key)); }
+        uint64_t keyHash(long key) noexcept { return mixHash(static_cast<uint64_t>(key)); }
+
+        // hash of a record's key in a unique index - COLUMN0 is never one
+        uint64_t uniqueHash(const db::QBRecord &rec, db::ColumnType columnID) noexcept
+        {
+            switch (columnID)
+            {
+            case db::ColumnType::COLUMN1:
+                return keyHash(rec.column1);
+            case db::ColumnType::COLUMN2:
+                return keyHash(rec.column2);
+            case db::ColumnType::COLUMN3:
+                return keyHash(rec.column3);
+            case db::ColumnType::COLUMN0:
+                break;
+            }
+            return 0;
+        }
+
+        bool sameKey(const db::QBRecord &a, const db::QBRecord &b, db::ColumnType columnID) noexcept
+        {
+            switch (columnID)
+            {
+            case db::ColumnType::COLUMN1:
+                return a.column1 == b.column1;
+            case db::ColumnType::COLUMN2:
+                return a.column2 == b.column2;
+            case db::ColumnType::COLUMN3:
+                return a.column3 == b.column3;
+            case db::ColumnType::COLUMN0:
+                break;
+            }
+            return a.column0 == b.column0;
+        }
+
+        db::FieldType columnField(const db::QBRecord &rec, db::ColumnType columnID)
+        {
+            switch (columnID)
+            {
+            case db::ColumnType::COLUMN1:
+                return rec.column1;
+            case db::ColumnType::COLUMN2:
+                return rec.column2;
+            case db::ColumnType::COLUMN3:
+                return rec.column3;
+            case db::ColumnType::COLUMN0:
+                break;
+            }
+            return rec.column0;
+        }
+
+        void applyUpdate(db::QBRecord &rec, const db::QBRecordUpdate &changes)
+        {
+            if (changes.column1)
+                rec.column1 = *changes.column1;
+            if (changes.column2)
+                rec.column2 = *changes.column2;
+            if (changes.column3)
+                rec.column3 = *changes.column3;
+        }
+
+        constexpr unsigned columnBit(db::ColumnType columnID) noexcept { return 1u << static_cast<unsigned>(columnID); }
+
+        // mask of the columns an update gives a new value, 0 when it changes nothing
+        unsigned changedColumns(const db::QBRecord &rec, const db::QBRecordUpdate &changes) noexcept
+        {
+            unsigned changed = 0;
+            if (changes.column1 && rec.column1 != *changes.column1)
+                changed |= columnBit(db::ColumnType::COLUMN1);
+            if (changes.column2 && rec.column2 != *changes.column2)
+                changed |= columnBit(db::ColumnType::COLUMN2);
+            if (changes.column3 && rec.column3 != *changes.column3)
+                changed |= columnBit(db::ColumnType::COLUMN3);
+            return changed;
+        }
+
+        unsigned changedColumns(const db::QBRecord &rec, const db::QBRecord &replacement) noexcept
+        {
+            unsigned changed = 0;
+            if (rec.column1 != replacement.column1)
+                changed |= columnBit(db::ColumnType::COLUMN1);
+            if (rec.column2 != replacement.column2)
+                changed |= columnBit(db::ColumnType::COLUMN2);
+            if (rec.column3 != replacement.column3)
+                changed |= columnBit(db::ColumnType::COLUMN3);
+            return changed;
+        }
+
+        // hash of a typed key as uniqueHash() computes it from a record
+        uint64_t fieldHash(const db::FieldType &field) noexcept
+        {
+            if (const auto *text = std::get_if<std::string>(&field))
+                return keyHash(std::string_view(*text));
+            if (const auto *number = std::get_if<long>(&field))
+                return keyHash(*number);
+            return 0;
+        }
+
+        // compare a column with a typed value without copying the column
+        bool fieldEquals(const db::QBRecord &rec, db::ColumnType columnID, const db::FieldType &value) noexcept
+        {
+            switch (columnID)
+            {
+            case db::ColumnType::COLUMN0:
+            {
+                const auto *id = std::get_if<db::uint>(&value);
+                return id && *id == rec.column0;
+            }
+            case db::ColumnType::COLUMN1:
+            case db::ColumnType::COLUMN3:
+            {
+                const auto *text = std::get_if<std::string>(&value);
+                return text && *text == (columnID == db::ColumnType::COLUMN1 ? rec.column1 : rec.column3);
+            }
+            case db::ColumnType::COLUMN2:
+            {
+                const auto *number = std::get_if<long>(&value);
+                return number && *number == rec.column2;
+            }
+            }
+            return false;
+        }
+
+        db::CompositeIndex::Key compositeKey(const db::QBRecord &rec, const std::vector<db::ColumnType> &columns)
+        {
+            db::CompositeIndex::Key key;
+            key.reserve(columns.size());
+            for (db::ColumnType columnID : columns)
+                key.push_back(columnField(rec, columnID));
+            return key;
+        }
+
+        // conditions with their literals in the column types, false when a literal does not parse
+        bool parseConditions(std::span<const db::ColumnMatch> conditions, std::vector<std::pair<db::ColumnType, db::FieldType>> &parsed)
+        {
+            parsed.reserve(conditions.size());
+            for (const auto &[columnID, text] : conditions)
+            {
+                if (columnID == db::ColumnType::COLUMN1 || columnID == db::ColumnType::COLUMN3)
+                {
+                    parsed.emplace_back(columnID, std::string(text));
+                    continue;
+                }
+                db::uint id = 0;
+                long number = 0;
+                const auto convResult = columnID == db::ColumnType::COLUMN0 ? std::from_chars(text.data(), text.data() + text.size(), id)
+                                                                             : std::from_chars(text.data(), text.data() + text.size(), number);
+                if (convResult.ec != std::errc{} || convResult.ptr != text.data() + text.size())
+                    return false;
+                if (columnID == db::ColumnType::COLUMN0)
+                    parsed.emplace_back(columnID, id);
+                else
+                    parsed.emplace_back(columnID, number);
+            }
+            return true;
+        }
+
+        std::string columnName(db::ColumnType columnID)
+        {
+            return "column" + std::to_string(static_cast<int>(columnID));
+        }
+    }
+
     /**
      * Find matching records by column type and value
      * Uses primary key index for COLUMN0, secondary indexes for other columns,
      * or falls back to linear scan for non-indexed columns
+     * Timed and aggregated per query shape when a query log is attached
      */
     std::vector<QBRecord> QBTable::findMatching(db::ColumnType columnID, std::string_view matchString) const
     {
         std::vector<QBRecord> result;
+        loggedVisitMatching(columnID, matchString, [&](const db::QBRecord &rec)
+                            { result.push_back(rec); });
+        return result;
+    }
+
+    /**
+     * Zero-copy variant of findMatching() - the visitor sees every matching record in table storage
+     * The table must not be modified from inside the visitor
+     */
+    size_t QBTable::forEachMatching(db::ColumnType columnID, std::string_view matchString, const db::RecordVisitor &visitor) const
+    {
+        return loggedVisitMatching(columnID, matchString, visitor);
+    }
+
+    /**
+     * Find records equal to every condition - a conjunction of exact matches
+     * Served by the primary key, a unique index, the composite index covering the longest leading run of the
+     * conditioned columns, the intersection of single column indexes, or a linear scan, in that order of preference
+     */
+    std::vector<QBRecord> QBTable::findMatchingAll(std::span<const db::ColumnMatch> conditions) const
+    {
+        std::vector<QBRecord> result;
+        loggedVisitMatchingAll(conditions, [&](const db::QBRecord &rec)
+                               { result.push_back(rec); });
+        return result;
+    }
+
+    size_t QBTable::forEachMatchingAll(std::span<const db::ColumnMatch> conditions, const db::RecordVisitor &visitor) const
+    {
+        return loggedVisitMatchingAll(conditions, visitor);
+    }
+
+    /**
+     * Run visitMatchingAll() and, when a query log is attached, aggregate it under the shape of all its columns
+     */
+    template <typename Visitor>
+    size_t QBTable::loggedVisitMatchingAll(std::span<const db::ColumnMatch> conditions, Visitor &&visit) const
+    {
+        if (!queryLog_)
+            return visitMatchingAll(conditions, visit);
+
+        auto examined = [this]
+        {
+            uint64_t rows = 0;
+            for (const auto &counters : columnStats_)
+                rows += counters.rowsExamined;
+            return rows;
+        };
+        const uint64_t examinedBefore = examined();
+        auto startTimer = std::chrono::steady_clock::now();
+        size_t matches = visitMatchingAll(conditions, visit);
+        auto elapsed = std::chrono::steady_clock::now() - startTimer;
+
+        std::string columns, literals;
+        for (const auto &[columnID, value] : conditions)
+        {
+            if (!columns.empty())
+            {
+                columns += ',';
+                literals += ',';
+            }
+            columns += columnName(columnID);
+            literals += value;
+        }
+        queryLog_->record({queryLogTable_, columns, db::MatchMode::Exact}, literals,
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed), examined() - examinedBefore, matches,
+                          [&]
+                          { return explain(conditions); });
+        return matches;
+    }
+
+    /**
+     * Execute a conjunctive query - every candidate the chosen access path yields is checked against all conditions
+     * Rows examined and returned are counted on the column whose index, or scan, produced the candidates
+     */
+    template <typename Visitor>
+    size_t QBTable::visitMatchingAll(std::span<const db::ColumnMatch> conditions, Visitor &&visit) const
+    {
+        if (conditions.empty())
+            throw std::runtime_error("findMatchingAll needs at least one condition");
+        std::vector<std::pair<db::ColumnType, db::FieldType>> parsed;
+        if (!parseConditions(conditions, parsed))
+            return 0;
+        auto valueOf = [&](db::ColumnType columnID) -> const db::FieldType *
+        {
+            for (const auto &[conditioned, value] : parsed)
+                if (conditioned == columnID)
+                    return &value;
+            return nullptr;
+        };
+
+        const auto now = expiryNow();
+        size_t matches = 0;
+        auto consider = [&](db::AtomicAccessPathCounters &counters, size_t idx)
+        {
+            ++counters.rowsExamined;
+            if (deleted_[idx] || expired(idx, now))
+            {
+                ++counters.deletedFiltered;
+                return;
+            }
+            const db::QBRecord &rec = records_[idx];
+            for (const auto &[columnID, value] : parsed)
+                if (!fieldEquals(rec, columnID, value))
+                    return;
+            ++counters.rowsReturned;
+            ++matches;
+            visit(rec);
+        };
+
+        if (const db::FieldType *id = valueOf(db::ColumnType::COLUMN0))
+        {
+            db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(db::ColumnType::COLUMN0)];
+            ++counters.pkLookups;
+            indexUsage_[static_cast<size_t>(db::ColumnType::COLUMN0)].touch();
+            if (auto it = pkIndex_.find(std::get<db::uint>(*id)); it != pkIndex_.end())
+                consider(counters, it->second);
+            return matches;
+        }
+
+        for (const auto &[columnID, index] : uniqueIndexes_)
+        {
+            const db::FieldType *value = valueOf(columnID);
+            if (!value)
+                continue;
+            db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(columnID)];
+            ++counters.secondaryIndexLookups;
+            indexUsage_[static_cast<size_t>(columnID)].touch();
+            const size_t holder = index.find(fieldHash(*value), [&](size_t idx)
+                                             { return fieldEquals(records_[idx], columnID, *value); });
+            if (holder != db::UniqueIndex::npos)
+                consider(counters, holder);
+            return matches;
+        }
+
+        auto [composite, prefixLength] = db::longestCompositePrefix(compositeIndexes_, [&](db::ColumnType columnID)
+                                                                    { return valueOf(columnID) != nullptr; });
+        if (composite != compositeIndexes_.end())
+        {
+            db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(composite->first.front())];
+            ++counters.secondaryIndexLookups;
+            if (auto usage = compositeUsage_.find(composite->first); usage != compositeUsage_.end())
+                usage->second.touch();
+            db::CompositeIndex::Key prefix;
+            for (size_t i = 0; i < prefixLength; ++i)
+                prefix.push_back(*valueOf(composite->first[i]));
+            composite->second.forEachPrefix(prefix, [&](const std::vector<size_t> &postings)
+                                            {
+                                                for (size_t idx : postings)
+                                                    consider(counters, idx); });
+            return matches;
+        }
+
+        // intersect the posting lists of single column indexes, driven by the shortest one
+        std::vector<std::pair<db::ColumnType, const std::vector<size_t> *>> postings;
+        for (const auto &[columnID, value] : parsed)
+        {
+            if (!secondaryIndexedColumns_.contains(columnID))
+                continue;
+            db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(columnID)];
+            ++counters.secondaryIndexLookups;
+            indexUsage_[static_cast<size_t>(columnID)].touch();
+            auto it = secondaryIndexes_.find({columnID, value});
+            if (it == secondaryIndexes_.end())
+                return 0;
+            postings.emplace_back(columnID, &it->second);
+        }
+        if (!postings.empty())
+        {
+            std::sort(postings.begin(), postings.end(), [](const auto &a, const auto &b)
+                      { return a.second->size() < b.second->size(); });
+            db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(postings.front().first)];
+            for (size_t idx : *postings.front().second)
+            {
+                if (std::all_of(postings.begin() + 1, postings.end(), [&](const auto &other)
+                                { return std::binary_search(other.second->begin(), other.second->end(), idx); }))
+                    consider(counters, idx);
+            }
+            return matches;
+        }
+
+        db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(parsed.front().first)];
+        ++counters.linearScans;
+        for (size_t i = 0; i < records_.size(); ++i)
+            consider(counters, i);
+        return matches;
+    }
+
+    /**
+     * Find records whose column2 lies in [low, high]
+     * Timed and aggregated per query shape when a query log is attached
+     */
+    std::vector<QBRecord> QBTable::findInRange(long low, long high) const
+    {
+        std::vector<QBRecord> result;
+        loggedVisitRange(low, high, [&](const db::QBRecord &rec)
+                         { result.push_back(rec); });
+        return result;
+    }
+
+    size_t QBTable::forEachInRange(long low, long high, const db::RecordVisitor &visitor) const
+    {
+        return loggedVisitRange(low, high, visitor);
+    }
+
+    /**
+     * Run visitRange() and, when a query log is attached, aggregate it under the column2 range shape
+     */
+    template <typename Visitor>
+    size_t QBTable::loggedVisitRange(long low, long high, Visitor &&visit) const
+    {
+        if (!queryLog_)
+            return visitRange(low, high, visit);
+
+        const db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(db::ColumnType::COLUMN2)];
+        const uint64_t examinedBefore = counters.rowsExamined;
+        auto startTimer = std::chrono::steady_clock::now();
+        size_t matches = visitRange(low, high, visit);
+        auto elapsed = std::chrono::steady_clock::now() - startTimer;
+
+        std::string literal = std::to_string(low);
+        literal += " AND ";
+        literal += std::to_string(high);
+        queryLog_->record({queryLogTable_, "column2", db::MatchMode::Range}, literal,
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed),
+                          counters.rowsExamined - examinedBefore, matches,
+                          [&]
+                          { return explainRange(low, high); });
+        return matches;
+    }
+
+    /**
+     * Execute a range query on column2
+     * The ordered general index answers it with one range of keys. Otherwise the adaptive index copies column2 on
+     * the first range query and cracks its pieces around the bounds of each query, so the rows examined shrink as
+     * queries accumulate; deleted and expired records are filtered when visited, as with index postings
+     */
+    template <typename Visitor>
+    size_t QBTable::visitRange(long low, long high, Visitor &&visit) const
+    {
+        db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(db::ColumnType::COLUMN2)];
+        const auto now = expiryNow();
+        size_t matches = 0;
+        auto consider = [&](size_t idx)
+        {
+            if (deleted_[idx] || expired(idx, now))
+            {
+                ++counters.deletedFiltered;
+                return;
+            }
+            visit(records_[idx]);
+            ++matches;
+        };
+
+        if (secondaryIndexedColumns_.contains(db::ColumnType::COLUMN2))
+        {
+            ++counters.secondaryIndexLookups;
+            indexUsage_[static_cast<size_t>(db::ColumnType::COLUMN2)].touch();
+            for (auto it = secondaryIndexes_.lower_bound({db::ColumnType::COLUMN2, db::FieldType{low}});
+                 it != secondaryIndexes_.end() && it->first.first == db::ColumnType::COLUMN2 && std::get<long>(it->first.second) <= high; ++it)
+            {
+                counters.rowsExamined += it->second.size();
+                for (size_t idx : it->second)
+                    consider(idx);
+            }
+        }
+        else if (adaptiveIndexing_)
+        {
+            ++counters.crackerLookups;
+            if (!cracker_.built())
+            {
+                QB_TRACE_SPAN("QBTable::cracker build", records_.size());
+                std::vector<db::CrackerColumn::Entry> entries;
+                entries.reserve(records_.size());
+                for (size_t i = 0; i < records_.size(); ++i)
+                    if (!deleted_[i])
+                        entries.push_back({records_[i].column2, i});
+                counters.rowsExamined += records_.size();
+                cracker_.build(std::move(entries));
+            }
+            counters.rowsExamined += cracker_.forEachInRange(low, high, consider);
+        }
+        else
+        {
+            ++counters.linearScans;
+            counters.rowsExamined += records_.size();
+            for (size_t i = 0; i < records_.size(); ++i)
+                if (records_[i].column2 >= low && records_[i].column2 <= high && !deleted_[i] && !expired(i, now))
+                {
+                    visit(records_[i]);
+                    ++matches;
+                }
+        }
+        counters.rowsReturned += matches;
+        return matches;
+    }
+
+    /**
+     * Switch adaptive indexing of column2 - switching it off frees the copy, switching it on lets the next range
+     * query build a fresh one
+     */
+    void QBTable::setAdaptiveIndexing(bool enabled)
+    {
+        adaptiveIndexing_ = enabled;
+        if (!enabled)
+            cracker_.clear();
+    }
+
+    /**
+     * Rank records by how well column3 matches the words of query
+     * The full-text index skips deleted and expired records before they are ranked, so k live records come back
+     * whenever that many match; counted as an index lookup on column3, examining the postings decoded
+     */
+    std::vector<db::TextMatch> QBTable::searchText(std::string_view query, size_t k) const
+    {
+        if (!fullText_)
+            throw std::runtime_error("No full-text index on column3");
+        db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(db::ColumnType::COLUMN3)];
+        ++counters.secondaryIndexLookups;
+        auto startTimer = std::chrono::steady_clock::now();
+        const auto now = expiryNow();
+        const auto hits = fullText_->search(query, k, [&](size_t idx)
+                                            {
+                                                if (!deleted_[idx] && !expired(idx, now))
+                                                    return true;
+                                                ++counters.deletedFiltered;
+                                                return false; });
+        std::vector<db::TextMatch> matches;
+        matches.reserve(hits.rows.size());
+        for (const auto &[idx, score] : hits.rows)
+            matches.push_back({records_[idx], score});
+        counters.rowsExamined += hits.postingsDecoded;
+        counters.rowsReturned += matches.size();
+        if (queryLog_)
+            queryLog_->record({queryLogTable_, "column3", db::MatchMode::FullText}, query,
+                              std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTimer),
+                              hits.postingsDecoded, matches.size(), [&]
+                              { return explainText(query); });
+        return matches;
+    }
+
+    /**
+     * Primary key lookups for a batch of keys - all hash probes run back to back before any record is visited,
+     * so the index buckets and the records they point to are fetched without interleaved serialization work
+     * Counted as one primary key lookup per key; with a query log attached each key is logged with the
+     * batch time split evenly
+     */
+    size_t QBTable::lookupBatch(std::span<const db::uint> ids, const db::BatchLookupVisitor &visitor) const
+    {
+        auto startTimer = std::chrono::steady_clock::now();
+        std::vector<const db::QBRecord *> found(ids.size(), nullptr);
+        size_t matches = 0;
+        const auto now = expiryNow();
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            auto it = pkIndex_.find(ids[i]);
+            if (it != pkIndex_.end() && !expired(it->second, now))
+            {
+                found[i] = &records_[it->second];
+                ++matches;
+            }
+        }
+
+        db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(db::ColumnType::COLUMN0)];
+        counters.pkLookups += ids.size();
+        counters.rowsExamined += matches;
+        counters.rowsReturned += matches;
+        indexUsage_[static_cast<size_t>(db::ColumnType::COLUMN0)].touch();
+
+        for (size_t i = 0; i < found.size(); ++i)
+            visitor(i, found[i]);
+
+        if (queryLog_ && !ids.empty())
+        {
+            auto perKey = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - startTimer) /
+                          static_cast<long>(ids.size());
+            const db::QueryShape shape{queryLogTable_, "column0", db::MatchMode::PrimaryKey};
+            for (size_t i = 0; i < ids.size(); ++i)
+            {
+                std::string literal = std::to_string(ids[i]);
+                queryLog_->record(shape, literal, perKey, found[i] ? 1 : 0, found[i] ? 1 : 0,
+                                  [&]
+                                  { return explain(db::ColumnType::COLUMN0, literal); });
+            }
+        }
+        return matches;
+    }
+
+    /**
+     * Visit every active record in storage order until the visitor returns false
+     * Counted as a linear scan in the table totals of stats()
+     */
+    size_t QBTable::forEachRecord(const db::ScanVisitor &visitor) const
+    {
+        ++scanStats_.linearScans;
+        size_t visited = 0;
+        const auto now = expiryNow();
+        for (size_t i = 0; i < records_.size(); ++i)
+        {
+            ++scanStats_.rowsExamined;
+            if (deleted_[i] || expired(i, now))
+                continue;
+            ++visited;
+            if (!visitor(records_[i]))
+                break;
+        }
+        scanStats_.rowsReturned += visited;
+        return visited;
+    }
+
+    /**
+     * Run visitMatching() and, when a query log is attached, time and aggregate the query by shape
+     */
+    template <typename Visitor>
+    size_t QBTable::loggedVisitMatching(db::ColumnType columnID, std::string_view matchString, Visitor &&visit) const
+    {
+        if (!queryLog_)
+            return visitMatching(columnID, matchString, visit);
+
+        const db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(columnID)];
+        const uint64_t examinedBefore = counters.rowsExamined;
+        auto startTimer = std::chrono::steady_clock::now();
+        size_t matches = visitMatching(columnID, matchString, visit);
+        auto elapsed = std::chrono::steady_clock::now() - startTimer;
+
+        db::MatchMode mode = db::MatchMode::Substring;
+        if (columnID == db::ColumnType::COLUMN0)
+            mode = db::MatchMode::PrimaryKey;
+        else if (columnID == db::ColumnType::COLUMN2 || secondaryIndexedColumns_.contains(columnID) || uniqueIndexes_.contains(columnID))
+            mode = db::MatchMode::Exact;
+        queryLog_->record({queryLogTable_, "column" + std::to_string(static_cast<int>(columnID)), mode}, matchString,
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed),
+                          counters.rowsExamined - examinedBefore, matches,
+                          [&]
+                          { return explain(columnID, matchString); });
+        return matches;
+    }
+
+    /**
+     * Execute a query - calls visit(record) for every match and returns the number of matches
+     */
+    template <typename Visitor>
+    size_t QBTable::visitMatching(db::ColumnType columnID, std::string_view matchString, Visitor &&visit) const
+    {
+        db::AtomicAccessPathCounters &counters = columnStats_[static_cast<size_t>(columnID)];
         // handle queries on primary key
         if (columnID == db::ColumnType::COLUMN0)
         {
+            ++counters.pkLookups;
+            indexUsage_[static_cast<size_t>(columnID)].touch();
             db::uint matchValue = 0;
             auto convResult = std::from_chars(matchString.data(), matchString.data() + matchString.size(), matchValue);
             // check if no error and entire string was consumed
             if (convResult.ec != std::errc{} || convResult.ptr != matchString.data() + matchString.size())
-                return {}; // Invalid conversion
+                return 0; // Invalid conversion
 
             auto it = pkIndex_.find(matchValue);
             if (it == pkIndex_.end())
-                return {}; // No matches
+                return 0; // No matches
+
+            ++counters.rowsExamined;
+            if (expired(it->second, expiryNow()))
+            {
+                ++counters.deletedFiltered;
+                return 0;
+            }
+            ++counters.rowsReturned;
+            visit(records_[it->second]);
 
-            result.push_back(records_[it->second]);
+            return 1;
+        }
 
-            return result;
+        // handle queries on unique indexed columns - one probe, the key is compared with the record it points to
+        if (auto uniqueIt = uniqueIndexes_.find(columnID); uniqueIt != uniqueIndexes_.end())
+        {
+            ++counters.secondaryIndexLookups;
+            indexUsage_[static_cast<size_t>(columnID)].touch();
+            size_t recordIdx = db::UniqueIndex::npos;
+            if (columnID == db::ColumnType::COLUMN2)
+            {
+                long val = 0;
+                auto convResult = std::from_chars(matchString.data(), matchString.data() + matchString.size(), val);
+                if (convResult.ec != std::errc{} || convResult.ptr != matchString.data() + matchString.size())
+                    return 0;
+                recordIdx = uniqueIt->second.find(keyHash(val), [&](size_t idx)
+                                                  { return records_[idx].column2 == val; });
+            }
+            else
+            {
+                const bool first = columnID == db::ColumnType::COLUMN1;
+                recordIdx = uniqueIt->second.find(keyHash(matchString), [&](size_t idx)
+                                                  { return (first ? records_[idx].column1 : records_[idx].column3) == matchString; });
+            }
+            if (recordIdx == db::UniqueIndex::npos)
+                return 0;
+            ++counters.rowsExamined;
+            if (expired(recordIdx, expiryNow()))
+            {
+                ++counters.deletedFiltered;
+                return 0;
+            }
+            ++counters.rowsReturned;
+            visit(records_[recordIdx]);
+            return 1;
         }
 
         // handle queries on non-pk columns - secondery indexed
         if (secondaryIndexedColumns_.contains(columnID))
         {
+            ++counters.secondaryIndexLookups;
+            indexUsage_[static_cast<size_t>(columnID)].touch();
             // create typed field from matchString depending on column type
             db::FieldType field;
             switch (columnID)
@@ -48,30 +722,43 @@ namespace db
                 auto convResult = std::from_chars(matchString.data(), matchString.data() + matchString.size(), val);
                 // check if no error and entire string was consumed
                 if (convResult.ec != std::errc{} || convResult.ptr != matchString.data() + matchString.size())
-                    return {};
+                    return 0;
                 field = val;
             }
             break;
             default:
                 // could not convert to a valid field type for indexing - return empty result
-                return {};
+                return 0;
             }
 
             auto it = secondaryIndexes_.find({columnID, field});
             if (it == secondaryIndexes_.end())
-                return {}; // No match found
+                return 0; // No match found
 
+            size_t matches = 0;
+            counters.rowsExamined += it->second.size();
+            const auto now = expiryNow();
             for (size_t idx : it->second)
             {
-                if (!deleted_[idx])
-                    result.push_back(records_[idx]);
+                if (!deleted_[idx] && !expired(idx, now))
+                {
+                    visit(records_[idx]);
+                    ++matches;
+                }
+                else
+                    ++counters.deletedFiltered;
             }
-            return result;
+            counters.rowsReturned += matches;
+            return matches;
         }
         else
         {
             // fall back to linear scan for non-indexed columns
-            return linearScan(columnID, matchString);
+            ++counters.linearScans;
+            counters.rowsExamined += records_.size();
+            size_t matches = linearScan(columnID, matchString, visit);
+            counters.rowsReturned += matches;
+            return matches;
         }
     }
 
@@ -91,14 +778,34 @@ namespace db
         if (!hardDelete && deleted_[recordIdx])
             return false;
 
+        // an expired record that was not purged yet is already gone for readers - purge it as expireRecords() would
+        if (expired(recordIdx, expiryNow()))
+        {
+            std::vector<size_t> stale{recordIdx};
+            softDeleteRecords(stale);
+            return false;
+        }
+
         // soft delete
         if (!hardDelete)
         {
             deleted_[recordIdx] = true;
             // remove from PK index
             pkIndex_.erase(pkIt);
+            removeUniqueEntries(recordIdx);
+            removeCompositeEntries(recordIdx);
+            if (fullText_)
+                fullText_->remove(recordIdx, records_[recordIdx].column3);
+            ++mutations_;
+            if (changeStream_)
+                changeStream_->publish(db::ChangeType::SoftDelete, id, recordIdx);
+            if (wal_)
+                wal_->appendDelete(id, false);
+            for (const auto &view : views_)
+                view->erase(recordIdx);
 
             // remove from secondary indexes
+            QB_TRACE_SPAN("QBTable::softDelete index scan", secondaryIndexes_.size());
             for (auto it = secondaryIndexes_.begin(); it != secondaryIndexes_.end();)
             {
                 auto &indices = it->second;
@@ -115,19 +822,633 @@ namespace db
 
             // swap the record to delete with the last record
             std::swap(records_[recordIdx], records_[lastIdx]);
-            std::swap(deleted_[recordIdx], deleted_[lastIdx]);
+            std::vector<bool>::swap(deleted_[recordIdx], deleted_[lastIdx]);
+            if (!expiresAt_.empty())
+            {
+                std::swap(expiresAt_[recordIdx], expiresAt_[lastIdx]);
+                expiresAt_.pop_back();
+            }
+
+            // remove last record
+            records_.pop_back();
+            deleted_.pop_back();
+
+            // rebuild all indexes for safety
+            QB_TRACE_SPAN("QBTable::hardDelete index rebuild", records_.size());
+            rebuildPrimaryKeyIndex();
+            for (const db::ColumnType colID : secondaryIndexedColumns_)
+                rebuildSecondaryIndexForColumn(colID);
+            rebuildUniqueIndexes();
+            rebuildCompositeIndexes();
+            rebuildFullTextIndex();
+            if (cracker_.built())
+            {
+                std::vector<size_t> newRows(lastIdx + 1);
+                for (size_t row = 0; row <= lastIdx; ++row)
+                    newRows[row] = row;
+                newRows[recordIdx] = db::CrackerColumn::npos;
+                newRows[lastIdx] = recordIdx == lastIdx ? db::CrackerColumn::npos : recordIdx;
+                cracker_.remapRows(newRows);
+            }
+
+            ++mutations_;
+            if (changeStream_)
+            {
+                std::vector<db::RecordMove> moves;
+                if (recordIdx != lastIdx)
+                    moves.push_back({lastIdx, recordIdx});
+                changeStream_->publish(db::ChangeType::HardDelete, id, recordIdx, nullptr, std::move(moves));
+            }
+            if (wal_)
+                wal_->appendDelete(id, true);
+            for (const auto &view : views_)
+            {
+                view->erase(recordIdx);
+                if (recordIdx != lastIdx)
+                    view->move(lastIdx, recordIdx);
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Update the non-key columns of an active record in place
+     * The record keeps its storage position, so the primary key index is untouched and each changed indexed
+     * column moves one posting between two keys instead of rebuilding or scanning the index
+     */
+    bool QBTable::updateRecord(db::uint id, const db::QBRecordUpdate &changes)
+    {
+        auto pkIt = pkIndex_.find(id);
+        if (pkIt == pkIndex_.end() || expired(pkIt->second, expiryNow()))
+            return false;
+
+        const size_t recordIdx = pkIt->second;
+        const unsigned changed = changedColumns(records_[recordIdx], changes);
+        if (!changed)
+            return true;
+        if (!uniqueIndexes_.empty())
+        {
+            db::QBRecord updated = records_[recordIdx];
+            applyUpdate(updated, changes);
+            std::vector<size_t> stale;
+            if (!uniqueKeysFree(updated, recordIdx, expiryNow(), stale))
+                return false;
+            softDeleteRecords(stale);
+        }
+        // only the entries of changed columns move
+        removeUniqueEntries(recordIdx, changed);
+        removeCompositeEntries(recordIdx, changed);
+        db::QBRecord &rec = records_[recordIdx];
+        auto apply = [&](db::ColumnType columnID, auto &field, const auto &value)
+        {
+            if (!value || field == *value)
+                return;
+            if (secondaryIndexedColumns_.contains(columnID))
+                moveSecondaryIndexEntry(columnID, db::FieldType{field}, db::FieldType{*value}, recordIdx);
+            field = *value;
+        };
+        if (changes.column2 && rec.column2 != *changes.column2)
+            cracker_.update(*changes.column2, recordIdx);
+        if (fullText_ && changes.column3 && rec.column3 != *changes.column3)
+            fullText_->replace(recordIdx, rec.column3, *changes.column3);
+        apply(db::ColumnType::COLUMN1, rec.column1, changes.column1);
+        apply(db::ColumnType::COLUMN2, rec.column2, changes.column2);
+        apply(db::ColumnType::COLUMN3, rec.column3, changes.column3);
+        addUniqueEntries(recordIdx, changed);
+        addCompositeEntries(recordIdx, changed);
+
+        ++mutations_;
+        if (changeStream_)
+            changeStream_->publish(db::ChangeType::Update, id, recordIdx, &rec);
+        if (wal_)
+            wal_->appendUpdate(rec);
+        for (const auto &view : views_)
+        {
+            view->erase(recordIdx);
+            view->insert(recordIdx, rec);
+        }
+        return true;
+    }
+
+    /**
+     * Merge a batch of records keyed on the primary key
+     * All keys are probed in one pass before anything changes. Updated records keep their position, new ones are
+     * appended; the primary key index is only written for appended records. Secondary indexes are maintained
+     * once for the whole batch: per indexed column the postings leaving and entering each key are collected,
+     * then every affected posting list is edited in a single pass. Change streams, the write-ahead log and
+     * views see the same Insert and Update sequence as addRecord() and updateRecord() calls would produce.
+     */
+    db::UpsertResult QBTable::upsertRecords(std::span<const db::QBRecord> records)
+    {
+        QB_TRACE_SPAN("QBTable::upsertRecords", records.size());
+        constexpr size_t npos = static_cast<size_t>(-1);
+        db::UpsertResult result;
+
+        std::vector<size_t> positions(records.size(), npos);
+        std::vector<size_t> expiredHits;
+        const auto now = expiryNow();
+        size_t misses = 0;
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            auto it = pkIndex_.find(records[i].column0);
+            if (it != pkIndex_.end() && !expired(it->second, now))
+                positions[i] = it->second;
+            else
+            {
+                if (it != pkIndex_.end())
+                    expiredHits.push_back(it->second);
+                ++misses;
+            }
+        }
+        // an expired record is replaced rather than updated - purge it first so its key reads as new
+        if (!expiredHits.empty())
+            softDeleteRecords(expiredHits);
+        // grow geometrically - an exact reserve would reallocate on every call of a stream of small batches
+        if (records_.size() + misses > records_.capacity())
+        {
+            records_.reserve(std::max(records_.size() + misses, 2 * records_.capacity()));
+            deleted_.reserve(records_.capacity());
+        }
+
+        // indexed values of existing records before their first change in this batch
+        const size_t firstAppended = records_.size();
+        std::unordered_map<size_t, std::vector<db::FieldType>> original;
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            const db::QBRecord &record = records[i];
+            size_t idx = positions[i];
+            // a miss may have been appended by an earlier record of the batch
+            if (idx == npos)
+            {
+                auto it = pkIndex_.find(record.column0);
+                if (it != pkIndex_.end())
+                    idx = it->second;
+            }
+            std::vector<size_t> stale;
+            if (!uniqueIndexes_.empty() && !uniqueKeysFree(record, idx, now, stale))
+            {
+                ++result.rejected;
+                continue;
+            }
+            if (!stale.empty())
+                softDeleteRecords(stale);
+            if (idx == npos)
+            {
+                idx = records_.size();
+                records_.push_back(record);
+                deleted_.push_back(false);
+                if (!expiresAt_.empty())
+                    expiresAt_.push_back(std::numeric_limits<db::TtlClock::rep>::max());
+                pkIndex_[record.column0] = idx;
+                cracker_.append(record.column2, idx);
+                if (fullText_)
+                    fullText_->add(idx, record.column3);
+                addUniqueEntries(idx);
+                addCompositeEntries(idx);
+                ++result.inserted;
+                ++mutations_;
+                if (changeStream_)
+                    changeStream_->publish(db::ChangeType::Insert, record.column0, idx, &record);
+                if (wal_)
+                    wal_->appendInsert(record);
+                for (const auto &view : views_)
+                    view->insert(idx, record);
+                continue;
+            }
+
+            db::QBRecord &rec = records_[idx];
+            const unsigned changed = changedColumns(rec, record);
+            if (!changed)
+            {
+                ++result.unchanged;
+                continue;
+            }
+            if (idx < firstAppended && !secondaryIndexedColumns_.empty() && !original.contains(idx))
+            {
+                auto &values = original[idx];
+                for (db::ColumnType columnID : secondaryIndexedColumns_)
+                    values.push_back(getColumnField(idx, columnID));
+            }
+            removeUniqueEntries(idx, changed);
+            removeCompositeEntries(idx, changed);
+            if (rec.column2 != record.column2)
+                cracker_.update(record.column2, idx);
+            if (fullText_ && rec.column3 != record.column3)
+                fullText_->replace(idx, rec.column3, record.column3);
+            rec = record;
+            addUniqueEntries(idx, changed);
+            addCompositeEntries(idx, changed);
+            ++result.updated;
+            ++mutations_;
+            if (changeStream_)
+                changeStream_->publish(db::ChangeType::Update, record.column0, idx, &rec);
+            if (wal_)
+                wal_->appendUpdate(rec);
+            for (const auto &view : views_)
+            {
+                view->erase(idx);
+                view->insert(idx, rec);
+            }
+        }
+
+        size_t column = 0;
+        for (db::ColumnType columnID : secondaryIndexedColumns_)
+        {
+            std::map<db::FieldType, std::vector<size_t>> removals, additions;
+            for (const auto &[idx, values] : original)
+            {
+                db::FieldType after = getColumnField(idx, columnID);
+                if (after == values[column])
+                    continue;
+                removals[values[column]].push_back(idx);
+                additions[std::move(after)].push_back(idx);
+            }
+            for (size_t idx = firstAppended; idx < records_.size(); ++idx)
+                additions[getColumnField(idx, columnID)].push_back(idx);
+            applySecondaryIndexDeltas(columnID, removals, additions);
+            ++column;
+        }
+        return result;
+    }
+
+    /**
+     * Apply the operations of a transaction in order, all or none
+     * Validation replays the sequence against the primary key index and an overlay of the keys the transaction
+     * itself inserts and deletes, so the table is only touched once every operation is known to apply. Records
+     * are then appended, updated and soft deleted in place, remembering the indexed values each existing record
+     * had before its first change; secondary indexes are corrected once per column at the end, as in
+     * upsertRecords(). Change streams and views see one event per operation, the write-ahead log one Batch entry.
+     */
+    db::CommitResult QBTable::commit(const db::QBTransaction &txn)
+    {
+        QB_TRACE_SPAN("QBTable::commit", txn.size());
+        db::CommitResult result;
+        const auto &operations = txn.operations();
+
+        // live - whether a key exists after the operations validated so far, for keys the transaction touched
+        std::unordered_map<db::uint, bool> live;
+        std::vector<size_t> expiredHits;
+        const auto now = expiryNow();
+        // with unique indexes: values of the records the transaction wrote, and whether it took or freed a unique key
+        std::unordered_map<db::uint, db::QBRecord> written;
+        std::map<std::pair<db::ColumnType, db::FieldType>, bool> uniqueTaken;
+        auto current = [&](db::uint id) -> const db::QBRecord &
+        {
+            auto it = written.find(id);
+            return it != written.end() ? it->second : records_[pkIndex_.at(id)];
+        };
+        // take the record's unique keys that differ from before, false when one is held by another record
+        auto claimUniqueKeys = [&](const db::QBRecord &record, const db::QBRecord *before)
+        {
+            for (const auto &[columnID, index] : uniqueIndexes_)
+            {
+                if (before && sameKey(*before, record, columnID))
+                    continue;
+                bool taken;
+                if (auto it = uniqueTaken.find({columnID, columnField(record, columnID)}); it != uniqueTaken.end())
+                    taken = it->second;
+                else
+                {
+                    const size_t holder = index.find(uniqueHash(record, columnID), [&](size_t idx)
+                                                     { return sameKey(records_[idx], record, columnID); });
+                    taken = holder != db::UniqueIndex::npos && !expired(holder, now);
+                    if (holder != db::UniqueIndex::npos && !taken)
+                        expiredHits.push_back(holder);
+                }
+                if (taken)
+                    return false;
+            }
+            for (const auto &[columnID, index] : uniqueIndexes_)
+            {
+                if (before && sameKey(*before, record, columnID))
+                    continue;
+                uniqueTaken[{columnID, columnField(record, columnID)}] = true;
+                if (before)
+                    uniqueTaken[{columnID, columnField(*before, columnID)}] = false;
+            }
+            return true;
+        };
+        size_t inserts = 0;
+        for (size_t i = 0; i < operations.size(); ++i)
+        {
+            const auto &operation = operations[i];
+            bool present;
+            if (auto it = live.find(operation.id); it != live.end())
+                present = it->second;
+            else
+            {
+                auto pkIt = pkIndex_.find(operation.id);
+                present = pkIt != pkIndex_.end() && !expired(pkIt->second, now);
+                if (pkIt != pkIndex_.end() && !present)
+                    expiredHits.push_back(pkIt->second);
+            }
+            bool valid = (operation.op == db::TransactionOp::Insert) != present;
+            if (valid && !uniqueIndexes_.empty())
+            {
+                if (operation.op == db::TransactionOp::Insert)
+                {
+                    valid = claimUniqueKeys(operation.record, nullptr);
+                    written[operation.id] = operation.record;
+                }
+                else if (operation.op == db::TransactionOp::Update)
+                {
+                    db::QBRecord updated = current(operation.id);
+                    applyUpdate(updated, operation.changes);
+                    valid = claimUniqueKeys(updated, &current(operation.id));
+                    written[operation.id] = std::move(updated);
+                }
+                else
+                {
+                    for (const auto &[columnID, index] : uniqueIndexes_)
+                        uniqueTaken[{columnID, columnField(current(operation.id), columnID)}] = false;
+                    written.erase(operation.id);
+                }
+            }
+            if (!valid)
+            {
+                result.failedOperation = i;
+                return result;
+            }
+            live[operation.id] = operation.op != db::TransactionOp::Delete;
+            inserts += operation.op == db::TransactionOp::Insert;
+        }
+
+        // an expired record is replaced by the insert of its key - purge it first, as addRecord() does
+        if (!expiredHits.empty())
+            softDeleteRecords(expiredHits);
+        // grow geometrically - an exact reserve would reallocate on every call of a stream of small batches
+        if (records_.size() + inserts > records_.capacity())
+        {
+            records_.reserve(std::max(records_.size() + inserts, 2 * records_.capacity()));
+            deleted_.reserve(records_.capacity());
+        }
+
+        const size_t firstAppended = records_.size();
+        std::unordered_map<size_t, std::vector<db::FieldType>> original;
+        auto remember = [&](size_t idx)
+        {
+            if (idx >= firstAppended || secondaryIndexedColumns_.empty() || original.contains(idx))
+                return;
+            auto &values = original[idx];
+            for (db::ColumnType columnID : secondaryIndexedColumns_)
+                values.push_back(getColumnField(idx, columnID));
+        };
+        std::vector<db::wal::LogEntry> logged;
+        if (wal_)
+            logged.reserve(operations.size());
+
+        for (const auto &operation : operations)
+        {
+            switch (operation.op)
+            {
+            case db::TransactionOp::Insert:
+            {
+                const size_t idx = records_.size();
+                records_.push_back(operation.record);
+                deleted_.push_back(false);
+                if (!expiresAt_.empty())
+                    expiresAt_.push_back(std::numeric_limits<db::TtlClock::rep>::max());
+                pkIndex_[operation.id] = idx;
+                cracker_.append(operation.record.column2, idx);
+                if (fullText_)
+                    fullText_->add(idx, operation.record.column3);
+                addUniqueEntries(idx);
+                addCompositeEntries(idx);
+                ++result.inserted;
+                ++mutations_;
+                if (changeStream_)
+                    changeStream_->publish(db::ChangeType::Insert, operation.id, idx, &records_[idx]);
+                if (wal_)
+                    logged.push_back({.type = db::wal::EntryType::Insert, .id = operation.id, .record = records_[idx]});
+                for (const auto &view : views_)
+                    view->insert(idx, records_[idx]);
+                break;
+            }
+            case db::TransactionOp::Update:
+            {
+                const size_t idx = pkIndex_.at(operation.id);
+                db::QBRecord &rec = records_[idx];
+                const db::QBRecordUpdate &changes = operation.changes;
+                const unsigned changed = changedColumns(rec, changes);
+                if (!changed)
+                    break;
+                remember(idx);
+                removeUniqueEntries(idx, changed);
+                removeCompositeEntries(idx, changed);
+                if (changes.column2 && rec.column2 != *changes.column2)
+                    cracker_.update(*changes.column2, idx);
+                if (fullText_ && changes.column3 && rec.column3 != *changes.column3)
+                    fullText_->replace(idx, rec.column3, *changes.column3);
+                applyUpdate(rec, changes);
+                addUniqueEntries(idx, changed);
+                addCompositeEntries(idx, changed);
+                ++result.updated;
+                ++mutations_;
+                if (changeStream_)
+                    changeStream_->publish(db::ChangeType::Update, operation.id, idx, &rec);
+                if (wal_)
+                    logged.push_back({.type = db::wal::EntryType::Update, .id = operation.id, .record = rec});
+                for (const auto &view : views_)
+                {
+                    view->erase(idx);
+                    view->insert(idx, rec);
+                }
+                break;
+            }
+            case db::TransactionOp::Delete:
+            {
+                auto pkIt = pkIndex_.find(operation.id);
+                const size_t idx = pkIt->second;
+                remember(idx);
+                removeUniqueEntries(idx);
+                removeCompositeEntries(idx);
+                if (fullText_)
+                    fullText_->remove(idx, records_[idx].column3);
+                deleted_[idx] = true;
+                pkIndex_.erase(pkIt);
+                ++result.deleted;
+                ++mutations_;
+                if (changeStream_)
+                    changeStream_->publish(db::ChangeType::SoftDelete, operation.id, idx);
+                if (wal_)
+                    logged.push_back({.type = db::wal::EntryType::SoftDelete, .id = operation.id});
+                for (const auto &view : views_)
+                    view->erase(idx);
+                break;
+            }
+            }
+        }
+        if (wal_ && !logged.empty())
+            wal_->appendBatch(logged);
+
+        size_t column = 0;
+        for (db::ColumnType columnID : secondaryIndexedColumns_)
+        {
+            std::map<db::FieldType, std::vector<size_t>> removals, additions;
+            for (const auto &[idx, values] : original)
+            {
+                if (deleted_[idx])
+                {
+                    removals[values[column]].push_back(idx);
+                    continue;
+                }
+                db::FieldType after = getColumnField(idx, columnID);
+                if (after == values[column])
+                    continue;
+                removals[values[column]].push_back(idx);
+                additions[std::move(after)].push_back(idx);
+            }
+            // records inserted and deleted again by the transaction never enter the index
+            for (size_t idx = firstAppended; idx < records_.size(); ++idx)
+                if (!deleted_[idx])
+                    additions[getColumnField(idx, columnID)].push_back(idx);
+            applySecondaryIndexDeltas(columnID, removals, additions);
+            ++column;
+        }
+        result.committed = true;
+        return result;
+    }
+
+    /**
+     * Remove and add postings of one indexed column, one pass over each affected posting list
+     */
+    void QBTable::applySecondaryIndexDeltas(db::ColumnType columnID, std::map<db::FieldType, std::vector<size_t>> &removals,
+                                            std::map<db::FieldType, std::vector<size_t>> &additions)
+    {
+        for (auto &[key, leaving] : removals)
+        {
+            auto it = secondaryIndexes_.find({columnID, key});
+            if (it == secondaryIndexes_.end())
+                continue;
+            std::sort(leaving.begin(), leaving.end());
+            auto &indices = it->second;
+            indices.erase(std::remove_if(indices.begin(), indices.end(), [&](size_t idx)
+                                         { return std::binary_search(leaving.begin(), leaving.end(), idx); }),
+                          indices.end());
+            if (indices.empty())
+                secondaryIndexes_.erase(it);
+        }
+        for (auto &[key, entering] : additions)
+        {
+            std::sort(entering.begin(), entering.end());
+            auto &indices = secondaryIndexes_[{columnID, key}];
+            const auto middle = static_cast<std::ptrdiff_t>(indices.size());
+            indices.insert(indices.end(), entering.begin(), entering.end());
+            if (middle > 0 && indices[size_t(middle) - 1] > entering.front())
+                std::inplace_merge(indices.begin(), indices.begin() + middle, indices.end());
+        }
+    }
+
+    /**
+     * Whether no other active record holds the record's key of any unique index - self is the record's own
+     * position, npos for a new record. Holders that expired but were not purged yet do not count; they are
+     * collected in stale for the caller to purge before it adds the keys.
+     */
+    bool QBTable::uniqueKeysFree(const db::QBRecord &record, size_t self, db::TtlClock::rep now, std::vector<size_t> &stale) const
+    {
+        for (const auto &[columnID, index] : uniqueIndexes_)
+        {
+            const size_t holder = index.find(uniqueHash(record, columnID), [&](size_t idx)
+                                             { return sameKey(records_[idx], record, columnID); });
+            if (holder == db::UniqueIndex::npos || holder == self)
+                continue;
+            if (!expired(holder, now))
+                return false;
+            stale.push_back(holder);
+        }
+        return true;
+    }
+
+    void QBTable::addUniqueEntries(size_t recordIdx, unsigned columns)
+    {
+        for (auto &[columnID, index] : uniqueIndexes_)
+            if (columns & columnBit(columnID))
+                index.insert(uniqueHash(records_[recordIdx], columnID), recordIdx);
+    }
+
+    void QBTable::removeUniqueEntries(size_t recordIdx, unsigned columns)
+    {
+        for (auto &[columnID, index] : uniqueIndexes_)
+            if (columns & columnBit(columnID))
+                index.erase(uniqueHash(records_[recordIdx], columnID), recordIdx);
+    }
+
+    /**
+     * Rebuild the unique indexes after records changed position - hard delete and compaction
+     */
+    void QBTable::rebuildUniqueIndexes()
+    {
+        for (auto &[columnID, index] : uniqueIndexes_)
+        {
+            index.clear();
+            index.reserve(pkIndex_.size());
+            for (size_t i = 0; i < records_.size(); ++i)
+                if (!deleted_[i])
+                    index.insert(uniqueHash(records_[i], columnID), i);
+        }
+    }
+
+    void QBTable::addCompositeEntries(size_t recordIdx, unsigned changed)
+    {
+        for (auto &[columns, index] : compositeIndexes_)
+            if (std::ranges::any_of(columns, [&](db::ColumnType columnID)
+                                    { return changed & columnBit(columnID); }))
+                index.add(compositeKey(records_[recordIdx], columns), recordIdx);
+    }
 
-            // remove last record
-            records_.pop_back();
-            deleted_.pop_back();
+    void QBTable::removeCompositeEntries(size_t recordIdx, unsigned changed)
+    {
+        for (auto &[columns, index] : compositeIndexes_)
+            if (std::ranges::any_of(columns, [&](db::ColumnType columnID)
+                                    { return changed & columnBit(columnID); }))
+                index.remove(compositeKey(records_[recordIdx], columns), recordIdx);
+    }
 
-            // rebuild all indexes for safety
-            rebuildPrimaryKeyIndex();
-            for (const db::ColumnType colID : secondaryIndexedColumns_)
-                rebuildSecondaryIndexForColumn(colID);
+    /**
+     * Rebuild the composite indexes after records changed position - hard delete and compaction
+     */
+    void QBTable::rebuildCompositeIndexes()
+    {
+        for (auto &[columns, index] : compositeIndexes_)
+        {
+            index.clear();
+            for (size_t i = 0; i < records_.size(); ++i)
+                if (!deleted_[i])
+                    index.add(compositeKey(records_[i], columns), i);
         }
+    }
 
-        return true;
+    /**
+     * Rebuild the full-text index after records changed position - hard delete and compaction
+     */
+    void QBTable::rebuildFullTextIndex()
+    {
+        if (!fullText_)
+            return;
+        fullText_->clear();
+        for (size_t i = 0; i < records_.size(); ++i)
+            if (!deleted_[i])
+                fullText_->add(i, records_[i].column3);
+    }
+
+    /**
+     * Move one record's posting between two keys of a secondary index, keeping postings in storage order
+     */
+    void QBTable::moveSecondaryIndexEntry(db::ColumnType columnID, const db::FieldType &from, const db::FieldType &to, size_t recordIdx)
+    {
+        auto it = secondaryIndexes_.find({columnID, from});
+        if (it != secondaryIndexes_.end())
+        {
+            auto &indices = it->second;
+            auto pos = std::lower_bound(indices.begin(), indices.end(), recordIdx);
+            if (pos != indices.end() && *pos == recordIdx)
+                indices.erase(pos);
+            if (indices.empty())
+                secondaryIndexes_.erase(it);
+        }
+        auto &indices = secondaryIndexes_[{columnID, to}];
+        indices.insert(std::lower_bound(indices.begin(), indices.end(), recordIdx), recordIdx);
     }
 
     /**
@@ -212,22 +1533,24 @@ namespace db
     /*
      * Linear scan fallback for non-indexed columns
      */
-    std::vector<db::QBRecord> QBTable::linearScan(db::ColumnType columnID, std::string_view matchString) const
+    template <typename Visitor>
+    size_t QBTable::linearScan(db::ColumnType columnID, std::string_view matchString, Visitor &&visit) const
     {
-        std::vector<db::QBRecord> result;
+        size_t matches = 0;
+        const auto now = expiryNow();
 
         for (size_t i = 0; i < records_.size(); ++i)
         {
-            if (deleted_[i])
+            if (deleted_[i] || expired(i, now))
                 continue;
 
             const db::QBRecord &rec = records_[i];
-            bool matches = false;
+            bool isMatch = false;
 
             switch (columnID)
             {
             case db::ColumnType::COLUMN1:
-                matches = (rec.column1.find(matchString) != std::string::npos);
+                isMatch = (rec.column1.find(matchString) != std::string::npos);
                 break;
 
             case db::ColumnType::COLUMN2:
@@ -236,38 +1559,68 @@ namespace db
                 auto convResult = std::from_chars(matchString.data(), matchString.data() + matchString.size(), matchValue);
                 // check if no error and entire string was consumed
                 if (convResult.ec != std::errc{} || convResult.ptr != matchString.data() + matchString.size())
-                    return {};
-                matches = (rec.column2 == matchValue);
+                    return 0;
+                isMatch = (rec.column2 == matchValue);
             }
             break;
 
             case db::ColumnType::COLUMN3:
-                matches = (rec.column3.find(matchString) != std::string::npos);
+                isMatch = (rec.column3.find(matchString) != std::string::npos);
                 break;
             case db::ColumnType::COLUMN0:
                 // Should never reach here - COLUMN0 is always indexed
                 break;
             }
 
-            if (matches)
-                result.push_back(rec);
+            if (isMatch)
+            {
+                visit(rec);
+                ++matches;
+            }
         }
 
-        return result;
+        return matches;
     }
 
     /*
      * Create an index on a specific column
+     * A Unique index is built in one pass and refused when two active records share a key
      */
-    void QBTable::createIndex(db::ColumnType columnID)
+    void QBTable::createIndex(db::ColumnType columnID, db::IndexKind kind)
     {
         // if column is already indexed, or is primary key exit
-        if (columnID == ColumnType::COLUMN0 || secondaryIndexedColumns_.contains(columnID))
+        if (columnID == ColumnType::COLUMN0 || secondaryIndexedColumns_.contains(columnID) || uniqueIndexes_.contains(columnID))
             throw std::runtime_error("Cannot create index on already indexed or primary key column");
         else
         {
-            secondaryIndexedColumns_.insert(columnID);
-            rebuildSecondaryIndexForColumn(columnID);
+            QB_TRACE_SPAN("QBTable::createIndex", records_.size());
+            if (kind == db::IndexKind::Unique)
+            {
+                db::UniqueIndex index;
+                index.reserve(pkIndex_.size());
+                for (size_t i = 0; i < records_.size(); ++i)
+                {
+                    if (deleted_[i])
+                        continue;
+                    const uint64_t hash = uniqueHash(records_[i], columnID);
+                    if (index.find(hash, [&](size_t idx)
+                                   { return sameKey(records_[idx], records_[i], columnID); }) != db::UniqueIndex::npos)
+                        throw std::runtime_error("Cannot create unique index on column with duplicate values");
+                    index.insert(hash, i);
+                }
+                uniqueIndexes_.emplace(columnID, std::move(index));
+            }
+            else
+            {
+                secondaryIndexedColumns_.insert(columnID);
+                rebuildSecondaryIndexForColumn(columnID);
+                // range queries use the index from now on
+                if (columnID == db::ColumnType::COLUMN2)
+                    cracker_.clear();
+            }
+            indexUsage_[static_cast<size_t>(columnID)] = {};
+            if (wal_)
+                wal_->appendIndexChange(columnID, true, kind);
         }
     }
 
@@ -282,7 +1635,11 @@ namespace db
         if (columnID == db::ColumnType::COLUMN0)
             throw std::runtime_error("Cannot drop index on primary key column");
         secondaryIndexedColumns_.erase(columnID);
+        uniqueIndexes_.erase(columnID);
+        indexUsage_[static_cast<size_t>(columnID)] = {};
         removeSecondaryIndexForColumn(columnID);
+        if (wal_)
+            wal_->appendIndexChange(columnID, false);
     }
 
     /**
@@ -292,21 +1649,99 @@ namespace db
     {
         if (columnID == db::ColumnType::COLUMN0)
             return true;
-        return secondaryIndexedColumns_.contains(columnID);
+        return secondaryIndexedColumns_.contains(columnID) || uniqueIndexes_.contains(columnID);
+    }
+
+    /**
+     * Create an index over several columns - its keys are the columns' values in the given order
+     * The primary key cannot be part of one, a lookup on it already finds at most one record
+     */
+    void QBTable::createCompositeIndex(std::vector<db::ColumnType> columns)
+    {
+        if (columns.size() < 2)
+            throw std::runtime_error("A composite index needs at least two columns");
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            if (columns[i] == db::ColumnType::COLUMN0)
+                throw std::runtime_error("Cannot include the primary key column in a composite index");
+            if (std::find(columns.begin(), columns.begin() + static_cast<std::ptrdiff_t>(i), columns[i]) != columns.begin() + static_cast<std::ptrdiff_t>(i))
+                throw std::runtime_error("Cannot repeat a column in a composite index");
+        }
+        if (compositeIndexes_.contains(columns))
+            throw std::runtime_error("Composite index already exists");
+
+        QB_TRACE_SPAN("QBTable::createCompositeIndex", records_.size());
+        db::CompositeIndex index;
+        for (size_t i = 0; i < records_.size(); ++i)
+            if (!deleted_[i])
+                index.add(compositeKey(records_[i], columns), i);
+        if (wal_)
+            wal_->appendCompositeIndexChange(columns, true);
+        compositeUsage_[columns] = {};
+        compositeIndexes_.emplace(std::move(columns), std::move(index));
+    }
+
+    void QBTable::dropCompositeIndex(const std::vector<db::ColumnType> &columns)
+    {
+        compositeIndexes_.erase(columns);
+        compositeUsage_.erase(columns);
+        if (wal_)
+            wal_->appendCompositeIndexChange(columns, false);
+    }
+
+    bool QBTable::hasCompositeIndex(const std::vector<db::ColumnType> &columns) const
+    {
+        return compositeIndexes_.contains(columns);
+    }
+
+    /**
+     * Create the full-text index on column3 from the active records
+     */
+    void QBTable::createFullTextIndex(db::TokenizerOptions tokenizer, db::Bm25Options bm25)
+    {
+        if (fullText_)
+            throw std::runtime_error("Full-text index on column3 already exists");
+        QB_TRACE_SPAN("QBTable::createFullTextIndex", records_.size());
+        fullText_ = std::make_unique<db::FullTextIndex>(std::move(tokenizer), bm25);
+        rebuildFullTextIndex();
+    }
+
+    void QBTable::dropFullTextIndex()
+    {
+        fullText_.reset();
     }
 
     /**
      * Add a new record to the table
      * Updates both primary key index and secondary indexes
      */
-    void QBTable::addRecord(const db::QBRecord &record)
+    bool QBTable::addRecord(const db::QBRecord &record)
     {
+        std::vector<size_t> stale;
+        if (!uniqueIndexes_.empty() && !uniqueKeysFree(record, db::UniqueIndex::npos, expiryNow(), stale))
+            return false;
+        if (!expiresAt_.empty())
+        {
+            // a record with the same key that expired but was not purged yet is replaced
+            auto it = pkIndex_.find(record.column0);
+            if (it != pkIndex_.end() && expired(it->second, expiryNow()))
+                stale.push_back(it->second);
+            softDeleteRecords(stale);
+            expiresAt_.push_back(std::numeric_limits<db::TtlClock::rep>::max());
+        }
         size_t idx = records_.size();
-        records_.push_back(record);
+        {
+            // push_back at capacity reallocates and moves every record
+            QB_TRACE_SPAN_IF(records_.size() == records_.capacity(), "QBTable::records_ reallocation", records_.size());
+            records_.push_back(record);
+        }
         deleted_.push_back(false);
 
         // update primary key index
         pkIndex_[record.column0] = idx;
+        cracker_.append(record.column2, idx);
+        if (fullText_)
+            fullText_->add(idx, record.column3);
 
         // update secondary indexes
         for (db::ColumnType columnID : secondaryIndexedColumns_)
@@ -314,6 +1749,17 @@ namespace db
             db::FieldType key = getColumnField(idx, columnID);
             secondaryIndexes_[{columnID, key}].push_back(idx);
         }
+        addUniqueEntries(idx);
+        addCompositeEntries(idx);
+
+        ++mutations_;
+        if (changeStream_)
+            changeStream_->publish(db::ChangeType::Insert, record.column0, idx, &record);
+        if (wal_)
+            wal_->appendInsert(record);
+        for (const auto &view : views_)
+            view->insert(idx, record);
+        return true;
     }
 
     /**
@@ -321,6 +1767,14 @@ namespace db
      */
     size_t QBTable::activeRecordsCount() const noexcept
     {
+        if (!expiresAt_.empty())
+        {
+            const auto now = expiryNow();
+            size_t active = 0;
+            for (size_t i = 0; i < records_.size(); ++i)
+                active += !deleted_[i] && !expired(i, now);
+            return active;
+        }
         // static_cast to size_t to avoid signed/unsigned comparison warnings
         return static_cast<size_t>(std::count_if(deleted_.begin(), deleted_.end(), [](bool del) -> bool
                              { return !del; }));
@@ -334,33 +1788,535 @@ namespace db
         return records_.size();
     }
 
+    /**
+     * Snapshot access path counters per column and usage of the primary key and secondary indexes
+     * Counters are relaxed atomics - a snapshot taken while queries run may mix counts from before and after one
+     */
+    db::QBTableStats QBTable::stats() const
+    {
+        db::QBTableStats snapshot;
+        for (size_t col = 0; col < columnStats_.size(); ++col)
+        {
+            const db::AccessPathCounters counters = columnStats_[col].snapshot();
+            if (counters.pkLookups + counters.secondaryIndexLookups + counters.linearScans + counters.crackerLookups > 0)
+                snapshot.columns[static_cast<db::ColumnType>(col)] = counters;
+            snapshot.table += counters;
+        }
+        snapshot.table += scanStats_.snapshot();
+        snapshot.indexes[db::ColumnType::COLUMN0] = indexUsage_[0].snapshot();
+        for (db::ColumnType columnID : secondaryIndexedColumns_)
+            snapshot.indexes[columnID] = indexUsage_[static_cast<size_t>(columnID)].snapshot();
+        for (const auto &[columnID, index] : uniqueIndexes_)
+            snapshot.indexes[columnID] = indexUsage_[static_cast<size_t>(columnID)].snapshot();
+        for (const auto &[columns, index] : compositeIndexes_)
+        {
+            auto it = compositeUsage_.find(columns);
+            snapshot.compositeIndexes[columns] = (it != compositeUsage_.end()) ? it->second.snapshot() : db::IndexUsage{};
+        }
+        snapshot.mutations = mutations_;
+        return snapshot;
+    }
+
+    /**
+     * Reset all access path counters and index usage
+     */
+    void QBTable::resetStats() noexcept
+    {
+        columnStats_.fill({});
+        indexUsage_.fill({});
+        for (auto &[columns, usage] : compositeUsage_)
+            usage = {};
+        scanStats_ = {};
+        mutations_ = 0;
+    }
+
+    /**
+     * Measure or estimate the general index on a column
+     * An existing index is measured key by key. For a column without one, a table of at most sampleSize records is
+     * counted exactly; a larger one is sampled at pseudo-random positions, which unlike a fixed stride cannot
+     * alias with periodic data, and its distinct values are estimated with the bias-corrected Chao1 estimator
+     * d + f1 (f1 - 1) / (2 (f2 + 1)), f1 and f2 the values seen once and twice. Memory counts map nodes, string
+     * keys too long for the small string buffer and posting lists with their growth slack.
+     */
+    db::IndexEstimate QBTable::estimateIndex(db::ColumnType columnID, size_t sampleSize) const
+    {
+        using Node = decltype(secondaryIndexes_)::value_type;
+        constexpr size_t kNodeOverhead = 4 * sizeof(void *); // red-black tree links and color of a std::map node
+        auto keyHeap = [](const db::FieldType &key) -> size_t
+        {
+            const auto *text = std::get_if<std::string>(&key);
+            return text && text->size() > 15 ? text->size() + 1 : 0;
+        };
+        db::IndexEstimate estimate;
+        if (columnID == db::ColumnType::COLUMN0)
+        {
+            estimate.keys = estimate.postings = pkIndex_.size();
+            estimate.memoryBytes = pkIndex_.bucket_count() * sizeof(void *) + pkIndex_.size() * (sizeof(void *) + sizeof(decltype(pkIndex_)::value_type));
+            estimate.exists = true;
+            return estimate;
+        }
+        if (auto uniqueIt = uniqueIndexes_.find(columnID); uniqueIt != uniqueIndexes_.end())
+        {
+            estimate.keys = estimate.postings = uniqueIt->second.size();
+            estimate.memoryBytes = uniqueIt->second.memoryUsage();
+            estimate.exists = estimate.unique = true;
+            return estimate;
+        }
+        if (secondaryIndexedColumns_.contains(columnID))
+        {
+            estimate.exists = true;
+            for (auto it = secondaryIndexes_.lower_bound({columnID, db::FieldType{}}); it != secondaryIndexes_.end() && it->first.first == columnID; ++it)
+            {
+                ++estimate.keys;
+                estimate.postings += it->second.size();
+                estimate.memoryBytes += kNodeOverhead + sizeof(Node) + keyHeap(it->first.second) + it->second.capacity() * sizeof(size_t);
+            }
+            return estimate;
+        }
+
+        const size_t active = pkIndex_.size();
+        std::unordered_map<db::FieldType, size_t> frequencies;
+        size_t sampled = 0, sampledHeap = 0;
+        auto sample = [&](size_t i)
+        {
+            if (deleted_[i])
+                return;
+            auto [it, inserted] = frequencies.try_emplace(columnField(records_[i], columnID), 0);
+            ++it->second;
+            ++sampled;
+            if (inserted)
+                sampledHeap += keyHeap(it->first);
+        };
+        const bool exact = records_.size() <= sampleSize;
+        if (exact)
+            for (size_t i = 0; i < records_.size(); ++i)
+                sample(i);
+        else
+            for (uint64_t draw = 0; draw < sampleSize; ++draw)
+                sample(static_cast<size_t>(mixHash(draw + 1) % records_.size()));
+        if (sampled == 0)
+            return estimate;
+        size_t once = 0, twice = 0;
+        for (const auto &[key, count] : frequencies)
+        {
+            once += count == 1;
+            twice += count == 2;
+        }
+        const double unseen = exact ? 0.0 : double(once) * double(once - (once > 0)) / double(2 * (twice + 1));
+        estimate.keys = std::min(active, frequencies.size() + static_cast<size_t>(std::llround(unseen)));
+        estimate.postings = active;
+        // posting lists grow by doubling, about a third of the used size is slack on average
+        estimate.memoryBytes = estimate.keys * (kNodeOverhead + sizeof(Node) + sampledHeap / frequencies.size()) + active * sizeof(size_t) * 4 / 3;
+        return estimate;
+    }
+
+    /**
+     * Attach a query log - every findMatching() call is then timed and aggregated under tableName
+     */
+    void QBTable::setQueryLog(std::shared_ptr<db::QueryLog> queryLog, std::string tableName)
+    {
+        queryLog_ = std::move(queryLog);
+        queryLogTable_ = std::move(tableName);
+    }
+
+    /**
+     * Attach a change stream that receives every addRecord, delete and compaction from now on
+     */
+    void QBTable::setChangeStream(std::shared_ptr<db::QBChangeStream> changeStream)
+    {
+        changeStream_ = std::move(changeStream);
+    }
+
+    /**
+     * Attach a write-ahead log that records every mutation and index change from now on
+     */
+    void QBTable::setWriteAheadLog(std::shared_ptr<db::wal::LogWriter> wal)
+    {
+        wal_ = std::move(wal);
+    }
+
+    /**
+     * Evaluate a view over every active record, replacing whatever it held
+     */
+    void QBTable::populateView(db::QBMaterializedView &view) const
+    {
+        view.clear();
+        for (size_t i = 0; i < records_.size(); ++i)
+            if (!deleted_[i])
+                view.insert(i, records_[i]);
+    }
+
+    /**
+     * Attach a materialized view - a view belongs to one table at a time
+     */
+    void QBTable::addView(std::shared_ptr<db::QBMaterializedView> view)
+    {
+        populateView(*view);
+        views_.push_back(std::move(view));
+    }
+
+    bool QBTable::removeView(const std::shared_ptr<db::QBMaterializedView> &view)
+    {
+        auto it = std::find(views_.begin(), views_.end(), view);
+        if (it == views_.end())
+            return false;
+        views_.erase(it);
+        return true;
+    }
+
+    /**
+     * Describe the access path findMatching() takes for a query, with the rows it would examine
+     */
+    std::string QBTable::explain(db::ColumnType columnID, std::string_view matchString) const
+    {
+        const std::string column = "column" + std::to_string(static_cast<int>(columnID));
+        const std::string literal(matchString);
+
+        if (columnID == db::ColumnType::COLUMN0)
+        {
+            db::uint matchValue = 0;
+            auto convResult = std::from_chars(matchString.data(), matchString.data() + matchString.size(), matchValue);
+            if (convResult.ec != std::errc{} || convResult.ptr != matchString.data() + matchString.size())
+                return "NO ROWS: invalid primary key literal '" + literal + "'";
+            return "PRIMARY KEY LOOKUP on " + column + " = " + literal + " (examines " +
+                   std::to_string(pkIndex_.contains(matchValue) ? 1 : 0) + " row)";
+        }
+
+        if (auto uniqueIt = uniqueIndexes_.find(columnID); uniqueIt != uniqueIndexes_.end())
+        {
+            size_t rows = 0;
+            if (columnID == db::ColumnType::COLUMN2)
+            {
+                long val = 0;
+                auto convResult = std::from_chars(matchString.data(), matchString.data() + matchString.size(), val);
+                if (convResult.ec != std::errc{} || convResult.ptr != matchString.data() + matchString.size())
+                    return "NO ROWS: invalid numeric literal '" + literal + "'";
+                rows = uniqueIt->second.find(keyHash(val), [&](size_t idx)
+                                             { return records_[idx].column2 == val; }) != db::UniqueIndex::npos;
+            }
+            else
+                rows = uniqueIt->second.find(keyHash(matchString), [&](size_t idx)
+                                             { return (columnID == db::ColumnType::COLUMN1 ? records_[idx].column1 : records_[idx].column3) == matchString; }) != db::UniqueIndex::npos;
+            return "UNIQUE INDEX LOOKUP on " + column + " = " + literal + " (examines " + std::to_string(rows) + " row)";
+        }
+
+        if (secondaryIndexedColumns_.contains(columnID))
+        {
+            db::FieldType field = std::string(matchString);
+            if (columnID == db::ColumnType::COLUMN2)
+            {
+                long val = 0;
+                auto convResult = std::from_chars(matchString.data(), matchString.data() + matchString.size(), val);
+                if (convResult.ec != std::errc{} || convResult.ptr != matchString.data() + matchString.size())
+                    return "NO ROWS: invalid numeric literal '" + literal + "'";
+                field = val;
+            }
+            auto it = secondaryIndexes_.find({columnID, field});
+            size_t postings = (it == secondaryIndexes_.end()) ? 0 : it->second.size();
+            return "INDEX LOOKUP on " + column + " = " + literal + " (examines " + std::to_string(postings) + " postings)";
+        }
+
+        const char *predicate = (columnID == db::ColumnType::COLUMN2) ? " = " : " LIKE '%";
+        const char *suffix = (columnID == db::ColumnType::COLUMN2) ? "" : "%'";
+        return "LINEAR SCAN on " + column + predicate + literal + suffix + " (examines " + std::to_string(records_.size()) +
+               " rows, " + std::to_string(records_.size() - activeRecordsCount()) + " deleted)";
+    }
+
+    /**
+     * Describe the access path findMatchingAll() takes for a conjunction of conditions
+     */
+    std::string QBTable::explain(std::span<const db::ColumnMatch> conditions) const
+    {
+        std::vector<std::pair<db::ColumnType, db::FieldType>> parsed;
+        if (conditions.empty() || !parseConditions(conditions, parsed))
+            return "NO ROWS: no conditions or an invalid literal";
+        std::string where;
+        for (const auto &[columnID, value] : conditions)
+        {
+            if (!where.empty())
+                where += " AND ";
+            where += columnName(columnID);
+            where += " = ";
+            where += value;
+        }
+        auto valueOf = [&](db::ColumnType columnID) -> const db::FieldType *
+        {
+            for (const auto &[conditioned, value] : parsed)
+                if (conditioned == columnID)
+                    return &value;
+            return nullptr;
+        };
+
+        if (valueOf(db::ColumnType::COLUMN0))
+            return "PRIMARY KEY LOOKUP on column0 (examines at most 1 row) for " + where;
+        for (const auto &[columnID, index] : uniqueIndexes_)
+            if (valueOf(columnID))
+                return "UNIQUE INDEX LOOKUP on " + columnName(columnID) + " (examines at most 1 row) for " + where;
+
+        auto [composite, prefixLength] = db::longestCompositePrefix(compositeIndexes_, [&](db::ColumnType columnID)
+                                                                    { return valueOf(columnID) != nullptr; });
+        if (composite != compositeIndexes_.end())
+        {
+            db::CompositeIndex::Key prefix;
+            std::string columns;
+            for (size_t i = 0; i < composite->first.size(); ++i)
+            {
+                if (i)
+                    columns += ", ";
+                columns += columnName(composite->first[i]);
+                if (i < prefixLength)
+                    prefix.push_back(*valueOf(composite->first[i]));
+            }
+            size_t postings = 0;
+            composite->second.forEachPrefix(prefix, [&](const std::vector<size_t> &indices)
+                                            { postings += indices.size(); });
+            return "COMPOSITE INDEX LOOKUP on (" + columns + ") using " + std::to_string(prefixLength) + " of " +
+                   std::to_string(composite->first.size()) + " columns (examines " + std::to_string(postings) + " postings) for " + where;
+        }
+
+        std::string intersected;
+        size_t shortest = std::numeric_limits<size_t>::max();
+        for (const auto &[columnID, value] : parsed)
+        {
+            if (!secondaryIndexedColumns_.contains(columnID))
+                continue;
+            auto it = secondaryIndexes_.find({columnID, value});
+            shortest = std::min(shortest, it == secondaryIndexes_.end() ? size_t(0) : it->second.size());
+            if (!intersected.empty())
+                intersected += ", ";
+            intersected += columnName(columnID);
+        }
+        if (!intersected.empty())
+            return "INDEX INTERSECTION of " + intersected + " (examines " + std::to_string(shortest) + " postings of the shortest list) for " + where;
+        return "LINEAR SCAN (examines " + std::to_string(records_.size()) + " rows) for " + where;
+    }
+
+    /**
+     * Describe the access path findInRange() takes, with the rows it would examine
+     */
+    std::string QBTable::explainRange(long low, long high) const
+    {
+        const std::string where = "column2 BETWEEN " + std::to_string(low) + " AND " + std::to_string(high);
+        if (low > high)
+            return "NO ROWS: empty range " + where;
+        if (secondaryIndexedColumns_.contains(db::ColumnType::COLUMN2))
+        {
+            size_t keys = 0, postings = 0;
+            for (auto it = secondaryIndexes_.lower_bound({db::ColumnType::COLUMN2, db::FieldType{low}});
+                 it != secondaryIndexes_.end() && it->first.first == db::ColumnType::COLUMN2 && std::get<long>(it->first.second) <= high; ++it)
+            {
+                ++keys;
+                postings += it->second.size();
+            }
+            return "INDEX RANGE SCAN on " + where + " (examines " + std::to_string(postings) + " postings of " + std::to_string(keys) + " keys)";
+        }
+        if (adaptiveIndexing_ && cracker_.built())
+            return "ADAPTIVE INDEX on " + where + " (examines at most " + std::to_string(cracker_.candidates(low, high)) + " of " +
+                   std::to_string(cracker_.size()) + " rows in " + std::to_string(cracker_.pieceCount()) + " pieces)";
+        if (adaptiveIndexing_)
+            return "ADAPTIVE INDEX on " + where + " (copies " + std::to_string(records_.size()) + " rows, then cracks them)";
+        return "LINEAR SCAN on " + where + " (examines " + std::to_string(records_.size()) + " rows, " +
+               std::to_string(records_.size() - activeRecordsCount()) + " deleted)";
+    }
+
+    /**
+     * Describe the work searchText() does for a query - the postings of its terms bound what it decodes
+     */
+    std::string QBTable::explainText(std::string_view query) const
+    {
+        const std::string where = "column3 MATCH '" + std::string(query) + "'";
+        if (!fullText_)
+            return "NO INDEX: searchText() needs a full-text index for " + where;
+        size_t terms = 0, postings = 0;
+        auto tokens = fullText_->tokenizer().tokenize(query);
+        std::sort(tokens.begin(), tokens.end());
+        tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+        for (const auto &token : tokens)
+            if (const size_t frequency = fullText_->documentFrequency(token))
+            {
+                ++terms;
+                postings += frequency;
+            }
+        return "FULL TEXT SEARCH on " + where + " (" + std::to_string(terms) + " of " + std::to_string(tokens.size()) +
+               " terms indexed, examines at most " + std::to_string(postings) + " postings of " +
+               std::to_string(fullText_->documentCount()) + " documents)";
+    }
+
     /**
      * Compact the collection by removing deleted records
      * Rebuilds primary and secondary indexes with new positions
      */
     void QBTable::compactRecords()
     {
+        QB_TRACE_SPAN("QBTable::compactRecords", records_.size());
         // count active records
         size_t activeCount = activeRecordsCount();
         std::vector<QBRecord> compacted;
         // only allocate what's needed for active records
         compacted.reserve(activeCount);
 
-        // move only active records
+        // move only active records, noting the ones that change position for change data capture
+        std::vector<db::RecordMove> moves;
+        std::vector<db::TtlClock::rep> compactedExpiry;
+        compactedExpiry.reserve(expiresAt_.empty() ? 0 : activeCount);
+        std::vector<size_t> newRows(cracker_.built() ? records_.size() : 0, db::CrackerColumn::npos);
         size_t i = 0;
         std::for_each(records_.begin(), records_.end(), [&](QBRecord &rec)
                       { 
                         if (!deleted_[i])
-                        compacted.push_back(std::move(rec));
+                        {
+                            if ((changeStream_ || !views_.empty()) && compacted.size() != i)
+                                moves.push_back({i, compacted.size()});
+                            if (!newRows.empty())
+                                newRows[i] = compacted.size();
+                            compacted.push_back(std::move(rec));
+                            if (!expiresAt_.empty())
+                                compactedExpiry.push_back(expiresAt_[i]);
+                        }
                         ++i; });
 
         records_ = std::move(compacted);
         deleted_.assign(records_.size(), false); // reset deleted flags
+        if (!expiresAt_.empty())
+            expiresAt_ = std::move(compactedExpiry);
 
         // rebuild all indexes from scratch
+        QB_TRACE_SPAN("QBTable::compactRecords index rebuild", records_.size());
         rebuildPrimaryKeyIndex();
         secondaryIndexes_.clear();
         for (const db::ColumnType colID : secondaryIndexedColumns_)
             rebuildSecondaryIndexForColumn(colID);
+        rebuildUniqueIndexes();
+        rebuildCompositeIndexes();
+        rebuildFullTextIndex();
+        if (cracker_.built())
+            cracker_.remapRows(newRows);
+
+        // soft deleted records already left the views - moves are in ascending order, so every target is vacant
+        for (const auto &view : views_)
+            for (const auto &move : moves)
+                view->move(move.from, move.to);
+        if (changeStream_)
+            changeStream_->publish(db::ChangeType::Compaction, 0, 0, nullptr, std::move(moves));
+        if (wal_)
+            wal_->appendCompaction();
+    }
+
+    /**
+     * Current time for expiry checks - the clock is only read once a record has a deadline
+     */
+    db::TtlClock::rep QBTable::expiryNow() const noexcept
+    {
+        return expiresAt_.empty() ? 0 : db::TtlClock::now().time_since_epoch().count();
+    }
+
+    bool QBTable::expired(size_t recordIdx, db::TtlClock::rep now) const noexcept
+    {
+        return !expiresAt_.empty() && expiresAt_[recordIdx] <= now;
+    }
+
+    /**
+     * Give an active record a deadline, replacing any earlier one
+     * The first deadline set on a table allocates the per record deadlines; from then on every query checks them
+     */
+    bool QBTable::expireRecordAt(db::uint id, db::TtlClock::time_point deadline)
+    {
+        auto pkIt = pkIndex_.find(id);
+        if (pkIt == pkIndex_.end() || expired(pkIt->second, expiryNow()))
+            return false;
+        if (expiresAt_.empty())
+            expiresAt_.assign(records_.size(), std::numeric_limits<db::TtlClock::rep>::max());
+        expiresAt_[pkIt->second] = deadline.time_since_epoch().count();
+        expiryWheel_.schedule(id, deadline);
+        return true;
+    }
+
+    bool QBTable::expireRecordAfter(db::uint id, db::TtlClock::duration ttl)
+    {
+        return expireRecordAt(id, db::TtlClock::now() + ttl);
+    }
+
+    /**
+     * Make a record permanent again - its wheel entry stays and is skipped when it comes due
+     */
+    bool QBTable::clearRecordExpiry(db::uint id)
+    {
+        auto pkIt = pkIndex_.find(id);
+        if (pkIt == pkIndex_.end() || expired(pkIt->second, expiryNow()))
+            return false;
+        if (!expiresAt_.empty())
+            expiresAt_[pkIt->second] = std::numeric_limits<db::TtlClock::rep>::max();
+        return true;
+    }
+
+    /**
+     * Soft delete records whose deadline has passed
+     * The wheel hands out at most budget due entries per call, so a burst of deadlines is spread over several
+     * calls instead of one long pause. An entry is acted on only if its record is still active and still has a
+     * passed deadline - deleted, rescheduled and cleared records are skipped. The records found are removed
+     * from the secondary indexes in a single pass.
+     */
+    size_t QBTable::expireRecords(size_t budget)
+    {
+        if (expiresAt_.empty())
+            return 0;
+        QB_TRACE_SPAN("QBTable::expireRecords", expiryWheel_.size());
+        const auto now = db::TtlClock::now();
+        expiryWheel_.advance(now);
+        std::vector<size_t> recordIdxs;
+        expiryWheel_.drain(budget, [&](db::uint id)
+                           {
+                               auto it = pkIndex_.find(id);
+                               if (it != pkIndex_.end() && expired(it->second, now.time_since_epoch().count()))
+                                   recordIdxs.push_back(it->second); });
+        softDeleteRecords(recordIdxs);
+        return recordIdxs.size();
+    }
+
+    size_t QBTable::pendingExpiries() const noexcept
+    {
+        return expiryWheel_.size();
+    }
+
+    /**
+     * Soft delete a batch of active records - the same change stream, log and view events as deleteRecordByID(),
+     * with one pass over the secondary indexes for the whole batch
+     */
+    void QBTable::softDeleteRecords(std::vector<size_t> &recordIdxs)
+    {
+        std::sort(recordIdxs.begin(), recordIdxs.end());
+        recordIdxs.erase(std::unique(recordIdxs.begin(), recordIdxs.end()), recordIdxs.end());
+        if (recordIdxs.empty())
+            return;
+        for (size_t recordIdx : recordIdxs)
+        {
+            const db::uint id = records_[recordIdx].column0;
+            deleted_[recordIdx] = true;
+            pkIndex_.erase(id);
+            removeUniqueEntries(recordIdx);
+            removeCompositeEntries(recordIdx);
+            if (fullText_)
+                fullText_->remove(recordIdx, records_[recordIdx].column3);
+            ++mutations_;
+            if (changeStream_)
+                changeStream_->publish(db::ChangeType::SoftDelete, id, recordIdx);
+            if (wal_)
+                wal_->appendDelete(id, false);
+            for (const auto &view : views_)
+                view->erase(recordIdx);
+        }
+
+        QB_TRACE_SPAN("QBTable::softDeleteRecords index scan", secondaryIndexes_.size());
+        for (auto it = secondaryIndexes_.begin(); it != secondaryIndexes_.end();)
+        {
+            auto &indices = it->second;
+            indices.erase(std::remove_if(indices.begin(), indices.end(), [&](size_t idx)
+                                         { return std::binary_search(recordIdxs.begin(), recordIdxs.end(), idx); }),
+                          indices.end());
+            if (indices.empty())
+                it = secondaryIndexes_.erase(it);
+            else
+                ++it;
+        }
     }
 }
\ No newline at end of file
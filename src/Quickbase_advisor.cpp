@@ -0,0 +1,160 @@
+#include "../include/Quickbase_advisor.hpp"
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+
+// Quickbase index advisor definitions
+namespace db
+{
+    namespace
+    {
+        constexpr db::ColumnType kCandidates[] = {db::ColumnType::COLUMN1, db::ColumnType::COLUMN2, db::ColumnType::COLUMN3};
+
+        // counters restart when an index is created or dropped and on resetStats()
+        uint64_t delta(uint64_t after, uint64_t before) noexcept
+        {
+            return after >= before ? after - before : after;
+        }
+
+        std::string describe(double benefit, double cost, size_t memoryBytes)
+        {
+            std::ostringstream text;
+            text << std::fixed << std::setprecision(0) << "saves " << benefit << " rows, costs " << cost << " rows, "
+                 << std::setprecision(2) << double(memoryBytes) / double(1 << 20) << " MiB";
+            return text.str();
+        }
+    }
+
+    IndexAdvisor::IndexAdvisor(db::QBTable &table, db::IndexAdvisorOptions options, std::shared_ptr<db::QueryLog> queryLog, std::string tableName)
+        : table_(table), options_(options), queryLog_(std::move(queryLog)), tableName_(std::move(tableName)), last_(table.stats())
+    {
+    }
+
+    /**
+     * Fold the workload since the last window into the decayed averages
+     * A column's equality lookups are the scans on it while unindexed and the hits of its index otherwise
+     */
+    void IndexAdvisor::observe()
+    {
+        const db::QBTableStats now = table_.stats();
+        for (db::ColumnType columnID : kCandidates)
+        {
+            uint64_t lookups = 0;
+            if (table_.isColumnIndexed(columnID))
+            {
+                auto hits = [&](const db::QBTableStats &stats) -> uint64_t
+                {
+                    auto it = stats.indexes.find(columnID);
+                    return it != stats.indexes.end() ? it->second.hits : 0;
+                };
+                lookups = delta(hits(now), hits(last_));
+            }
+            else
+            {
+                auto scans = [&](const db::QBTableStats &stats) -> uint64_t
+                {
+                    auto it = stats.columns.find(columnID);
+                    return it != stats.columns.end() ? it->second.linearScans : 0;
+                };
+                lookups = delta(scans(now), scans(last_));
+            }
+            double &smoothed = lookups_[static_cast<size_t>(columnID)];
+            smoothed = options_.decay * smoothed + (1 - options_.decay) * double(lookups);
+        }
+        mutations_ = options_.decay * mutations_ + (1 - options_.decay) * double(delta(now.mutations, last_.mutations));
+        last_ = now;
+
+        if (!queryLog_)
+            return;
+        for (const auto &shape : queryLog_->shapes())
+        {
+            if (shape.shape.table != tableName_ || shape.calls == 0)
+                continue;
+            // findMatchingAll() shapes list their columns separated by commas
+            std::istringstream columns(shape.shape.column);
+            for (std::string column; std::getline(columns, column, ',');)
+            {
+                for (db::ColumnType columnID : kCandidates)
+                {
+                    if (column != "column" + std::to_string(static_cast<int>(columnID)))
+                        continue;
+                    if (shape.shape.mode == db::MatchMode::Substring)
+                        substring_[static_cast<size_t>(columnID)] = true;
+                    else if (shape.shape.mode == db::MatchMode::Exact)
+                        equality_[static_cast<size_t>(columnID)] = true;
+                }
+            }
+        }
+    }
+
+    /**
+     * Judge every non-key column: indexes are granted greedily by net benefit per byte until the budget is spent
+     * Only columns with an index or an index worth creating are reported
+     */
+    std::vector<db::IndexRecommendation> IndexAdvisor::recommend()
+    {
+        observe();
+        struct Candidate
+        {
+            db::IndexRecommendation verdict;
+            bool exists;
+            const char *blocked; // why the index may not be created, nullptr when it may
+        };
+        const double active = double(table_.activeRecordsCount());
+        std::vector<Candidate> candidates;
+        for (db::ColumnType columnID : kCandidates)
+        {
+            const db::IndexEstimate estimate = table_.estimateIndex(columnID, options_.sampleSize);
+            if (estimate.unique)
+                continue;
+            const double perKey = estimate.keys ? double(estimate.postings) / double(estimate.keys) : 0.0;
+            Candidate candidate{{columnID, db::IndexAdvice::Keep, lookups_[static_cast<size_t>(columnID)] * std::max(0.0, active - perKey),
+                                 mutations_ * options_.writeCostRows, estimate.memoryBytes, {}},
+                                estimate.exists, nullptr};
+            if (columnID != db::ColumnType::COLUMN2 && !estimate.exists)
+            {
+                if (substring_[static_cast<size_t>(columnID)])
+                    candidate.blocked = "substring queries would turn into exact matches";
+                else if (!equality_[static_cast<size_t>(columnID)])
+                    candidate.blocked = "no equality queries on the string column in the query log";
+            }
+            candidates.push_back(std::move(candidate));
+        }
+        std::sort(candidates.begin(), candidates.end(), [](const Candidate &a, const Candidate &b)
+                  { return (a.verdict.benefitRows - a.verdict.costRows) / double(std::max<size_t>(a.verdict.memoryBytes, 1)) >
+                           (b.verdict.benefitRows - b.verdict.costRows) / double(std::max<size_t>(b.verdict.memoryBytes, 1)); });
+
+        std::vector<db::IndexRecommendation> recommendations;
+        size_t remaining = options_.memoryBudget;
+        for (auto &[verdict, exists, blocked] : candidates)
+        {
+            const double net = verdict.benefitRows - verdict.costRows;
+            verdict.reason = describe(verdict.benefitRows, verdict.costRows, verdict.memoryBytes);
+            bool wanted = !blocked && net >= (exists ? 0.0 : options_.minBenefitRows);
+            if (wanted && verdict.memoryBytes > remaining)
+            {
+                wanted = false;
+                verdict.reason += ", over the memory budget";
+            }
+            if (wanted)
+                remaining -= verdict.memoryBytes;
+            else if (!exists)
+                continue;
+            verdict.advice = !wanted ? db::IndexAdvice::Drop : exists ? db::IndexAdvice::Keep : db::IndexAdvice::Create;
+            recommendations.push_back(std::move(verdict));
+        }
+        return recommendations;
+    }
+
+    std::vector<db::IndexRecommendation> IndexAdvisor::apply()
+    {
+        auto recommendations = recommend();
+        for (const auto &recommendation : recommendations)
+            if (recommendation.advice == db::IndexAdvice::Drop)
+                table_.dropIndex(recommendation.column);
+        for (const auto &recommendation : recommendations)
+            if (recommendation.advice == db::IndexAdvice::Create)
+                table_.createIndex(recommendation.column);
+        return recommendations;
+    }
+}
@@ -0,0 +1,468 @@
+#include "../include/Quickbase_bench.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+// build environment injected by CMake, see CMakeLists.txt
+#ifndef QB_BUILD_FLAGS
+#define QB_BUILD_FLAGS "unknown"
+#endif
+#ifndef QB_BUILD_TYPE
+#define QB_BUILD_TYPE "unknown"
+#endif
+#ifndef QB_GIT_COMMIT
+#define QB_GIT_COMMIT "unknown"
+#endif
+
+// Quickbase benchmark reporting definitions
+namespace db::bench
+{
+    namespace
+    {
+        /**
+         * Two-sided 95% critical value of Student's t distribution
+         * Exact table for small degrees of freedom, normal approximation above 30
+         */
+        double tCritical95(double dof)
+        {
+            static const double table[] = {12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+                                           2.201, 2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086,
+                                           2.080, 2.074, 2.069, 2.064, 2.060, 2.056, 2.052, 2.048, 2.045, 2.042};
+            if (dof < 1)
+                return table[0];
+            if (dof > 30)
+                return 1.960;
+            return table[static_cast<size_t>(dof) - 1];
+        }
+
+        std::string escapeJson(const std::string &value)
+        {
+            std::string escaped;
+            for (char c : value)
+            {
+                switch (c)
+                {
+                case '"':
+                    escaped += "\\\"";
+                    break;
+                case '\\':
+                    escaped += "\\\\";
+                    break;
+                case '\n':
+                    escaped += "\\n";
+                    break;
+                case '\t':
+                    escaped += "\\t";
+                    break;
+                default:
+                    if (static_cast<unsigned char>(c) >= 0x20)
+                        escaped += c;
+                }
+            }
+            return escaped;
+        }
+
+        std::string escapeCsv(const std::string &value)
+        {
+            if (value.find_first_of(",\"\n") == std::string::npos)
+                return value;
+            std::string escaped = "\"";
+            for (char c : value)
+            {
+                if (c == '"')
+                    escaped += '"';
+                escaped += c;
+            }
+            return escaped + "\"";
+        }
+
+        std::string cpuModel()
+        {
+#if defined(__linux__)
+            std::ifstream cpuinfo("/proc/cpuinfo");
+            std::string line;
+            while (std::getline(cpuinfo, line))
+            {
+                if (line.rfind("model name", 0) == 0)
+                {
+                    auto pos = line.find(':');
+                    if (pos != std::string::npos)
+                        return line.substr(line.find_first_not_of(' ', pos + 1));
+                }
+            }
+#endif
+            return "unknown";
+        }
+
+        // ========== minimal JSON reader for documents produced by writeJson ==========
+
+        struct JsonValue
+        {
+            enum class Kind
+            {
+                Null,
+                Bool,
+                Number,
+                String,
+                Array,
+                Object
+            } kind = Kind::Null;
+            double number = 0;
+            std::string text;
+            std::vector<JsonValue> items;
+            std::map<std::string, JsonValue> members;
+
+            const JsonValue &at(const std::string &key) const
+            {
+                auto it = members.find(key);
+                if (kind != Kind::Object || it == members.end())
+                    throw std::runtime_error("Benchmark JSON: missing key " + key);
+                return it->second;
+            }
+            std::string str(const std::string &key) const
+            {
+                auto it = members.find(key);
+                return (it != members.end() && it->second.kind == Kind::String) ? it->second.text : std::string{};
+            }
+            double num(const std::string &key) const
+            {
+                auto it = members.find(key);
+                return (it != members.end() && it->second.kind == Kind::Number) ? it->second.number : 0.0;
+            }
+        };
+
+        class JsonParser
+        {
+        public:
+            explicit JsonParser(std::string text) : text_(std::move(text)) {}
+
+            JsonValue parse()
+            {
+                JsonValue value = parseValue();
+                skipWhitespace();
+                if (pos_ != text_.size())
+                    fail("trailing characters");
+                return value;
+            }
+
+        private:
+            std::string text_;
+            size_t pos_ = 0;
+
+            [[noreturn]] void fail(const std::string &what) const
+            {
+                throw std::runtime_error("Benchmark JSON: " + what + " at offset " + std::to_string(pos_));
+            }
+            void skipWhitespace()
+            {
+                while (pos_ < text_.size() && std::isspace(static_cast<unsigned char>(text_[pos_])))
+                    ++pos_;
+            }
+            bool consume(char c)
+            {
+                skipWhitespace();
+                if (pos_ < text_.size() && text_[pos_] == c)
+                {
+                    ++pos_;
+                    return true;
+                }
+                return false;
+            }
+            void expect(char c)
+            {
+                if (!consume(c))
+                    fail(std::string("expected '") + c + "'");
+            }
+            std::string parseString()
+            {
+                expect('"');
+                std::string out;
+                while (pos_ < text_.size() && text_[pos_] != '"')
+                {
+                    char c = text_[pos_++];
+                    if (c == '\\' && pos_ < text_.size())
+                    {
+                        char e = text_[pos_++];
+                        out += (e == 'n') ? '\n' : (e == 't') ? '\t' : e;
+                    }
+                    else
+                        out += c;
+                }
+                expect('"');
+                return out;
+            }
+            JsonValue parseValue()
+            {
+                skipWhitespace();
+                if (pos_ >= text_.size())
+                    fail("unexpected end of input");
+                JsonValue value;
+                char c = text_[pos_];
+                if (c == '{')
+                {
+                    ++pos_;
+                    value.kind = JsonValue::Kind::Object;
+                    if (consume('}'))
+                        return value;
+                    do
+                    {
+                        skipWhitespace();
+                        std::string key = parseString();
+                        expect(':');
+                        value.members[key] = parseValue();
+                    } while (consume(','));
+                    expect('}');
+                }
+                else if (c == '[')
+                {
+                    ++pos_;
+                    value.kind = JsonValue::Kind::Array;
+                    if (consume(']'))
+                        return value;
+                    do
+                        value.items.push_back(parseValue());
+                    while (consume(','));
+                    expect(']');
+                }
+                else if (c == '"')
+                {
+                    value.kind = JsonValue::Kind::String;
+                    value.text = parseString();
+                }
+                else if (text_.compare(pos_, 4, "true") == 0 || text_.compare(pos_, 5, "false") == 0)
+                {
+                    value.kind = JsonValue::Kind::Bool;
+                    value.number = (c == 't') ? 1 : 0;
+                    pos_ += (c == 't') ? 4 : 5;
+                }
+                else if (text_.compare(pos_, 4, "null") == 0)
+                {
+                    pos_ += 4;
+                }
+                else
+                {
+                    char *end = nullptr;
+                    value.kind = JsonValue::Kind::Number;
+                    value.number = std::strtod(text_.c_str() + pos_, &end);
+                    if (end == text_.c_str() + pos_)
+                        fail("invalid value");
+                    pos_ = static_cast<size_t>(end - text_.c_str());
+                }
+                return value;
+            }
+        };
+    }
+
+    /**
+     * Compute mean, sample standard deviation and 95% confidence interval of the mean
+     */
+    Summary summarize(const std::vector<double> &samples)
+    {
+        Summary s;
+        s.count = samples.size();
+        if (samples.empty())
+            return s;
+
+        double sum = 0;
+        for (double v : samples)
+            sum += v;
+        s.mean = sum / double(s.count);
+        s.min = *std::min_element(samples.begin(), samples.end());
+        s.max = *std::max_element(samples.begin(), samples.end());
+
+        if (s.count > 1)
+        {
+            double sq = 0;
+            for (double v : samples)
+                sq += (v - s.mean) * (v - s.mean);
+            s.stddev = std::sqrt(sq / double(s.count - 1));
+            s.ci95 = tCritical95(double(s.count - 1)) * s.stddev / std::sqrt(double(s.count));
+        }
+        return s;
+    }
+
+    /**
+     * Collect compiler, build flags, CPU and commit of the running binary
+     */
+    RunMetadata collectMetadata()
+    {
+        RunMetadata meta;
+#if defined(__clang__)
+        meta.compiler = "Clang " __clang_version__;
+#elif defined(__GNUC__)
+        meta.compiler = "GCC " __VERSION__;
+#elif defined(_MSC_VER)
+        meta.compiler = "MSVC " + std::to_string(_MSC_VER);
+#else
+        meta.compiler = "unknown";
+#endif
+        meta.flags = QB_BUILD_FLAGS;
+        meta.buildType = QB_BUILD_TYPE;
+        meta.commit = QB_GIT_COMMIT;
+        meta.cpu = cpuModel();
+        meta.hardwareThreads = std::thread::hardware_concurrency();
+
+        std::time_t now = std::chrono::system_clock::to_time_t(std::chrono::system_clock::now());
+        char buffer[32] = {};
+        if (std::tm *utc = std::gmtime(&now))
+            std::strftime(buffer, sizeof(buffer), "%Y-%m-%dT%H:%M:%SZ", utc);
+        meta.timestamp = buffer;
+        return meta;
+    }
+
+    /**
+     * Write a run as a single JSON document - metadata plus per-case samples and summary
+     */
+    void writeJson(std::ostream &out, const RunMetadata &meta, const std::vector<BenchmarkStats> &results)
+    {
+        out << std::setprecision(6) << std::fixed;
+        out << "{\n  \"metadata\": {\n"
+            << "    \"compiler\": \"" << escapeJson(meta.compiler) << "\",\n"
+            << "    \"flags\": \"" << escapeJson(meta.flags) << "\",\n"
+            << "    \"build_type\": \"" << escapeJson(meta.buildType) << "\",\n"
+            << "    \"cpu\": \"" << escapeJson(meta.cpu) << "\",\n"
+            << "    \"hardware_threads\": " << meta.hardwareThreads << ",\n"
+            << "    \"commit\": \"" << escapeJson(meta.commit) << "\",\n"
+            << "    \"timestamp\": \"" << escapeJson(meta.timestamp) << "\",\n"
+            << "    \"data_size\": " << meta.dataSize << ",\n"
+            << "    \"iterations\": " << meta.iterations << ",\n"
+            << "    \"trials\": " << meta.trials << "\n"
+            << "  },\n  \"results\": [";
+
+        for (size_t i = 0; i < results.size(); ++i)
+        {
+            const auto &r = results[i];
+            Summary s = summarize(r.samplesMs);
+            out << (i ? "," : "") << "\n    {\"test\": \"" << escapeJson(r.test) << "\", \"name\": \"" << escapeJson(r.name) << "\""
+                << ", \"mean_ms\": " << s.mean << ", \"stddev_ms\": " << s.stddev << ", \"ci95_ms\": " << s.ci95
+                << ", \"min_ms\": " << s.min << ", \"max_ms\": " << s.max << ", \"samples_ms\": [";
+            for (size_t j = 0; j < r.samplesMs.size(); ++j)
+                out << (j ? ", " : "") << r.samplesMs[j];
+            out << "]}";
+        }
+        out << "\n  ]\n}\n";
+    }
+
+    /**
+     * Write a run as CSV - one row per case, metadata repeated on each row so rows can be concatenated across runs
+     */
+    void writeCsv(std::ostream &out, const RunMetadata &meta, const std::vector<BenchmarkStats> &results)
+    {
+        out << "test,name,trials,mean_ms,stddev_ms,ci95_ms,min_ms,max_ms,compiler,flags,build_type,cpu,commit,timestamp\n";
+        out << std::setprecision(6) << std::fixed;
+        for (const auto &r : results)
+        {
+            Summary s = summarize(r.samplesMs);
+            out << escapeCsv(r.test) << ',' << escapeCsv(r.name) << ',' << s.count << ','
+                << s.mean << ',' << s.stddev << ',' << s.ci95 << ',' << s.min << ',' << s.max << ','
+                << escapeCsv(meta.compiler) << ',' << escapeCsv(meta.flags) << ',' << escapeCsv(meta.buildType) << ','
+                << escapeCsv(meta.cpu) << ',' << escapeCsv(meta.commit) << ',' << escapeCsv(meta.timestamp) << '\n';
+        }
+    }
+
+    /**
+     * Read back a run written by writeJson
+     */
+    std::vector<BenchmarkStats> readJson(std::istream &in, RunMetadata *meta)
+    {
+        std::stringstream buffer;
+        buffer << in.rdbuf();
+        JsonValue doc = JsonParser(buffer.str()).parse();
+
+        if (meta)
+        {
+            const JsonValue &m = doc.at("metadata");
+            meta->compiler = m.str("compiler");
+            meta->flags = m.str("flags");
+            meta->buildType = m.str("build_type");
+            meta->cpu = m.str("cpu");
+            meta->commit = m.str("commit");
+            meta->timestamp = m.str("timestamp");
+            meta->hardwareThreads = static_cast<unsigned>(m.num("hardware_threads"));
+            meta->dataSize = static_cast<size_t>(m.num("data_size"));
+            meta->iterations = static_cast<size_t>(m.num("iterations"));
+            meta->trials = static_cast<size_t>(m.num("trials"));
+        }
+
+        std::vector<BenchmarkStats> results;
+        for (const JsonValue &item : doc.at("results").items)
+        {
+            BenchmarkStats stats{item.str("test"), item.str("name"), {}};
+            for (const JsonValue &sample : item.at("samples_ms").items)
+                stats.samplesMs.push_back(sample.number);
+            results.push_back(std::move(stats));
+        }
+        return results;
+    }
+
+    /**
+     * Match cases by (test, name) and flag significant slowdowns
+     * A case regresses when its mean is slower by more than thresholdPct and a Welch t-test
+     * rejects equal means at 95% confidence - with a single trial only the threshold applies
+     */
+    std::vector<Comparison> compareRuns(const std::vector<BenchmarkStats> &baseline,
+                                        const std::vector<BenchmarkStats> &current,
+                                        double thresholdPct)
+    {
+        std::vector<Comparison> comparisons;
+        for (const auto &cur : current)
+        {
+            auto base = std::find_if(baseline.begin(), baseline.end(), [&](const BenchmarkStats &b)
+                                     { return b.test == cur.test && b.name == cur.name; });
+            if (base == baseline.end())
+                continue;
+
+            Comparison c{cur.test, cur.name, summarize(base->samplesMs), summarize(cur.samplesMs), 0, false, false};
+            if (c.baseline.mean > 0)
+                c.changePct = (c.current.mean - c.baseline.mean) / c.baseline.mean * 100.0;
+
+            if (c.baseline.count > 1 && c.current.count > 1)
+            {
+                double vb = c.baseline.stddev * c.baseline.stddev / double(c.baseline.count);
+                double vc = c.current.stddev * c.current.stddev / double(c.current.count);
+                double se = std::sqrt(vb + vc);
+                if (se == 0)
+                    c.significant = c.current.mean != c.baseline.mean;
+                else
+                {
+                    // Welch-Satterthwaite degrees of freedom
+                    double dof = (vb + vc) * (vb + vc) /
+                                 (vb * vb / double(c.baseline.count - 1) + vc * vc / double(c.current.count - 1));
+                    c.significant = std::fabs(c.current.mean - c.baseline.mean) / se > tCritical95(dof);
+                }
+            }
+            else
+                c.significant = true;
+
+            c.regression = c.significant && c.changePct > thresholdPct;
+            comparisons.push_back(c);
+        }
+        return comparisons;
+    }
+
+    /**
+     * Print a comparison table in the benchmark's text style
+     */
+    void printComparison(std::ostream &out, const std::vector<Comparison> &comparisons, double thresholdPct)
+    {
+        out << "BENCHMARK COMPARISON (regression threshold: " << std::fixed << std::setprecision(1) << thresholdPct << "%)" << std::endl;
+        out << "-" << std::string(76, '-') << std::endl;
+        for (const auto &c : comparisons)
+        {
+            out << "  " << std::left << std::setw(10) << c.test << std::setw(22) << c.name
+                << std::right << std::setprecision(3)
+                << std::setw(10) << c.baseline.mean << " -> " << std::setw(10) << c.current.mean << " ms"
+                << std::setw(9) << std::setprecision(1) << std::showpos << c.changePct << "%" << std::noshowpos
+                << (c.regression ? "  REGRESSION" : c.significant ? "  significant" : "  ~noise") << std::endl;
+        }
+    }
+}
@@ -0,0 +1,528 @@
+#include "../include/Quickbase_c.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+#include "../include/Quickbase.hpp"
+#include "../include/Quickbase_dynamic.hpp"
+
+// Quickbase C API definitions - no C++ exception may cross these functions
+struct qb_table
+{
+    std::variant<db::QBTable, db::QBTableDynamic> table;
+};
+
+namespace
+{
+    thread_local std::string lastError;
+
+    qb_status failure(qb_status status, std::string message)
+    {
+        lastError = std::move(message);
+        return status;
+    }
+
+    template <typename Operation>
+    qb_status guarded(Operation &&operation) noexcept
+    {
+        try
+        {
+            return operation();
+        }
+        catch (const std::exception &e)
+        {
+            return failure(QB_ERROR, e.what());
+        }
+        catch (...)
+        {
+            return failure(QB_ERROR, "Unknown error");
+        }
+    }
+
+    std::string toString(const char *data, size_t length)
+    {
+        return data ? std::string(data, length) : std::string{};
+    }
+
+    db::FieldType toField(const qb_value &value)
+    {
+        switch (value.type)
+        {
+        case QB_FIELD_UINT:
+            return db::uint{value.as.u};
+        case QB_FIELD_LONG:
+            return static_cast<long>(value.as.l);
+        case QB_FIELD_STRING:
+            return toString(value.as.s.data, value.as.s.length);
+        }
+        throw std::invalid_argument("Unknown field type");
+    }
+
+    // ColumnBuilder - accumulates one result column in its final columnar layout
+    // Dynamic columns take the type of their first value, missing values before it are back-filled
+    struct ColumnBuilder
+    {
+        std::string name;
+        qb_field_type type = QB_FIELD_STRING;
+        bool typed = false;
+        size_t pendingMissing = 0;
+        bool hasMissing = false;
+
+        std::vector<uint32_t> uints;
+        std::vector<int64_t> longs;
+        std::string bytes;
+        std::vector<uint64_t> offsets{0};
+        std::vector<uint8_t> validity;
+
+        explicit ColumnBuilder(std::string columnName) : name(std::move(columnName)) {}
+        ColumnBuilder(std::string columnName, qb_field_type columnType) : name(std::move(columnName)), type(columnType), typed(true) {}
+
+        void appendDefault()
+        {
+            if (type == QB_FIELD_UINT)
+                uints.push_back(0);
+            else if (type == QB_FIELD_LONG)
+                longs.push_back(0);
+            else
+                offsets.push_back(bytes.size());
+        }
+
+        void appendMissing()
+        {
+            hasMissing = true;
+            if (!typed)
+            {
+                ++pendingMissing;
+                return;
+            }
+            appendDefault();
+            validity.push_back(0);
+        }
+
+        void setType(qb_field_type columnType)
+        {
+            type = columnType;
+            typed = true;
+            for (; pendingMissing > 0; --pendingMissing)
+            {
+                appendDefault();
+                validity.push_back(0);
+            }
+        }
+
+        void append(db::uint value)
+        {
+            uints.push_back(value);
+            validity.push_back(1);
+        }
+
+        void append(long value)
+        {
+            longs.push_back(value);
+            validity.push_back(1);
+        }
+
+        void append(std::string_view value)
+        {
+            bytes.append(value);
+            offsets.push_back(bytes.size());
+            validity.push_back(1);
+        }
+
+        void append(const db::FieldType &value)
+        {
+            const auto valueType = static_cast<qb_field_type>(value.index());
+            if (!typed)
+                setType(valueType);
+            if (valueType != type)
+                return appendMissing();
+            std::visit([this](const auto &v)
+                       { append(v); },
+                       value);
+        }
+
+        void append(const std::string &value)
+        {
+            append(std::string_view(value));
+        }
+
+        qb_column view() const
+        {
+            qb_column column{};
+            column.name = name.c_str();
+            column.type = type;
+            if (type == QB_FIELD_UINT)
+                column.values = uints.data();
+            else if (type == QB_FIELD_LONG)
+                column.values = longs.data();
+            else
+            {
+                column.values = bytes.data();
+                column.offsets = offsets.data();
+            }
+            column.validity = hasMissing ? validity.data() : nullptr;
+            return column;
+        }
+    };
+
+    qb_status notStatic()
+    {
+        return failure(QB_INVALID_ARGUMENT, "Operation needs a QBTable handle");
+    }
+
+    qb_status notDynamic()
+    {
+        return failure(QB_INVALID_ARGUMENT, "Operation needs a QBTableDynamic handle");
+    }
+
+    bool validColumn(int column)
+    {
+        return column >= 0 && column <= 3;
+    }
+}
+
+struct qb_result
+{
+    size_t rows = 0;
+    std::vector<ColumnBuilder> builders;
+    std::vector<qb_column> columns;
+
+    // publish the column views once the builders stop growing
+    void finish()
+    {
+        for (auto &builder : builders)
+        {
+            for (; builder.pendingMissing > 0; --builder.pendingMissing)
+            {
+                builder.appendDefault();
+                builder.validity.push_back(0);
+            }
+            columns.push_back(builder.view());
+        }
+    }
+};
+
+extern "C"
+{
+    int qb_abi_version(void)
+    {
+        return QB_C_ABI_VERSION;
+    }
+
+    const char *qb_last_error(void)
+    {
+        return lastError.c_str();
+    }
+
+    qb_table *qb_table_create(void)
+    {
+        try
+        {
+            return new qb_table{db::QBTable{}};
+        }
+        catch (const std::exception &e)
+        {
+            failure(QB_ERROR, e.what());
+            return nullptr;
+        }
+    }
+
+    qb_table *qb_table_create_dynamic(void)
+    {
+        try
+        {
+            return new qb_table{db::QBTableDynamic{}};
+        }
+        catch (const std::exception &e)
+        {
+            failure(QB_ERROR, e.what());
+            return nullptr;
+        }
+    }
+
+    void qb_table_destroy(qb_table *table)
+    {
+        delete table;
+    }
+
+    size_t qb_table_active_count(const qb_table *table)
+    {
+        if (!table)
+            return 0;
+        return std::visit([](const auto &t)
+                          { return t.activeRecordsCount(); },
+                          table->table);
+    }
+
+    qb_status qb_add_record(qb_table *table, const qb_record *record)
+    {
+        return qb_add_records(table, record, 1);
+    }
+
+    /**
+     * Add records as one transaction - a record whose id or unique key is taken, by the table or by an earlier
+     * record of the batch, rejects the whole batch
+     */
+    qb_status qb_add_records(qb_table *table, const qb_record *records, size_t count)
+    {
+        if (!table || (!records && count > 0))
+            return failure(QB_INVALID_ARGUMENT, "Null table or records");
+        auto *t = std::get_if<db::QBTable>(&table->table);
+        if (!t)
+            return notStatic();
+        return guarded([&]
+                       {
+                           db::QBTransaction txn;
+                           txn.reserve(count);
+                           for (size_t i = 0; i < count; ++i)
+                           {
+                               const qb_record &r = records[i];
+                               txn.insert({r.column0, toString(r.column1, r.column1_length), static_cast<long>(r.column2),
+                                           toString(r.column3, r.column3_length)});
+                           }
+                           const db::CommitResult committed = t->commit(txn);
+                           if (!committed)
+                               return failure(QB_CONSTRAINT_VIOLATION, "Record " + std::to_string(committed.failedOperation) +
+                                                                           " duplicates an id or a unique index key");
+                           return QB_OK; });
+    }
+
+    qb_status qb_create_index(qb_table *table, int column)
+    {
+        if (!table || !validColumn(column))
+            return failure(QB_INVALID_ARGUMENT, "Null table or column outside 0..3");
+        auto *t = std::get_if<db::QBTable>(&table->table);
+        if (!t)
+            return notStatic();
+        return guarded([&]
+                       {
+                           t->createIndex(static_cast<db::ColumnType>(column));
+                           return QB_OK; });
+    }
+
+    qb_status qb_create_unique_index(qb_table *table, int column)
+    {
+        if (!table || !validColumn(column))
+            return failure(QB_INVALID_ARGUMENT, "Null table or column outside 0..3");
+        auto *t = std::get_if<db::QBTable>(&table->table);
+        if (!t)
+            return notStatic();
+        return guarded([&]
+                       {
+                           t->createIndex(static_cast<db::ColumnType>(column), db::IndexKind::Unique);
+                           return QB_OK; });
+    }
+
+    qb_status qb_drop_index(qb_table *table, int column)
+    {
+        if (!table || !validColumn(column))
+            return failure(QB_INVALID_ARGUMENT, "Null table or column outside 0..3");
+        auto *t = std::get_if<db::QBTable>(&table->table);
+        if (!t)
+            return notStatic();
+        return guarded([&]
+                       {
+                           t->dropIndex(static_cast<db::ColumnType>(column));
+                           return QB_OK; });
+    }
+
+    /**
+     * Serialize matches straight from table storage into the result columns
+     */
+    qb_status qb_find(const qb_table *table, int column, const char *match, size_t match_length, qb_result **result)
+    {
+        if (!table || !result || !validColumn(column) || (!match && match_length > 0))
+            return failure(QB_INVALID_ARGUMENT, "Null argument or column outside 0..3");
+        *result = nullptr;
+        const auto *t = std::get_if<db::QBTable>(&table->table);
+        if (!t)
+            return notStatic();
+        return guarded([&]
+                       {
+                           auto r = std::make_unique<qb_result>();
+                           r->builders.reserve(4);
+                           r->builders.emplace_back("column0", QB_FIELD_UINT);
+                           r->builders.emplace_back("column1", QB_FIELD_STRING);
+                           r->builders.emplace_back("column2", QB_FIELD_LONG);
+                           r->builders.emplace_back("column3", QB_FIELD_STRING);
+                           auto &b = r->builders;
+                           r->rows = t->forEachMatching(static_cast<db::ColumnType>(column), std::string_view(match ? match : "", match_length),
+                                                        [&](const db::QBRecord &rec)
+                                                        {
+                                                            b[0].uints.push_back(rec.column0);
+                                                            b[1].bytes.append(rec.column1);
+                                                            b[1].offsets.push_back(b[1].bytes.size());
+                                                            b[2].longs.push_back(rec.column2);
+                                                            b[3].bytes.append(rec.column3);
+                                                            b[3].offsets.push_back(b[3].bytes.size());
+                                                        });
+                           r->finish();
+                           *result = r.release();
+                           return QB_OK; });
+    }
+
+    qb_status qb_dynamic_add_column(qb_table *table, const char *name, qb_value default_value)
+    {
+        if (!table || !name)
+            return failure(QB_INVALID_ARGUMENT, "Null table or column name");
+        auto *t = std::get_if<db::QBTableDynamic>(&table->table);
+        if (!t)
+            return notDynamic();
+        return guarded([&]
+                       {
+                           if (!t->addColumn(name, toField(default_value)))
+                               return failure(QB_INVALID_ARGUMENT, std::string("Column already exists: ") + name);
+                           return QB_OK; });
+    }
+
+    qb_status qb_dynamic_add_record(qb_table *table, const qb_dynamic_record *record)
+    {
+        return qb_dynamic_add_records(table, record, 1);
+    }
+
+    /**
+     * Add records in order once all of them match the schema - a record naming an unknown column rejects the
+     * whole batch
+     */
+    qb_status qb_dynamic_add_records(qb_table *table, const qb_dynamic_record *records, size_t count)
+    {
+        if (!table || (!records && count > 0))
+            return failure(QB_INVALID_ARGUMENT, "Null table or records");
+        auto *t = std::get_if<db::QBTableDynamic>(&table->table);
+        if (!t)
+            return notDynamic();
+        return guarded([&]
+                       {
+                           std::vector<db::QBRecordDynamic> batch(count);
+                           for (size_t i = 0; i < count; ++i)
+                           {
+                               const qb_dynamic_record &r = records[i];
+                               if (!r.fields && r.field_count > 0)
+                                   return failure(QB_INVALID_ARGUMENT, "Null fields in record " + std::to_string(i));
+                               batch[i].id = r.id;
+                               for (size_t f = 0; f < r.field_count; ++f)
+                               {
+                                   if (!r.fields[f].name)
+                                       return failure(QB_INVALID_ARGUMENT, "Null field name in record " + std::to_string(i));
+                                   const std::string_view name = r.fields[f].name;
+                                   if (name == "id" || !t->hasColumn(std::string(name)))
+                                       return failure(QB_INVALID_ARGUMENT, "Record " + std::to_string(i) + " does not match the table schema");
+                                   batch[i].fields.emplace(name, toField(r.fields[f].value));
+                               }
+                           }
+                           for (const auto &rec : batch)
+                               t->addRecord(rec);
+                           return QB_OK; });
+    }
+
+    qb_status qb_dynamic_create_index(qb_table *table, const char *column)
+    {
+        if (!table || !column)
+            return failure(QB_INVALID_ARGUMENT, "Null table or column name");
+        auto *t = std::get_if<db::QBTableDynamic>(&table->table);
+        if (!t)
+            return notDynamic();
+        return guarded([&]
+                       {
+                           t->createIndex(column);
+                           return QB_OK; });
+    }
+
+    qb_status qb_dynamic_drop_index(qb_table *table, const char *column)
+    {
+        if (!table || !column)
+            return failure(QB_INVALID_ARGUMENT, "Null table or column name");
+        auto *t = std::get_if<db::QBTableDynamic>(&table->table);
+        if (!t)
+            return notDynamic();
+        return guarded([&]
+                       {
+                           t->dropIndex(column);
+                           return QB_OK; });
+    }
+
+    /**
+     * Serialize matches straight from table storage into one result column per physical table column
+     */
+    qb_status qb_dynamic_find(const qb_table *table, const char *column, qb_value value, qb_result **result)
+    {
+        if (!table || !column || !result)
+            return failure(QB_INVALID_ARGUMENT, "Null argument");
+        *result = nullptr;
+        const auto *t = std::get_if<db::QBTableDynamic>(&table->table);
+        if (!t)
+            return notDynamic();
+        if (std::string_view(column) == "id" && value.type != QB_FIELD_UINT)
+            return failure(QB_INVALID_ARGUMENT, "Primary key lookups need a QB_FIELD_UINT value");
+        return guarded([&]
+                       {
+                           auto r = std::make_unique<qb_result>();
+                           std::vector<std::string> names = t->columnNames();
+                           r->builders.reserve(names.size());
+                           r->builders.emplace_back(names[0], QB_FIELD_UINT);
+                           for (size_t i = 1; i < names.size(); ++i)
+                               r->builders.emplace_back(names[i]);
+                           auto &b = r->builders;
+                           r->rows = t->forEachMatching(column, toField(value), [&](const db::QBRecordDynamic &rec)
+                                                        {
+                                                            b[0].append(rec.id);
+                                                            for (size_t i = 1; i < b.size(); ++i)
+                                                            {
+                                                                auto it = rec.fields.find(b[i].name);
+                                                                if (it == rec.fields.end())
+                                                                    b[i].appendMissing();
+                                                                else
+                                                                    b[i].append(it->second);
+                                                            } });
+                           r->finish();
+                           *result = r.release();
+                           return QB_OK; });
+    }
+
+    qb_status qb_delete_record(qb_table *table, uint32_t id, int hard_delete)
+    {
+        if (!table)
+            return failure(QB_INVALID_ARGUMENT, "Null table");
+        return guarded([&]
+                       {
+                           bool deleted = std::visit([&](auto &t)
+                                                     { return t.deleteRecordByID(id, hard_delete != 0); },
+                                                     table->table);
+                           return deleted ? QB_OK : failure(QB_NOT_FOUND, "No record with id " + std::to_string(id)); });
+    }
+
+    qb_status qb_compact(qb_table *table)
+    {
+        if (!table)
+            return failure(QB_INVALID_ARGUMENT, "Null table");
+        return guarded([&]
+                       {
+                           std::visit([](auto &t)
+                                      { t.compactRecords(); },
+                                      table->table);
+                           return QB_OK; });
+    }
+
+    size_t qb_result_rows(const qb_result *result)
+    {
+        return result ? result->rows : 0;
+    }
+
+    size_t qb_result_column_count(const qb_result *result)
+    {
+        return result ? result->columns.size() : 0;
+    }
+
+    const qb_column *qb_result_column(const qb_result *result, size_t index)
+    {
+        if (!result || index >= result->columns.size())
+            return nullptr;
+        return &result->columns[index];
+    }
+
+    void qb_result_free(qb_result *result)
+    {
+        delete result;
+    }
+}
@@ -0,0 +1,216 @@
+#include "../include/Quickbase_client.hpp"
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <utility>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Quickbase table server client definitions
+namespace db
+{
+    namespace
+    {
+        [[noreturn]] void throwSystemError(const std::string &what)
+        {
+            throw std::runtime_error(what + ": " + std::strerror(errno));
+        }
+    }
+
+    QBClient::QBClient(QBClient &&other) noexcept
+        : fd_(std::exchange(other.fd_, -1)), nextRequestId_(other.nextRequestId_),
+          in_(std::move(other.in_)), inOffset_(std::exchange(other.inOffset_, 0)) {}
+
+    QBClient &QBClient::operator=(QBClient &&other) noexcept
+    {
+        if (this != &other)
+        {
+            close();
+            fd_ = std::exchange(other.fd_, -1);
+            nextRequestId_ = other.nextRequestId_;
+            in_ = std::move(other.in_);
+            inOffset_ = std::exchange(other.inOffset_, 0);
+        }
+        return *this;
+    }
+
+    QBClient::~QBClient()
+    {
+        close();
+    }
+
+    void QBClient::connectTcp(const std::string &host, uint16_t port)
+    {
+        close();
+        sockaddr_in addr{};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (::inet_pton(AF_INET, host.c_str(), &addr.sin_addr) != 1)
+            throw std::runtime_error("Invalid IPv4 address: " + host);
+        fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+            throwSystemError("socket");
+        if (::connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+            throwSystemError("connect " + host + ":" + std::to_string(port));
+        int one = 1;
+        ::setsockopt(fd_, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+
+    void QBClient::connectUnix(const std::string &path)
+    {
+        close();
+        sockaddr_un addr{};
+        if (path.size() >= sizeof(addr.sun_path))
+            throw std::runtime_error("Unix socket path too long: " + path);
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        fd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0)
+            throwSystemError("socket");
+        if (::connect(fd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+            throwSystemError("connect " + path);
+    }
+
+    void QBClient::close() noexcept
+    {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = -1;
+        in_.clear();
+        inOffset_ = 0;
+    }
+
+    uint32_t QBClient::encodeRequest(std::vector<char> &out, db::wire::Opcode opcode, const std::function<void(db::wire::Writer &)> &body)
+    {
+        db::wire::Writer writer(out);
+        uint32_t requestId = nextRequestId_++;
+        size_t start = writer.beginFrame(static_cast<uint8_t>(opcode), requestId);
+        if (body)
+            body(writer);
+        writer.endFrame(start);
+        return requestId;
+    }
+
+    void QBClient::sendAll(const char *data, size_t size)
+    {
+        while (size > 0)
+        {
+            ssize_t n = ::send(fd_, data, size, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                throwSystemError("send");
+            }
+            data += n;
+            size -= size_t(n);
+        }
+    }
+
+    void QBClient::send(const std::vector<char> &frames)
+    {
+        sendAll(frames.data(), frames.size());
+    }
+
+    db::ClientResponse QBClient::receive()
+    {
+        db::wire::FrameHeader header{};
+        while (!db::wire::peekFrame(in_.data() + inOffset_, in_.size() - inOffset_, header))
+        {
+            if (inOffset_ > 0)
+            {
+                in_.erase(in_.begin(), in_.begin() + static_cast<std::ptrdiff_t>(inOffset_));
+                inOffset_ = 0;
+            }
+            size_t used = in_.size();
+            in_.resize(used + 64 * 1024);
+            ssize_t n = ::recv(fd_, in_.data() + used, 64 * 1024, 0);
+            in_.resize(used + (n > 0 ? size_t(n) : 0));
+            if (n == 0)
+                throw std::runtime_error("Connection closed by server");
+            if (n < 0 && errno != EINTR)
+                throwSystemError("recv");
+        }
+
+        const char *frame = in_.data() + inOffset_;
+        db::ClientResponse response;
+        response.status = static_cast<db::wire::Status>(header.code);
+        response.requestId = header.requestId;
+        response.payload.assign(frame + db::wire::kHeaderSize, frame + header.frameSize());
+        inOffset_ += header.frameSize();
+        return response;
+    }
+
+    bool QBClient::hasBufferedResponse() const
+    {
+        db::wire::FrameHeader header{};
+        return db::wire::peekFrame(in_.data() + inOffset_, in_.size() - inOffset_, header);
+    }
+
+    db::ClientResponse QBClient::call(db::wire::Opcode opcode, const std::function<void(db::wire::Writer &)> &body)
+    {
+        std::vector<char> frame;
+        encodeRequest(frame, opcode, body);
+        send(frame);
+        return receive();
+    }
+
+    db::wire::Status QBClient::createTable(const std::string &name)
+    {
+        return call(db::wire::Opcode::CreateTable, [&](db::wire::Writer &w)
+                    {
+                        w.putName(name);
+                        w.putU8(static_cast<uint8_t>(db::wire::Engine::Static)); })
+            .status;
+    }
+
+    db::wire::Status QBClient::addRecord(const std::string &name, const db::QBRecord &record)
+    {
+        return call(db::wire::Opcode::Add, [&](db::wire::Writer &w)
+                    {
+                        w.putName(name);
+                        w.putRecord(record); })
+            .status;
+    }
+
+    db::wire::Status QBClient::createIndex(const std::string &name, db::ColumnType column)
+    {
+        return call(db::wire::Opcode::CreateIndex, [&](db::wire::Writer &w)
+                    {
+                        w.putName(name);
+                        w.putU8(static_cast<uint8_t>(column)); })
+            .status;
+    }
+
+    db::wire::Status QBClient::deleteRecord(const std::string &name, db::uint id, bool hardDelete)
+    {
+        return call(db::wire::Opcode::Delete, [&](db::wire::Writer &w)
+                    {
+                        w.putName(name);
+                        w.putU32(id);
+                        w.putU8(hardDelete ? 1 : 0); })
+            .status;
+    }
+
+    std::vector<db::QBRecord> QBClient::findMatching(const std::string &name, db::ColumnType column, std::string_view matchString)
+    {
+        db::ClientResponse response = call(db::wire::Opcode::Find, [&](db::wire::Writer &w)
+                                           {
+                                               w.putName(name);
+                                               w.putU8(static_cast<uint8_t>(column));
+                                               w.putString(matchString); });
+        std::vector<db::QBRecord> records;
+        if (response.status != db::wire::Status::Ok)
+            return records;
+        db::wire::Reader reader = response.reader();
+        uint32_t count = reader.getU32();
+        records.reserve(count);
+        for (uint32_t i = 0; i < count; ++i)
+            records.push_back(reader.getRecord());
+        return records;
+    }
+}
@@ -0,0 +1,31 @@
+#include "../include/Quickbase_composite.hpp"
+#include <algorithm>
+
+// Quickbase composite index definitions
+namespace db
+{
+    /**
+     * Add a posting - appended records land at the end of their list, updated ones are inserted in order
+     */
+    void CompositeIndex::add(Key key, size_t recordIdx)
+    {
+        auto &indices = postings_[std::move(key)];
+        if (indices.empty() || indices.back() < recordIdx)
+            indices.push_back(recordIdx);
+        else
+            indices.insert(std::lower_bound(indices.begin(), indices.end(), recordIdx), recordIdx);
+    }
+
+    void CompositeIndex::remove(const Key &key, size_t recordIdx)
+    {
+        auto it = postings_.find(key);
+        if (it == postings_.end())
+            return;
+        auto &indices = it->second;
+        auto pos = std::lower_bound(indices.begin(), indices.end(), recordIdx);
+        if (pos != indices.end() && *pos == recordIdx)
+            indices.erase(pos);
+        if (indices.empty())
+            postings_.erase(it);
+    }
+}
@@ -0,0 +1,164 @@
+#include "../include/Quickbase_cracking.hpp"
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+// Quickbase adaptive indexing definitions
+namespace db
+{
+    void CrackerColumn::build(std::vector<Entry> entries)
+    {
+        entries_ = std::move(entries);
+        pivots_.clear();
+        pending_.clear();
+        pendingRows_.clear();
+        stale_.clear();
+        built_ = true;
+    }
+
+    void CrackerColumn::append(long value, size_t row)
+    {
+        if (!built_)
+            return;
+        pendingRows_[row] = pending_.size();
+        pending_.push_back({value, row});
+    }
+
+    /**
+     * A pending row takes the new value where it is. Otherwise the row's entry sits in a piece that may not hold
+     * the new value - it is marked stale instead of moved, and the new value waits in the pending list
+     */
+    void CrackerColumn::update(long value, size_t row)
+    {
+        if (!built_)
+            return;
+        if (auto it = pendingRows_.find(row); it != pendingRows_.end())
+        {
+            pending_[it->second].value = value;
+            return;
+        }
+        stale_.insert(row);
+        append(value, row);
+    }
+
+    /**
+     * Rewrite the rows of the entries and drop the ones without a new row, and the stale ones - each piece shrinks
+     * in place, so the pivots only shift down by the entries dropped before them
+     */
+    void CrackerColumn::remapRows(const std::vector<size_t> &newRows)
+    {
+        auto keep = [&](std::vector<Entry> &entries, size_t from, size_t to, size_t &kept)
+        {
+            for (size_t i = from; i < to; ++i)
+            {
+                const bool stale = &entries == &entries_ && stale_.contains(entries[i].row);
+                const size_t row = entries[i].row < newRows.size() && !stale ? newRows[entries[i].row] : npos;
+                if (row != npos)
+                    entries[kept++] = {entries[i].value, row};
+            }
+        };
+        size_t kept = 0, from = 0;
+        for (auto &[pivot, position] : pivots_)
+        {
+            keep(entries_, from, position, kept);
+            from = position;
+            position = kept;
+        }
+        keep(entries_, from, entries_.size(), kept);
+        entries_.resize(kept);
+        kept = 0;
+        stale_.clear();
+        keep(pending_, 0, pending_.size(), kept);
+        pending_.resize(kept);
+        pendingRows_.clear();
+        for (size_t i = 0; i < pending_.size(); ++i)
+            pendingRows_[pending_[i].row] = i;
+    }
+
+    void CrackerColumn::clear() noexcept
+    {
+        entries_ = {};
+        pivots_.clear();
+        pending_ = {};
+        pendingRows_.clear();
+        stale_.clear();
+        built_ = false;
+    }
+
+    /**
+     * Crack the piece holding pivot in two - the piece lies between the nearest pivots below and above it, and
+     * only its entries are partitioned
+     */
+    size_t CrackerColumn::crack(long pivot, size_t &examined)
+    {
+        auto next = pivots_.lower_bound(pivot);
+        if (next != pivots_.end() && next->first == pivot)
+            return next->second;
+        const size_t from = next == pivots_.begin() ? 0 : std::prev(next)->second;
+        const size_t to = next == pivots_.end() ? entries_.size() : next->second;
+        auto split = std::partition(entries_.begin() + static_cast<std::ptrdiff_t>(from), entries_.begin() + static_cast<std::ptrdiff_t>(to),
+                                    [pivot](const Entry &entry)
+                                    { return entry.value < pivot; });
+        examined += to - from;
+        const size_t position = static_cast<size_t>(split - entries_.begin());
+        pivots_.emplace_hint(next, pivot, position);
+        return position;
+    }
+
+    /**
+     * Move the pending entries into their pieces - the pieces are copied in order without their stale entries, each
+     * followed by the sorted pending entries below its upper pivot, so every pivot keeps its meaning at its new position
+     */
+    void CrackerColumn::mergePending()
+    {
+        std::sort(pending_.begin(), pending_.end(), [](const Entry &a, const Entry &b)
+                  { return a.value < b.value; });
+        std::vector<Entry> merged;
+        merged.reserve(entries_.size() + pending_.size() - stale_.size());
+        auto copy = [&](size_t from, size_t to)
+        {
+            for (size_t i = from; i < to; ++i)
+                if (stale_.empty() || !stale_.contains(entries_[i].row))
+                    merged.push_back(entries_[i]);
+        };
+        auto added = pending_.begin();
+        size_t from = 0;
+        for (auto &[pivot, position] : pivots_)
+        {
+            copy(from, position);
+            for (; added != pending_.end() && added->value < pivot; ++added)
+                merged.push_back(*added);
+            from = position;
+            position = merged.size();
+        }
+        copy(from, entries_.size());
+        merged.insert(merged.end(), added, pending_.end());
+        entries_ = std::move(merged);
+        pending_.clear();
+        pendingRows_.clear();
+        stale_.clear();
+    }
+
+    size_t CrackerColumn::candidates(long low, long high) const
+    {
+        if (!built_ || low > high)
+            return 0;
+        auto first = pivots_.upper_bound(low);
+        const size_t from = first == pivots_.begin() ? 0 : std::prev(first)->second;
+        auto last = pivots_.upper_bound(high);
+        const size_t to = last == pivots_.end() ? entries_.size() : last->second;
+        return to - from + pending_.size();
+    }
+
+    size_t CrackerColumn::memoryUsage() const noexcept
+    {
+        // a map node holds its value and, with libstdc++ and libc++, three links and the color
+        constexpr size_t nodeBytes = sizeof(std::pair<const long, size_t>) + 4 * sizeof(void *);
+        // a hash node holds its value and the next link, each bucket one pointer
+        constexpr size_t rowNodeBytes = sizeof(std::pair<const size_t, size_t>) + sizeof(void *);
+        constexpr size_t staleNodeBytes = sizeof(size_t) + sizeof(void *);
+        return (entries_.capacity() + pending_.capacity()) * sizeof(Entry) + pivots_.size() * nodeBytes +
+               pendingRows_.size() * rowNodeBytes + stale_.size() * staleNodeBytes +
+               (pendingRows_.bucket_count() + stale_.bucket_count()) * sizeof(void *);
+    }
+}
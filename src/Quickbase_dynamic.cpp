@@ -1,5 +1,8 @@
 #include "../include/Quickbase_dynamic.hpp"
+#include "../include/Quickbase_trace.hpp"
 #include <algorithm>
+#include <chrono>
+#include <limits>
 
 namespace db
 {
@@ -7,39 +10,315 @@ namespace db
      * Find matching records by column name and corresponding value
      * Uses primary key index for column "id", secondary indexes for other columns,
      * or falls back to linear scan for non-indexed columns
+     * Timed and aggregated per query shape when a query log is attached
      */
     std::vector<db::QBRecordDynamic> QBTableDynamic::findMatching(std::string column, db::FieldType value) const
     {
         std::vector<db::QBRecordDynamic> result;
+        loggedVisitMatching(column, value, [&](const db::QBRecordDynamic &rec)
+                            { result.push_back(rec); });
+        return result;
+    }
+
+    /**
+     * Zero-copy variant of findMatching() - the visitor sees every matching record in table storage
+     * The table must not be modified from inside the visitor
+     */
+    size_t QBTableDynamic::forEachMatching(const std::string &column, const db::FieldType &value, const db::DynamicRecordVisitor &visitor) const
+    {
+        return loggedVisitMatching(column, value, visitor);
+    }
+
+    /**
+     * Find records equal to every condition, see QBTable::findMatchingAll()
+     * Served by the primary key, the composite index covering the longest leading run of the conditioned
+     * columns, the intersection of single column indexes, or a linear scan
+     */
+    std::vector<db::QBRecordDynamic> QBTableDynamic::findMatchingAll(std::span<const db::DynamicColumnMatch> conditions) const
+    {
+        std::vector<db::QBRecordDynamic> result;
+        loggedVisitMatchingAll(conditions, [&](const db::QBRecordDynamic &rec)
+                               { result.push_back(rec); });
+        return result;
+    }
+
+    size_t QBTableDynamic::forEachMatchingAll(std::span<const db::DynamicColumnMatch> conditions, const db::DynamicRecordVisitor &visitor) const
+    {
+        return loggedVisitMatchingAll(conditions, visitor);
+    }
+
+    /**
+     * Visit every active record in storage order until the visitor returns false
+     * Counted as a linear scan in the table totals of stats()
+     */
+    size_t QBTableDynamic::forEachRecord(const db::DynamicScanVisitor &visitor) const
+    {
+        ++scanStats_.linearScans;
+        size_t visited = 0;
+        const auto now = expiryNow();
+        for (size_t i = 0; i < records_.size(); ++i)
+        {
+            ++scanStats_.rowsExamined;
+            if (deleted_[i] || expired(i, now))
+                continue;
+            ++visited;
+            if (!visitor(records_[i]))
+                break;
+        }
+        scanStats_.rowsReturned += visited;
+        return visited;
+    }
+
+    /**
+     * Counters of a column named by a query - unknown names share a per-thread scratch entry, so a typo or a
+     * name sent by a client never grows columnStats_ and concurrent readers never insert into it
+     */
+    db::AtomicAccessPathCounters &QBTableDynamic::countersFor(const std::string &column) const
+    {
+        if (auto it = columnStats_.find(column); it != columnStats_.end())
+            return it->second;
+        thread_local db::AtomicAccessPathCounters uncounted;
+        return uncounted;
+    }
+
+    void QBTableDynamic::touchIndex(const std::string &column) const noexcept
+    {
+        if (auto it = indexUsage_.find(column); it != indexUsage_.end())
+            it->second.touch();
+    }
+
+    /**
+     * Run visitMatching() and, when a query log is attached, time and aggregate the query by shape
+     */
+    template <typename Visitor>
+    size_t QBTableDynamic::loggedVisitMatching(const std::string &column, const db::FieldType &value, Visitor &&visit) const
+    {
+        if (!queryLog_)
+            return visitMatching(column, value, visit);
+
+        const db::AtomicAccessPathCounters &counters = countersFor(column);
+        const uint64_t examinedBefore = counters.rowsExamined;
+        auto startTimer = std::chrono::steady_clock::now();
+        size_t matches = visitMatching(column, value, visit);
+        auto elapsed = std::chrono::steady_clock::now() - startTimer;
+
+        db::MatchMode mode = (column == "id") ? db::MatchMode::PrimaryKey : db::MatchMode::Exact;
+        queryLog_->record({queryLogTable_, column, mode}, db::fieldToString(value),
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed),
+                          counters.rowsExamined - examinedBefore, matches,
+                          [&]
+                          { return explain(column, value); });
+        return matches;
+    }
+
+    /**
+     * Run visitMatchingAll() and, when a query log is attached, aggregate it under the shape of all its columns
+     */
+    template <typename Visitor>
+    size_t QBTableDynamic::loggedVisitMatchingAll(std::span<const db::DynamicColumnMatch> conditions, Visitor &&visit) const
+    {
+        if (!queryLog_)
+            return visitMatchingAll(conditions, visit);
+
+        auto examined = [this]
+        {
+            uint64_t rows = 0;
+            for (const auto &[column, counters] : columnStats_)
+                rows += counters.rowsExamined;
+            return rows;
+        };
+        const uint64_t examinedBefore = examined();
+        auto startTimer = std::chrono::steady_clock::now();
+        size_t matches = visitMatchingAll(conditions, visit);
+        auto elapsed = std::chrono::steady_clock::now() - startTimer;
+
+        std::string columns, literals;
+        for (const auto &[column, value] : conditions)
+        {
+            if (!columns.empty())
+            {
+                columns += ',';
+                literals += ',';
+            }
+            columns += column;
+            literals += db::fieldToString(value);
+        }
+        queryLog_->record({queryLogTable_, columns, db::MatchMode::Exact}, literals,
+                          std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed), examined() - examinedBefore, matches,
+                          [&]
+                          { return explain(conditions); });
+        return matches;
+    }
+
+    /**
+     * Execute a conjunctive query - every candidate the chosen access path yields is checked against all conditions
+     */
+    template <typename Visitor>
+    size_t QBTableDynamic::visitMatchingAll(std::span<const db::DynamicColumnMatch> conditions, Visitor &&visit) const
+    {
+        if (conditions.empty())
+            throw std::runtime_error("findMatchingAll needs at least one condition");
+        auto valueOf = [&](const std::string &column) -> const db::FieldType *
+        {
+            for (const auto &condition : conditions)
+                if (condition.column == column)
+                    return &condition.value;
+            return nullptr;
+        };
+
+        const auto now = expiryNow();
+        size_t matches = 0;
+        auto consider = [&](db::AtomicAccessPathCounters &counters, size_t idx)
+        {
+            ++counters.rowsExamined;
+            if (deleted_[idx] || expired(idx, now))
+            {
+                ++counters.deletedFiltered;
+                return;
+            }
+            for (const auto &[column, value] : conditions)
+                if (!fieldEquals(idx, column, value))
+                    return;
+            ++counters.rowsReturned;
+            ++matches;
+            visit(records_[idx]);
+        };
+
+        if (const db::FieldType *id = valueOf("id"))
+        {
+            db::AtomicAccessPathCounters &counters = countersFor("id");
+            ++counters.pkLookups;
+            touchIndex("id");
+            if (const auto *key = std::get_if<db::uint>(id))
+                if (auto it = pkIndex_.find(*key); it != pkIndex_.end())
+                    consider(counters, it->second);
+            return matches;
+        }
+
+        auto [composite, prefixLength] = db::longestCompositePrefix(compositeIndexes_, [&](const std::string &column)
+                                                                    { return valueOf(column) != nullptr; });
+        if (composite != compositeIndexes_.end())
+        {
+            db::AtomicAccessPathCounters &counters = countersFor(composite->first.front());
+            ++counters.secondaryIndexLookups;
+            if (auto usage = compositeUsage_.find(composite->first); usage != compositeUsage_.end())
+                usage->second.touch();
+            db::CompositeIndex::Key prefix;
+            for (size_t i = 0; i < prefixLength; ++i)
+                prefix.push_back(*valueOf(composite->first[i]));
+            composite->second.forEachPrefix(prefix, [&](const std::vector<size_t> &postings)
+                                            {
+                                                for (size_t idx : postings)
+                                                    consider(counters, idx); });
+            return matches;
+        }
+
+        // intersect the posting lists of single column indexes, driven by the shortest one
+        std::vector<std::pair<const std::string *, const std::vector<size_t> *>> postings;
+        for (const auto &[column, value] : conditions)
+        {
+            if (!secondaryIndexedColumns_.contains(column))
+                continue;
+            db::AtomicAccessPathCounters &counters = countersFor(column);
+            ++counters.secondaryIndexLookups;
+            touchIndex(column);
+            auto it = secondaryIndexes_.find({column, value});
+            if (it == secondaryIndexes_.end())
+                return 0;
+            postings.emplace_back(&column, &it->second);
+        }
+        if (!postings.empty())
+        {
+            std::sort(postings.begin(), postings.end(), [](const auto &a, const auto &b)
+                      { return a.second->size() < b.second->size(); });
+            db::AtomicAccessPathCounters &counters = countersFor(*postings.front().first);
+            for (size_t idx : *postings.front().second)
+            {
+                if (std::all_of(postings.begin() + 1, postings.end(), [&](const auto &other)
+                                { return std::binary_search(other.second->begin(), other.second->end(), idx); }))
+                    consider(counters, idx);
+            }
+            return matches;
+        }
+
+        db::AtomicAccessPathCounters &counters = countersFor(conditions.front().column);
+        ++counters.linearScans;
+        for (size_t i = 0; i < records_.size(); ++i)
+            consider(counters, i);
+        return matches;
+    }
+
+    /**
+     * Execute a query - calls visit(record) for every match and returns the number of matches
+     */
+    template <typename Visitor>
+    size_t QBTableDynamic::visitMatching(const std::string &column, const db::FieldType &value, Visitor &&visit) const
+    {
+        size_t matches = 0;
+        db::AtomicAccessPathCounters &counters = countersFor(column);
         // handle queries on primary key
         if (column == "id")
         {
+            ++counters.pkLookups;
+            touchIndex("id");
             auto it = pkIndex_.find(std::get<db::uint>(value));
-            if (it != pkIndex_.end() && !deleted_[it->second])
-                result.push_back(records_[it->second]);
-            return result;
+            if (it != pkIndex_.end())
+            {
+                ++counters.rowsExamined;
+                if (!deleted_[it->second] && !expired(it->second, expiryNow()))
+                {
+                    visit(records_[it->second]);
+                    ++matches;
+                }
+                else
+                    ++counters.deletedFiltered;
+            }
+            counters.rowsReturned += matches;
+            return matches;
         }
         // handle queries on non-pk columns - secondery indexed
-        auto idxIt = secondaryIndexes_.find({column, value});
-        if (idxIt != secondaryIndexes_.end())
+        if (secondaryIndexedColumns_.contains(column))
         {
+            ++counters.secondaryIndexLookups;
+            touchIndex(column);
+            auto idxIt = secondaryIndexes_.find({column, value});
+            if (idxIt == secondaryIndexes_.end())
+                return 0; // no match in the index - no need to scan
+
+            counters.rowsExamined += idxIt->second.size();
+            const auto now = expiryNow();
             for (size_t i : idxIt->second)
-                if (!deleted_[i])
-                    result.push_back(records_[i]);
-            return result;
+            {
+                if (!deleted_[i] && !expired(i, now))
+                {
+                    visit(records_[i]);
+                    ++matches;
+                }
+                else
+                    ++counters.deletedFiltered;
+            }
+            counters.rowsReturned += matches;
+            return matches;
         }
 
         // Linear scan fallback
+        ++counters.linearScans;
+        counters.rowsExamined += records_.size();
+        const auto now = expiryNow();
         for (size_t i = 0; i < records_.size(); ++i)
         {
-            if (deleted_[i])
+            if (deleted_[i] || expired(i, now))
                 continue;
             auto fIt = records_[i].fields.find(column);
             if (fIt != records_[i].fields.end() && fIt->second == value)
-                result.push_back(records_[i]);
+            {
+                visit(records_[i]);
+                ++matches;
+            }
         }
+        counters.rowsReturned += matches;
 
-        return result;
+        return matches;
     }
     /**
      * Delete a record by its unique ID - id
@@ -55,12 +334,26 @@ namespace db
         if (!hardDelete && deleted_[idx])
             return false;
 
+        // an expired record that was not purged yet is already gone for readers - purge it as expireRecords() would
+        if (expired(idx, expiryNow()))
+        {
+            std::vector<size_t> stale{idx};
+            softDeleteRecords(stale);
+            return false;
+        }
+
         // soft delete
         if (!hardDelete)
         {
             deleted_[idx] = true;
             // remove from PK index
             pkIndex_.erase(pkIt);
+            removeCompositeEntries(idx);
+            ++mutations_;
+            if (changeStream_)
+                changeStream_->publish(db::ChangeType::SoftDelete, id, idx);
+            for (const auto &view : views_)
+                view->erase(idx);
 
             // remove index entries for this record only
             for (const auto &column : secondaryIndexedColumns_)
@@ -88,13 +381,18 @@ namespace db
             if (idx != lastIdx)
             {
                 std::swap(records_[idx], records_[lastIdx]);
-                std::swap(deleted_[idx], deleted_[lastIdx]);
+                std::vector<bool>::swap(deleted_[idx], deleted_[lastIdx]);
+                if (!expiresAt_.empty())
+                    std::swap(expiresAt_[idx], expiresAt_[lastIdx]);
             }
 
             records_.pop_back();
             deleted_.pop_back();
+            if (!expiresAt_.empty())
+                expiresAt_.pop_back();
 
             // Rebuild indexes for correctness and simplicity
+            QB_TRACE_SPAN("QBTableDynamic::hardDelete index rebuild", records_.size());
             rebuildPrimaryIndex();
             secondaryIndexes_.clear();
             for (const auto &column : secondaryIndexedColumns_)
@@ -104,10 +402,405 @@ namespace db
 
                 rebuildSecondaryIndex(column);
             }
+            rebuildCompositeIndexes();
+
+            ++mutations_;
+            if (changeStream_)
+            {
+                std::vector<db::RecordMove> moves;
+                if (idx != lastIdx)
+                    moves.push_back({lastIdx, idx});
+                changeStream_->publish(db::ChangeType::HardDelete, id, idx, nullptr, std::move(moves));
+            }
+            for (const auto &view : views_)
+            {
+                view->erase(idx);
+                if (idx != lastIdx)
+                    view->move(lastIdx, idx);
+            }
+            return true;
+        }
+    }
+    /**
+     * Update fields of an active record in place
+     * Indexed columns are compared before and after the change - a physical column only when it is among the
+     * changes, a derived column always as it may depend on them - and only those whose value differs move
+     * their posting
+     */
+    bool QBTableDynamic::updateRecord(db::uint id, const std::unordered_map<std::string, db::FieldType> &changes)
+    {
+        auto pkIt = pkIndex_.find(id);
+        if (pkIt == pkIndex_.end() || expired(pkIt->second, expiryNow()))
+            return false;
+        for (const auto &[column, _] : changes)
+            if (!columns_.contains(column))
+                return false;
 
+        const size_t idx = pkIt->second;
+        auto &fields = records_[idx].fields;
+        if (std::ranges::all_of(changes, [&](const auto &change)
+                                { auto it = fields.find(change.first);
+                                  return it != fields.end() && it->second == change.second; }))
             return true;
+        std::vector<std::pair<const std::string *, db::FieldType>> indexed;
+        for (const auto &column : secondaryIndexedColumns_)
+            if (changes.contains(column) || derivedColumns_.contains(column))
+                indexed.emplace_back(&column, getField(idx, column));
+
+        removeCompositeEntries(idx, &changes);
+        for (const auto &[column, value] : changes)
+            fields.insert_or_assign(column, value);
+        addCompositeEntries(idx, &changes);
+
+        for (const auto &[column, before] : indexed)
+        {
+            db::FieldType after = getField(idx, *column);
+            if (after != before)
+                moveSecondaryIndexEntry(*column, before, after, idx);
+        }
+
+        ++mutations_;
+        if (changeStream_)
+            changeStream_->publish(db::ChangeType::Update, id, idx, &records_[idx]);
+        for (const auto &view : views_)
+        {
+            view->erase(idx);
+            view->insert(idx, records_[idx]);
+        }
+        return true;
+    }
+
+    /**
+     * Merge a batch of records keyed on id, see QBTable::upsertRecords()
+     * Fields missing from an incoming record keep their stored value. Derived columns are re-read for every
+     * updated record, so an indexed derived column follows the fields it is computed from.
+     */
+    db::UpsertResult QBTableDynamic::upsertRecords(std::span<const db::QBRecordDynamic> records)
+    {
+        QB_TRACE_SPAN("QBTableDynamic::upsertRecords", records.size());
+        constexpr size_t npos = static_cast<size_t>(-1);
+        db::UpsertResult result;
+
+        std::vector<size_t> positions(records.size(), npos);
+        std::vector<size_t> expiredHits;
+        const auto now = expiryNow();
+        size_t misses = 0;
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            auto it = pkIndex_.find(records[i].id);
+            if (it != pkIndex_.end() && !expired(it->second, now))
+                positions[i] = it->second;
+            else
+            {
+                if (it != pkIndex_.end())
+                    expiredHits.push_back(it->second);
+                ++misses;
+            }
+        }
+        // an expired record is replaced rather than updated - purge it first so its id reads as new
+        if (!expiredHits.empty())
+            softDeleteRecords(expiredHits);
+        // grow geometrically - an exact reserve would reallocate on every call of a stream of small batches
+        if (records_.size() + misses > records_.capacity())
+        {
+            records_.reserve(std::max(records_.size() + misses, 2 * records_.capacity()));
+            deleted_.reserve(records_.capacity());
+        }
+
+        // indexed values of existing records before their first change in this batch
+        const size_t firstAppended = records_.size();
+        std::unordered_map<size_t, std::vector<db::FieldType>> original;
+        for (size_t i = 0; i < records.size(); ++i)
+        {
+            const db::QBRecordDynamic &record = records[i];
+            if (!std::ranges::all_of(record.fields, [&](const auto &field)
+                                     { return columns_.contains(field.first); }))
+            {
+                ++result.rejected;
+                continue;
+            }
+            size_t idx = positions[i];
+            // a miss may have been appended by an earlier record of the batch
+            if (idx == npos)
+            {
+                auto it = pkIndex_.find(record.id);
+                if (it != pkIndex_.end())
+                    idx = it->second;
+            }
+            if (idx == npos)
+            {
+                idx = records_.size();
+                records_.push_back(record);
+                deleted_.push_back(false);
+                if (!expiresAt_.empty())
+                    expiresAt_.push_back(std::numeric_limits<db::TtlClock::rep>::max());
+                pkIndex_[record.id] = idx;
+                addCompositeEntries(idx);
+                ++result.inserted;
+                ++mutations_;
+                if (changeStream_)
+                    changeStream_->publish(db::ChangeType::Insert, record.id, idx, &record);
+                for (const auto &view : views_)
+                    view->insert(idx, record);
+                continue;
+            }
+
+            auto &fields = records_[idx].fields;
+            if (std::ranges::all_of(record.fields, [&](const auto &field)
+                                    { auto it = fields.find(field.first);
+                                      return it != fields.end() && it->second == field.second; }))
+            {
+                ++result.unchanged;
+                continue;
+            }
+            if (idx < firstAppended && !secondaryIndexedColumns_.empty() && !original.contains(idx))
+            {
+                auto &values = original[idx];
+                for (const auto &column : secondaryIndexedColumns_)
+                    values.push_back(getField(idx, column));
+            }
+            removeCompositeEntries(idx, &record.fields);
+            for (const auto &[column, value] : record.fields)
+                fields.insert_or_assign(column, value);
+            addCompositeEntries(idx, &record.fields);
+            ++result.updated;
+            ++mutations_;
+            if (changeStream_)
+                changeStream_->publish(db::ChangeType::Update, record.id, idx, &records_[idx]);
+            for (const auto &view : views_)
+            {
+                view->erase(idx);
+                view->insert(idx, records_[idx]);
+            }
+        }
+
+        size_t column = 0;
+        for (const auto &name : secondaryIndexedColumns_)
+        {
+            std::map<db::FieldType, std::vector<size_t>> removals, additions;
+            for (const auto &[idx, values] : original)
+            {
+                db::FieldType after = getField(idx, name);
+                if (after == values[column])
+                    continue;
+                removals[values[column]].push_back(idx);
+                additions[std::move(after)].push_back(idx);
+            }
+            for (size_t idx = firstAppended; idx < records_.size(); ++idx)
+                additions[getField(idx, name)].push_back(idx);
+            applySecondaryIndexDeltas(name, removals, additions);
+            ++column;
+        }
+        return result;
+    }
+
+    /**
+     * Apply the operations of a transaction in order, all or none, see QBTable::commit()
+     * Schema enforcement is part of validation: an insert or update naming a column the table does not have
+     * fails the commit before anything is applied. Derived columns are re-read for every updated record.
+     */
+    db::CommitResult QBTableDynamic::commit(const db::QBDynamicTransaction &txn)
+    {
+        QB_TRACE_SPAN("QBTableDynamic::commit", txn.size());
+        db::CommitResult result;
+        const auto &operations = txn.operations();
+        auto knownColumns = [&](const auto &fields)
+        {
+            return std::ranges::all_of(fields, [&](const auto &field)
+                                       { return columns_.contains(field.first); });
+        };
+
+        // live - whether an id exists after the operations validated so far, for ids the transaction touched
+        std::unordered_map<db::uint, bool> live;
+        std::vector<size_t> expiredHits;
+        const auto now = expiryNow();
+        size_t inserts = 0;
+        for (size_t i = 0; i < operations.size(); ++i)
+        {
+            const auto &operation = operations[i];
+            bool present;
+            if (auto it = live.find(operation.id); it != live.end())
+                present = it->second;
+            else
+            {
+                auto pkIt = pkIndex_.find(operation.id);
+                present = pkIt != pkIndex_.end() && !expired(pkIt->second, now);
+                if (pkIt != pkIndex_.end() && !present)
+                    expiredHits.push_back(pkIt->second);
+            }
+            const bool valid = operation.op == db::TransactionOp::Insert   ? !present && knownColumns(operation.record.fields)
+                               : operation.op == db::TransactionOp::Update ? present && knownColumns(operation.changes)
+                                                                           : present;
+            if (!valid)
+            {
+                result.failedOperation = i;
+                return result;
+            }
+            live[operation.id] = operation.op != db::TransactionOp::Delete;
+            inserts += operation.op == db::TransactionOp::Insert;
+        }
+
+        // an expired record is replaced by the insert of its id - purge it first, as addRecord() does
+        if (!expiredHits.empty())
+            softDeleteRecords(expiredHits);
+        // grow geometrically - an exact reserve would reallocate on every call of a stream of small batches
+        if (records_.size() + inserts > records_.capacity())
+        {
+            records_.reserve(std::max(records_.size() + inserts, 2 * records_.capacity()));
+            deleted_.reserve(records_.capacity());
         }
+
+        const size_t firstAppended = records_.size();
+        std::unordered_map<size_t, std::vector<db::FieldType>> original;
+        auto remember = [&](size_t idx)
+        {
+            if (idx >= firstAppended || secondaryIndexedColumns_.empty() || original.contains(idx))
+                return;
+            auto &values = original[idx];
+            for (const auto &column : secondaryIndexedColumns_)
+                values.push_back(getField(idx, column));
+        };
+
+        for (const auto &operation : operations)
+        {
+            switch (operation.op)
+            {
+            case db::TransactionOp::Insert:
+            {
+                const size_t idx = records_.size();
+                records_.push_back(operation.record);
+                deleted_.push_back(false);
+                if (!expiresAt_.empty())
+                    expiresAt_.push_back(std::numeric_limits<db::TtlClock::rep>::max());
+                pkIndex_[operation.id] = idx;
+                addCompositeEntries(idx);
+                ++result.inserted;
+                ++mutations_;
+                if (changeStream_)
+                    changeStream_->publish(db::ChangeType::Insert, operation.id, idx, &records_[idx]);
+                for (const auto &view : views_)
+                    view->insert(idx, records_[idx]);
+                break;
+            }
+            case db::TransactionOp::Update:
+            {
+                const size_t idx = pkIndex_.at(operation.id);
+                auto &fields = records_[idx].fields;
+                if (std::ranges::all_of(operation.changes, [&](const auto &change)
+                                        { auto it = fields.find(change.first);
+                                          return it != fields.end() && it->second == change.second; }))
+                    break;
+                remember(idx);
+                removeCompositeEntries(idx, &operation.changes);
+                for (const auto &[column, value] : operation.changes)
+                    fields.insert_or_assign(column, value);
+                addCompositeEntries(idx, &operation.changes);
+                ++result.updated;
+                ++mutations_;
+                if (changeStream_)
+                    changeStream_->publish(db::ChangeType::Update, operation.id, idx, &records_[idx]);
+                for (const auto &view : views_)
+                {
+                    view->erase(idx);
+                    view->insert(idx, records_[idx]);
+                }
+                break;
+            }
+            case db::TransactionOp::Delete:
+            {
+                auto pkIt = pkIndex_.find(operation.id);
+                const size_t idx = pkIt->second;
+                remember(idx);
+                removeCompositeEntries(idx);
+                deleted_[idx] = true;
+                pkIndex_.erase(pkIt);
+                ++result.deleted;
+                ++mutations_;
+                if (changeStream_)
+                    changeStream_->publish(db::ChangeType::SoftDelete, operation.id, idx);
+                for (const auto &view : views_)
+                    view->erase(idx);
+                break;
+            }
+            }
+        }
+
+        size_t column = 0;
+        for (const auto &name : secondaryIndexedColumns_)
+        {
+            std::map<db::FieldType, std::vector<size_t>> removals, additions;
+            for (const auto &[idx, values] : original)
+            {
+                if (deleted_[idx])
+                {
+                    removals[values[column]].push_back(idx);
+                    continue;
+                }
+                db::FieldType after = getField(idx, name);
+                if (after == values[column])
+                    continue;
+                removals[values[column]].push_back(idx);
+                additions[std::move(after)].push_back(idx);
+            }
+            for (size_t idx = firstAppended; idx < records_.size(); ++idx)
+                if (!deleted_[idx])
+                    additions[getField(idx, name)].push_back(idx);
+            applySecondaryIndexDeltas(name, removals, additions);
+            ++column;
+        }
+        result.committed = true;
+        return result;
     }
+
+    /**
+     * Remove and add postings of one indexed column, one pass over each affected posting list
+     */
+    void QBTableDynamic::applySecondaryIndexDeltas(const std::string &column, std::map<db::FieldType, std::vector<size_t>> &removals,
+                                                   std::map<db::FieldType, std::vector<size_t>> &additions)
+    {
+        for (auto &[key, leaving] : removals)
+        {
+            auto it = secondaryIndexes_.find({column, key});
+            if (it == secondaryIndexes_.end())
+                continue;
+            std::sort(leaving.begin(), leaving.end());
+            auto &indices = it->second;
+            indices.erase(std::remove_if(indices.begin(), indices.end(), [&](size_t idx)
+                                         { return std::binary_search(leaving.begin(), leaving.end(), idx); }),
+                          indices.end());
+            if (indices.empty())
+                secondaryIndexes_.erase(it);
+        }
+        for (auto &[key, entering] : additions)
+        {
+            std::sort(entering.begin(), entering.end());
+            auto &indices = secondaryIndexes_[{column, key}];
+            const auto middle = static_cast<std::ptrdiff_t>(indices.size());
+            indices.insert(indices.end(), entering.begin(), entering.end());
+            if (middle > 0 && indices[size_t(middle) - 1] > entering.front())
+                std::inplace_merge(indices.begin(), indices.begin() + middle, indices.end());
+        }
+    }
+
+    /**
+     * Move one record's posting between two keys of a secondary index, keeping postings in storage order
+     */
+    void QBTableDynamic::moveSecondaryIndexEntry(const std::string &column, const db::FieldType &from, const db::FieldType &to, size_t recordIdx)
+    {
+        auto it = secondaryIndexes_.find({column, from});
+        if (it != secondaryIndexes_.end())
+        {
+            auto &vec = it->second;
+            auto pos = std::lower_bound(vec.begin(), vec.end(), recordIdx);
+            if (pos != vec.end() && *pos == recordIdx)
+                vec.erase(pos);
+            if (vec.empty())
+                secondaryIndexes_.erase(it);
+        }
+        auto &vec = secondaryIndexes_[{column, to}];
+        vec.insert(std::lower_bound(vec.begin(), vec.end(), recordIdx), recordIdx);
+    }
+
     /**
      * Add a new column to the table schema
      * Updates all existing records with the default value for the type if not provided
@@ -116,10 +809,13 @@ namespace db
     {
         if (!columns_.insert(name).second)
             return false;
+        columnStats_.try_emplace(name);
 
         // add a new column/field to each record with a default value if not provided
         for (auto &r : records_)
             r.fields.emplace(name, defaultValue);
+        for (const auto &view : views_)
+            populateView(*view);
         return true;
     }
     /**
@@ -130,11 +826,20 @@ namespace db
     void QBTableDynamic::removeColumn(const std::string &name)
     {
         columns_.erase(name);
+        if (!derivedColumns_.contains(name))
+            columnStats_.erase(name);
         secondaryIndexedColumns_.erase(name);
+        indexUsage_.erase(name);
         secondaryIndexes_.erase({name, {}}); // full cleanup
+        std::erase_if(compositeIndexes_, [&](const auto &entry)
+                      { return std::ranges::find(entry.first, name) != entry.first.end(); });
+        std::erase_if(compositeUsage_, [&](const auto &entry)
+                      { return std::ranges::find(entry.first, name) != entry.first.end(); });
 
         for (auto &r : records_)
             r.fields.erase(name);
+        for (const auto &view : views_)
+            populateView(*view);
     }
     /**
      * Add a derived column with a custom computation function
@@ -146,8 +851,24 @@ namespace db
             return false; // name conflicts with physical column
 
         derivedColumns_[name] = func;
+        columnStats_.try_emplace(name);
         return true;
     }
+    /**
+     * List the table's physical columns, starting with the primary key "id"
+     */
+    std::vector<std::string> QBTableDynamic::columnNames() const
+    {
+        std::vector<std::string> names{"id"};
+        names.insert(names.end(), columns_.begin(), columns_.end());
+        return names;
+    }
+
+    bool QBTableDynamic::hasColumn(const std::string &name) const
+    {
+        return name == "id" || columns_.contains(name);
+    }
+
     /**
      * Get the value of a column for a specific record, handling both physical and derived columns
       * This is used internally for indexing and querying
@@ -166,6 +887,68 @@ namespace db
 
         throw std::runtime_error("Unknown column: " + column);
     }
+
+    bool QBTableDynamic::fieldEquals(size_t recordIdx, const std::string &column, const db::FieldType &value) const
+    {
+        const auto &rec = records_[recordIdx];
+        if (column == "id")
+        {
+            const auto *id = std::get_if<db::uint>(&value);
+            return id && *id == rec.id;
+        }
+        if (auto it = rec.fields.find(column); it != rec.fields.end())
+            return it->second == value;
+        if (auto dit = derivedColumns_.find(column); dit != derivedColumns_.end())
+            return dit->second(rec) == value;
+        return false;
+    }
+
+    db::CompositeIndex::Key QBTableDynamic::compositeKey(size_t recordIdx, const std::vector<std::string> &columns) const
+    {
+        db::CompositeIndex::Key key;
+        key.reserve(columns.size());
+        for (const auto &column : columns)
+            key.push_back(getField(recordIdx, column));
+        return key;
+    }
+
+    /**
+     * Whether a record's entry in the composite index over columns may change - always without changes, else
+     * when one of the columns is changed or derived, as a derived column may depend on the changed ones
+     */
+    bool QBTableDynamic::compositeChanges(const std::vector<std::string> &columns, const std::unordered_map<std::string, db::FieldType> *changes) const
+    {
+        return !changes || std::ranges::any_of(columns, [&](const std::string &column)
+                                               { return changes->contains(column) || derivedColumns_.contains(column); });
+    }
+
+    void QBTableDynamic::addCompositeEntries(size_t recordIdx, const std::unordered_map<std::string, db::FieldType> *changes)
+    {
+        for (auto &[columns, index] : compositeIndexes_)
+            if (compositeChanges(columns, changes))
+                index.add(compositeKey(recordIdx, columns), recordIdx);
+    }
+
+    void QBTableDynamic::removeCompositeEntries(size_t recordIdx, const std::unordered_map<std::string, db::FieldType> *changes)
+    {
+        for (auto &[columns, index] : compositeIndexes_)
+            if (compositeChanges(columns, changes))
+                index.remove(compositeKey(recordIdx, columns), recordIdx);
+    }
+
+    /**
+     * Rebuild the composite indexes after records changed position - hard delete and compaction
+     */
+    void QBTableDynamic::rebuildCompositeIndexes()
+    {
+        for (auto &[columns, index] : compositeIndexes_)
+        {
+            index.clear();
+            for (size_t i = 0; i < records_.size(); ++i)
+                if (!deleted_[i])
+                    index.add(compositeKey(i, columns), i);
+        }
+    }
     /**
      * Rebuild the index for a specific secondary column
      * Called when createIndex() is invoked for non-PK columns
@@ -205,8 +988,23 @@ namespace db
             if (!columns_.contains(key))
                 return false; // invalid column
 
+        if (!expiresAt_.empty())
+        {
+            // a record with the same id that expired but was not purged yet is replaced
+            auto it = pkIndex_.find(record.id);
+            if (it != pkIndex_.end() && expired(it->second, expiryNow()))
+            {
+                std::vector<size_t> stale{it->second};
+                softDeleteRecords(stale);
+            }
+            expiresAt_.push_back(std::numeric_limits<db::TtlClock::rep>::max());
+        }
         size_t idx = records_.size();
-        records_.push_back(record);
+        {
+            // push_back at capacity reallocates and moves every record
+            QB_TRACE_SPAN_IF(records_.size() == records_.capacity(), "QBTableDynamic::records_ reallocation", records_.size());
+            records_.push_back(record);
+        }
         deleted_.push_back(false);
 
         pkIndex_[record.id] = idx;
@@ -216,6 +1014,13 @@ namespace db
             db::FieldType v = getField(idx, col);
             secondaryIndexes_[{col, v}].push_back(idx);
         }
+        addCompositeEntries(idx);
+
+        ++mutations_;
+        if (changeStream_)
+            changeStream_->publish(db::ChangeType::Insert, record.id, idx, &record);
+        for (const auto &view : views_)
+            view->insert(idx, record);
         return true;
     }
     /*
@@ -228,6 +1033,8 @@ namespace db
 
         if (!secondaryIndexedColumns_.insert(column).second)
             return;
+        indexUsage_[column] = {};
+        QB_TRACE_SPAN("QBTableDynamic::createIndex", records_.size());
 
         rebuildSecondaryIndex(column);
     }
@@ -239,6 +1046,7 @@ namespace db
         if (column == "id")
             throw std::runtime_error("Cannot drop index on primary key column");
         secondaryIndexedColumns_.erase(column);
+        indexUsage_.erase(column);
         auto it = secondaryIndexes_.begin();
         while (it != secondaryIndexes_.end())
         {
@@ -248,11 +1056,61 @@ namespace db
                 ++it;
         }
     }
+
+    bool QBTableDynamic::isColumnIndexed(const std::string &column) const
+    {
+        return column == "id" || secondaryIndexedColumns_.contains(column);
+    }
+
+    /**
+     * Create an index over several columns - its keys are the columns' values in the given order
+     */
+    void QBTableDynamic::createCompositeIndex(std::vector<std::string> columns)
+    {
+        if (columns.size() < 2)
+            throw std::runtime_error("A composite index needs at least two columns");
+        for (size_t i = 0; i < columns.size(); ++i)
+        {
+            if (!columns_.contains(columns[i]) && !derivedColumns_.contains(columns[i]))
+                throw std::runtime_error("Cannot index unknown column");
+            if (std::find(columns.begin(), columns.begin() + static_cast<std::ptrdiff_t>(i), columns[i]) != columns.begin() + static_cast<std::ptrdiff_t>(i))
+                throw std::runtime_error("Cannot repeat a column in a composite index");
+        }
+        if (compositeIndexes_.contains(columns))
+            throw std::runtime_error("Composite index already exists");
+
+        QB_TRACE_SPAN("QBTableDynamic::createCompositeIndex", records_.size());
+        db::CompositeIndex index;
+        for (size_t i = 0; i < records_.size(); ++i)
+            if (!deleted_[i])
+                index.add(compositeKey(i, columns), i);
+        compositeUsage_[columns] = {};
+        compositeIndexes_.emplace(std::move(columns), std::move(index));
+    }
+
+    void QBTableDynamic::dropCompositeIndex(const std::vector<std::string> &columns)
+    {
+        compositeIndexes_.erase(columns);
+        compositeUsage_.erase(columns);
+    }
+
+    bool QBTableDynamic::hasCompositeIndex(const std::vector<std::string> &columns) const
+    {
+        return compositeIndexes_.contains(columns);
+    }
     /**
      * Get count of active records
      */
     size_t QBTableDynamic::activeRecordsCount() const noexcept
     {
+        if (!expiresAt_.empty())
+        {
+            const auto now = expiryNow();
+            size_t active = 0;
+            for (size_t i = 0; i < records_.size(); ++i)
+                active += !deleted_[i] && !expired(i, now);
+            return active;
+        }
         // static_cast to size_t to avoid signed/unsigned comparison warnings
         return static_cast<size_t>(std::count_if(deleted_.begin(), deleted_.end(), [](bool del) -> bool
                                                  { return !del; }));
@@ -265,34 +1123,330 @@ namespace db
         return records_.size();
     }
 
+    /**
+     * Snapshot access path counters per column and usage of the primary key and secondary indexes
+     */
+    db::QBTableDynamicStats QBTableDynamic::stats() const
+    {
+        db::QBTableDynamicStats snapshot;
+        for (const auto &[column, live] : columnStats_)
+        {
+            const db::AccessPathCounters counters = live.snapshot();
+            if (counters.pkLookups + counters.secondaryIndexLookups + counters.linearScans > 0)
+                snapshot.columns[column] = counters;
+            snapshot.table += counters;
+        }
+        snapshot.table += scanStats_.snapshot();
+        snapshot.indexes["id"] = indexUsage_.at("id").snapshot();
+        for (const auto &column : secondaryIndexedColumns_)
+        {
+            auto it = indexUsage_.find(column);
+            snapshot.indexes[column] = (it != indexUsage_.end()) ? it->second.snapshot() : db::IndexUsage{};
+        }
+        for (const auto &[columns, index] : compositeIndexes_)
+        {
+            auto it = compositeUsage_.find(columns);
+            snapshot.compositeIndexes[columns] = (it != compositeUsage_.end()) ? it->second.snapshot() : db::IndexUsage{};
+        }
+        snapshot.mutations = mutations_;
+        return snapshot;
+    }
+
+    /**
+     * Reset all access path counters and index usage
+     */
+    void QBTableDynamic::resetStats() noexcept
+    {
+        for (auto &[column, counters] : columnStats_)
+            counters = {};
+        for (auto &[column, usage] : indexUsage_)
+            usage = {};
+        for (auto &[columns, usage] : compositeUsage_)
+            usage = {};
+        scanStats_ = {};
+        mutations_ = 0;
+    }
+
+    /**
+     * Attach a query log - every findMatching() call is then timed and aggregated under tableName
+     */
+    void QBTableDynamic::setQueryLog(std::shared_ptr<db::QueryLog> queryLog, std::string tableName)
+    {
+        queryLog_ = std::move(queryLog);
+        queryLogTable_ = std::move(tableName);
+    }
+
+    /**
+     * Attach a change stream that receives every addRecord, delete and compaction from now on
+     */
+    void QBTableDynamic::setChangeStream(std::shared_ptr<db::QBDynamicChangeStream> changeStream)
+    {
+        changeStream_ = std::move(changeStream);
+    }
+
+    /**
+     * Evaluate a view over every active record, replacing whatever it held
+     */
+    void QBTableDynamic::populateView(db::QBDynamicMaterializedView &view) const
+    {
+        view.clear();
+        for (size_t i = 0; i < records_.size(); ++i)
+            if (!deleted_[i])
+                view.insert(i, records_[i]);
+    }
+
+    /**
+     * Attach a materialized view - a view belongs to one table at a time
+     */
+    void QBTableDynamic::addView(std::shared_ptr<db::QBDynamicMaterializedView> view)
+    {
+        populateView(*view);
+        views_.push_back(std::move(view));
+    }
+
+    bool QBTableDynamic::removeView(const std::shared_ptr<db::QBDynamicMaterializedView> &view)
+    {
+        auto it = std::find(views_.begin(), views_.end(), view);
+        if (it == views_.end())
+            return false;
+        views_.erase(it);
+        return true;
+    }
+
+    /**
+     * Describe the access path findMatching() takes for a query, with the rows it would examine
+     */
+    std::string QBTableDynamic::explain(const std::string &column, const db::FieldType &value) const
+    {
+        const std::string literal = db::fieldToString(value);
+        if (column == "id")
+        {
+            auto it = std::holds_alternative<db::uint>(value) ? pkIndex_.find(std::get<db::uint>(value)) : pkIndex_.end();
+            return "PRIMARY KEY LOOKUP on id = " + literal + " (examines " +
+                   std::to_string(it != pkIndex_.end() ? 1 : 0) + " row)";
+        }
+        if (secondaryIndexedColumns_.contains(column))
+        {
+            auto it = secondaryIndexes_.find({column, value});
+            size_t postings = (it == secondaryIndexes_.end()) ? 0 : it->second.size();
+            return "INDEX LOOKUP on " + column + " = " + literal + " (examines " + std::to_string(postings) + " postings)";
+        }
+        return "LINEAR SCAN on " + column + " = " + literal + " (examines " + std::to_string(records_.size()) +
+               " rows, " + std::to_string(records_.size() - activeRecordsCount()) + " deleted)";
+    }
+
+    /**
+     * Describe the access path findMatchingAll() takes for a conjunction of conditions
+     */
+    std::string QBTableDynamic::explain(std::span<const db::DynamicColumnMatch> conditions) const
+    {
+        if (conditions.empty())
+            return "NO ROWS: no conditions";
+        std::string where;
+        for (const auto &[column, value] : conditions)
+        {
+            if (!where.empty())
+                where += " AND ";
+            where += column;
+            where += " = ";
+            where += db::fieldToString(value);
+        }
+        auto valueOf = [&](const std::string &column) -> const db::FieldType *
+        {
+            for (const auto &condition : conditions)
+                if (condition.column == column)
+                    return &condition.value;
+            return nullptr;
+        };
+
+        if (valueOf("id"))
+            return "PRIMARY KEY LOOKUP on id (examines at most 1 row) for " + where;
+
+        auto [composite, prefixLength] = db::longestCompositePrefix(compositeIndexes_, [&](const std::string &column)
+                                                                    { return valueOf(column) != nullptr; });
+        if (composite != compositeIndexes_.end())
+        {
+            db::CompositeIndex::Key prefix;
+            std::string columns;
+            for (size_t i = 0; i < composite->first.size(); ++i)
+            {
+                if (i)
+                    columns += ", ";
+                columns += composite->first[i];
+                if (i < prefixLength)
+                    prefix.push_back(*valueOf(composite->first[i]));
+            }
+            size_t postings = 0;
+            composite->second.forEachPrefix(prefix, [&](const std::vector<size_t> &indices)
+                                            { postings += indices.size(); });
+            return "COMPOSITE INDEX LOOKUP on (" + columns + ") using " + std::to_string(prefixLength) + " of " +
+                   std::to_string(composite->first.size()) + " columns (examines " + std::to_string(postings) + " postings) for " + where;
+        }
+
+        std::string intersected;
+        size_t shortest = std::numeric_limits<size_t>::max();
+        for (const auto &[column, value] : conditions)
+        {
+            if (!secondaryIndexedColumns_.contains(column))
+                continue;
+            auto it = secondaryIndexes_.find({column, value});
+            shortest = std::min(shortest, it == secondaryIndexes_.end() ? size_t(0) : it->second.size());
+            if (!intersected.empty())
+                intersected += ", ";
+            intersected += column;
+        }
+        if (!intersected.empty())
+            return "INDEX INTERSECTION of " + intersected + " (examines " + std::to_string(shortest) + " postings of the shortest list) for " + where;
+        return "LINEAR SCAN (examines " + std::to_string(records_.size()) + " rows) for " + where;
+    }
+
     /**
      * Compact the collection by removing deleted records
      * Rebuilds primary and secondary indexes with new positions
      */
     void QBTableDynamic::compactRecords()
     {
+        QB_TRACE_SPAN("QBTableDynamic::compactRecords", records_.size());
         // Count active records
         size_t activeCount = activeRecordsCount();
 
         std::vector<QBRecordDynamic> compacted;
         compacted.reserve(activeCount); // only allocate needed space
 
-        // move active records
+        // move active records, noting the ones that change position for change data capture
+        std::vector<db::RecordMove> moves;
+        std::vector<db::TtlClock::rep> compactedExpiry;
+        compactedExpiry.reserve(expiresAt_.empty() ? 0 : activeCount);
         size_t i = 0;
         std::for_each(records_.begin(), records_.end(), [&](QBRecordDynamic &rec)
                       { 
                         if (!deleted_[i])
-                        compacted.push_back(std::move(rec));
+                        {
+                            if ((changeStream_ || !views_.empty()) && compacted.size() != i)
+                                moves.push_back({i, compacted.size()});
+                            compacted.push_back(std::move(rec));
+                            if (!expiresAt_.empty())
+                                compactedExpiry.push_back(expiresAt_[i]);
+                        }
                         ++i; });
 
         records_ = std::move(compacted);
         deleted_.assign(records_.size(), false);
+        if (!expiresAt_.empty())
+            expiresAt_ = std::move(compactedExpiry);
 
         // rebuild all indexes
+        QB_TRACE_SPAN("QBTableDynamic::compactRecords index rebuild", records_.size());
         rebuildPrimaryIndex();
         secondaryIndexes_.clear();
         for (const auto &column : secondaryIndexedColumns_)
             rebuildSecondaryIndex(column);
+        rebuildCompositeIndexes();
+
+        // soft deleted records already left the views - moves are in ascending order, so every target is vacant
+        for (const auto &view : views_)
+            for (const auto &move : moves)
+                view->move(move.from, move.to);
+        if (changeStream_)
+            changeStream_->publish(db::ChangeType::Compaction, 0, 0, nullptr, std::move(moves));
+    }
+
+    /**
+     * Current time for expiry checks - the clock is only read once a record has a deadline
+     */
+    db::TtlClock::rep QBTableDynamic::expiryNow() const noexcept
+    {
+        return expiresAt_.empty() ? 0 : db::TtlClock::now().time_since_epoch().count();
+    }
+
+    bool QBTableDynamic::expired(size_t recordIdx, db::TtlClock::rep now) const noexcept
+    {
+        return !expiresAt_.empty() && expiresAt_[recordIdx] <= now;
+    }
+
+    /**
+     * Give an active record a deadline, replacing any earlier one, see QBTable::expireRecordAt()
+     */
+    bool QBTableDynamic::expireRecordAt(db::uint id, db::TtlClock::time_point deadline)
+    {
+        auto pkIt = pkIndex_.find(id);
+        if (pkIt == pkIndex_.end() || expired(pkIt->second, expiryNow()))
+            return false;
+        if (expiresAt_.empty())
+            expiresAt_.assign(records_.size(), std::numeric_limits<db::TtlClock::rep>::max());
+        expiresAt_[pkIt->second] = deadline.time_since_epoch().count();
+        expiryWheel_.schedule(id, deadline);
+        return true;
+    }
+
+    bool QBTableDynamic::expireRecordAfter(db::uint id, db::TtlClock::duration ttl)
+    {
+        return expireRecordAt(id, db::TtlClock::now() + ttl);
+    }
+
+    bool QBTableDynamic::clearRecordExpiry(db::uint id)
+    {
+        auto pkIt = pkIndex_.find(id);
+        if (pkIt == pkIndex_.end() || expired(pkIt->second, expiryNow()))
+            return false;
+        if (!expiresAt_.empty())
+            expiresAt_[pkIt->second] = std::numeric_limits<db::TtlClock::rep>::max();
+        return true;
+    }
+
+    /**
+     * Soft delete records whose deadline has passed, at most budget due wheel entries per call,
+     * see QBTable::expireRecords()
+     */
+    size_t QBTableDynamic::expireRecords(size_t budget)
+    {
+        if (expiresAt_.empty())
+            return 0;
+        QB_TRACE_SPAN("QBTableDynamic::expireRecords", expiryWheel_.size());
+        const auto now = db::TtlClock::now();
+        expiryWheel_.advance(now);
+        std::vector<size_t> recordIdxs;
+        expiryWheel_.drain(budget, [&](db::uint id)
+                           {
+                               auto it = pkIndex_.find(id);
+                               if (it != pkIndex_.end() && expired(it->second, now.time_since_epoch().count()))
+                                   recordIdxs.push_back(it->second); });
+        softDeleteRecords(recordIdxs);
+        return recordIdxs.size();
+    }
+
+    size_t QBTableDynamic::pendingExpiries() const noexcept
+    {
+        return expiryWheel_.size();
+    }
+
+    /**
+     * Soft delete a batch of active records - postings are grouped per indexed column and key first,
+     * so each affected posting list is edited once for the whole batch
+     */
+    void QBTableDynamic::softDeleteRecords(std::vector<size_t> &recordIdxs)
+    {
+        std::sort(recordIdxs.begin(), recordIdxs.end());
+        recordIdxs.erase(std::unique(recordIdxs.begin(), recordIdxs.end()), recordIdxs.end());
+        for (const auto &column : secondaryIndexedColumns_)
+        {
+            std::map<db::FieldType, std::vector<size_t>> removals, additions;
+            for (size_t idx : recordIdxs)
+                removals[getField(idx, column)].push_back(idx);
+            applySecondaryIndexDeltas(column, removals, additions);
+        }
+        for (size_t idx : recordIdxs)
+        {
+            const db::uint id = records_[idx].id;
+            removeCompositeEntries(idx);
+            deleted_[idx] = true;
+            pkIndex_.erase(id);
+            ++mutations_;
+            if (changeStream_)
+                changeStream_->publish(db::ChangeType::SoftDelete, id, idx);
+            for (const auto &view : views_)
+                view->erase(idx);
+        }
     }
 
 }
@@ -0,0 +1,512 @@
+#include "../include/Quickbase_fulltext.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <utility>
+
+// Quickbase full-text index definitions
+namespace db
+{
+    namespace
+    {
+        constexpr size_t kEnd = std::numeric_limits<size_t>::max();
+        constexpr uint8_t kAbsent = 0, kLive = 1, kRemoved = 2;
+
+        bool tokenByte(unsigned char c) noexcept
+        {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c >= 0x80;
+        }
+
+        void putVarint(std::vector<uint8_t> &bytes, uint64_t value)
+        {
+            while (value >= 0x80)
+            {
+                bytes.push_back(static_cast<uint8_t>(value | 0x80));
+                value >>= 7;
+            }
+            bytes.push_back(static_cast<uint8_t>(value));
+        }
+
+        uint64_t getVarint(const uint8_t *bytes, size_t &pos) noexcept
+        {
+            uint64_t value = 0;
+            for (int shift = 0;; shift += 7)
+            {
+                const uint8_t byte = bytes[pos++];
+                value |= uint64_t(byte & 0x7f) << shift;
+                if (byte < 0x80)
+                    return value;
+            }
+        }
+
+        // append a posting after the last one - a block codes its first row against the last row of the previous one
+        void appendPosting(db::FullTextIndex::PostingList &list, size_t row, uint32_t tf)
+        {
+            size_t previous = list.blocks.empty() ? 0 : list.blocks.back().lastRow;
+            if (list.blocks.empty() || list.blocks.back().count == db::FullTextIndex::kBlockSize)
+                list.blocks.push_back({row, list.bytes.size(), 0});
+            putVarint(list.bytes, row - previous);
+            putVarint(list.bytes, tf);
+            list.blocks.back().lastRow = row;
+            ++list.blocks.back().count;
+        }
+
+        std::vector<std::pair<size_t, uint32_t>> decodeAll(const db::FullTextIndex::PostingList &list)
+        {
+            std::vector<std::pair<size_t, uint32_t>> postings;
+            size_t previous = 0;
+            for (const auto &block : list.blocks)
+            {
+                size_t pos = block.offset;
+                for (uint32_t i = 0; i < block.count; ++i)
+                {
+                    previous += getVarint(list.bytes.data(), pos);
+                    postings.emplace_back(previous, static_cast<uint32_t>(getVarint(list.bytes.data(), pos)));
+                }
+            }
+            return postings;
+        }
+
+        // PostingCursor - walks a posting list in row order, row is kEnd past the last posting
+        class PostingCursor
+        {
+        private:
+            const db::FullTextIndex::PostingList *list_;
+            size_t &decoded_;
+            size_t block_ = 0;
+            size_t pos_ = 0;
+            uint32_t left_ = 0;
+            size_t previous_ = 0;
+
+            void enter(size_t block)
+            {
+                block_ = block;
+                pos_ = list_->blocks[block].offset;
+                left_ = list_->blocks[block].count;
+                previous_ = block == 0 ? 0 : list_->blocks[block - 1].lastRow;
+            }
+
+        public:
+            size_t row = kEnd;
+            uint32_t tf = 0;
+
+            PostingCursor(const db::FullTextIndex::PostingList &list, size_t &decoded) : list_(&list), decoded_(decoded)
+            {
+                if (!list.blocks.empty())
+                {
+                    enter(0);
+                    next();
+                }
+            }
+
+            void next()
+            {
+                if (left_ == 0)
+                {
+                    if (block_ + 1 >= list_->blocks.size())
+                    {
+                        row = kEnd;
+                        return;
+                    }
+                    enter(block_ + 1);
+                }
+                row = previous_ + getVarint(list_->bytes.data(), pos_);
+                previous_ = row;
+                tf = static_cast<uint32_t>(getVarint(list_->bytes.data(), pos_));
+                --left_;
+                ++decoded_;
+            }
+
+            // move to the first posting not below target, skipping blocks that end before it undecoded
+            void seek(size_t target)
+            {
+                if (row >= target)
+                    return;
+                const auto &blocks = list_->blocks;
+                if (blocks[block_].lastRow < target)
+                {
+                    auto it = std::partition_point(blocks.begin() + static_cast<std::ptrdiff_t>(block_ + 1), blocks.end(),
+                                                   [target](const db::FullTextIndex::Block &block)
+                                                   { return block.lastRow < target; });
+                    if (it == blocks.end())
+                    {
+                        row = kEnd;
+                        left_ = 0;
+                        block_ = blocks.size();
+                        return;
+                    }
+                    enter(static_cast<size_t>(it - blocks.begin()));
+                    next();
+                }
+                while (row < target)
+                    next();
+            }
+        };
+    }
+
+    Tokenizer::Tokenizer(db::TokenizerOptions options) : options_(std::move(options))
+    {
+        for (const auto &word : options_.stopWords)
+        {
+            std::string normalized = word;
+            if (options_.lowercase)
+                std::transform(normalized.begin(), normalized.end(), normalized.begin(), [](unsigned char c)
+                               { return static_cast<char>(c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c); });
+            stopWords_.insert(std::move(normalized));
+        }
+    }
+
+    std::vector<std::string> Tokenizer::tokenize(std::string_view text) const
+    {
+        std::vector<std::string> tokens;
+        std::string token;
+        size_t length = 0;
+        bool digitsOnly = true;
+        auto finish = [&]
+        {
+            if (length >= options_.minLength && (options_.keepDigits || !digitsOnly) && !stopWords_.contains(token))
+                tokens.push_back(token);
+            token.clear();
+            length = 0;
+            digitsOnly = true;
+        };
+        for (char ch : text)
+        {
+            const auto c = static_cast<unsigned char>(ch);
+            if (!tokenByte(c))
+            {
+                if (length > 0)
+                    finish();
+                continue;
+            }
+            ++length;
+            digitsOnly = digitsOnly && c >= '0' && c <= '9';
+            if (token.size() < options_.maxLength)
+                token += static_cast<char>(options_.lowercase && c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c);
+        }
+        if (length > 0)
+            finish();
+        return tokens;
+    }
+
+    FullTextIndex::FullTextIndex(db::TokenizerOptions tokenizer, db::Bm25Options bm25)
+        : tokenizer_(std::move(tokenizer)), bm25_(bm25)
+    {
+    }
+
+    std::vector<std::pair<std::string, uint32_t>> FullTextIndex::termFrequencies(std::string_view text, uint32_t &length) const
+    {
+        std::vector<std::string> tokens = tokenizer_.tokenize(text);
+        length = static_cast<uint32_t>(tokens.size());
+        std::sort(tokens.begin(), tokens.end());
+        std::vector<std::pair<std::string, uint32_t>> frequencies;
+        for (auto &token : tokens)
+        {
+            if (!frequencies.empty() && frequencies.back().first == token)
+                ++frequencies.back().second;
+            else
+                frequencies.emplace_back(std::move(token), 1);
+        }
+        return frequencies;
+    }
+
+    /**
+     * Add a posting - appended when the row follows the list's last one, otherwise the list is re-encoded
+     */
+    void FullTextIndex::insertPosting(PostingList &list, size_t row, uint32_t tf)
+    {
+        if (list.blocks.empty() || row > list.blocks.back().lastRow)
+            appendPosting(list, row, tf);
+        else
+        {
+            auto postings = decodeAll(list);
+            postings.insert(std::lower_bound(postings.begin(), postings.end(), std::make_pair(row, uint32_t(0))), {row, tf});
+            list.bytes.clear();
+            list.blocks.clear();
+            for (const auto &[posted, frequency] : postings)
+                appendPosting(list, posted, frequency);
+        }
+        ++list.live;
+        list.maxTf = std::max(list.maxTf, tf);
+        list.minLength = std::min(list.minLength, lengths_[row]);
+    }
+
+    /**
+     * Re-encode a list with the postings of live rows other than droppedRow, tightening its score bound
+     */
+    void FullTextIndex::rewrite(PostingList &list, size_t droppedRow)
+    {
+        const auto postings = decodeAll(list);
+        list.bytes.clear();
+        list.blocks.clear();
+        list.live = list.dead = list.maxTf = 0;
+        list.minLength = UINT32_MAX;
+        for (const auto &[row, tf] : postings)
+        {
+            if (row == droppedRow || states_[row] != kLive)
+                continue;
+            appendPosting(list, row, tf);
+            ++list.live;
+            list.maxTf = std::max(list.maxTf, tf);
+            list.minLength = std::min(list.minLength, lengths_[row]);
+        }
+        list.bytes.shrink_to_fit();
+    }
+
+    void FullTextIndex::add(size_t row, std::string_view text)
+    {
+        if (row < states_.size() && states_[row] != kAbsent)
+            throw std::runtime_error("Full-text index row " + std::to_string(row) + " was already added");
+        if (row >= states_.size())
+        {
+            states_.resize(row + 1, kAbsent);
+            lengths_.resize(row + 1, 0);
+        }
+        uint32_t length = 0;
+        auto frequencies = termFrequencies(text, length);
+        states_[row] = kLive;
+        lengths_[row] = length;
+        ++documents_;
+        totalLength_ += length;
+        for (auto &[term, tf] : frequencies)
+            insertPosting(terms_[std::move(term)], row, tf);
+    }
+
+    /**
+     * Remove a live row - its postings stay until the dead ones of a list outnumber the live ones
+     */
+    void FullTextIndex::remove(size_t row, std::string_view text)
+    {
+        if (row >= states_.size() || states_[row] != kLive)
+            return;
+        states_[row] = kRemoved;
+        --documents_;
+        totalLength_ -= lengths_[row];
+        uint32_t length = 0;
+        for (const auto &[term, tf] : termFrequencies(text, length))
+        {
+            auto it = terms_.find(term);
+            if (it == terms_.end())
+                continue;
+            PostingList &list = it->second;
+            --list.live;
+            ++list.dead;
+            if (list.live == 0)
+                terms_.erase(it);
+            else if (list.dead > list.live)
+                rewrite(list, kEnd);
+        }
+    }
+
+    /**
+     * Change the text of a live row - terms whose frequency is unchanged keep their posting, the others are
+     * rewritten without the row and the new postings inserted in row order
+     */
+    void FullTextIndex::replace(size_t row, std::string_view oldText, std::string_view newText)
+    {
+        if (row >= states_.size() || states_[row] != kLive)
+            return;
+        uint32_t oldLength = 0, newLength = 0;
+        const auto before = termFrequencies(oldText, oldLength);
+        auto after = termFrequencies(newText, newLength);
+        for (const auto &posting : before)
+        {
+            if (std::binary_search(after.begin(), after.end(), posting))
+                continue;
+            auto it = terms_.find(posting.first);
+            if (it == terms_.end())
+                continue;
+            rewrite(it->second, row);
+            if (it->second.live == 0)
+                terms_.erase(it);
+        }
+        lengths_[row] = newLength;
+        totalLength_ = totalLength_ - oldLength + newLength;
+        for (auto &posting : after)
+        {
+            if (std::binary_search(before.begin(), before.end(), posting))
+            {
+                // the posting stays, the row's new length still has to bound the term's scores
+                auto &list = terms_[posting.first];
+                list.minLength = std::min(list.minLength, newLength);
+                continue;
+            }
+            insertPosting(terms_[std::move(posting.first)], row, posting.second);
+        }
+    }
+
+    void FullTextIndex::clear() noexcept
+    {
+        terms_.clear();
+        lengths_.clear();
+        states_.clear();
+        documents_ = 0;
+        totalLength_ = 0;
+    }
+
+    /**
+     * BM25 top-k with MaxScore
+     * Terms are ordered by score upper bound, from the maxTf and minLength of their list. Once k rows are held,
+     * the leading terms whose bounds sum to at most the k-th score are non-essential: rows only they hold cannot
+     * enter the top k, so candidates come from the essential lists alone and the non-essential ones are sought
+     * to each candidate - from the largest bound down, and only while the candidate can still beat the k-th score.
+     * A candidate's score is summed in the order of the query's terms, so it depends neither on which lists were
+     * essential nor on how tight the bounds of the lists are.
+     */
+    db::FullTextHits FullTextIndex::search(std::string_view query, size_t k, const std::function<bool(size_t)> &accept,
+                                           bool earlyTermination) const
+    {
+        db::FullTextHits hits;
+        if (k == 0 || documents_ == 0)
+            return hits;
+        std::vector<std::string> tokens = tokenizer_.tokenize(query);
+        std::sort(tokens.begin(), tokens.end());
+        tokens.erase(std::unique(tokens.begin(), tokens.end()), tokens.end());
+
+        const double averageLength = totalLength_ ? double(totalLength_) / double(documents_) : 1.0;
+        const double k1 = bm25_.k1, b = bm25_.b;
+        auto termScore = [&](double idf, uint32_t tf, uint32_t length)
+        {
+            return idf * tf * (k1 + 1) / (tf + k1 * (1 - b + b * length / averageLength));
+        };
+        struct QueryTerm
+        {
+            const PostingList *list;
+            double idf;
+            double bound;
+            size_t slot; // position among the query's terms in text order, where its score is summed
+        };
+        std::vector<QueryTerm> terms;
+        for (const auto &token : tokens)
+        {
+            auto it = terms_.find(token);
+            if (it == terms_.end() || it->second.live == 0)
+                continue;
+            const double df = it->second.live;
+            const double idf = std::log(1 + (double(documents_) - df + 0.5) / (df + 0.5));
+            // a hair above the exact bound, so rounding never prunes a row reaching it
+            terms.push_back({&it->second, idf, termScore(idf, it->second.maxTf, it->second.minLength) * (1 + 1e-9), terms.size()});
+        }
+        std::sort(terms.begin(), terms.end(), [](const QueryTerm &a, const QueryTerm &c)
+                  { return a.bound < c.bound; });
+        const size_t n = terms.size();
+        std::vector<double> prefix(n);
+        std::vector<PostingCursor> cursors;
+        cursors.reserve(n);
+        for (size_t i = 0; i < n; ++i)
+        {
+            prefix[i] = terms[i].bound + (i ? prefix[i - 1] : 0);
+            cursors.emplace_back(*terms[i].list, hits.postingsDecoded);
+        }
+
+        // heap of the best rows, the worst on top
+        auto better = [](const db::ScoredRow &a, const db::ScoredRow &c)
+        { return a.score > c.score || (a.score == c.score && a.row < c.row); };
+        std::vector<db::ScoredRow> &heap = hits.rows;
+        double threshold = -1;
+        size_t essential = 0;
+        std::vector<double> contributions(n);
+        while (true)
+        {
+            size_t row = kEnd;
+            for (size_t i = essential; i < n; ++i)
+                row = std::min(row, cursors[i].row);
+            if (row == kEnd)
+                break;
+            std::fill(contributions.begin(), contributions.end(), 0.0);
+            double partial = 0;
+            for (size_t i = essential; i < n; ++i)
+            {
+                if (cursors[i].row != row)
+                    continue;
+                contributions[terms[i].slot] = termScore(terms[i].idf, cursors[i].tf, lengths_[row]);
+                partial += contributions[terms[i].slot];
+                cursors[i].next();
+            }
+            bool reachable = true;
+            for (size_t i = essential; i-- > 0;)
+            {
+                if (partial + prefix[i] <= threshold)
+                {
+                    reachable = false;
+                    break;
+                }
+                cursors[i].seek(row);
+                if (cursors[i].row == row)
+                {
+                    contributions[terms[i].slot] = termScore(terms[i].idf, cursors[i].tf, lengths_[row]);
+                    partial += contributions[terms[i].slot];
+                }
+            }
+            if (!reachable || states_[row] != kLive || (accept && !accept(row)))
+                continue;
+            ++hits.candidates;
+            double score = 0;
+            for (double contribution : contributions)
+                score += contribution;
+            const db::ScoredRow scored{row, score};
+            if (heap.size() < k)
+            {
+                heap.push_back(scored);
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+            else if (better(scored, heap.front()))
+            {
+                std::pop_heap(heap.begin(), heap.end(), better);
+                heap.back() = scored;
+                std::push_heap(heap.begin(), heap.end(), better);
+            }
+            if (heap.size() == k && earlyTermination)
+            {
+                threshold = heap.front().score;
+                while (essential < n && prefix[essential] <= threshold)
+                    ++essential;
+            }
+        }
+        std::sort(heap.begin(), heap.end(), better);
+        return hits;
+    }
+
+    size_t FullTextIndex::documentFrequency(std::string_view term) const
+    {
+        const auto tokens = tokenizer_.tokenize(term);
+        if (tokens.size() != 1)
+            return 0;
+        auto it = terms_.find(tokens.front());
+        return it == terms_.end() ? 0 : it->second.live;
+    }
+
+    size_t FullTextIndex::postingCount() const noexcept
+    {
+        size_t postings = 0;
+        for (const auto &[term, list] : terms_)
+            postings += list.live + list.dead;
+        return postings;
+    }
+
+    size_t FullTextIndex::postingBytes() const noexcept
+    {
+        size_t bytes = 0;
+        for (const auto &[term, list] : terms_)
+            bytes += list.bytes.size() + list.blocks.size() * sizeof(Block);
+        return bytes;
+    }
+
+    /**
+     * Heap held by the index - dictionary nodes and buckets, terms too long for the small string buffer, coded
+     * postings with their capacity and the per row arrays
+     */
+    size_t FullTextIndex::memoryUsage() const noexcept
+    {
+        size_t bytes = terms_.bucket_count() * sizeof(void *) + (lengths_.capacity() * sizeof(uint32_t)) + states_.capacity();
+        for (const auto &[term, list] : terms_)
+        {
+            bytes += sizeof(void *) + sizeof(size_t) + sizeof(std::pair<const std::string, PostingList>);
+            if (term.capacity() > std::string().capacity())
+                bytes += term.capacity() + 1;
+            bytes += list.bytes.capacity() + list.blocks.capacity() * sizeof(Block);
+        }
+        return bytes;
+    }
+}
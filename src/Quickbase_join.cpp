@@ -0,0 +1,316 @@
+#include "../include/Quickbase_join.hpp"
+#include <charconv>
+#include <limits>
+
+// Quickbase join definitions
+namespace db::join
+{
+    namespace
+    {
+        template <typename Number>
+        bool parseNumber(std::string_view text, Number &value)
+        {
+            auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            return result.ec == std::errc{} && result.ptr == text.data() + text.size();
+        }
+
+        std::string columnName(db::ColumnType column)
+        {
+            return "column" + std::to_string(static_cast<int>(column));
+        }
+
+        /**
+         * Residual check of a where() predicate with the rules forEachMatching() applies to this table -
+         * numbers compare equal, strings match exactly when the column is indexed and as a substring otherwise
+         */
+        bool matches(const db::QBTable &table, const db::QBRecord &record, db::ColumnType column, std::string_view matchString)
+        {
+            switch (column)
+            {
+            case db::ColumnType::COLUMN0:
+            {
+                db::uint value = 0;
+                return parseNumber(matchString, value) && record.column0 == value;
+            }
+            case db::ColumnType::COLUMN2:
+            {
+                long value = 0;
+                return parseNumber(matchString, value) && record.column2 == value;
+            }
+            case db::ColumnType::COLUMN1:
+            case db::ColumnType::COLUMN3:
+            {
+                const std::string &text = column == db::ColumnType::COLUMN1 ? record.column1 : record.column3;
+                return table.isColumnIndexed(column) ? text == matchString : text.find(matchString) != std::string::npos;
+            }
+            }
+            return false;
+        }
+
+        bool passes(const db::join::StaticSide &side, const db::QBRecord &record, size_t firstPredicate)
+        {
+            for (size_t i = firstPredicate; i < side.predicates.size(); ++i)
+                if (!matches(*side.table, record, side.predicates[i].first, side.predicates[i].second))
+                    return false;
+            return !side.filter || side.filter(record);
+        }
+
+        std::optional<db::FieldType> fieldOf(const db::QBRecordDynamic &record, const std::string &column)
+        {
+            if (column == "id")
+                return db::FieldType{record.id};
+            auto it = record.fields.find(column);
+            if (it == record.fields.end())
+                return std::nullopt;
+            return it->second;
+        }
+
+        bool passes(const db::join::DynamicSide &side, const db::QBRecordDynamic &record, size_t firstPredicate)
+        {
+            for (size_t i = firstPredicate; i < side.predicates.size(); ++i)
+                if (fieldOf(record, side.predicates[i].first) != side.predicates[i].second)
+                    return false;
+            return !side.filter || side.filter(record);
+        }
+
+        // a numeric join key as a primary key, false when out of range or a string
+        bool asId(const db::join::JoinKey &key, db::uint &id)
+        {
+            const long *number = std::get_if<long>(&key);
+            if (!number || *number < 0 || static_cast<unsigned long>(*number) > std::numeric_limits<db::uint>::max())
+                return false;
+            id = static_cast<db::uint>(*number);
+            return true;
+        }
+
+        /**
+         * Combine two residual predicates with AND
+         */
+        template <typename Record>
+        std::function<bool(const Record &)> conjunction(std::function<bool(const Record &)> first, std::function<bool(const Record &)> second)
+        {
+            if (!first)
+                return second;
+            return [first = std::move(first), second = std::move(second)](const Record &record)
+            { return first(record) && second(record); };
+        }
+    }
+
+    StaticSide &StaticSide::where(db::ColumnType column, std::string matchString)
+    {
+        predicates.emplace_back(column, std::move(matchString));
+        return *this;
+    }
+
+    StaticSide &StaticSide::where(std::function<bool(const db::QBRecord &)> predicate)
+    {
+        filter = conjunction(std::move(filter), std::move(predicate));
+        return *this;
+    }
+
+    DynamicSide &DynamicSide::where(std::string column, db::FieldType value)
+    {
+        predicates.emplace_back(std::move(column), std::move(value));
+        return *this;
+    }
+
+    DynamicSide &DynamicSide::where(std::function<bool(const db::QBRecordDynamic &)> predicate)
+    {
+        filter = conjunction(std::move(filter), std::move(predicate));
+        return *this;
+    }
+
+    db::join::StaticSide side(const db::QBTable &table, db::ColumnType key)
+    {
+        db::join::StaticSide result;
+        result.table = &table;
+        result.key = key;
+        return result;
+    }
+
+    db::join::DynamicSide side(const db::QBTableDynamic &table, std::string key)
+    {
+        db::join::DynamicSide result;
+        result.table = &table;
+        result.key = std::move(key);
+        return result;
+    }
+
+    /**
+     * Candidates of a side - the first where() predicate runs through forEachMatching(), so an indexed column is
+     * read through its index, the others and the filter are checked on each record it returns
+     */
+    size_t scan(const db::join::StaticSide &side, const std::function<void(const db::QBRecord &)> &visit)
+    {
+        size_t visited = 0;
+        auto accept = [&](const db::QBRecord &record)
+        {
+            if (passes(side, record, 1))
+            {
+                visit(record);
+                ++visited;
+            }
+        };
+        if (side.predicates.empty())
+            side.table->forEachRecord([&](const db::QBRecord &record)
+                                      { accept(record); return true; });
+        else
+            side.table->forEachMatching(side.predicates.front().first, side.predicates.front().second, accept);
+        return visited;
+    }
+
+    size_t scan(const db::join::DynamicSide &side, const std::function<void(const db::QBRecordDynamic &)> &visit)
+    {
+        size_t visited = 0;
+        auto accept = [&](const db::QBRecordDynamic &record)
+        {
+            if (passes(side, record, 1))
+            {
+                visit(record);
+                ++visited;
+            }
+        };
+        if (side.predicates.empty())
+            side.table->forEachRecord([&](const db::QBRecordDynamic &record)
+                                      { accept(record); return true; });
+        else
+            side.table->forEachMatching(side.predicates.front().first, side.predicates.front().second, accept);
+        return visited;
+    }
+
+    std::optional<db::join::JoinKey> keyOf(const db::join::StaticSide &side, const db::QBRecord &record)
+    {
+        switch (side.key)
+        {
+        case db::ColumnType::COLUMN0:
+            return db::join::JoinKey{long(record.column0)};
+        case db::ColumnType::COLUMN1:
+            return db::join::JoinKey{record.column1};
+        case db::ColumnType::COLUMN2:
+            return db::join::JoinKey{record.column2};
+        case db::ColumnType::COLUMN3:
+            return db::join::JoinKey{record.column3};
+        }
+        return std::nullopt;
+    }
+
+    std::optional<db::join::JoinKey> keyOf(const db::join::DynamicSide &side, const db::QBRecordDynamic &record)
+    {
+        auto field = fieldOf(record, side.key);
+        if (!field)
+            return std::nullopt;
+        if (const db::uint *number = std::get_if<db::uint>(&*field))
+            return db::join::JoinKey{long(*number)};
+        if (const long *number = std::get_if<long>(&*field))
+            return db::join::JoinKey{*number};
+        return db::join::JoinKey{std::get<std::string>(*field)};
+    }
+
+    bool indexed(const db::join::StaticSide &side)
+    {
+        return side.key == db::ColumnType::COLUMN0 || side.table->isColumnIndexed(side.key);
+    }
+
+    bool indexed(const db::join::DynamicSide &side)
+    {
+        return side.key == "id" || side.table->isColumnIndexed(side.key);
+    }
+
+    /**
+     * Primary keys go through lookupBatch() in one batch, secondary index keys through one forEachMatching() each
+     * A number never matches a string column and a string never matches a number column, as in the hash join
+     */
+    void probe(const db::join::StaticSide &side, std::span<const db::join::JoinKey> keys,
+               const std::function<void(size_t, const db::QBRecord &)> &visit)
+    {
+        if (side.key == db::ColumnType::COLUMN0)
+        {
+            std::vector<db::uint> ids;
+            std::vector<size_t> positions;
+            ids.reserve(keys.size());
+            positions.reserve(keys.size());
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                db::uint id = 0;
+                if (asId(keys[i], id))
+                {
+                    ids.push_back(id);
+                    positions.push_back(i);
+                }
+            }
+            side.table->lookupBatch(ids, [&](size_t i, const db::QBRecord *record)
+                                    {
+                                        if (record && passes(side, *record, 0))
+                                            visit(positions[i], *record); });
+            return;
+        }
+
+        const bool numeric = side.key == db::ColumnType::COLUMN2;
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            const long *number = std::get_if<long>(&keys[i]);
+            if (numeric != (number != nullptr))
+                continue;
+            side.table->forEachMatching(side.key, numeric ? std::to_string(*number) : std::get<std::string>(keys[i]),
+                                        [&](const db::QBRecord &record)
+                                        {
+                                            if (passes(side, record, 0))
+                                                visit(i, record); });
+        }
+    }
+
+    /**
+     * Dynamic records may hold a number as uint or long - a numeric key probes both, like the query engine does
+     */
+    void probe(const db::join::DynamicSide &side, std::span<const db::join::JoinKey> keys,
+               const std::function<void(size_t, const db::QBRecordDynamic &)> &visit)
+    {
+        for (size_t i = 0; i < keys.size(); ++i)
+        {
+            auto accept = [&](const db::QBRecordDynamic &record)
+            {
+                if (passes(side, record, 0))
+                    visit(i, record);
+            };
+            db::uint id = 0;
+            const bool isId = asId(keys[i], id);
+            if (side.key == "id")
+            {
+                if (isId)
+                    side.table->forEachMatching("id", id, accept);
+                continue;
+            }
+            if (const long *number = std::get_if<long>(&keys[i]))
+            {
+                if (isId)
+                    side.table->forEachMatching(side.key, id, accept);
+                side.table->forEachMatching(side.key, *number, accept);
+            }
+            else
+                side.table->forEachMatching(side.key, std::get<std::string>(keys[i]), accept);
+        }
+    }
+
+    std::string describe(const db::join::StaticSide &side)
+    {
+        std::string text = "QBTable." + columnName(side.key);
+        for (const auto &[column, matchString] : side.predicates)
+            text += " [" + columnName(column) + " '" + matchString + "']";
+        return side.filter ? text + " [filter]" : text;
+    }
+
+    std::string describe(const db::join::DynamicSide &side)
+    {
+        std::string text = "QBTableDynamic." + side.key;
+        for (const auto &[column, value] : side.predicates)
+            text += " [" + column + " = " + std::visit([](const auto &v)
+                                                      {
+                                                          if constexpr (std::is_same_v<std::decay_t<decltype(v)>, std::string>)
+                                                              return "'" + v + "'";
+                                                          else
+                                                              return std::to_string(v); },
+                                                      value) +
+                    "]";
+        return side.filter ? text + " [filter]" : text;
+    }
+}
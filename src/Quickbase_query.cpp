@@ -0,0 +1,825 @@
+#include "../include/Quickbase_query.hpp"
+#include <cctype>
+#include <charconv>
+#include <limits>
+
+// Quickbase query language definitions
+namespace db::query
+{
+    namespace
+    {
+        enum class TokenKind
+        {
+            Identifier,
+            Number,
+            String,
+            Symbol,
+            End
+        };
+
+        struct Token
+        {
+            TokenKind kind = TokenKind::End;
+            std::string_view text; // source text of the token
+            std::string value;     // unescaped string literal
+            long number = 0;
+            size_t pos = 0;
+        };
+
+        [[noreturn]] void fail(const std::string &message, size_t pos)
+        {
+            throw db::query::QueryError(message + " at position " + std::to_string(pos));
+        }
+
+        bool isIdentifierStart(char c)
+        {
+            return std::isalpha(static_cast<unsigned char>(c)) || c == '_';
+        }
+
+        bool isIdentifierChar(char c)
+        {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+        }
+
+        bool isDigit(char c)
+        {
+            return c >= '0' && c <= '9';
+        }
+
+        /**
+         * Split the query text into tokens, the last token is always End
+         */
+        std::vector<Token> tokenize(std::string_view src)
+        {
+            std::vector<Token> tokens;
+            size_t i = 0;
+            while (true)
+            {
+                while (i < src.size() && std::isspace(static_cast<unsigned char>(src[i])))
+                    ++i;
+                Token token;
+                token.pos = i;
+                if (i == src.size())
+                {
+                    tokens.push_back(token);
+                    return tokens;
+                }
+
+                const char c = src[i];
+                if (isIdentifierStart(c))
+                {
+                    size_t end = i + 1;
+                    while (end < src.size() && isIdentifierChar(src[end]))
+                        ++end;
+                    token.kind = TokenKind::Identifier;
+                    token.text = src.substr(i, end - i);
+                    i = end;
+                }
+                else if (isDigit(c) || (c == '-' && i + 1 < src.size() && isDigit(src[i + 1])))
+                {
+                    size_t end = i + 1;
+                    while (end < src.size() && isDigit(src[end]))
+                        ++end;
+                    auto convResult = std::from_chars(src.data() + i, src.data() + end, token.number);
+                    if (convResult.ec != std::errc{})
+                        fail("Integer literal out of range", i);
+                    token.kind = TokenKind::Number;
+                    token.text = src.substr(i, end - i);
+                    i = end;
+                }
+                else if (c == '\'')
+                {
+                    size_t end = i + 1;
+                    while (true)
+                    {
+                        if (end == src.size())
+                            fail("Unterminated string literal", i);
+                        if (src[end] == '\'')
+                        {
+                            if (end + 1 < src.size() && src[end + 1] == '\'')
+                            {
+                                token.value += '\'';
+                                end += 2;
+                                continue;
+                            }
+                            break;
+                        }
+                        token.value += src[end++];
+                    }
+                    token.kind = TokenKind::String;
+                    token.text = src.substr(i, end + 1 - i);
+                    i = end + 1;
+                }
+                else if (c == ',' || c == '(' || c == ')' || c == '*' || c == '=' || c == ';')
+                {
+                    token.kind = TokenKind::Symbol;
+                    token.text = src.substr(i, 1);
+                    ++i;
+                }
+                else
+                    fail(std::string("Unexpected character '") + c + "'", i);
+                tokens.push_back(std::move(token));
+            }
+        }
+
+        bool equalsIgnoreCase(std::string_view a, std::string_view b)
+        {
+            if (a.size() != b.size())
+                return false;
+            for (size_t i = 0; i < a.size(); ++i)
+                if (std::toupper(static_cast<unsigned char>(a[i])) != std::toupper(static_cast<unsigned char>(b[i])))
+                    return false;
+            return true;
+        }
+
+        // Parser - recursive descent over the token list
+        class Parser
+        {
+        private:
+            std::vector<Token> tokens_;
+            size_t next_ = 0;
+
+            const Token &peek(size_t ahead = 0) const
+            {
+                return tokens_[std::min(next_ + ahead, tokens_.size() - 1)];
+            }
+
+            const Token &take()
+            {
+                const Token &token = peek();
+                if (next_ < tokens_.size() - 1)
+                    ++next_;
+                return token;
+            }
+
+            [[noreturn]] void unexpected(const std::string &expected) const
+            {
+                const Token &token = peek();
+                std::string found = token.kind == TokenKind::End ? "end of query" : "'" + std::string(token.text) + "'";
+                fail("Expected " + expected + " but found " + found, token.pos);
+            }
+
+            static bool isKeyword(const Token &token, std::string_view keyword)
+            {
+                return token.kind == TokenKind::Identifier && equalsIgnoreCase(token.text, keyword);
+            }
+
+            bool acceptKeyword(std::string_view keyword)
+            {
+                if (!isKeyword(peek(), keyword))
+                    return false;
+                take();
+                return true;
+            }
+
+            void expectKeyword(std::string_view keyword)
+            {
+                if (!acceptKeyword(keyword))
+                    unexpected(std::string(keyword));
+            }
+
+            bool acceptSymbol(char symbol)
+            {
+                if (peek().kind != TokenKind::Symbol || peek().text[0] != symbol)
+                    return false;
+                take();
+                return true;
+            }
+
+            void expectSymbol(char symbol)
+            {
+                if (!acceptSymbol(symbol))
+                    unexpected(std::string("'") + symbol + "'");
+            }
+
+            std::string expectIdentifier(const std::string &what)
+            {
+                if (peek().kind != TokenKind::Identifier)
+                    unexpected(what);
+                return std::string(take().text);
+            }
+
+            db::query::Literal expectLiteral()
+            {
+                db::query::Literal literal;
+                if (peek().kind == TokenKind::Number)
+                {
+                    literal.isNumber = true;
+                    literal.number = take().number;
+                }
+                else if (peek().kind == TokenKind::String)
+                    literal.text = take().value;
+                else
+                    unexpected("an integer or string literal");
+                return literal;
+            }
+
+        public:
+            explicit Parser(std::string_view text) : tokens_(tokenize(text)) {}
+
+            db::query::SelectStatement parseSelect()
+            {
+                db::query::SelectStatement statement;
+                expectKeyword("SELECT");
+                if (isKeyword(peek(), "COUNT") && peek(1).kind == TokenKind::Symbol && peek(1).text[0] == '(')
+                {
+                    take();
+                    expectSymbol('(');
+                    expectSymbol('*');
+                    expectSymbol(')');
+                    statement.count = true;
+                }
+                else if (!acceptSymbol('*'))
+                {
+                    do
+                        statement.columns.push_back(expectIdentifier("a column name"));
+                    while (acceptSymbol(','));
+                }
+
+                expectKeyword("FROM");
+                statement.table = expectIdentifier("a table name");
+
+                if (acceptKeyword("WHERE"))
+                {
+                    do
+                    {
+                        db::query::Predicate predicate;
+                        predicate.column = expectIdentifier("a column name");
+                        if (acceptSymbol('='))
+                            predicate.value = expectLiteral();
+                        else if (acceptKeyword("LIKE"))
+                        {
+                            predicate.op = db::query::CompareOp::Like;
+                            if (peek().kind != TokenKind::String)
+                                unexpected("a string pattern");
+                            predicate.value.text = take().value;
+                        }
+                        else
+                            unexpected("'=' or LIKE");
+                        statement.where.push_back(std::move(predicate));
+                    } while (acceptKeyword("AND"));
+                }
+
+                if (acceptKeyword("LIMIT"))
+                {
+                    if (peek().kind != TokenKind::Number || peek().number < 0)
+                        unexpected("a non-negative row count");
+                    statement.limit = static_cast<size_t>(take().number);
+                }
+                acceptSymbol(';');
+                if (peek().kind != TokenKind::End)
+                    unexpected("end of query");
+                return statement;
+            }
+        };
+
+        std::string columnName(db::ColumnType columnID)
+        {
+            return "column" + std::to_string(static_cast<int>(columnID));
+        }
+
+        db::ColumnType staticColumn(const std::string &name, const std::string &table)
+        {
+            for (int col = 0; col < 4; ++col)
+                if (name == "column" + std::to_string(col))
+                    return static_cast<db::ColumnType>(col);
+            throw db::query::QueryError("Unknown column '" + name + "' in table '" + table + "'");
+        }
+
+        bool hasWildcard(std::string_view pattern)
+        {
+            return pattern.find_first_of("%_") != std::string_view::npos;
+        }
+
+        // longest wildcard free run of a LIKE pattern - every match contains it as a substring
+        std::string_view longestLiteralRun(std::string_view pattern)
+        {
+            std::string_view best;
+            size_t start = 0;
+            while (start <= pattern.size())
+            {
+                size_t end = pattern.find_first_of("%_", start);
+                if (end == std::string_view::npos)
+                    end = pattern.size();
+                if (end - start > best.size())
+                    best = pattern.substr(start, end - start);
+                start = end + 1;
+            }
+            return best;
+        }
+
+        /**
+         * Bind a statement to a QBTable - validates columns and literal types, picks the cheapest access path:
+         * primary key lookup, then secondary index lookup, then a single column scan, then a full scan
+         */
+        void planStatic(db::query::Plan &plan, const db::QBTable &table)
+        {
+            const auto &statement = plan.statement;
+            if (!statement.count)
+            {
+                if (statement.columns.empty())
+                    plan.projection = {db::ColumnType::COLUMN0, db::ColumnType::COLUMN1, db::ColumnType::COLUMN2, db::ColumnType::COLUMN3};
+                for (const auto &column : statement.columns)
+                    plan.projection.push_back(staticColumn(column, statement.table));
+            }
+
+            int bestRank = 3;
+            for (size_t i = 0; i < statement.where.size(); ++i)
+            {
+                const auto &predicate = statement.where[i];
+                db::ColumnType columnID = staticColumn(predicate.column, statement.table);
+                plan.predicateColumns.push_back(columnID);
+                const bool numeric = columnID == db::ColumnType::COLUMN0 || columnID == db::ColumnType::COLUMN2;
+                if (predicate.op == db::query::CompareOp::Like && numeric)
+                    throw db::query::QueryError("LIKE needs a string column, " + predicate.column + " is numeric");
+                if (predicate.op == db::query::CompareOp::Equal && numeric != predicate.value.isNumber)
+                    throw db::query::QueryError(predicate.column + (numeric ? " expects an integer literal" : " expects a string literal"));
+
+                int rank = 3;
+                std::string literal;
+                const bool indexed = table.isColumnIndexed(columnID);
+                if (numeric)
+                {
+                    rank = columnID == db::ColumnType::COLUMN0 ? 0 : (indexed ? 1 : 2);
+                    literal = std::to_string(predicate.value.number);
+                }
+                else if (predicate.op == db::query::CompareOp::Equal || !hasWildcard(predicate.value.text))
+                {
+                    // an index lookup is exact, a column scan is a substring match narrowed by the filter
+                    rank = indexed ? 1 : 2;
+                    literal = predicate.value.text;
+                }
+                else if (!indexed)
+                {
+                    literal = std::string(longestLiteralRun(predicate.value.text));
+                    rank = literal.empty() ? 3 : 2;
+                }
+
+                if (rank < bestRank)
+                {
+                    bestRank = rank;
+                    plan.driving = i;
+                    plan.drivingColumn = columnID;
+                    plan.drivingLiteral = std::move(literal);
+                }
+            }
+            plan.access = static_cast<db::query::AccessPath>(bestRank);
+        }
+
+        /**
+         * Bind a statement to a QBTableDynamic - column types are not declared, so integer literals match both
+         * uint and long fields and only string equality may drive a column scan
+         */
+        void planDynamic(db::query::Plan &plan, const db::QBTableDynamic &table)
+        {
+            const auto &statement = plan.statement;
+            if (!statement.count)
+            {
+                plan.projectionNames = statement.columns.empty() ? table.columnNames() : statement.columns;
+                for (const auto &column : plan.projectionNames)
+                    if (!table.hasColumn(column))
+                        throw db::query::QueryError("Unknown column '" + column + "' in table '" + statement.table + "'");
+            }
+
+            int bestRank = 3;
+            for (size_t i = 0; i < statement.where.size(); ++i)
+            {
+                const auto &predicate = statement.where[i];
+                if (!table.hasColumn(predicate.column))
+                    throw db::query::QueryError("Unknown column '" + predicate.column + "' in table '" + statement.table + "'");
+                const bool primaryKey = predicate.column == "id";
+                if (primaryKey && (predicate.op == db::query::CompareOp::Like || !predicate.value.isNumber))
+                    throw db::query::QueryError("id expects an integer literal");
+                const bool equality = predicate.op == db::query::CompareOp::Equal || !hasWildcard(predicate.value.text);
+                if (!equality)
+                    continue;
+
+                const long number = predicate.value.number;
+                const bool fitsUint = number >= 0 && static_cast<unsigned long>(number) <= std::numeric_limits<db::uint>::max();
+                int rank = 3;
+                std::vector<db::FieldType> probes;
+                if (primaryKey)
+                {
+                    rank = 0;
+                    if (fitsUint)
+                        probes.emplace_back(static_cast<db::uint>(number)); // no probe - no row can match
+                }
+                else if (predicate.value.isNumber)
+                {
+                    if (table.isColumnIndexed(predicate.column))
+                    {
+                        rank = 1;
+                        probes.emplace_back(number);
+                        if (fitsUint)
+                            probes.emplace_back(static_cast<db::uint>(number));
+                    }
+                }
+                else
+                {
+                    rank = table.isColumnIndexed(predicate.column) ? 1 : 2;
+                    probes.emplace_back(predicate.value.text);
+                }
+
+                if (rank < bestRank)
+                {
+                    bestRank = rank;
+                    plan.driving = i;
+                    plan.probes = std::move(probes);
+                }
+            }
+            plan.access = static_cast<db::query::AccessPath>(bestRank);
+        }
+
+        bool matches(const db::query::Plan &plan, const db::QBRecord &rec)
+        {
+            for (size_t i = 0; i < plan.statement.where.size(); ++i)
+            {
+                const auto &predicate = plan.statement.where[i];
+                bool match = false;
+                switch (plan.predicateColumns[i])
+                {
+                case db::ColumnType::COLUMN0:
+                    match = predicate.value.number >= 0 && static_cast<unsigned long>(predicate.value.number) == rec.column0;
+                    break;
+                case db::ColumnType::COLUMN2:
+                    match = rec.column2 == predicate.value.number;
+                    break;
+                case db::ColumnType::COLUMN1:
+                case db::ColumnType::COLUMN3:
+                {
+                    const std::string &value = plan.predicateColumns[i] == db::ColumnType::COLUMN1 ? rec.column1 : rec.column3;
+                    match = predicate.op == db::query::CompareOp::Equal ? value == predicate.value.text
+                                                                        : likeMatch(value, predicate.value.text);
+                }
+                break;
+                }
+                if (!match)
+                    return false;
+            }
+            return true;
+        }
+
+        bool matchesField(const db::query::Predicate &predicate, const db::FieldType &field)
+        {
+            if (predicate.op == db::query::CompareOp::Like)
+            {
+                const auto *text = std::get_if<std::string>(&field);
+                return text && likeMatch(*text, predicate.value.text);
+            }
+            if (!predicate.value.isNumber)
+            {
+                const auto *text = std::get_if<std::string>(&field);
+                return text && *text == predicate.value.text;
+            }
+            if (const auto *u = std::get_if<db::uint>(&field))
+                return predicate.value.number >= 0 && static_cast<unsigned long>(predicate.value.number) == *u;
+            if (const auto *l = std::get_if<long>(&field))
+                return *l == predicate.value.number;
+            return false;
+        }
+
+        bool matches(const db::query::Plan &plan, const db::QBRecordDynamic &rec)
+        {
+            for (const auto &predicate : plan.statement.where)
+            {
+                if (predicate.column == "id")
+                {
+                    if (!matchesField(predicate, db::FieldType(rec.id)))
+                        return false;
+                    continue;
+                }
+                auto it = rec.fields.find(predicate.column);
+                if (it == rec.fields.end() || !matchesField(predicate, it->second))
+                    return false;
+            }
+            return true;
+        }
+
+        std::optional<db::FieldType> project(const db::QBRecord &rec, db::ColumnType columnID)
+        {
+            switch (columnID)
+            {
+            case db::ColumnType::COLUMN0:
+                return rec.column0;
+            case db::ColumnType::COLUMN1:
+                return rec.column1;
+            case db::ColumnType::COLUMN2:
+                return rec.column2;
+            case db::ColumnType::COLUMN3:
+                return rec.column3;
+            }
+            return std::nullopt;
+        }
+
+        std::optional<db::FieldType> project(const db::QBRecordDynamic &rec, const std::string &column)
+        {
+            if (column == "id")
+                return rec.id;
+            auto it = rec.fields.find(column);
+            if (it == rec.fields.end())
+                return std::nullopt;
+            return it->second;
+        }
+    }
+
+    db::query::SelectStatement parse(std::string_view text)
+    {
+        return Parser(text).parseSelect();
+    }
+
+    std::string normalize(std::string_view text)
+    {
+        std::string normalized;
+        normalized.reserve(text.size());
+        bool inString = false;
+        bool pendingSpace = false;
+        for (char c : text)
+        {
+            if (inString)
+            {
+                normalized += c;
+                inString = c != '\''; // an escaped quote closes and immediately reopens the literal
+            }
+            else if (std::isspace(static_cast<unsigned char>(c)))
+                pendingSpace = !normalized.empty();
+            else
+            {
+                if (pendingSpace)
+                    normalized += ' ';
+                pendingSpace = false;
+                normalized += c;
+                inString = c == '\'';
+            }
+        }
+        return normalized;
+    }
+
+    /**
+     * Match value against a LIKE pattern - greedy, backtracking to the last % on a mismatch
+     */
+    bool likeMatch(std::string_view value, std::string_view pattern)
+    {
+        size_t v = 0, p = 0;
+        size_t starP = std::string_view::npos, starV = 0;
+        while (v < value.size())
+        {
+            if (p < pattern.size() && (pattern[p] == '_' || (pattern[p] != '%' && pattern[p] == value[v])))
+            {
+                ++v;
+                ++p;
+            }
+            else if (p < pattern.size() && pattern[p] == '%')
+            {
+                starP = p++;
+                starV = v;
+            }
+            else if (starP != std::string_view::npos)
+            {
+                p = starP + 1;
+                v = ++starV;
+            }
+            else
+                return false;
+        }
+        while (p < pattern.size() && pattern[p] == '%')
+            ++p;
+        return p == pattern.size();
+    }
+
+    std::vector<std::string> Plan::columnNames() const
+    {
+        if (statement.count)
+            return {"COUNT(*)"};
+        if (dynamic)
+            return projectionNames;
+        std::vector<std::string> names;
+        for (db::ColumnType columnID : projection)
+            names.push_back(columnName(columnID));
+        return names;
+    }
+
+    std::string Plan::explain() const
+    {
+        std::string text;
+        std::string column = statement.where.empty() ? "" : statement.where[driving].column;
+        switch (access)
+        {
+        case db::query::AccessPath::PrimaryKey:
+            text = "PRIMARY KEY LOOKUP " + column + " = " + std::to_string(statement.where[driving].value.number);
+            break;
+        case db::query::AccessPath::IndexLookup:
+            text = "INDEX LOOKUP " + column + " = " + (dynamic ? db::fieldToString(probes.front()) : drivingLiteral);
+            break;
+        case db::query::AccessPath::ColumnScan:
+            if (dynamic)
+                text = "COLUMN SCAN " + column + " = '" + db::fieldToString(probes.front()) + "'";
+            else if (drivingColumn == db::ColumnType::COLUMN2)
+                text = "COLUMN SCAN " + column + " = " + drivingLiteral;
+            else
+                text = "COLUMN SCAN " + column + " contains '" + drivingLiteral + "'";
+            break;
+        case db::query::AccessPath::FullScan:
+            text = "FULL SCAN " + statement.table;
+            break;
+        }
+        size_t filters = statement.where.size() - (access == db::query::AccessPath::FullScan ? 0 : 1);
+        if (filters > 0)
+            text += " + FILTER " + std::to_string(filters) + (filters == 1 ? " predicate" : " predicates");
+        if (statement.count)
+            text += " -> COUNT(*)";
+        else if (statement.limit)
+            text += " LIMIT " + std::to_string(*statement.limit);
+        return text;
+    }
+
+    QueryEngine::QueryEngine(size_t planCacheCapacity) : cacheCapacity_(planCacheCapacity) {}
+
+    void QueryEngine::registerTable(const std::string &name, const db::QBTable &table)
+    {
+        tables_[name] = &table;
+        clearCache();
+    }
+
+    void QueryEngine::registerTable(const std::string &name, const db::QBTableDynamic &table)
+    {
+        tables_[name] = &table;
+        clearCache();
+    }
+
+    const QueryEngine::TableRef &QueryEngine::resolve(std::string_view table) const
+    {
+        auto it = tables_.find(table);
+        if (it == tables_.end())
+            throw db::query::QueryError("Unknown table '" + std::string(table) + "'");
+        return it->second;
+    }
+
+    std::shared_ptr<const db::query::Plan> QueryEngine::plan(db::query::SelectStatement statement) const
+    {
+        auto plan = std::make_shared<db::query::Plan>();
+        plan->statement = std::move(statement);
+        const TableRef &table = resolve(plan->statement.table);
+        if (const auto *staticTable = std::get_if<const db::QBTable *>(&table))
+            planStatic(*plan, **staticTable);
+        else
+        {
+            plan->dynamic = true;
+            planDynamic(*plan, *std::get<const db::QBTableDynamic *>(table));
+        }
+        plan->indexSignature = indexSignature(*plan);
+        return plan;
+    }
+
+    std::vector<bool> QueryEngine::indexSignature(const db::query::Plan &plan) const
+    {
+        std::vector<bool> signature;
+        signature.reserve(plan.statement.where.size());
+        const TableRef &table = resolve(plan.statement.table);
+        for (size_t i = 0; i < plan.statement.where.size(); ++i)
+        {
+            if (const auto *staticTable = std::get_if<const db::QBTable *>(&table))
+                signature.push_back(!plan.dynamic && (*staticTable)->isColumnIndexed(plan.predicateColumns[i]));
+            else
+                signature.push_back(std::get<const db::QBTableDynamic *>(table)->isColumnIndexed(plan.statement.where[i].column));
+        }
+        return signature;
+    }
+
+    /**
+     * Look the normalized text up in the plan cache, parse and plan only on a miss
+     * A cached plan is rebuilt when an index on one of its predicate columns was created or dropped
+     */
+    std::shared_ptr<const db::query::Plan> QueryEngine::prepare(std::string_view sql)
+    {
+        std::string key = normalize(sql);
+        if (cacheCapacity_ > 0)
+        {
+            if (auto it = cache_.find(key); it != cache_.end())
+            {
+                ++cacheStats_.hits;
+                lru_.splice(lru_.begin(), lru_, it->second);
+                auto &cached = it->second->second;
+                if (indexSignature(*cached) != cached->indexSignature)
+                {
+                    ++cacheStats_.replans;
+                    cached = plan(cached->statement);
+                }
+                return cached;
+            }
+        }
+
+        ++cacheStats_.misses;
+        auto prepared = plan(parse(key));
+        if (cacheCapacity_ > 0)
+        {
+            lru_.emplace_front(key, prepared);
+            cache_[std::move(key)] = lru_.begin();
+            if (cache_.size() > cacheCapacity_)
+            {
+                cache_.erase(lru_.back().first);
+                lru_.pop_back();
+                ++cacheStats_.evictions;
+            }
+        }
+        return prepared;
+    }
+
+    db::query::QueryResult QueryEngine::execute(std::string_view sql)
+    {
+        return execute(*prepare(sql));
+    }
+
+    /**
+     * Run a plan - rows from the access path are filtered by every predicate, projected and counted
+     * LIMIT stops full scans early, index lookups and column scans run to completion
+     */
+    db::query::QueryResult QueryEngine::execute(const db::query::Plan &plan) const
+    {
+        db::query::QueryResult result;
+        result.columns = plan.columnNames();
+        const auto &statement = plan.statement;
+        if (statement.limit && *statement.limit == 0)
+            return result;
+
+        const TableRef &table = resolve(statement.table);
+        if (plan.dynamic != std::holds_alternative<const db::QBTableDynamic *>(table))
+            throw db::query::QueryError("Table '" + statement.table + "' was replaced since the plan was prepared");
+
+        const size_t limit = (!statement.count && statement.limit) ? *statement.limit : std::numeric_limits<size_t>::max();
+        size_t count = 0;
+        bool done = false;
+        auto accept = [&](const auto &rec)
+        {
+            if (!matches(plan, rec))
+                return true;
+            ++count;
+            if (!statement.count)
+            {
+                if constexpr (std::is_same_v<std::decay_t<decltype(rec)>, db::QBRecord>)
+                    for (db::ColumnType columnID : plan.projection)
+                        result.cells.push_back(project(rec, columnID));
+                else
+                    for (const auto &column : plan.projectionNames)
+                        result.cells.push_back(project(rec, column));
+            }
+            done = count >= limit;
+            return !done;
+        };
+
+        if (const auto *staticTable = std::get_if<const db::QBTable *>(&table))
+        {
+            if (plan.access == db::query::AccessPath::FullScan)
+                (*staticTable)->forEachRecord(accept);
+            else
+                (*staticTable)->forEachMatching(plan.drivingColumn, plan.drivingLiteral, [&](const db::QBRecord &rec)
+                                                {
+                                                    if (!done)
+                                                        accept(rec); });
+        }
+        else
+        {
+            const db::QBTableDynamic &dynamicTable = *std::get<const db::QBTableDynamic *>(table);
+            if (plan.access == db::query::AccessPath::FullScan)
+                dynamicTable.forEachRecord(accept);
+            else
+                for (const auto &probe : plan.probes)
+                    if (!done)
+                        dynamicTable.forEachMatching(statement.where[plan.driving].column, probe, [&](const db::QBRecordDynamic &rec)
+                                                     {
+                                                         if (!done)
+                                                             accept(rec); });
+        }
+
+        if (statement.count)
+            result.cells.emplace_back(db::FieldType(static_cast<long>(count)));
+        return result;
+    }
+
+    std::string QueryEngine::explain(std::string_view sql)
+    {
+        auto prepared = prepare(sql);
+        std::string text = prepared->explain();
+        if (prepared->access == db::query::AccessPath::FullScan)
+            return text;
+
+        const TableRef &table = resolve(prepared->statement.table);
+        if (const auto *staticTable = std::get_if<const db::QBTable *>(&table))
+            text += "\n  " + (*staticTable)->explain(prepared->drivingColumn, prepared->drivingLiteral);
+        else if (!prepared->probes.empty())
+            text += "\n  " + std::get<const db::QBTableDynamic *>(table)->explain(prepared->statement.where[prepared->driving].column, prepared->probes.front());
+        return text;
+    }
+
+    db::query::PlanCacheStats QueryEngine::cacheStats() const
+    {
+        db::query::PlanCacheStats stats = cacheStats_;
+        stats.size = cache_.size();
+        return stats;
+    }
+
+    void QueryEngine::clearCache()
+    {
+        cache_.clear();
+        lru_.clear();
+    }
+}
@@ -0,0 +1,136 @@
+#include "../include/Quickbase_querylog.hpp"
+#include <algorithm>
+#include <type_traits>
+
+// Quickbase query log definitions
+namespace db
+{
+    /**
+     * Render a shape in a SQL-like form with the literal replaced by '?'
+     */
+    std::string QueryShape::toString() const
+    {
+        std::string text = table.empty() ? column : table + "." + column;
+        switch (mode)
+        {
+        case db::MatchMode::PrimaryKey:
+        case db::MatchMode::Exact:
+            return text + " = ?";
+        case db::MatchMode::Substring:
+            return text + " LIKE '%?%'";
+        case db::MatchMode::Range:
+            return text + " BETWEEN ? AND ?";
+        case db::MatchMode::FullText:
+            return text + " MATCH ?";
+        }
+        return text;
+    }
+
+    /**
+     * Render a field value for logs and explain output
+     */
+    std::string fieldToString(const db::FieldType &value)
+    {
+        return std::visit([](const auto &v) -> std::string
+                          {
+                              if constexpr (std::is_same_v<std::decay_t<decltype(v)>, std::string>)
+                                  return v;
+                              else
+                                  return std::to_string(v); },
+                          value);
+    }
+
+    QueryLog::QueryLog(db::QueryLogOptions options) : options_(options) {}
+
+    /**
+     * Aggregate one query into its shape and log it if it exceeded the slow threshold
+     * When the shape table is full the least called shape is evicted to make room
+     */
+    void QueryLog::record(const db::QueryShape &shape, std::string_view literal, std::chrono::nanoseconds duration,
+                          uint64_t rowsExamined, uint64_t rowsReturned, const std::function<std::string()> &explain)
+    {
+        const double durationMs = std::chrono::duration<double, std::milli>(duration).count();
+        std::lock_guard<std::mutex> lock(mutex_);
+
+        auto it = shapes_.find(shape);
+        if (it == shapes_.end())
+        {
+            if (options_.maxShapes == 0)
+                return;
+            if (shapes_.size() >= options_.maxShapes)
+            {
+                auto victim = std::min_element(shapes_.begin(), shapes_.end(), [](const auto &a, const auto &b)
+                                               { return a.second.calls < b.second.calls; });
+                shapes_.erase(victim);
+                ++evictedShapes_;
+            }
+            it = shapes_.emplace(shape, db::QueryShapeStats{shape}).first;
+        }
+
+        db::QueryShapeStats &stats = it->second;
+        ++stats.calls;
+        stats.totalMs += durationMs;
+        stats.maxMs = std::max(stats.maxMs, durationMs);
+        stats.rowsExamined += rowsExamined;
+        stats.rowsReturned += rowsReturned;
+
+        if (duration < options_.slowThreshold || options_.slowLogCapacity == 0)
+            return;
+        if (slowQueries_.size() >= options_.slowLogCapacity)
+            slowQueries_.pop_front();
+        slowQueries_.push_back({shape, std::string(literal), durationMs, rowsExamined, rowsReturned,
+                                explain ? explain() : std::string{}, std::chrono::system_clock::now()});
+    }
+
+    void QueryLog::setSlowThreshold(std::chrono::microseconds threshold)
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        options_.slowThreshold = threshold;
+    }
+
+    std::chrono::microseconds QueryLog::slowThreshold() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return options_.slowThreshold;
+    }
+
+    /**
+     * Snapshot of all shapes, most expensive (total time) first
+     */
+    std::vector<db::QueryShapeStats> QueryLog::shapes() const
+    {
+        std::vector<db::QueryShapeStats> result;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            result.reserve(shapes_.size());
+            for (const auto &[shape, stats] : shapes_)
+                result.push_back(stats);
+        }
+        std::sort(result.begin(), result.end(), [](const auto &a, const auto &b)
+                  { return a.totalMs > b.totalMs; });
+        return result;
+    }
+
+    /**
+     * Snapshot of the slow query ring buffer, oldest first
+     */
+    std::vector<db::SlowQueryEntry> QueryLog::slowQueries() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return {slowQueries_.begin(), slowQueries_.end()};
+    }
+
+    uint64_t QueryLog::evictedShapes() const
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return evictedShapes_;
+    }
+
+    void QueryLog::reset()
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        shapes_.clear();
+        slowQueries_.clear();
+        evictedShapes_ = 0;
+    }
+}
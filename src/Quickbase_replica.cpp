@@ -0,0 +1,201 @@
+#include "../include/Quickbase_replica.hpp"
+
+// Quickbase read replica definitions
+namespace db::replica
+{
+    Follower::Follower(const std::string &walPath, db::replica::FollowerOptions options)
+        : options_(options), reader_(walPath) {}
+
+    Follower::~Follower()
+    {
+        stop();
+    }
+
+    /**
+     * Replay one entry the way the primary executed it, so storage positions stay identical
+     * The primary only logs operations that succeeded, so one refused here means the replica has diverged
+     */
+    void Follower::apply(const db::wal::LogEntry &entry)
+    {
+        auto diverged = [&](const std::string &operation)
+        {
+            throw db::replica::ReplicationError("Replica could not apply " + operation + " of id " + std::to_string(entry.id) +
+                                                " at lsn " + std::to_string(entry.lsn));
+        };
+        switch (entry.type)
+        {
+        case db::wal::EntryType::Insert:
+            if (!table_.addRecord(entry.record))
+                diverged("insert");
+            break;
+        case db::wal::EntryType::Update:
+            if (!table_.updateRecord(entry.id, {entry.record.column1, entry.record.column2, entry.record.column3}))
+                diverged("update");
+            break;
+        case db::wal::EntryType::SoftDelete:
+        case db::wal::EntryType::HardDelete:
+            if (!table_.deleteRecordByID(entry.id, entry.type == db::wal::EntryType::HardDelete))
+                diverged("delete");
+            break;
+        case db::wal::EntryType::Compaction:
+            table_.compactRecords();
+            break;
+        case db::wal::EntryType::CreateIndex:
+        case db::wal::EntryType::CreateUniqueIndex:
+            if (!table_.isColumnIndexed(entry.column))
+                table_.createIndex(entry.column, entry.type == db::wal::EntryType::CreateUniqueIndex ? db::IndexKind::Unique : db::IndexKind::General);
+            break;
+        case db::wal::EntryType::DropIndex:
+            table_.dropIndex(entry.column);
+            break;
+        case db::wal::EntryType::CreateCompositeIndex:
+            if (!table_.hasCompositeIndex(entry.columns))
+                table_.createCompositeIndex(entry.columns);
+            break;
+        case db::wal::EntryType::DropCompositeIndex:
+            table_.dropCompositeIndex(entry.columns);
+            break;
+        case db::wal::EntryType::Batch:
+        {
+            // committed as one transaction, so readers never see part of it
+            db::QBTransaction txn;
+            txn.reserve(entry.batch.size());
+            for (const db::wal::LogEntry &batched : entry.batch)
+            {
+                if (batched.type == db::wal::EntryType::Insert)
+                    txn.insert(batched.record);
+                else if (batched.type == db::wal::EntryType::Update)
+                    txn.update(batched.id, {batched.record.column1, batched.record.column2, batched.record.column3});
+                else
+                    txn.erase(batched.id);
+            }
+            if (auto result = table_.commit(txn); !result)
+                diverged("operation " + std::to_string(result.failedOperation) + " of a transaction");
+            break;
+        }
+        }
+    }
+
+    /**
+     * Apply everything the primary has flushed, holding the table lock for at most maxBatch entries at a time
+     * Lag is measured per batch from the primary's timestamp of its last entry
+     */
+    size_t Follower::poll()
+    {
+        if (failed_.load(std::memory_order_acquire))
+            return 0;
+        size_t applied = 0;
+        bool more = true;
+        db::wal::LogEntry entry;
+        while (more)
+        {
+            size_t batch = 0;
+            int64_t newestNs = 0;
+            {
+                std::lock_guard lock(tableMutex_);
+                try
+                {
+                    while (batch < options_.maxBatch && (more = reader_.next(entry)))
+                    {
+                        apply(entry);
+                        newestNs = entry.timestampNs;
+                        ++batch;
+                    }
+                }
+                catch (const std::exception &e)
+                {
+                    fail(e.what());
+                    throw;
+                }
+            }
+            if (batch == 0)
+                break;
+            applied += batch;
+            appliedLsn_.store(reader_.lastLsn(), std::memory_order_release);
+            bytesApplied_.store(reader_.bytesRead(), std::memory_order_relaxed);
+            const int64_t lag = db::wal::wallClockNs() - newestNs;
+            lastLagNs_.store(lag, std::memory_order_relaxed);
+            if (lag > maxLagNs_.load(std::memory_order_relaxed))
+                maxLagNs_.store(lag, std::memory_order_relaxed);
+        }
+        caughtUpNs_.store(db::wal::wallClockNs(), std::memory_order_release);
+        return applied;
+    }
+
+    /**
+     * Stop tailing for good - the error is reported by status() and reads are refused from now on
+     */
+    void Follower::fail(const std::string &error)
+    {
+        {
+            std::lock_guard lock(errorMutex_);
+            error_ = error;
+        }
+        failed_.store(true, std::memory_order_release);
+    }
+
+    void Follower::run()
+    {
+        while (!stop_.load(std::memory_order_relaxed))
+        {
+            try
+            {
+                if (poll() == 0)
+                {
+                    if (failed_.load(std::memory_order_acquire))
+                        return;
+                    std::this_thread::sleep_for(options_.pollInterval);
+                }
+            }
+            catch (const std::exception &)
+            {
+                return; // recorded by poll()
+            }
+        }
+    }
+
+    void Follower::start()
+    {
+        if (thread_.joinable())
+            return;
+        stop_.store(false);
+        thread_ = std::thread([this]
+                              { run(); });
+    }
+
+    void Follower::stop()
+    {
+        stop_.store(true);
+        if (thread_.joinable())
+            thread_.join();
+    }
+
+    db::replica::ReplicationStatus Follower::status() const
+    {
+        db::replica::ReplicationStatus status;
+        status.appliedLsn = appliedLsn_.load(std::memory_order_acquire);
+        status.bytesApplied = bytesApplied_.load(std::memory_order_relaxed);
+        status.lastLagMs = double(lastLagNs_.load(std::memory_order_relaxed)) / 1e6;
+        status.maxLagMs = double(maxLagNs_.load(std::memory_order_relaxed)) / 1e6;
+        status.caughtUpAt = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+            std::chrono::nanoseconds(caughtUpNs_.load(std::memory_order_acquire))));
+        {
+            std::lock_guard lock(errorMutex_);
+            status.error = error_;
+        }
+        status.running = thread_.joinable() && !stop_.load() && status.error.empty();
+        return status;
+    }
+
+    bool Follower::waitForLsn(uint64_t lsn, std::chrono::milliseconds timeout) const
+    {
+        const auto deadline = std::chrono::steady_clock::now() + timeout;
+        while (appliedLsn_.load(std::memory_order_acquire) < lsn)
+        {
+            if (std::chrono::steady_clock::now() >= deadline)
+                return false;
+            std::this_thread::sleep_for(options_.pollInterval);
+        }
+        return true;
+    }
+}
@@ -0,0 +1,723 @@
+#include "../include/Quickbase_server.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <deque>
+#include <stdexcept>
+#include <unordered_map>
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Quickbase table server definitions
+namespace db
+{
+    namespace
+    {
+        constexpr size_t kReadChunk = 64 * 1024;
+        constexpr size_t kOutChunk = 64 * 1024;
+        constexpr size_t kMaxIovecs = 64;
+        constexpr size_t kMaxBatch = 1024;
+        // backpressure - a client that pipelines requests without reading the responses stops being read
+        constexpr size_t kInputHighWater = 4 << 20;  // unprocessed request bytes buffered per connection
+        constexpr size_t kOutputHighWater = 4 << 20; // queued response bytes before requests are held back
+        constexpr size_t kOutputLowWater = 1 << 20;  // queued response bytes below which reading resumes
+        constexpr int kMaxEvents = 128;
+
+        [[noreturn]] void throwSystemError(const std::string &what)
+        {
+            throw std::runtime_error(what + ": " + std::strerror(errno));
+        }
+
+        // EAGAIN and EWOULDBLOCK may be distinct values on some systems
+        bool wouldBlock(int err)
+        {
+#if EAGAIN == EWOULDBLOCK
+            return err == EAGAIN;
+#else
+            return err == EAGAIN || err == EWOULDBLOCK;
+#endif
+        }
+
+        std::string columnName(db::ColumnType columnID)
+        {
+            return "column" + std::to_string(static_cast<int>(columnID));
+        }
+    }
+
+    // Connection - per client buffers, owned by the event loop that accepted it
+    struct QBServer::Connection
+    {
+        int fd = -1;
+        std::vector<char> in;
+        size_t inOffset = 0; // start of the first unprocessed byte in `in`
+        // out - response chunks flushed with one vectored write, a new chunk is started once the last one
+        // exceeds kOutChunk so large responses never reallocate and copy the responses queued before them
+        std::deque<std::vector<char>> out;
+        size_t outOffset = 0; // bytes of out.front() already written to the socket
+        bool wantWrite = false;
+        bool readPaused = false; // EPOLLIN dropped until the queued responses drain
+
+        std::vector<char> &outputChunk()
+        {
+            if (out.empty() || out.back().size() >= kOutChunk)
+                out.emplace_back();
+            return out.back();
+        }
+
+        bool hasPendingOutput() const noexcept
+        {
+            return !out.empty() && out.front().size() > outOffset;
+        }
+
+        size_t pendingOutputBytes() const noexcept
+        {
+            size_t bytes = 0;
+            for (const auto &chunk : out)
+                bytes += chunk.size();
+            return bytes - outOffset;
+        }
+
+        // every chunk but the last holds at least kOutChunk bytes - a constant time lower bound of the queue
+        bool outputFull() const noexcept
+        {
+            return out.size() > kOutputHighWater / kOutChunk;
+        }
+
+        size_t bufferedInput() const noexcept
+        {
+            return in.size() - inOffset;
+        }
+
+        // input buffered before reads stop - a larger frame is always read completely
+        size_t inputLimit() const noexcept
+        {
+            db::wire::FrameHeader header{};
+            try
+            {
+                if (bufferedInput() >= db::wire::kHeaderSize && !db::wire::peekFrame(in.data() + inOffset, bufferedInput(), header))
+                    return std::max(kInputHighWater, header.frameSize());
+            }
+            catch (const db::wire::ProtocolError &)
+            {
+                // reported when the frame is processed
+            }
+            return kInputHighWater;
+        }
+    };
+
+    // Worker - one epoll event loop and the connections it owns
+    struct QBServer::Worker
+    {
+        int epollFd = -1;
+        std::unordered_map<int, std::unique_ptr<Connection>> connections;
+    };
+
+    QBServer::QBServer(db::ServerOptions options) : options_(std::move(options)) {}
+
+    QBServer::~QBServer()
+    {
+        stop();
+        wait();
+        for (auto &worker : workers_)
+        {
+            for (auto &[fd, conn] : worker->connections)
+                ::close(fd);
+            if (worker->epollFd >= 0)
+                ::close(worker->epollFd);
+        }
+        if (listenFd_ >= 0)
+            ::close(listenFd_);
+        if (stopFd_ >= 0)
+            ::close(stopFd_);
+        if (!options_.unixPath.empty())
+            ::unlink(options_.unixPath.c_str());
+    }
+
+    /**
+     * Host a table created in-process
+     */
+    bool QBServer::hostTable(const std::string &name, std::variant<db::QBTable, db::QBTableDynamic> table)
+    {
+        std::unique_lock lock(tablesMutex_);
+        if (tables_.contains(name))
+            return false;
+        auto hosted = std::make_unique<db::HostedTable>();
+        hosted->table = std::move(table);
+        tables_.emplace(name, std::move(hosted));
+        return true;
+    }
+
+    db::HostedTable *QBServer::findTable(std::string_view name)
+    {
+        std::shared_lock lock(tablesMutex_);
+        auto it = tables_.find(name);
+        return it == tables_.end() ? nullptr : it->second.get();
+    }
+
+    /**
+     * Create the non-blocking listening socket shared by all event loops
+     */
+    void QBServer::openListener()
+    {
+        if (!options_.unixPath.empty())
+        {
+            sockaddr_un addr{};
+            if (options_.unixPath.size() >= sizeof(addr.sun_path))
+                throw std::runtime_error("Unix socket path too long: " + options_.unixPath);
+            addr.sun_family = AF_UNIX;
+            std::memcpy(addr.sun_path, options_.unixPath.c_str(), options_.unixPath.size() + 1);
+            listenFd_ = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (listenFd_ < 0)
+                throwSystemError("socket");
+            ::unlink(options_.unixPath.c_str());
+            if (::bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+                throwSystemError("bind " + options_.unixPath);
+        }
+        else
+        {
+            sockaddr_in addr{};
+            addr.sin_family = AF_INET;
+            addr.sin_port = htons(options_.port);
+            if (::inet_pton(AF_INET, options_.host.c_str(), &addr.sin_addr) != 1)
+                throw std::runtime_error("Invalid IPv4 address: " + options_.host);
+            listenFd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+            if (listenFd_ < 0)
+                throwSystemError("socket");
+            int one = 1;
+            ::setsockopt(listenFd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+            if (::bind(listenFd_, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0)
+                throwSystemError("bind " + options_.host + ":" + std::to_string(options_.port));
+        }
+        if (::listen(listenFd_, SOMAXCONN) < 0)
+            throwSystemError("listen");
+    }
+
+    /**
+     * Start one event loop per thread - each loop owns an epoll instance and the connections it accepts
+     * The listening socket is registered with EPOLLEXCLUSIVE so a new connection wakes a single loop
+     */
+    void QBServer::start()
+    {
+        openListener();
+        stopFd_ = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (stopFd_ < 0)
+            throwSystemError("eventfd");
+
+        unsigned threads = options_.threads ? options_.threads : std::max(1u, std::thread::hardware_concurrency());
+        for (unsigned i = 0; i < threads; ++i)
+        {
+            auto worker = std::make_unique<Worker>();
+            worker->epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+            if (worker->epollFd < 0)
+                throwSystemError("epoll_create1");
+
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLEXCLUSIVE;
+            ev.data.fd = listenFd_;
+            if (::epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, listenFd_, &ev) < 0)
+                throwSystemError("epoll_ctl listener");
+            ev.events = EPOLLIN;
+            ev.data.fd = stopFd_;
+            if (::epoll_ctl(worker->epollFd, EPOLL_CTL_ADD, stopFd_, &ev) < 0)
+                throwSystemError("epoll_ctl stop");
+            workers_.push_back(std::move(worker));
+        }
+        for (auto &worker : workers_)
+            threads_.emplace_back([this, w = worker.get()]
+                                  { runWorker(*w); });
+    }
+
+    void QBServer::stop() noexcept
+    {
+        if (stopFd_ >= 0)
+        {
+            uint64_t one = 1;
+            [[maybe_unused]] auto written = ::write(stopFd_, &one, sizeof(one));
+        }
+    }
+
+    void QBServer::wait()
+    {
+        for (auto &thread : threads_)
+            if (thread.joinable())
+                thread.join();
+        threads_.clear();
+    }
+
+    /**
+     * Event loop - level triggered, EPOLLOUT is only requested while a connection has pending output
+     */
+    void QBServer::runWorker(Worker &worker)
+    {
+        epoll_event events[kMaxEvents];
+        for (;;)
+        {
+            int ready = ::epoll_wait(worker.epollFd, events, kMaxEvents, -1);
+            if (ready < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                return;
+            }
+            for (int i = 0; i < ready; ++i)
+            {
+                const int fd = events[i].data.fd;
+                if (fd == stopFd_)
+                    return; // the eventfd stays readable, so every loop observes it
+                if (fd == listenFd_)
+                {
+                    acceptConnections(worker);
+                    continue;
+                }
+
+                auto it = worker.connections.find(fd);
+                if (it == worker.connections.end())
+                    continue;
+                Connection &conn = *it->second;
+                bool alive = !(events[i].events & (EPOLLERR | EPOLLHUP));
+                if (alive && (events[i].events & EPOLLIN))
+                    alive = readConnection(worker, conn);
+                if (alive && (events[i].events & EPOLLOUT))
+                    alive = flushConnection(worker, conn);
+                if (!alive)
+                    closeConnection(worker, fd);
+            }
+        }
+    }
+
+    void QBServer::acceptConnections(Worker &worker)
+    {
+        for (;;)
+        {
+            int fd = ::accept4(listenFd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return; // EAGAIN - another loop took it, or the backlog is drained
+            if (options_.unixPath.empty())
+            {
+                int one = 1;
+                ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            }
+            epoll_event ev{};
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = fd;
+            if (::epoll_ctl(worker.epollFd, EPOLL_CTL_ADD, fd, &ev) < 0)
+            {
+                ::close(fd);
+                continue;
+            }
+            auto conn = std::make_unique<Connection>();
+            conn->fd = fd;
+            worker.connections.emplace(fd, std::move(conn));
+        }
+    }
+
+    void QBServer::closeConnection(Worker &worker, int fd)
+    {
+        ::epoll_ctl(worker.epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        worker.connections.erase(fd);
+    }
+
+    /**
+     * Drain the socket up to the input limit, answer every complete frame and try to write the responses immediately
+     * Pipelined requests are all answered before the single flush, runs of primary key finds as one batch
+     */
+    bool QBServer::readConnection(Worker &worker, Connection &conn)
+    {
+        bool peerClosed = false;
+        try
+        {
+            while (conn.bufferedInput() < conn.inputLimit())
+            {
+                size_t used = conn.in.size();
+                conn.in.resize(used + kReadChunk);
+                ssize_t n = ::recv(conn.fd, conn.in.data() + used, kReadChunk, 0);
+                conn.in.resize(used + (n > 0 ? size_t(n) : 0));
+                if (n > 0)
+                    continue;
+                if (n == 0)
+                    peerClosed = true;
+                else if (!wouldBlock(errno) && errno != EINTR)
+                    return false;
+                break;
+            }
+            processFrames(conn);
+        }
+        catch (const db::wire::ProtocolError &)
+        {
+            return false; // framing is lost, drop the client
+        }
+
+        return flushConnection(worker, conn) && !peerClosed;
+    }
+
+    /**
+     * Answer buffered complete frames until the response queue is full, returns the number of frames consumed
+     * Throws ProtocolError on a malformed frame header
+     */
+    size_t QBServer::processFrames(Connection &conn)
+    {
+        size_t handled = 0;
+        db::wire::FrameHeader header{};
+        while (!conn.outputFull() && db::wire::peekFrame(conn.in.data() + conn.inOffset, conn.bufferedInput(), header))
+        {
+            if (size_t batched = handlePrimaryKeyBatch(conn); batched > 0)
+            {
+                handled += batched;
+                continue;
+            }
+            const char *frame = conn.in.data() + conn.inOffset;
+            handleFrame(header, frame + db::wire::kHeaderSize, header.frameSize() - db::wire::kHeaderSize, conn.outputChunk());
+            conn.inOffset += header.frameSize();
+            ++handled;
+        }
+
+        // keep only the unprocessed frames
+        if (conn.inOffset == conn.in.size())
+        {
+            conn.in.clear();
+            conn.inOffset = 0;
+        }
+        else if (conn.inOffset > conn.in.size() / 2)
+        {
+            conn.in.erase(conn.in.begin(), conn.in.begin() + static_cast<std::ptrdiff_t>(conn.inOffset));
+            conn.inOffset = 0;
+        }
+        return handled;
+    }
+
+    /**
+     * Write pending responses with vectored sends, registering for EPOLLOUT while the socket buffer is full
+     * Reading is paused while the responses queue up past the high-water mark and resumed below the low-water
+     * mark, answering the requests held back in the meantime
+     */
+    bool QBServer::flushConnection(Worker &worker, Connection &conn)
+    {
+        try
+        {
+            do
+            {
+                if (!sendOutput(conn))
+                    return false;
+            } while (conn.pendingOutputBytes() < kOutputLowWater && processFrames(conn) > 0);
+        }
+        catch (const db::wire::ProtocolError &)
+        {
+            return false;
+        }
+
+        bool pending = conn.hasPendingOutput();
+        bool paused = conn.readPaused ? conn.pendingOutputBytes() >= kOutputLowWater
+                                      : conn.outputFull() || conn.bufferedInput() >= conn.inputLimit();
+        if (pending != conn.wantWrite || paused != conn.readPaused)
+        {
+            // a paused connection only waits for the peer to read, EPOLLRDHUP would fire on every wait
+            epoll_event ev{};
+            ev.events = (paused ? 0u : EPOLLIN | EPOLLRDHUP) | (pending ? EPOLLOUT : 0u);
+            ev.data.fd = conn.fd;
+            ::epoll_ctl(worker.epollFd, EPOLL_CTL_MOD, conn.fd, &ev);
+            conn.wantWrite = pending;
+            conn.readPaused = paused;
+        }
+        return true;
+    }
+
+    /**
+     * Write as much pending output as the socket accepts, false when the connection failed
+     */
+    bool QBServer::sendOutput(Connection &conn)
+    {
+        while (conn.hasPendingOutput())
+        {
+            iovec iov[kMaxIovecs];
+            size_t count = 0;
+            size_t skip = conn.outOffset;
+            for (auto it = conn.out.begin(); it != conn.out.end() && count < kMaxIovecs; ++it, skip = 0)
+            {
+                iov[count].iov_base = it->data() + skip;
+                iov[count].iov_len = it->size() - skip;
+                ++count;
+            }
+
+            msghdr msg{};
+            msg.msg_iov = iov;
+            msg.msg_iovlen = count;
+            ssize_t n = ::sendmsg(conn.fd, &msg, MSG_NOSIGNAL);
+            if (n < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                if (wouldBlock(errno))
+                    break;
+                return false;
+            }
+
+            // release fully written chunks, the last one is kept for reuse
+            size_t written = size_t(n);
+            while (written > 0)
+            {
+                size_t left = conn.out.front().size() - conn.outOffset;
+                if (written < left)
+                {
+                    conn.outOffset += written;
+                    break;
+                }
+                written -= left;
+                conn.outOffset = 0;
+                if (conn.out.size() > 1)
+                    conn.out.pop_front();
+                else
+                    conn.out.front().clear();
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Coalesce a run of pipelined primary key finds on the same QBTable into one batched probe
+     * Takes the table lock once for the whole run and answers every request in order
+     * Returns the number of requests consumed, 0 when the buffered frames do not start such a run
+     */
+    size_t QBServer::handlePrimaryKeyBatch(Connection &conn)
+    {
+        db::HostedTable *hosted = nullptr;
+        std::string_view tableName;
+        std::vector<uint32_t> requestIds;
+        std::vector<db::uint> ids;
+        size_t offset = conn.inOffset;
+
+        db::wire::FrameHeader header{};
+        while (ids.size() < kMaxBatch && db::wire::peekFrame(conn.in.data() + offset, conn.in.size() - offset, header))
+        {
+            if (header.code != static_cast<uint8_t>(db::wire::Opcode::Find))
+                break;
+            db::wire::Reader reader(conn.in.data() + offset + db::wire::kHeaderSize, header.frameSize() - db::wire::kHeaderSize);
+            db::uint id = 0;
+            try
+            {
+                std::string_view name = reader.getName();
+                if (!hosted)
+                {
+                    hosted = findTable(name);
+                    if (!hosted || !std::holds_alternative<db::QBTable>(hosted->table))
+                        return 0;
+                    tableName = name;
+                }
+                else if (name != tableName)
+                    break;
+                if (reader.getU8() != static_cast<uint8_t>(db::ColumnType::COLUMN0))
+                    break;
+                std::string_view literal = reader.getString();
+                auto convResult = std::from_chars(literal.data(), literal.data() + literal.size(), id);
+                if (convResult.ec != std::errc{} || convResult.ptr != literal.data() + literal.size())
+                    break; // answered individually
+            }
+            catch (const db::wire::ProtocolError &)
+            {
+                break; // answered individually with BadRequest
+            }
+            requestIds.push_back(header.requestId);
+            ids.push_back(id);
+            offset += header.frameSize();
+        }
+        if (ids.size() < 2)
+            return 0;
+
+        std::shared_lock lock(hosted->mutex);
+        std::get<db::QBTable>(hosted->table).lookupBatch(ids, [&](size_t i, const db::QBRecord *rec)
+                                                         {
+                                                             db::wire::Writer writer(conn.outputChunk());
+                                                             size_t frameStart = writer.beginFrame(static_cast<uint8_t>(db::wire::Status::Ok), requestIds[i]);
+                                                             writer.putU32(rec ? 1 : 0);
+                                                             if (rec)
+                                                                 writer.putRecord(*rec);
+                                                             writer.endFrame(frameStart); });
+        conn.inOffset = offset;
+        return ids.size();
+    }
+
+    /**
+     * Decode one request and append its response frame - malformed payloads answer BadRequest
+     */
+    void QBServer::handleFrame(const db::wire::FrameHeader &header, const char *payload, size_t size, std::vector<char> &out)
+    {
+        db::wire::Writer writer(out);
+        size_t frameStart = writer.beginFrame(0, header.requestId);
+        size_t bodyStart = out.size();
+        db::wire::Reader reader(payload, size);
+        db::wire::Status status = db::wire::Status::BadRequest;
+
+        try
+        {
+            switch (static_cast<db::wire::Opcode>(header.code))
+            {
+            case db::wire::Opcode::CreateTable:
+                status = handleCreateTable(reader, writer);
+                break;
+            case db::wire::Opcode::Find:
+                status = handleFind(reader, writer);
+                break;
+            case db::wire::Opcode::Add:
+                status = handleAdd(reader, writer);
+                break;
+            case db::wire::Opcode::Delete:
+                status = handleDelete(reader, writer);
+                break;
+            case db::wire::Opcode::CreateIndex:
+                status = handleCreateIndex(reader, writer);
+                break;
+            default:
+                writer.putName("Unknown opcode");
+                break;
+            }
+        }
+        catch (const std::exception &e)
+        {
+            // drop any partial body, answer with the error message
+            out.resize(bodyStart);
+            status = dynamic_cast<const db::wire::ProtocolError *>(&e) ? db::wire::Status::BadRequest : db::wire::Status::Error;
+            writer.putName(e.what());
+        }
+
+        out[frameStart + sizeof(uint32_t)] = static_cast<char>(status);
+        writer.endFrame(frameStart);
+    }
+
+    db::wire::Status QBServer::handleCreateTable(db::wire::Reader &in, db::wire::Writer &out)
+    {
+        std::string name(in.getName());
+        auto engine = static_cast<db::wire::Engine>(in.getU8());
+        std::variant<db::QBTable, db::QBTableDynamic> table;
+        if (engine == db::wire::Engine::Dynamic)
+        {
+            db::QBTableDynamic dynamicTable;
+            uint16_t columns = in.getU16();
+            for (uint16_t i = 0; i < columns; ++i)
+            {
+                std::string column(in.getName());
+                dynamicTable.addColumn(column, in.getField());
+            }
+            table = std::move(dynamicTable);
+        }
+        else if (engine != db::wire::Engine::Static)
+            throw db::wire::ProtocolError("Unknown engine");
+
+        if (!hostTable(name, std::move(table)))
+        {
+            out.putName("Table already exists: " + name);
+            return db::wire::Status::Error;
+        }
+        return db::wire::Status::Ok;
+    }
+
+    /**
+     * Serialize matching records straight from table storage into the connection's output buffer
+     */
+    db::wire::Status QBServer::handleFind(db::wire::Reader &in, db::wire::Writer &out)
+    {
+        db::HostedTable *hosted = findTable(in.getName());
+        if (!hosted)
+            return db::wire::Status::NotFound;
+
+        std::shared_lock lock(hosted->mutex);
+        if (auto *table = std::get_if<db::QBTable>(&hosted->table))
+        {
+            auto columnID = static_cast<db::ColumnType>(in.getU8());
+            if (columnID > db::ColumnType::COLUMN3)
+                throw db::wire::ProtocolError("Unknown column");
+            std::string_view literal = in.getString();
+            size_t countPos = out.reserveU32();
+            size_t rows = table->forEachMatching(columnID, literal, [&](const db::QBRecord &rec)
+                                                 { out.putRecord(rec); });
+            out.patchU32(countPos, static_cast<uint32_t>(rows));
+        }
+        else
+        {
+            auto &dynamicTable = std::get<db::QBTableDynamic>(hosted->table);
+            std::string column(in.getName());
+            db::FieldType value = in.getField();
+            if (column == "id" && !std::holds_alternative<db::uint>(value))
+                throw db::wire::ProtocolError("Primary key lookups need a uint field");
+            size_t countPos = out.reserveU32();
+            size_t rows = dynamicTable.forEachMatching(column, value, [&](const db::QBRecordDynamic &rec)
+                                                       { out.putDynamicRecord(rec); });
+            out.patchU32(countPos, static_cast<uint32_t>(rows));
+        }
+        return db::wire::Status::Ok;
+    }
+
+    db::wire::Status QBServer::handleAdd(db::wire::Reader &in, db::wire::Writer &out)
+    {
+        db::HostedTable *hosted = findTable(in.getName());
+        if (!hosted)
+            return db::wire::Status::NotFound;
+
+        if (std::holds_alternative<db::QBTable>(hosted->table))
+        {
+            db::QBRecord rec = in.getRecord();
+            std::lock_guard lock(hosted->mutex);
+            if (!std::get<db::QBTable>(hosted->table).addRecord(rec))
+            {
+                out.putName("Record duplicates a unique index key");
+                return db::wire::Status::BadRequest;
+            }
+            return db::wire::Status::Ok;
+        }
+
+        db::QBRecordDynamic rec = in.getDynamicRecord();
+        std::lock_guard lock(hosted->mutex);
+        if (!std::get<db::QBTableDynamic>(hosted->table).addRecord(rec))
+        {
+            out.putName("Record does not match the table schema");
+            return db::wire::Status::BadRequest;
+        }
+        return db::wire::Status::Ok;
+    }
+
+    db::wire::Status QBServer::handleDelete(db::wire::Reader &in, db::wire::Writer &)
+    {
+        db::HostedTable *hosted = findTable(in.getName());
+        if (!hosted)
+            return db::wire::Status::NotFound;
+        db::uint id = in.getU32();
+        bool hardDelete = in.getU8() != 0;
+
+        std::lock_guard lock(hosted->mutex);
+        bool deleted = std::visit([&](auto &table)
+                                  { return table.deleteRecordByID(id, hardDelete); },
+                                  hosted->table);
+        return deleted ? db::wire::Status::Ok : db::wire::Status::NotFound;
+    }
+
+    db::wire::Status QBServer::handleCreateIndex(db::wire::Reader &in, db::wire::Writer &)
+    {
+        db::HostedTable *hosted = findTable(in.getName());
+        if (!hosted)
+            return db::wire::Status::NotFound;
+
+        if (auto *table = std::get_if<db::QBTable>(&hosted->table))
+        {
+            auto columnID = static_cast<db::ColumnType>(in.getU8());
+            if (columnID > db::ColumnType::COLUMN3)
+                throw db::wire::ProtocolError("Unknown column " + columnName(columnID));
+            std::lock_guard lock(hosted->mutex);
+            table->createIndex(columnID);
+        }
+        else
+        {
+            std::string column(in.getName());
+            std::lock_guard lock(hosted->mutex);
+            std::get<db::QBTableDynamic>(hosted->table).createIndex(column);
+        }
+        return db::wire::Status::Ok;
+    }
+}
@@ -0,0 +1,349 @@
+#include "../include/Quickbase_shm.hpp"
+#include <charconv>
+#include <cstring>
+#include <new>
+#include <thread>
+#include <vector>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Quickbase shared memory table definitions
+// Readers load record fields with plain loads that may race with the writer. Every value read under a
+// version that later changes is discarded, and offsets are bounds-checked before use, so a torn read can
+// at worst cost a retry - the usual seqlock contract.
+namespace db::shm
+{
+    namespace
+    {
+        constexpr size_t kAlignment = 64;
+        // records validated per seqlock read in a scan, so a busy writer costs a retry of one chunk rather than the whole scan
+        constexpr uint64_t kScanChunk = 4096;
+
+        size_t alignUp(size_t value) noexcept
+        {
+            return (value + kAlignment - 1) & ~(kAlignment - 1);
+        }
+
+        size_t bucketIndex(db::uint id, uint64_t bucketCount) noexcept
+        {
+            // Fibonacci hashing - spreads sequential ids over the table
+            return static_cast<size_t>((uint64_t(id) * 0x9E3779B97F4A7C15ull) >> 32) & (bucketCount - 1);
+        }
+
+        template <typename T>
+        bool parseNumber(std::string_view text, T &value) noexcept
+        {
+            auto result = std::from_chars(text.data(), text.data() + text.size(), value);
+            return result.ec == std::errc{} && result.ptr == text.data() + text.size();
+        }
+
+        std::string errnoMessage(const std::string &what, const std::string &name)
+        {
+            return what + " " + name + ": " + std::strerror(errno);
+        }
+    }
+
+    /**
+     * Create the segment - pages are only backed by memory once the writer touches them
+     */
+    SharedTableWriter::SharedTableWriter(std::string name, size_t recordCapacity, size_t stringCapacity) : name_(std::move(name))
+    {
+        if (recordCapacity == 0 || recordCapacity >= UINT32_MAX)
+            throw ShmError("Record capacity must be between 1 and 2^32 - 2");
+        uint64_t bucketCount = 2;
+        while (bucketCount < recordCapacity * 2)
+            bucketCount <<= 1;
+
+        const size_t recordsOffset = alignUp(sizeof(SegmentHeader));
+        const size_t bucketsOffset = alignUp(recordsOffset + recordCapacity * sizeof(SharedRecord));
+        const size_t stringsOffset = alignUp(bucketsOffset + bucketCount * sizeof(uint32_t));
+        size_ = alignUp(stringsOffset + stringCapacity);
+
+        ::shm_unlink(name_.c_str());
+        int fd = ::shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            throw ShmError(errnoMessage("Cannot create shared memory", name_));
+        if (::ftruncate(fd, static_cast<off_t>(size_)) != 0)
+        {
+            ::close(fd);
+            ::shm_unlink(name_.c_str());
+            throw ShmError(errnoMessage("Cannot size shared memory", name_));
+        }
+        void *mapped = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+        {
+            ::shm_unlink(name_.c_str());
+            throw ShmError(errnoMessage("Cannot map shared memory", name_));
+        }
+        base_ = static_cast<char *>(mapped);
+
+        header_ = new (base_) SegmentHeader{};
+        header_->formatVersion = kFormatVersion;
+        header_->segmentSize = size_;
+        header_->recordCapacity = recordCapacity;
+        header_->stringCapacity = stringCapacity;
+        header_->bucketCount = bucketCount;
+        header_->recordsOffset = recordsOffset;
+        header_->bucketsOffset = bucketsOffset;
+        header_->stringsOffset = stringsOffset;
+        // readers accept the segment once the magic is visible
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(header_->magic, kMagic, sizeof(kMagic));
+    }
+
+    SharedTableWriter::~SharedTableWriter()
+    {
+        ::munmap(base_, size_);
+        ::shm_unlink(name_.c_str());
+    }
+
+    void SharedTableWriter::beginWrite() noexcept
+    {
+        header_->version.store(header_->version.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void SharedTableWriter::endWrite() noexcept
+    {
+        header_->version.store(header_->version.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    /**
+     * Linear probing - the bucket holding id, or for inserts the first empty bucket when id is absent
+     * Buckets store record index + 1, 0 marks an empty bucket
+     */
+    uint32_t *SharedTableWriter::bucketFor(db::uint id, bool forInsert)
+    {
+        auto *buckets = reinterpret_cast<uint32_t *>(base_ + header_->bucketsOffset);
+        const auto *records = reinterpret_cast<const SharedRecord *>(base_ + header_->recordsOffset);
+        const uint64_t mask = header_->bucketCount - 1;
+        for (size_t i = bucketIndex(id, header_->bucketCount);; i = (i + 1) & mask)
+        {
+            if (buckets[i] == 0)
+                return forInsert ? &buckets[i] : nullptr;
+            if (records[buckets[i] - 1].column0 == id)
+                return &buckets[i];
+        }
+    }
+
+    void SharedTableWriter::insert(const db::QBRecord &record)
+    {
+        const uint64_t index = header_->recordCount.load(std::memory_order_relaxed);
+        const uint64_t used = header_->stringBytes.load(std::memory_order_relaxed);
+        if (index == header_->recordCapacity || used + record.column1.size() + record.column3.size() > header_->stringCapacity)
+            throw ShmError("Shared memory segment " + name_ + " is full");
+
+        char *strings = base_ + header_->stringsOffset;
+        std::memcpy(strings + used, record.column1.data(), record.column1.size());
+        std::memcpy(strings + used + record.column1.size(), record.column3.data(), record.column3.size());
+
+        auto *records = reinterpret_cast<SharedRecord *>(base_ + header_->recordsOffset);
+        records[index] = {record.column0, 0, record.column2, used, used + record.column1.size(),
+                          static_cast<uint32_t>(record.column1.size()), static_cast<uint32_t>(record.column3.size())};
+        *bucketFor(record.column0, true) = static_cast<uint32_t>(index + 1);
+
+        header_->stringBytes.store(used + record.column1.size() + record.column3.size(), std::memory_order_relaxed);
+        header_->recordCount.store(index + 1, std::memory_order_relaxed);
+        header_->activeCount.store(header_->activeCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+    void SharedTableWriter::addRecord(const db::QBRecord &record)
+    {
+        addRecords({&record, 1});
+    }
+
+    void SharedTableWriter::addRecords(std::span<const db::QBRecord> records)
+    {
+        beginWrite();
+        try
+        {
+            for (const auto &record : records)
+                insert(record);
+        }
+        catch (...)
+        {
+            endWrite();
+            throw;
+        }
+        endWrite();
+    }
+
+    bool SharedTableWriter::deleteRecordByID(db::uint id)
+    {
+        uint32_t *bucket = bucketFor(id, false);
+        if (!bucket)
+            return false;
+        auto &record = reinterpret_cast<SharedRecord *>(base_ + header_->recordsOffset)[*bucket - 1];
+        if (record.deleted)
+            return false;
+        beginWrite();
+        record.deleted = 1;
+        header_->activeCount.store(header_->activeCount.load(std::memory_order_relaxed) - 1, std::memory_order_relaxed);
+        endWrite();
+        return true;
+    }
+
+    size_t SharedTableWriter::activeRecordsCount() const noexcept
+    {
+        return static_cast<size_t>(header_->activeCount.load(std::memory_order_relaxed));
+    }
+
+    /**
+     * Map an existing segment read-only and validate its header
+     */
+    SharedTableReader::SharedTableReader(const std::string &name)
+    {
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            throw ShmError(errnoMessage("Cannot open shared memory", name));
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || size_t(st.st_size) < sizeof(SegmentHeader))
+        {
+            ::close(fd);
+            throw ShmError("Shared memory " + name + " is not a table segment");
+        }
+        size_ = size_t(st.st_size);
+        void *mapped = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            throw ShmError(errnoMessage("Cannot map shared memory", name));
+        base_ = static_cast<const char *>(mapped);
+        header_ = reinterpret_cast<const SegmentHeader *>(base_);
+
+        if (std::memcmp(header_->magic, kMagic, sizeof(kMagic)) != 0 || header_->formatVersion != kFormatVersion || header_->segmentSize > size_)
+        {
+            ::munmap(const_cast<char *>(base_), size_);
+            throw ShmError("Shared memory " + name + " is not a table segment of format " + std::to_string(kFormatVersion));
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+    }
+
+    SharedTableReader::~SharedTableReader()
+    {
+        ::munmap(const_cast<char *>(base_), size_);
+    }
+
+    /**
+     * Run query until it completes under an unchanged, even version
+     */
+    template <typename Query>
+    auto SharedTableReader::consistent(Query &&query) const
+    {
+        for (;;)
+        {
+            const uint64_t before = header_->version.load(std::memory_order_acquire);
+            if ((before & 1) == 0)
+            {
+                auto result = query();
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (header_->version.load(std::memory_order_relaxed) == before)
+                    return result;
+            }
+            retries_.fetch_add(1, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    }
+
+    /**
+     * View of a record with its strings clamped to the heap - only torn reads can be out of range
+     */
+    db::shm::RecordView SharedTableReader::view(const db::shm::SharedRecord &record) const
+    {
+        const char *strings = base_ + header_->stringsOffset;
+        const uint64_t capacity = header_->stringCapacity;
+        auto text = [&](uint64_t offset, uint32_t length)
+        {
+            if (offset > capacity || length > capacity - offset)
+                return std::string_view{};
+            return std::string_view(strings + offset, length);
+        };
+        return {record.column0, text(record.column1Offset, record.column1Length), static_cast<long>(record.column2),
+                text(record.column3Offset, record.column3Length)};
+    }
+
+    std::optional<db::shm::RecordView> SharedTableReader::findByPrimaryKey(db::uint id) const
+    {
+        const auto *buckets = reinterpret_cast<const uint32_t *>(base_ + header_->bucketsOffset);
+        const auto *records = reinterpret_cast<const SharedRecord *>(base_ + header_->recordsOffset);
+        const uint64_t mask = header_->bucketCount - 1;
+        return consistent([&]() -> std::optional<db::shm::RecordView>
+                          {
+                              size_t i = bucketIndex(id, header_->bucketCount);
+                              for (uint64_t probes = 0; probes <= mask; ++probes, i = (i + 1) & mask)
+                              {
+                                  const uint32_t slot = buckets[i];
+                                  if (slot == 0 || slot > header_->recordCapacity)
+                                      return std::nullopt;
+                                  const SharedRecord &record = records[slot - 1];
+                                  if (record.column0 == id)
+                                      return record.deleted ? std::nullopt : std::optional(view(record));
+                              }
+                              return std::nullopt; });
+    }
+
+    /**
+     * Scan the records for matches - views are collected under one consistent version, then visited
+     */
+    size_t SharedTableReader::forEachMatching(db::ColumnType column, std::string_view matchString, const db::shm::RecordViewVisitor &visitor) const
+    {
+        if (column == db::ColumnType::COLUMN0)
+        {
+            db::uint id = 0;
+            if (!parseNumber(matchString, id))
+                return 0;
+            auto record = findByPrimaryKey(id);
+            if (record)
+                visitor(*record);
+            return record ? 1 : 0;
+        }
+        long number = 0;
+        if (column == db::ColumnType::COLUMN2 && !parseNumber(matchString, number))
+            return 0;
+
+        const auto *records = reinterpret_cast<const SharedRecord *>(base_ + header_->recordsOffset);
+        const uint64_t count = std::min(header_->recordCount.load(std::memory_order_acquire), header_->recordCapacity);
+        std::vector<db::shm::RecordView> matches;
+        size_t total = 0;
+        for (uint64_t begin = 0; begin < count; begin += kScanChunk)
+        {
+            const uint64_t end = std::min(count, begin + kScanChunk);
+            consistent([&]
+                       {
+                           matches.clear();
+                           for (uint64_t i = begin; i < end; ++i)
+                           {
+                               const SharedRecord &record = records[i];
+                               if (record.deleted)
+                                   continue;
+                               bool isMatch = false;
+                               if (column == db::ColumnType::COLUMN2)
+                                   isMatch = record.column2 == number;
+                               else
+                               {
+                                   auto rec = view(record);
+                                   isMatch = (column == db::ColumnType::COLUMN1 ? rec.column1 : rec.column3).find(matchString) != std::string_view::npos;
+                               }
+                               if (isMatch)
+                                   matches.push_back(view(record));
+                           }
+                           return matches.size(); });
+            for (const auto &match : matches)
+                visitor(match);
+            total += matches.size();
+        }
+        return total;
+    }
+
+    size_t SharedTableReader::activeRecordsCount() const noexcept
+    {
+        return static_cast<size_t>(header_->activeCount.load(std::memory_order_acquire));
+    }
+
+    uint64_t SharedTableReader::version() const noexcept
+    {
+        return header_->version.load(std::memory_order_acquire);
+    }
+}
@@ -0,0 +1,123 @@
+#include "../include/Quickbase_trace.hpp"
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_WIN32)
+#include <process.h>
+#define QB_GETPID _getpid
+#else
+#include <unistd.h>
+#define QB_GETPID getpid
+#endif
+
+// Quickbase tracing definitions
+namespace db::trace
+{
+    namespace
+    {
+        // ThreadBuffer - ring buffer owned by one writer thread
+        // head_ is published with release ordering after the slot is written, readers acquire it
+        struct ThreadBuffer
+        {
+            uint32_t tid = 0;
+            std::atomic<uint64_t> head{0};
+            std::array<TraceEvent, kThreadBufferEvents> events{};
+        };
+
+        std::atomic<bool> tracingEnabled{false};
+
+        // registry of all thread buffers - only locked on a thread's first event and when dumping
+        std::mutex registryMutex;
+        std::vector<std::shared_ptr<ThreadBuffer>> registry;
+        uint32_t nextThreadId = 1;
+
+        ThreadBuffer &threadBuffer()
+        {
+            // shared ownership keeps the events of finished threads available for the dump
+            thread_local std::shared_ptr<ThreadBuffer> buffer = []
+            {
+                auto created = std::make_shared<ThreadBuffer>();
+                std::lock_guard<std::mutex> lock(registryMutex);
+                created->tid = nextThreadId++;
+                registry.push_back(created);
+                return created;
+            }();
+            return *buffer;
+        }
+    }
+
+    void setEnabled(bool enabled) noexcept
+    {
+        tracingEnabled.store(enabled, std::memory_order_relaxed);
+    }
+
+    bool enabled() noexcept
+    {
+        return tracingEnabled.load(std::memory_order_relaxed);
+    }
+
+    uint64_t nowNs() noexcept
+    {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                         std::chrono::steady_clock::now().time_since_epoch())
+                                         .count());
+    }
+
+    /**
+     * Append a completed span to the calling thread's ring buffer
+     */
+    void record(const char *name, uint64_t startNs, uint64_t durationNs, uint64_t rows) noexcept
+    {
+        ThreadBuffer &buffer = threadBuffer();
+        uint64_t head = buffer.head.load(std::memory_order_relaxed);
+        buffer.events[head % kThreadBufferEvents] = {name, startNs, durationNs, rows};
+        buffer.head.store(head + 1, std::memory_order_release);
+    }
+
+    /**
+     * Dump all buffered events in Chrome trace-event format (complete "X" events, microsecond timestamps)
+     */
+    void writeChromeTrace(std::ostream &out)
+    {
+        std::vector<std::shared_ptr<ThreadBuffer>> buffers;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            buffers = registry;
+        }
+
+        const auto pid = QB_GETPID();
+        bool first = true;
+        out << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+        out << std::fixed << std::setprecision(3);
+        for (const auto &buffer : buffers)
+        {
+            uint64_t head = buffer->head.load(std::memory_order_acquire);
+            uint64_t begin = head > kThreadBufferEvents ? head - kThreadBufferEvents : 0;
+            for (uint64_t i = begin; i < head; ++i)
+            {
+                const TraceEvent &ev = buffer->events[i % kThreadBufferEvents];
+                out << (first ? "" : ",") << "\n  {\"name\": \"" << ev.name << "\", \"cat\": \"qbtable\", \"ph\": \"X\""
+                    << ", \"ts\": " << double(ev.startNs) / 1000.0 << ", \"dur\": " << double(ev.durationNs) / 1000.0
+                    << ", \"pid\": " << pid << ", \"tid\": " << buffer->tid
+                    << ", \"args\": {\"rows\": " << ev.rows << "}}";
+                first = false;
+            }
+        }
+        out << "\n]}\n";
+    }
+
+    /**
+     * Drop all buffered events - threads keep their buffers, only the write positions are reset
+     */
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (const auto &buffer : registry)
+            buffer->head.store(0, std::memory_order_release);
+    }
+}
@@ -0,0 +1,135 @@
+#include "../include/Quickbase_ttl.hpp"
+#include <algorithm>
+#include <bit>
+#include <limits>
+
+// Quickbase time to live definitions
+namespace db
+{
+    namespace
+    {
+        uint64_t tickOf(db::TtlClock::time_point time, bool roundUp)
+        {
+            auto since = time.time_since_epoch();
+            auto ms = roundUp ? std::chrono::ceil<std::chrono::milliseconds>(since) : std::chrono::floor<std::chrono::milliseconds>(since);
+            return ms.count() < 0 ? 0 : static_cast<uint64_t>(ms.count());
+        }
+    }
+
+    TimerWheel::TimerWheel() : now_(tickOf(db::TtlClock::now(), false)) {}
+
+    void TimerWheel::schedule(db::uint id, db::TtlClock::time_point deadline)
+    {
+        ++stats_.scheduled;
+        place({id, tickOf(deadline, true)});
+    }
+
+    /**
+     * File an entry at the lowest level whose range covers its distance from now, or in the due queue
+     */
+    void TimerWheel::place(const Entry &entry)
+    {
+        if (entry.tick <= now_)
+        {
+            due_.push_back(entry);
+            return;
+        }
+        const uint64_t delta = entry.tick - now_;
+        unsigned level = 0;
+        while (level + 1 < kLevels && delta >= (uint64_t(1) << (kLevelBits * (level + 1))))
+            ++level;
+        const uint64_t slot = (entry.tick >> (kLevelBits * level)) & (kSlots - 1);
+        slots_[level][slot].push_back(entry);
+        occupied_[level] |= uint64_t(1) << slot;
+        ++scheduled_;
+    }
+
+    /**
+     * First tick after now at which an occupied slot is reached - slots at or behind the current one of their
+     * level belong to the next turn of the level above
+     */
+    uint64_t TimerWheel::nextEvent() const noexcept
+    {
+        uint64_t next = std::numeric_limits<uint64_t>::max();
+        for (unsigned level = 0; level < kLevels; ++level)
+        {
+            if (!occupied_[level])
+                continue;
+            const unsigned shift = kLevelBits * level;
+            const uint64_t current = (now_ >> shift) & (kSlots - 1);
+            const uint64_t turn = (now_ >> (shift + kLevelBits)) << (shift + kLevelBits);
+            const uint64_t ahead = current + 1 == kSlots ? 0 : occupied_[level] & (~uint64_t(0) << (current + 1));
+            const uint64_t tick = ahead ? turn + (uint64_t(std::countr_zero(ahead)) << shift)
+                                        : turn + (kSlots << shift) + (uint64_t(std::countr_zero(occupied_[level])) << shift);
+            next = std::min(next, tick);
+        }
+        return next;
+    }
+
+    /**
+     * Walk the wheel to now, visiting only ticks where a slot is occupied - on a level boundary the slot of
+     * each level above is cascaded first, top down, then the level 0 slot of the tick becomes due
+     */
+    void TimerWheel::advance(db::TtlClock::time_point now)
+    {
+        const uint64_t target = tickOf(now, false);
+        while (now_ < target)
+        {
+            if (scheduled_ == 0)
+            {
+                now_ = target;
+                break;
+            }
+            now_ = std::min(nextEvent(), target);
+            for (unsigned level = kLevels - 1; level > 0; --level)
+            {
+                const unsigned shift = kLevelBits * level;
+                if ((now_ & ((uint64_t(1) << shift) - 1)) != 0)
+                    continue;
+                const uint64_t slot = (now_ >> shift) & (kSlots - 1);
+                if (!(occupied_[level] & (uint64_t(1) << slot)))
+                    continue;
+                std::vector<Entry> entries = std::move(slots_[level][slot]);
+                slots_[level][slot].clear();
+                occupied_[level] &= ~(uint64_t(1) << slot);
+                scheduled_ -= entries.size();
+                stats_.cascaded += entries.size();
+                for (const Entry &entry : entries)
+                    place(entry);
+            }
+            const uint64_t slot = now_ & (kSlots - 1);
+            if (occupied_[0] & (uint64_t(1) << slot))
+            {
+                auto &entries = slots_[0][slot];
+                due_.insert(due_.end(), entries.begin(), entries.end());
+                scheduled_ -= entries.size();
+                entries.clear();
+                occupied_[0] &= ~(uint64_t(1) << slot);
+            }
+        }
+    }
+
+    size_t TimerWheel::drain(size_t budget, const std::function<void(db::uint)> &visit)
+    {
+        size_t handed = 0;
+        while (handed < budget && !due_.empty())
+        {
+            const db::uint id = due_.front().id;
+            due_.pop_front();
+            ++handed;
+            visit(id);
+        }
+        stats_.fired += handed;
+        return handed;
+    }
+
+    void TimerWheel::clear() noexcept
+    {
+        for (auto &level : slots_)
+            for (auto &slot : level)
+                slot.clear();
+        occupied_.fill(0);
+        scheduled_ = 0;
+        due_.clear();
+    }
+}
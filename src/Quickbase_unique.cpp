@@ -0,0 +1,82 @@
+#include "../include/Quickbase_unique.hpp"
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+// Quickbase unique index definitions
+namespace db
+{
+    void UniqueIndex::insert(uint64_t hash, size_t row)
+    {
+        if (row >= kEmpty)
+            throw std::runtime_error("Unique index rows are limited to 32 bits");
+        if ((size_ + 1) * 4 > slots_.size() * 3)
+            rehash(slots_.empty() ? 16 : slots_.size() * 2);
+        const uint32_t tag = tagOf(hash);
+        size_t i = tag & mask_;
+        while (slots_[i].row != kEmpty)
+            i = (i + 1) & mask_;
+        slots_[i] = {tag, static_cast<uint32_t>(row)};
+        ++size_;
+    }
+
+    /**
+     * Remove an entry and move later entries of the cluster back into the gap when that brings them no further
+     * from their home slot, so every chain stays unbroken without tombstones
+     */
+    bool UniqueIndex::erase(uint64_t hash, size_t row)
+    {
+        if (size_ == 0)
+            return false;
+        size_t i = tagOf(hash) & mask_;
+        while (slots_[i].row != row)
+        {
+            if (slots_[i].row == kEmpty)
+                return false;
+            i = (i + 1) & mask_;
+        }
+        for (size_t j = (i + 1) & mask_; slots_[j].row != kEmpty; j = (j + 1) & mask_)
+        {
+            const size_t home = slots_[j].tag & mask_;
+            if (((j - home) & mask_) >= ((j - i) & mask_))
+            {
+                slots_[i] = slots_[j];
+                i = j;
+            }
+        }
+        slots_[i] = Slot{};
+        --size_;
+        return true;
+    }
+
+    void UniqueIndex::reserve(size_t count)
+    {
+        const size_t needed = std::bit_ceil((count * 4 + 2) / 3);
+        if (needed > slots_.size())
+            rehash(std::max<size_t>(needed, 16));
+    }
+
+    void UniqueIndex::clear() noexcept
+    {
+        slots_.clear();
+        slots_.shrink_to_fit();
+        mask_ = 0;
+        size_ = 0;
+    }
+
+    void UniqueIndex::rehash(size_t capacity)
+    {
+        std::vector<Slot> old(capacity);
+        old.swap(slots_);
+        mask_ = capacity - 1;
+        for (const Slot &slot : old)
+        {
+            if (slot.row == kEmpty)
+                continue;
+            size_t i = slot.tag & mask_;
+            while (slots_[i].row != kEmpty)
+                i = (i + 1) & mask_;
+            slots_[i] = slot;
+        }
+    }
+}
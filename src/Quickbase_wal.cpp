@@ -0,0 +1,292 @@
+#include "../include/Quickbase_wal.hpp"
+#include <algorithm>
+#include <cstring>
+#include "../include/Quickbase_protocol.hpp"
+
+// Quickbase write-ahead log definitions
+namespace db::wal
+{
+    namespace
+    {
+        /**
+         * FNV-1a over an entry's lsn .. payload bytes
+         */
+        uint32_t checksum(const char *data, size_t size) noexcept
+        {
+            uint32_t hash = 2166136261u;
+            for (size_t i = 0; i < size; ++i)
+            {
+                hash ^= static_cast<uint8_t>(data[i]);
+                hash *= 16777619u;
+            }
+            return hash;
+        }
+
+        bool isBatchEntryType(db::wal::EntryType type) noexcept
+        {
+            return type == db::wal::EntryType::Insert || type == db::wal::EntryType::Update || type == db::wal::EntryType::SoftDelete;
+        }
+
+        void putPayload(db::wire::Writer &writer, db::wal::EntryType type, db::uint id, db::ColumnType column, const db::QBRecord *record)
+        {
+            switch (type)
+            {
+            case db::wal::EntryType::Insert:
+            case db::wal::EntryType::Update:
+                writer.putRecord(*record);
+                break;
+            case db::wal::EntryType::SoftDelete:
+            case db::wal::EntryType::HardDelete:
+                writer.putU32(id);
+                break;
+            case db::wal::EntryType::CreateIndex:
+            case db::wal::EntryType::CreateUniqueIndex:
+            case db::wal::EntryType::DropIndex:
+                writer.putU8(static_cast<uint8_t>(column));
+                break;
+            case db::wal::EntryType::Compaction:
+            case db::wal::EntryType::Batch:
+            case db::wal::EntryType::CreateCompositeIndex:
+            case db::wal::EntryType::DropCompositeIndex:
+                break;
+            }
+        }
+
+        /**
+         * Decode the payload of any entry but a Batch, whose type is already set
+         */
+        void getPayload(db::wire::Reader &reader, db::wal::LogEntry &entry)
+        {
+            switch (entry.type)
+            {
+            case db::wal::EntryType::Insert:
+            case db::wal::EntryType::Update:
+                entry.record = reader.getRecord();
+                entry.id = entry.record.column0;
+                break;
+            case db::wal::EntryType::SoftDelete:
+            case db::wal::EntryType::HardDelete:
+                entry.id = reader.getU32();
+                break;
+            case db::wal::EntryType::CreateIndex:
+            case db::wal::EntryType::CreateUniqueIndex:
+            case db::wal::EntryType::DropIndex:
+                entry.column = static_cast<db::ColumnType>(reader.getU8());
+                if (entry.column > db::ColumnType::COLUMN3)
+                    throw WalError("Invalid column in lsn " + std::to_string(entry.lsn));
+                break;
+            case db::wal::EntryType::Compaction:
+                break;
+            default:
+                throw WalError("Unknown entry type in lsn " + std::to_string(entry.lsn));
+            }
+        }
+    }
+
+    int64_t wallClockNs() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * Create (or truncate) the log file and write its magic, so followers can open it right away
+     */
+    LogWriter::LogWriter(const std::string &path, db::wal::LogWriterOptions options) : options_(options)
+    {
+        file_ = std::fopen(path.c_str(), "wb");
+        if (!file_)
+            throw WalError("Cannot create write-ahead log " + path);
+        buffer_.reserve(options_.bufferSize + 256);
+        buffer_.insert(buffer_.end(), std::begin(kMagic), std::end(kMagic));
+        flush();
+    }
+
+    LogWriter::~LogWriter()
+    {
+        try
+        {
+            flush();
+        }
+        catch (const WalError &)
+        {
+            // nothing left to report to in a destructor
+        }
+        std::fclose(file_);
+    }
+
+    /**
+     * Encode one entry into the buffer and flush when it is full or the last flush is too old
+     */
+    void LogWriter::append(db::wal::EntryType type, db::uint id, db::ColumnType column, const db::QBRecord *record,
+                           std::span<const db::wal::LogEntry> batch, std::span<const db::ColumnType> columns)
+    {
+        const uint64_t lsn = lastLsn_ + 1;
+        const int64_t now = wallClockNs();
+        const size_t start = buffer_.size();
+
+        db::wire::Writer writer(buffer_);
+        writer.putU32(0); // length
+        writer.putU32(0); // checksum
+        writer.putU64(lsn);
+        writer.putI64(now);
+        writer.putU8(static_cast<uint8_t>(type));
+        if (type == db::wal::EntryType::Batch)
+        {
+            writer.putU32(static_cast<uint32_t>(batch.size()));
+            for (const db::wal::LogEntry &entry : batch)
+            {
+                if (!isBatchEntryType(entry.type))
+                    throw WalError("A batch holds only Insert, Update and SoftDelete entries");
+                writer.putU8(static_cast<uint8_t>(entry.type));
+                putPayload(writer, entry.type, entry.id, entry.column, &entry.record);
+            }
+        }
+        else if (type == db::wal::EntryType::CreateCompositeIndex || type == db::wal::EntryType::DropCompositeIndex)
+        {
+            writer.putU8(static_cast<uint8_t>(columns.size()));
+            for (db::ColumnType indexed : columns)
+                writer.putU8(static_cast<uint8_t>(indexed));
+        }
+        else
+            putPayload(writer, type, id, column, record);
+
+        const char *body = buffer_.data() + start + kEntryHeaderSize;
+        const auto length = static_cast<uint32_t>(buffer_.size() - start - kEntryHeaderSize);
+        const uint32_t sum = checksum(body, length);
+        std::memcpy(buffer_.data() + start, &length, sizeof(length));
+        std::memcpy(buffer_.data() + start + sizeof(length), &sum, sizeof(sum));
+        lastLsn_ = lsn;
+
+        if (buffer_.size() >= options_.bufferSize || now - lastFlushNs_ >= std::chrono::nanoseconds(options_.flushInterval).count())
+            flush();
+    }
+
+    /**
+     * Write buffered entries to the file and hand them to the OS, making them visible to followers
+     */
+    void LogWriter::flush()
+    {
+        lastFlushNs_ = wallClockNs();
+        if (buffer_.empty())
+            return;
+        if (std::fwrite(buffer_.data(), 1, buffer_.size(), file_) != buffer_.size() || std::fflush(file_) != 0)
+            throw WalError("Write-ahead log write failed");
+        bytesWritten_ += buffer_.size();
+        buffer_.clear();
+        flushedLsn_ = lastLsn_;
+    }
+
+    LogReader::LogReader(const std::string &path)
+    {
+        file_ = std::fopen(path.c_str(), "rb");
+        if (!file_)
+            throw WalError("Cannot open write-ahead log " + path);
+    }
+
+    LogReader::~LogReader()
+    {
+        std::fclose(file_);
+    }
+
+    /**
+     * Make at least needed unread bytes available, false if the file does not hold them yet
+     */
+    bool LogReader::fill(size_t needed)
+    {
+        while (buffer_.size() - begin_ < needed)
+        {
+            // drop consumed bytes before growing the buffer
+            if (begin_ > 0)
+            {
+                buffer_.erase(buffer_.begin(), buffer_.begin() + static_cast<std::ptrdiff_t>(begin_));
+                begin_ = 0;
+            }
+            const size_t have = buffer_.size();
+            buffer_.resize(have + std::max<size_t>(needed - have, 64 << 10));
+            const size_t got = std::fread(buffer_.data() + have, 1, buffer_.size() - have, file_);
+            buffer_.resize(have + got);
+            if (got == 0)
+            {
+                // at the current end of a growing file - clear EOF so the next call reads appended data
+                std::clearerr(file_);
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * Decode the next complete entry
+     */
+    bool LogReader::next(db::wal::LogEntry &entry)
+    {
+        if (!headerRead_)
+        {
+            if (!fill(sizeof(kMagic)))
+                return false;
+            if (std::memcmp(buffer_.data() + begin_, kMagic, sizeof(kMagic)) != 0)
+                throw WalError("Not a write-ahead log");
+            begin_ += sizeof(kMagic);
+            bytesRead_ += sizeof(kMagic);
+            headerRead_ = true;
+        }
+
+        if (!fill(kEntryHeaderSize))
+            return false;
+        uint32_t length, sum;
+        std::memcpy(&length, buffer_.data() + begin_, sizeof(length));
+        std::memcpy(&sum, buffer_.data() + begin_ + sizeof(length), sizeof(sum));
+        if (length < kEntryFixedSize || length > db::wire::kMaxFrameSize)
+            throw WalError("Invalid entry length " + std::to_string(length) + " after lsn " + std::to_string(lastLsn_));
+        if (!fill(kEntryHeaderSize + length))
+            return false;
+
+        const char *body = buffer_.data() + begin_ + kEntryHeaderSize;
+        if (checksum(body, length) != sum)
+            throw WalError("Checksum mismatch after lsn " + std::to_string(lastLsn_));
+
+        db::wire::Reader reader(body, length);
+        const uint64_t lsn = reader.getU64();
+        if (lsn != lastLsn_ + 1)
+            throw WalError("Sequence gap: lsn " + std::to_string(lsn) + " after " + std::to_string(lastLsn_));
+        entry.lsn = lsn;
+        entry.timestampNs = reader.getI64();
+        entry.type = static_cast<db::wal::EntryType>(reader.getU8());
+        entry.batch.clear();
+        entry.columns.clear();
+        if (entry.type == db::wal::EntryType::CreateCompositeIndex || entry.type == db::wal::EntryType::DropCompositeIndex)
+        {
+            entry.columns.resize(reader.getU8());
+            for (db::ColumnType &indexed : entry.columns)
+            {
+                indexed = static_cast<db::ColumnType>(reader.getU8());
+                if (indexed > db::ColumnType::COLUMN3)
+                    throw WalError("Invalid column in lsn " + std::to_string(lsn));
+            }
+        }
+        else if (entry.type == db::wal::EntryType::Batch)
+        {
+            const uint32_t count = reader.getU32();
+            // every batched entry takes at least a type and a u32 id
+            if (count > length / 5)
+                throw WalError("Invalid batch size in lsn " + std::to_string(lsn));
+            entry.batch.resize(count);
+            for (db::wal::LogEntry &batched : entry.batch)
+            {
+                batched.lsn = lsn;
+                batched.timestampNs = entry.timestampNs;
+                batched.type = static_cast<db::wal::EntryType>(reader.getU8());
+                if (!isBatchEntryType(batched.type))
+                    throw WalError("Invalid batched entry type in lsn " + std::to_string(lsn));
+                getPayload(reader, batched);
+            }
+        }
+        else
+            getPayload(reader, entry);
+
+        begin_ += kEntryHeaderSize + length;
+        bytesRead_ += kEntryHeaderSize + length;
+        lastLsn_ = lsn;
+        return true;
+    }
+}
@@ -0,0 +1,175 @@
+/*
+ * Quickbase C API microbenchmark - per-call overhead of the C ABI and cost of reading columnar results
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "Quickbase_c.h"
+
+#define DEFAULT_RECORDS 100000
+#define KEYS 1024
+#define CALLS 1000000
+
+static double nowNs(void)
+{
+    struct timespec ts;
+    timespec_get(&ts, TIME_UTC);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void report(const char *operation, double totalNs, size_t calls, size_t rows)
+{
+    printf("  %-36s %12.1f ns/call", operation, totalNs / (double)calls);
+    if (rows > 0)
+        printf(" %10.2f ns/row", totalNs / (double)rows);
+    printf("\n");
+}
+
+static void check(qb_status status, const char *what)
+{
+    if (status != QB_OK)
+    {
+        fprintf(stderr, "%s failed: %s\n", what, qb_last_error());
+        exit(1);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    size_t records = argc > 1 ? strtoul(argv[1], NULL, 10) : DEFAULT_RECORDS;
+    if (records < KEYS)
+        records = KEYS;
+
+    printf("\n================================================================================\n");
+    printf("C API CALL OVERHEAD (ABI version %d)\n", qb_abi_version());
+    printf("================================================================================\n");
+    printf("  - Records: %zu\n\n", records);
+
+    /* records with the demo's data layout, strings live in two flat buffers */
+    qb_record *data = malloc(records * sizeof(qb_record));
+    char *column1 = malloc(records * 32);
+    char *column3 = malloc(records * 32);
+    char (*keys)[16] = malloc(KEYS * sizeof *keys);
+    if (!data || !column1 || !column3 || !keys)
+        return 1;
+    for (size_t i = 0; i < records; ++i)
+    {
+        char *c1 = column1 + i * 32;
+        char *c3 = column3 + i * 32;
+        data[i].column0 = (uint32_t)i;
+        data[i].column1 = c1;
+        data[i].column1_length = (size_t)snprintf(c1, 32, "testdata%zu", i);
+        data[i].column2 = (int64_t)(i % 100);
+        data[i].column3 = c3;
+        data[i].column3_length = (size_t)snprintf(c3, 32, "%zutestdata", i);
+    }
+    for (size_t k = 0; k < KEYS; ++k)
+        snprintf(keys[k], sizeof keys[k], "%zu", (k * 7919) % records);
+
+    /* ingest - one call per record against one call for all */
+    qb_table *single = qb_table_create();
+    double start = nowNs();
+    for (size_t i = 0; i < records; ++i)
+        check(qb_add_record(single, &data[i]), "qb_add_record");
+    report("qb_add_record", nowNs() - start, records, 0);
+    qb_table_destroy(single);
+
+    qb_table *table = qb_table_create();
+    start = nowNs();
+    check(qb_add_records(table, data, records), "qb_add_records");
+    report("qb_add_records (bulk, per record)", nowNs() - start, records, 0);
+    check(qb_create_index(table, 2), "qb_create_index");
+
+    /* a call that does no work - the cost of crossing the ABI */
+    size_t sink = 0;
+    start = nowNs();
+    for (size_t i = 0; i < CALLS; ++i)
+        sink += (size_t)qb_abi_version();
+    report("qb_abi_version (empty call)", nowNs() - start, CALLS, 0);
+
+    /* primary key lookup, result read in place and released */
+    uint64_t checksum = 0;
+    start = nowNs();
+    for (size_t i = 0; i < CALLS / 10; ++i)
+    {
+        const char *key = keys[i % KEYS];
+        qb_result *result = NULL;
+        check(qb_find(table, 0, key, strlen(key), &result), "qb_find");
+        const qb_column *ids = qb_result_column(result, 0);
+        if (qb_result_rows(result) == 1)
+            checksum += ((const uint32_t *)ids->values)[0];
+        qb_result_free(result);
+    }
+    report("qb_find column0 + qb_result_free", nowNs() - start, CALLS / 10, 0);
+
+    /* secondary index lookup returning ~1% of the table, every column read */
+    size_t rowsRead = 0;
+    start = nowNs();
+    for (size_t i = 0; i < 1000; ++i)
+    {
+        char match[8];
+        int length = snprintf(match, sizeof match, "%zu", i % 100);
+        qb_result *result = NULL;
+        check(qb_find(table, 2, match, (size_t)length, &result), "qb_find");
+        size_t rows = qb_result_rows(result);
+        const uint32_t *column0 = qb_result_column(result, 0)->values;
+        const qb_column *strings = qb_result_column(result, 1);
+        const int64_t *column2 = qb_result_column(result, 2)->values;
+        for (size_t r = 0; r < rows; ++r)
+            checksum += column0[r] + (uint64_t)column2[r] + (strings->offsets[r + 1] - strings->offsets[r]);
+        rowsRead += rows;
+        qb_result_free(result);
+    }
+    report("qb_find column2 (indexed) + read", nowNs() - start, 1000, rowsRead);
+
+    /* dynamic table - bulk add and primary key lookups */
+    qb_table *dynamicTable = qb_table_create_dynamic();
+    qb_value emptyString = {QB_FIELD_STRING, {.s = {"", 0}}};
+    qb_value zero = {QB_FIELD_LONG, {.l = 0}};
+    check(qb_dynamic_add_column(dynamicTable, "column1", emptyString), "qb_dynamic_add_column");
+    check(qb_dynamic_add_column(dynamicTable, "column2", zero), "qb_dynamic_add_column");
+    qb_field *fields = malloc(records * 2 * sizeof(qb_field));
+    qb_dynamic_record *dynamicRecords = malloc(records * sizeof(qb_dynamic_record));
+    if (!fields || !dynamicRecords)
+        return 1;
+    for (size_t i = 0; i < records; ++i)
+    {
+        fields[2 * i].name = "column1";
+        fields[2 * i].value.type = QB_FIELD_STRING;
+        fields[2 * i].value.as.s.data = data[i].column1;
+        fields[2 * i].value.as.s.length = data[i].column1_length;
+        fields[2 * i + 1].name = "column2";
+        fields[2 * i + 1].value.type = QB_FIELD_LONG;
+        fields[2 * i + 1].value.as.l = data[i].column2;
+        dynamicRecords[i].id = data[i].column0;
+        dynamicRecords[i].fields = &fields[2 * i];
+        dynamicRecords[i].field_count = 2;
+    }
+    start = nowNs();
+    check(qb_dynamic_add_records(dynamicTable, dynamicRecords, records), "qb_dynamic_add_records");
+    report("qb_dynamic_add_records (per record)", nowNs() - start, records, 0);
+
+    start = nowNs();
+    for (size_t i = 0; i < CALLS / 10; ++i)
+    {
+        qb_value id = {QB_FIELD_UINT, {.u = (uint32_t)((i * 7919) % records)}};
+        qb_result *result = NULL;
+        check(qb_dynamic_find(dynamicTable, "id", id, &result), "qb_dynamic_find");
+        checksum += qb_result_rows(result);
+        qb_result_free(result);
+    }
+    report("qb_dynamic_find id + qb_result_free", nowNs() - start, CALLS / 10, 0);
+
+    printf("\n  (checksum %llu, %zu, %zu active)\n", (unsigned long long)checksum, sink, qb_table_active_count(table));
+
+    qb_table_destroy(dynamicTable);
+    qb_table_destroy(table);
+    free(dynamicRecords);
+    free(fields);
+    free(keys);
+    free(column3);
+    free(column1);
+    free(data);
+    return 0;
+}
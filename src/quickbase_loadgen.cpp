@@ -0,0 +1,311 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include "../include/Quickbase_client.hpp"
+#include "../include/Quickbase_server.hpp"
+
+#define DEFAULT_RECORDS 100000
+#define DEFAULT_REQUESTS 20000
+#define LOAD_BATCH 256
+
+/**
+    Load generator settings
+*/
+struct LoadOptions
+{
+    std::string host = "127.0.0.1";
+    uint16_t port = 7070;
+    std::string unixPath;
+    unsigned connections = 4;
+    size_t requests = DEFAULT_REQUESTS; // per connection
+    db::uint records = DEFAULT_RECORDS;
+    std::string query = "pk"; // pk | column2
+    std::vector<size_t> pipelineDepths = {1}; // requests in flight per connection, one run per depth
+    bool embedded = false;    // run the server in this process
+};
+
+void connect(db::QBClient &client, const LoadOptions &options)
+{
+    if (options.unixPath.empty())
+        client.connectTcp(options.host, options.port);
+    else
+        client.connectUnix(options.unixPath);
+}
+
+/**
+    Create and populate the benchmark table - adds are sent in pipelined batches
+*/
+void populate(const LoadOptions &options)
+{
+    db::QBClient client;
+    connect(client, options);
+    if (client.createTable("loadgen") != db::wire::Status::Ok)
+    {
+        std::cout << "  - Table 'loadgen' already exists, reusing it" << std::endl;
+        return;
+    }
+
+    std::vector<char> batch;
+    size_t pending = 0;
+    for (db::uint i = 0; i < options.records; ++i)
+    {
+        db::QBRecord rec = {i, "testdata" + std::to_string(i), long(i % 100), std::to_string(i) + "testdata"};
+        client.encodeRequest(batch, db::wire::Opcode::Add, [&](db::wire::Writer &w)
+                             {
+                                 w.putName("loadgen");
+                                 w.putRecord(rec); });
+        if (++pending == LOAD_BATCH || i + 1 == options.records)
+        {
+            client.send(batch);
+            for (; pending > 0; --pending)
+                client.receive();
+            batch.clear();
+        }
+    }
+    client.createIndex("loadgen", db::ColumnType::COLUMN2);
+}
+
+/**
+    Keep up to `depth` requests in flight on a single connection and record per-request latency in microseconds
+    Refills are sent as one write once every response already buffered has been consumed
+*/
+void runConnection(const LoadOptions &options, size_t depth, unsigned seed, std::vector<double> &latenciesUs, size_t &errors)
+{
+    using namespace std::chrono;
+
+    db::QBClient client;
+    connect(client, options);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<db::uint> pick(0, options.records - 1);
+    const db::ColumnType column = options.query == "column2" ? db::ColumnType::COLUMN2 : db::ColumnType::COLUMN0;
+
+    latenciesUs.reserve(options.requests);
+    std::vector<steady_clock::time_point> sentAt(options.requests);
+    std::vector<db::uint> keys(options.requests);
+    std::vector<char> frames;
+    uint32_t firstRequestId = 0;
+    size_t sent = 0;
+    size_t received = 0;
+    while (received < options.requests)
+    {
+        for (; sent < options.requests && sent - received < depth; ++sent)
+        {
+            db::uint key = keys[sent] = pick(rng);
+            std::string literal = std::to_string(column == db::ColumnType::COLUMN2 ? key % 100 : key);
+            uint32_t requestId = client.encodeRequest(frames, db::wire::Opcode::Find, [&](db::wire::Writer &w)
+                                                      {
+                                                          w.putName("loadgen");
+                                                          w.putU8(static_cast<uint8_t>(column));
+                                                          w.putString(literal); });
+            if (sent == 0)
+                firstRequestId = requestId;
+        }
+        if (!frames.empty())
+        {
+            auto now = steady_clock::now();
+            for (size_t i = received; i < sent; ++i)
+                if (sentAt[i] == steady_clock::time_point{})
+                    sentAt[i] = now;
+            client.send(frames);
+            frames.clear();
+        }
+
+        do
+        {
+            db::ClientResponse response = client.receive();
+            size_t idx = response.requestId - firstRequestId;
+            latenciesUs.push_back(duration<double, std::micro>(steady_clock::now() - sentAt[idx]).count());
+            ++received;
+
+            // every key exists, so a primary key lookup must return exactly the requested record
+            db::wire::Reader reader = response.reader();
+            if (response.status != db::wire::Status::Ok)
+                ++errors;
+            else if (column == db::ColumnType::COLUMN0 && (reader.getU32() != 1 || reader.getRecord().column0 != keys[idx]))
+                ++errors;
+        } while (client.hasBufferedResponse());
+    }
+}
+
+/**
+    Summary of one run at a given pipeline depth
+*/
+struct RunResult
+{
+    size_t depth = 1;
+    double requestsPerSecond = 0;
+    double meanUs = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double p999Us = 0;
+    double maxUs = 0;
+    size_t errors = 0;
+};
+
+double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t idx = std::min(sorted.size() - 1, size_t(p / 100.0 * double(sorted.size())));
+    return sorted[idx];
+}
+
+RunResult runAtDepth(const LoadOptions &options, size_t depth)
+{
+    using namespace std::chrono;
+
+    std::vector<std::vector<double>> latencies(options.connections);
+    std::vector<size_t> errors(options.connections, 0);
+    std::vector<std::thread> clients;
+    auto runStart = steady_clock::now();
+    for (unsigned c = 0; c < options.connections; ++c)
+        clients.emplace_back([&, c]
+                             { runConnection(options, depth, c + 1, latencies[c], errors[c]); });
+    for (auto &t : clients)
+        t.join();
+    double elapsedS = duration<double>(steady_clock::now() - runStart).count();
+
+    std::vector<double> all;
+    for (const auto &l : latencies)
+        all.insert(all.end(), l.begin(), l.end());
+    std::sort(all.begin(), all.end());
+
+    RunResult result;
+    result.depth = depth;
+    for (double v : all)
+        result.meanUs += v;
+    result.meanUs = all.empty() ? 0 : result.meanUs / double(all.size());
+    result.requestsPerSecond = double(all.size()) / elapsedS;
+    result.p50Us = percentile(all, 50);
+    result.p99Us = percentile(all, 99);
+    result.p999Us = percentile(all, 99.9);
+    result.maxUs = all.empty() ? 0 : all.back();
+    for (size_t e : errors)
+        result.errors += e;
+    return result;
+}
+
+/**
+    Parse a comma separated list of pipeline depths, e.g. "1,16,128"
+*/
+std::vector<size_t> parseDepths(const std::string &list)
+{
+    std::vector<size_t> depths;
+    size_t start = 0;
+    while (start <= list.size())
+    {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos)
+            end = list.size();
+        long depth = std::atol(list.substr(start, end - start).c_str());
+        if (depth > 0)
+            depths.push_back(static_cast<size_t>(depth));
+        start = end + 1;
+    }
+    return depths.empty() ? std::vector<size_t>{1} : depths;
+}
+
+/**
+    Print command line usage
+*/
+void printUsage(const char *program)
+{
+    std::cout << "Usage:\n"
+              << "  " << program << " [--host <ipv4>] [--port <port>] [--unix <path>] [--embedded]\n"
+              << "      [--connections <n>] [--requests <n>] [--records <n>] [--query pk|column2] [--pipeline <d1,d2,..>]\n"
+              << "\n"
+              << "  --embedded     start the server inside the load generator process\n"
+              << "  --connections  concurrent client connections, one thread each (default 4)\n"
+              << "  --requests     requests per connection (default " << DEFAULT_REQUESTS << ")\n"
+              << "  --records      records loaded into the 'loadgen' table (default " << DEFAULT_RECORDS << ")\n"
+              << "  --query        pk = primary key lookups, column2 = secondary index lookups\n"
+              << "  --pipeline     requests in flight per connection, one run per listed depth (default 1)\n";
+}
+
+int main(int argc, char **argv)
+{
+    using namespace std::chrono;
+
+    LoadOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc)
+            options.host = argv[++i];
+        else if (arg == "--port" && i + 1 < argc)
+            options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (arg == "--unix" && i + 1 < argc)
+            options.unixPath = argv[++i];
+        else if (arg == "--connections" && i + 1 < argc)
+            options.connections = std::max(1u, static_cast<unsigned>(std::atoi(argv[++i])));
+        else if (arg == "--requests" && i + 1 < argc)
+            options.requests = static_cast<size_t>(std::atol(argv[++i]));
+        else if (arg == "--records" && i + 1 < argc)
+            options.records = std::max(1u, static_cast<db::uint>(std::atol(argv[++i])));
+        else if (arg == "--query" && i + 1 < argc)
+            options.query = argv[++i];
+        else if (arg == "--pipeline" && i + 1 < argc)
+            options.pipelineDepths = parseDepths(argv[++i]);
+        else if (arg == "--embedded")
+            options.embedded = true;
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    std::unique_ptr<db::QBServer> server;
+    try
+    {
+        if (options.embedded)
+        {
+            server = std::make_unique<db::QBServer>(db::ServerOptions{options.host, options.port, options.unixPath, 0});
+            server->start();
+        }
+
+        std::cout << "\n"
+                  << std::string(80, '=') << std::endl;
+        std::cout << "TABLE SERVER LOAD GENERATOR" << std::endl;
+        std::cout << std::string(80, '=') << std::endl;
+        std::cout << "  - Endpoint: " << (options.unixPath.empty() ? options.host + ":" + std::to_string(options.port) : options.unixPath)
+                  << (options.embedded ? " (embedded server)" : "") << std::endl;
+        std::cout << "  - Records: " << options.records << std::endl;
+        std::cout << "  - Connections: " << options.connections << std::endl;
+        std::cout << "  - Requests per connection: " << options.requests << " (" << options.query << " lookups)" << std::endl;
+
+        auto loadStart = steady_clock::now();
+        populate(options);
+        std::cout << "  - Load time: " << std::fixed << std::setprecision(1)
+                  << duration<double, std::milli>(steady_clock::now() - loadStart).count() << " ms\n"
+                  << std::endl;
+
+        std::cout << std::left << std::setw(10) << "  Depth" << std::right
+                  << std::setw(14) << "Requests/s" << std::setw(12) << "Mean us" << std::setw(12) << "p50 us"
+                  << std::setw(12) << "p99 us" << std::setw(12) << "p99.9 us" << std::setw(12) << "Max us" << std::endl;
+        std::cout << "  " << std::string(82, '-') << std::endl;
+        for (size_t depth : options.pipelineDepths)
+        {
+            RunResult r = runAtDepth(options, depth);
+            std::cout << "  " << std::left << std::setw(8) << r.depth << std::right << std::setprecision(0)
+                      << std::setw(14) << r.requestsPerSecond << std::setprecision(1)
+                      << std::setw(12) << r.meanUs << std::setw(12) << r.p50Us << std::setw(12) << r.p99Us
+                      << std::setw(12) << r.p999Us << std::setw(12) << r.maxUs << std::endl;
+            if (r.errors > 0)
+                std::cout << "  ! " << r.errors << " unexpected responses" << std::endl;
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Load generator failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,374 @@
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <cstring>
+#include <cstddef>
+#include <new>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+#include <stdexcept>
+#include "../include/Quickbase.hpp"
+#include "../include/Quickbase_dynamic.hpp"
+#if defined(__linux__)
+#include <unistd.h>
+#endif
+
+#define DEFAULT_DATA_SIZE 20000
+// every N-th record is soft deleted before compactRecords() is measured
+#define DELETE_STRIDE 50
+
+// ============================================================================
+// ALLOCATOR HOOKS
+// ============================================================================
+
+// Every allocation made through global operator new is prefixed with a small header
+// holding the requested size, so that operator delete can account for it even when
+// the unsized overload is called. The header is sized to keep default new alignment.
+namespace
+{
+    constexpr size_t kHeaderSize = alignof(std::max_align_t);
+
+    size_t liveBytes = 0;
+    size_t peakBytes = 0;
+
+    void *countedAlloc(size_t size) noexcept
+    {
+        void *raw = std::malloc(size + kHeaderSize);
+        if (raw == nullptr)
+            return nullptr;
+        std::memcpy(raw, &size, sizeof(size));
+        liveBytes += size;
+        if (liveBytes > peakBytes)
+            peakBytes = liveBytes;
+        return static_cast<char *>(raw) + kHeaderSize;
+    }
+
+    void countedFree(void *ptr) noexcept
+    {
+        if (ptr == nullptr)
+            return;
+        void *raw = static_cast<char *>(ptr) - kHeaderSize;
+        size_t size = 0;
+        std::memcpy(&size, raw, sizeof(size));
+        liveBytes -= size;
+        std::free(raw);
+    }
+}
+
+void *operator new(size_t size)
+{
+    if (void *ptr = countedAlloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void *operator new[](size_t size)
+{
+    if (void *ptr = countedAlloc(size))
+        return ptr;
+    throw std::bad_alloc();
+}
+void *operator new(size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+void *operator new[](size_t size, const std::nothrow_t &) noexcept { return countedAlloc(size); }
+void operator delete(void *ptr) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr) noexcept { countedFree(ptr); }
+void operator delete(void *ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr, size_t) noexcept { countedFree(ptr); }
+void operator delete(void *ptr, const std::nothrow_t &) noexcept { countedFree(ptr); }
+void operator delete[](void *ptr, const std::nothrow_t &) noexcept { countedFree(ptr); }
+
+// ============================================================================
+// MEASUREMENT HELPERS
+// ============================================================================
+
+/**
+    Resident set size of the process in bytes, or 0 when the platform does not expose it
+    Only implemented for Linux (/proc/self/statm) - RSS deltas are reported as n/a elsewhere
+*/
+size_t residentBytes()
+{
+#if defined(__linux__)
+    static const size_t pageSize = size_t(sysconf(_SC_PAGESIZE));
+    std::ifstream statm("/proc/self/statm");
+    size_t totalPages = 0, residentPages = 0;
+    if (statm >> totalPages >> residentPages)
+        return residentPages * pageSize;
+#endif
+    return 0;
+}
+
+/**
+    Snapshot of allocator and RSS counters taken before an operation
+    peakSince() reports the high-water mark reached by the operation above the snapshot
+*/
+struct MemoryProbe
+{
+    size_t live;
+    size_t rss;
+
+    static MemoryProbe start()
+    {
+        peakBytes = liveBytes;
+        return {liveBytes, residentBytes()};
+    }
+    double liveDelta() const { return double(liveBytes) - double(live); }
+    double rssDelta() const
+    {
+        size_t now = residentBytes();
+        return (now == 0 || rss == 0) ? 0.0 : double(now) - double(rss);
+    }
+    double peakSince() const { return double(peakBytes) - double(live); }
+};
+
+// ============================================================================
+// DATASET AND ENGINE ADAPTERS
+// ============================================================================
+
+/**
+    Build a string of exactly `length` characters ending with the record number
+    Lengths around the std::string SSO capacity (15 for libstdc++/MSVC, 22 for libc++)
+    decide whether a column costs an extra heap block per record
+    Long record numbers cut the prefix, not the digits, so values stay unique while the number fits
+*/
+std::string paddedValue(const std::string &prefix, db::uint i, size_t length)
+{
+    std::string value = prefix + std::to_string(i);
+    if (value.size() < length)
+        value.insert(prefix.size(), length - value.size(), 'x');
+    else
+        value.erase(0, value.size() - length);
+    return value;
+}
+
+std::vector<db::QBRecord> populateDummyData(db::uint numRecords, size_t stringLength)
+{
+    std::vector<db::QBRecord> data;
+    data.reserve(numRecords);
+    for (db::uint i = 0; i < numRecords; i++)
+        data.push_back({i, paddedValue("c1_", i, stringLength), long(i % 100), paddedValue("c3_", i, stringLength)});
+    return data;
+}
+
+// index sets benchmarked for every engine - column0 / id is always indexed
+struct IndexSet
+{
+    const char *name;
+    std::vector<db::ColumnType> columns;
+    db::IndexKind kind = db::IndexKind::General;
+};
+
+const std::vector<IndexSet> &indexSets()
+{
+    static const std::vector<IndexSet> sets = {
+        {"pk only", {}},
+        {"column2", {db::ColumnType::COLUMN2}},
+        {"column1", {db::ColumnType::COLUMN1}},
+        {"uq col1", {db::ColumnType::COLUMN1}, db::IndexKind::Unique},
+        {"all", {db::ColumnType::COLUMN1, db::ColumnType::COLUMN2, db::ColumnType::COLUMN3}},
+    };
+    return sets;
+}
+
+std::string dynamicColumnName(db::ColumnType columnID)
+{
+    return "column" + std::to_string(static_cast<int>(columnID));
+}
+
+/**
+    Thin adapters so that every scenario drives QBTable and QBTableDynamic through identical steps
+*/
+struct StaticEngine
+{
+    static constexpr const char *name = "QBTable";
+    static constexpr bool uniqueIndexes = true;
+    db::QBTable table;
+
+    void load(const std::vector<db::QBRecord> &data)
+    {
+        // a rejected insert would report memory for fewer rows than requested
+        for (const auto &rec : data)
+            if (!table.addRecord(rec))
+                throw std::runtime_error("Record " + std::to_string(rec.column0) + " rejected, column values are not unique");
+    }
+    void createIndex(db::ColumnType columnID, db::IndexKind kind) { table.createIndex(columnID, kind); }
+    void deleteRecord(db::uint id) { table.deleteRecordByID(id); }
+    void compact() { table.compactRecords(); }
+    size_t activeRecords() const { return table.activeRecordsCount(); }
+};
+
+struct DynamicEngine
+{
+    static constexpr const char *name = "QBTableDynamic";
+    static constexpr bool uniqueIndexes = false;
+    db::QBTableDynamic table;
+
+    DynamicEngine()
+    {
+        table.addColumn("column1", std::string{});
+        table.addColumn("column2", 0L);
+        table.addColumn("column3", std::string{});
+    }
+    void load(const std::vector<db::QBRecord> &data)
+    {
+        for (const auto &rec : data)
+            if (!table.addRecord({rec.column0, {{"column1", rec.column1}, {"column2", rec.column2}, {"column3", rec.column3}}}))
+                throw std::runtime_error("Record " + std::to_string(rec.column0) + " rejected by the table schema");
+    }
+    void createIndex(db::ColumnType columnID, db::IndexKind) { table.createIndex(dynamicColumnName(columnID)); }
+    void deleteRecord(db::uint id) { table.deleteRecordByID(id); }
+    void compact() { table.compactRecords(); }
+    size_t activeRecords() const { return table.activeRecordsCount(); }
+};
+
+// ============================================================================
+// SCENARIOS
+// ============================================================================
+
+/**
+    Helper struct to hold one measured engine/layout/index combination
+*/
+struct MemoryResult
+{
+    std::string engine;
+    std::string layout;
+    std::string indexes;
+    size_t stringLength;
+    double bytesPerRow;        // allocator bytes for records + pk index, per row
+    double rssBytesPerRow;     // RSS delta for the same load, per row
+    double bytesPerIndexEntry; // allocator bytes of secondary indexes, per indexed entry
+    double peakIndexBytes;     // peak above baseline while building secondary indexes
+    double peakCompactBytes;   // peak above baseline during compactRecords()
+};
+
+/**
+    Measure one combination
+    layout "load+index" - records are loaded first, then createIndex() is called per column
+    layout "index+load" - indexes are created on the empty table and maintained by addRecord()
+*/
+template <typename Engine>
+MemoryResult measure(const std::vector<db::QBRecord> &data, const IndexSet &indexSet, bool indexFirst, size_t stringLength, double baselineBytesPerRow)
+{
+    MemoryResult result{Engine::name, indexFirst ? "index+load" : "load+index", indexSet.name, stringLength, 0, 0, 0, 0, 0};
+    const double rows = double(data.size());
+    const double indexEntries = rows * double(indexSet.columns.size());
+
+    auto tableProbe = MemoryProbe::start();
+    Engine engine;
+    if (indexFirst)
+    {
+        auto indexProbe = MemoryProbe::start();
+        for (db::ColumnType columnID : indexSet.columns)
+            engine.createIndex(columnID, indexSet.kind);
+        engine.load(data);
+        result.peakIndexBytes = indexProbe.peakSince();
+        // records cost is taken from the unindexed baseline, the remainder is attributed to indexes
+        result.bytesPerRow = baselineBytesPerRow;
+        result.rssBytesPerRow = tableProbe.rssDelta() / rows;
+        if (indexEntries > 0)
+            result.bytesPerIndexEntry = (tableProbe.liveDelta() - baselineBytesPerRow * rows) / indexEntries;
+    }
+    else
+    {
+        engine.load(data);
+        result.bytesPerRow = tableProbe.liveDelta() / rows;
+        result.rssBytesPerRow = tableProbe.rssDelta() / rows;
+
+        auto indexProbe = MemoryProbe::start();
+        for (db::ColumnType columnID : indexSet.columns)
+            engine.createIndex(columnID, indexSet.kind);
+        result.peakIndexBytes = indexProbe.peakSince();
+        if (indexEntries > 0)
+            result.bytesPerIndexEntry = indexProbe.liveDelta() / indexEntries;
+    }
+
+    for (size_t i = 0; i < data.size(); i += DELETE_STRIDE)
+        engine.deleteRecord(data[i].column0);
+    auto compactProbe = MemoryProbe::start();
+    engine.compact();
+    result.peakCompactBytes = compactProbe.peakSince();
+
+    return result;
+}
+
+void printResult(const MemoryResult &r)
+{
+    std::cout << "  " << std::left << std::setw(16) << r.engine
+              << std::setw(12) << r.layout
+              << std::setw(9) << r.indexes
+              << std::right << std::setw(5) << r.stringLength
+              << std::fixed << std::setprecision(1)
+              << std::setw(11) << r.bytesPerRow
+              << std::setw(11) << r.rssBytesPerRow
+              << std::setw(11) << r.bytesPerIndexEntry
+              << std::setw(13) << r.peakIndexBytes / 1024.0
+              << std::setw(13) << r.peakCompactBytes / 1024.0 << std::endl;
+}
+
+/**
+    Run the memory footprint benchmark over every engine, layout, index set and string length
+*/
+template <typename Engine>
+void runEngine(const std::vector<size_t> &stringLengths, db::uint numRecords)
+{
+    for (size_t stringLength : stringLengths)
+    {
+        auto data = populateDummyData(numRecords, stringLength);
+
+        // unindexed baseline gives the per-row cost of records + primary key index
+        double baselineBytesPerRow = 0;
+        {
+            auto probe = MemoryProbe::start();
+            Engine engine;
+            engine.load(data);
+            baselineBytesPerRow = probe.liveDelta() / double(data.size());
+        }
+
+        for (bool indexFirst : {false, true})
+            for (const auto &indexSet : indexSets())
+                if (indexSet.kind == db::IndexKind::General || Engine::uniqueIndexes)
+                    printResult(measure<Engine>(data, indexSet, indexFirst, stringLength, baselineBytesPerRow));
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char **argv)
+{
+    db::uint numRecords = DEFAULT_DATA_SIZE;
+    if (argc > 1)
+        numRecords = db::uint(std::strtoul(argv[1], nullptr, 10));
+
+    // string lengths straddling the SSO capacity of the common standard libraries
+    const std::vector<size_t> stringLengths = {8, 15, 16, 22, 23, 32, 64};
+
+    std::cout << "\n"
+              << std::string(80, '=') << std::endl;
+    std::cout << "MEMORY FOOTPRINT BENCHMARK: QBTABLE vs QBTABLE DYNAMIC" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+    std::cout << "\nDataset Configuration:" << std::endl;
+    std::cout << "  - Total Records: " << numRecords << std::endl;
+    std::cout << "  - sizeof(std::string): " << sizeof(std::string)
+              << " (SSO capacity: " << std::string().capacity() << ")" << std::endl;
+    std::cout << "  - Soft deleted before compaction: every " << DELETE_STRIDE << "th record" << std::endl;
+    std::cout << "  - bytes/row and bytes/entry are allocator counted, rss/row is the RSS delta (0 if unavailable)" << std::endl;
+    std::cout << "  - peak columns are KiB above the pre-operation baseline (index+load peaks cover the whole load)\n"
+              << std::endl;
+
+    std::cout << "  " << std::left << std::setw(16) << "engine"
+              << std::setw(12) << "layout"
+              << std::setw(9) << "indexes"
+              << std::right << std::setw(5) << "str"
+              << std::setw(11) << "bytes/row"
+              << std::setw(11) << "rss/row"
+              << std::setw(11) << "bytes/ent"
+              << std::setw(13) << "peak idx KiB"
+              << std::setw(13) << "peak cmp KiB" << std::endl;
+    std::cout << "-" << std::string(100, '-') << std::endl;
+
+    runEngine<StaticEngine>(stringLengths, numRecords);
+    runEngine<DynamicEngine>(stringLengths, numRecords);
+
+    std::cout << std::string(80, '=') << std::endl;
+    std::cout << "MEMORY BENCHMARK COMPLETED" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+    return 0;
+}
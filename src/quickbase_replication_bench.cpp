@@ -0,0 +1,309 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../include/Quickbase.hpp"
+#include "../include/Quickbase_replica.hpp"
+#include "../include/Quickbase_wal.hpp"
+
+#define DEFAULT_RECORDS 100000
+#define DEFAULT_SECONDS 3
+#define DEFAULT_RATE 100000
+
+/**
+    Replication harness settings
+*/
+struct ReplicationOptions
+{
+    db::uint records = DEFAULT_RECORDS; // loaded before the timed phase
+    double seconds = DEFAULT_SECONDS;   // duration of the write load
+    size_t rate = DEFAULT_RATE;         // primary writes per second, 0 for as fast as possible
+    unsigned readers = 2;               // follower query threads
+    std::chrono::milliseconds staleness{50};
+    std::string walPath;
+};
+
+double percentile(const std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    size_t idx = std::min(sorted.size() - 1, size_t(p / 100.0 * double(sorted.size())));
+    return sorted[idx];
+}
+
+/**
+    Read a u64 the primary sent over the pipe - 1 when received, 0 on timeout, -1 when the primary is gone
+*/
+int receiveLsn(int fd, uint64_t &lsn, int timeoutMs)
+{
+    pollfd pfd{fd, POLLIN, 0};
+    if (::poll(&pfd, 1, timeoutMs) <= 0)
+        return 0;
+    return ::read(fd, &lsn, sizeof(lsn)) == ssize_t(sizeof(lsn)) ? 1 : -1;
+}
+
+/**
+    Follower process - tails the log, serves primary key reads with bounded staleness and samples lag
+    The primary sends the last lsn of the initial load and of the write load over the pipe
+*/
+int runFollower(const ReplicationOptions &options, int pipeFd)
+{
+    using namespace std::chrono;
+
+    db::replica::Follower follower(options.walPath);
+    follower.start();
+
+    uint64_t loadLsn = 0;
+    int received;
+    while ((received = receiveLsn(pipeFd, loadLsn, 1000)) == 0)
+        continue;
+    if (received < 0)
+        return 1;
+    auto catchUpStart = steady_clock::now();
+    if (!follower.waitForLsn(loadLsn, seconds(60)))
+    {
+        std::cerr << "Follower did not catch up with the initial load" << std::endl;
+        return 1;
+    }
+    const double catchUpMs = duration<double, std::milli>(steady_clock::now() - catchUpStart).count();
+
+    std::atomic<bool> done{false};
+    std::vector<size_t> reads(options.readers, 0), found(options.readers, 0), stale(options.readers, 0);
+    std::vector<std::thread> readers;
+    for (unsigned r = 0; r < options.readers; ++r)
+        readers.emplace_back([&, r]
+                             {
+                                 std::mt19937 rng(r + 1);
+                                 db::uint key[1];
+                                 while (!done.load(std::memory_order_relaxed))
+                                 {
+                                     key[0] = db::uint(rng() % (options.records * 2));
+                                     bool fresh = follower.read([&](const db::QBTable &table)
+                                                                { found[r] += table.lookupBatch(key, [](size_t, const db::QBRecord *) {}); },
+                                                                options.staleness);
+                                     ++(fresh ? reads[r] : stale[r]);
+                                 } });
+
+    // sample replication lag until the primary reports the end of its write load
+    std::vector<double> lagMs;
+    uint64_t finalLsn = 0;
+    auto readStart = steady_clock::now();
+    while ((received = receiveLsn(pipeFd, finalLsn, 1)) == 0)
+        lagMs.push_back(follower.status().lastLagMs);
+    const bool caughtUp = received > 0 && follower.waitForLsn(finalLsn, seconds(60));
+    const double readSeconds = duration<double>(steady_clock::now() - readStart).count();
+    done = true;
+    for (auto &t : readers)
+        t.join();
+    auto status = follower.status();
+    follower.stop();
+
+    size_t totalReads = 0, totalFound = 0, totalStale = 0;
+    for (unsigned r = 0; r < options.readers; ++r)
+    {
+        totalReads += reads[r];
+        totalFound += found[r];
+        totalStale += stale[r];
+    }
+    std::sort(lagMs.begin(), lagMs.end());
+
+    // report after the primary, which closes the pipe once it has printed
+    char eof;
+    while (::read(pipeFd, &eof, 1) > 0)
+        continue;
+    std::cout << "\n  Follower" << std::endl;
+    std::cout << "  - Initial catch-up: " << std::fixed << std::setprecision(1) << catchUpMs << " ms after the primary finished loading" << std::endl;
+    std::cout << "  - Applied lsn: " << status.appliedLsn << " of " << finalLsn << (caughtUp ? "" : " (did not catch up)")
+              << ", " << status.bytesApplied / 1024 << " KiB" << std::endl;
+    std::cout << "  - Replication lag: p50 " << std::setprecision(2) << percentile(lagMs, 50) << " ms, p99 " << percentile(lagMs, 99)
+              << " ms, max " << status.maxLagMs << " ms (" << lagMs.size() << " samples)" << std::endl;
+    std::cout << "  - Reads: " << std::setprecision(0) << double(totalReads) / readSeconds << " /s over " << options.readers
+              << " threads, " << totalFound << " hits, " << totalStale << " refused as staler than " << options.staleness.count() << " ms" << std::endl;
+    if (!status.error.empty())
+        std::cout << "  ! " << status.error << std::endl;
+    std::cout.flush();
+    return caughtUp && status.error.empty() ? 0 : 1;
+}
+
+/**
+    Primary process - loads the table, then runs inserts, soft deletes and a compaction per second at the
+    requested rate, sending the lsn at the end of each phase
+*/
+void runPrimary(const ReplicationOptions &options, std::shared_ptr<db::wal::LogWriter> wal, int pipeFd)
+{
+    using namespace std::chrono;
+
+    db::QBTable table;
+    table.setWriteAheadLog(wal);
+    auto loadStart = steady_clock::now();
+    for (db::uint i = 0; i < options.records; ++i)
+        table.addRecord({i, "testdata" + std::to_string(i), long(i % 100), std::to_string(i) + "testdata"});
+    wal->flush();
+    const double loadMs = duration<double, std::milli>(steady_clock::now() - loadStart).count();
+    uint64_t lsn = wal->lastLsn();
+    if (::write(pipeFd, &lsn, sizeof(lsn)) != ssize_t(sizeof(lsn)))
+        throw std::runtime_error("Pipe to the follower closed");
+
+    std::mt19937 rng(42);
+    db::uint nextId = options.records;
+    size_t writes = 0, inserts = 0, deletes = 0, compactions = 0;
+    const auto start = steady_clock::now();
+    const auto end = start + duration_cast<steady_clock::duration>(duration<double>(options.seconds));
+    auto nextCompaction = start + seconds(1);
+    for (auto now = start; now < end; now = steady_clock::now())
+    {
+        for (int i = 0; i < 64; ++i, ++writes)
+        {
+            if (rng() % 100 < 75)
+            {
+                table.addRecord({nextId, "testdata" + std::to_string(nextId), long(nextId % 100), std::to_string(nextId) + "testdata"});
+                ++nextId;
+                ++inserts;
+            }
+            else
+                deletes += table.deleteRecordByID(db::uint(rng() % nextId)) ? 1 : 0;
+        }
+        if (now >= nextCompaction)
+        {
+            table.compactRecords();
+            ++compactions;
+            nextCompaction += seconds(1);
+        }
+        // hold the requested rate - flush first so entries do not wait in the buffer while the primary sleeps
+        if (options.rate > 0)
+        {
+            auto due = start + duration_cast<steady_clock::duration>(duration<double>(double(writes) / double(options.rate)));
+            if (due > steady_clock::now())
+            {
+                wal->flush();
+                std::this_thread::sleep_until(due);
+            }
+        }
+    }
+    wal->flush();
+    const double elapsedS = duration<double>(steady_clock::now() - start).count();
+    lsn = wal->lastLsn();
+    if (::write(pipeFd, &lsn, sizeof(lsn)) != ssize_t(sizeof(lsn)))
+        throw std::runtime_error("Pipe to the follower closed");
+
+    std::cout << "\n  Primary" << std::endl;
+    std::cout << "  - Initial load: " << options.records << " records in " << std::fixed << std::setprecision(1) << loadMs << " ms" << std::endl;
+    std::cout << "  - Write load: " << std::setprecision(0) << double(writes) / elapsedS << " writes/s (" << inserts << " inserts, "
+              << deletes << " soft deletes, " << compactions << " compactions)" << std::endl;
+    std::cout << "  - Log: lsn " << lsn << ", " << wal->bytesWritten() / 1024 << " KiB" << std::endl;
+}
+
+/**
+    Print command line usage
+*/
+void printUsage(const char *program)
+{
+    std::cout << "Usage:\n"
+              << "  " << program << " [--records <n>] [--seconds <s>] [--rate <writes/s>] [--readers <n>] [--staleness <ms>] [--wal <path>]\n"
+              << "\n"
+              << "  --records    records loaded before the write load (default " << DEFAULT_RECORDS << ")\n"
+              << "  --seconds    duration of the write load (default " << DEFAULT_SECONDS << ")\n"
+              << "  --rate       primary writes per second, 0 = unthrottled (default " << DEFAULT_RATE << ")\n"
+              << "  --readers    follower query threads (default 2)\n"
+              << "  --staleness  follower reads are refused when it last caught up longer ago (default 50)\n"
+              << "  --wal        log file shared by both processes (default in the temp directory)\n";
+}
+
+int main(int argc, char **argv)
+{
+    ReplicationOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--records" && i + 1 < argc)
+            options.records = std::max(1u, static_cast<db::uint>(std::atol(argv[++i])));
+        else if (arg == "--seconds" && i + 1 < argc)
+            options.seconds = std::max(0.1, std::atof(argv[++i]));
+        else if (arg == "--rate" && i + 1 < argc)
+            options.rate = static_cast<size_t>(std::atol(argv[++i]));
+        else if (arg == "--readers" && i + 1 < argc)
+            options.readers = std::max(1u, static_cast<unsigned>(std::atoi(argv[++i])));
+        else if (arg == "--staleness" && i + 1 < argc)
+            options.staleness = std::chrono::milliseconds(std::atol(argv[++i]));
+        else if (arg == "--wal" && i + 1 < argc)
+            options.walPath = argv[++i];
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+    if (options.walPath.empty())
+        options.walPath = (std::filesystem::temp_directory_path() / ("quickbase_replication_" + std::to_string(::getpid()) + ".wal")).string();
+
+    std::cout << "\n"
+              << std::string(80, '=') << std::endl;
+    std::cout << "LOG SHIPPING REPLICATION: PRIMARY + FOLLOWER PROCESS" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+    std::cout << "  - Log: " << options.walPath << std::endl;
+    std::cout << "  - Records: " << options.records << ", write load " << options.seconds << " s at "
+              << (options.rate ? std::to_string(options.rate) + " writes/s" : std::string("full speed")) << std::endl;
+    std::cout.flush();
+
+    int fds[2];
+    if (::pipe(fds) != 0)
+    {
+        std::cerr << "pipe failed" << std::endl;
+        return 1;
+    }
+    // the log exists with its magic before the follower opens it
+    auto wal = std::make_shared<db::wal::LogWriter>(options.walPath);
+
+    pid_t child = ::fork();
+    if (child < 0)
+    {
+        std::cerr << "fork failed" << std::endl;
+        return 1;
+    }
+    if (child == 0)
+    {
+        ::close(fds[1]);
+        int code = 1;
+        try
+        {
+            code = runFollower(options, fds[0]);
+        }
+        catch (const std::exception &e)
+        {
+            std::cerr << "Follower failed: " << e.what() << std::endl;
+        }
+        // skip destructors - the log writer belongs to the primary
+        std::_Exit(code);
+    }
+
+    ::close(fds[0]);
+    int code = 0;
+    try
+    {
+        runPrimary(options, wal, fds[1]);
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Primary failed: " << e.what() << std::endl;
+        code = 1;
+    }
+    ::close(fds[1]);
+    int status = 0;
+    ::waitpid(child, &status, 0);
+    wal.reset();
+    std::filesystem::remove(options.walPath);
+    return code != 0 ? code : (WIFEXITED(status) ? WEXITSTATUS(status) : 1);
+}
@@ -0,0 +1,75 @@
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "../include/Quickbase_server.hpp"
+
+namespace
+{
+    db::QBServer *runningServer = nullptr;
+
+    void handleSignal(int)
+    {
+        if (runningServer)
+            runningServer->stop();
+    }
+}
+
+/**
+    Print command line usage
+*/
+void printUsage(const char *program)
+{
+    std::cout << "Usage:\n"
+              << "  " << program << " [--host <ipv4>] [--port <port>] [--unix <path>] [--threads <n>]\n"
+              << "\n"
+              << "  --host     TCP listen address (default 127.0.0.1)\n"
+              << "  --port     TCP listen port (default 7070)\n"
+              << "  --unix     listen on a Unix socket instead of TCP\n"
+              << "  --threads  event loops (default: one per hardware thread)\n";
+}
+
+int main(int argc, char **argv)
+{
+    db::ServerOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--host" && i + 1 < argc)
+            options.host = argv[++i];
+        else if (arg == "--port" && i + 1 < argc)
+            options.port = static_cast<uint16_t>(std::atoi(argv[++i]));
+        else if (arg == "--unix" && i + 1 < argc)
+            options.unixPath = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc)
+            options.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    db::QBServer server(options);
+    try
+    {
+        server.start();
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Cannot start server: " << e.what() << std::endl;
+        return 1;
+    }
+
+    runningServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+    std::cout << "QBTable server listening on "
+              << (options.unixPath.empty() ? options.host + ":" + std::to_string(options.port) : options.unixPath)
+              << std::endl;
+
+    server.wait();
+    runningServer = nullptr;
+    std::cout << "QBTable server stopped" << std::endl;
+    return 0;
+}
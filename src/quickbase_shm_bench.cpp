@@ -0,0 +1,341 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "../include/Quickbase.hpp"
+#include "../include/Quickbase_shm.hpp"
+
+#define DEFAULT_RECORDS 500000
+#define DEFAULT_WORKERS 4
+#define DEFAULT_LOOKUPS 200000
+
+/**
+    Shared memory benchmark settings
+*/
+struct ShmOptions
+{
+    db::uint records = DEFAULT_RECORDS;
+    unsigned workers = DEFAULT_WORKERS;
+    size_t lookups = DEFAULT_LOOKUPS; // primary key lookups per worker
+    bool writer = true;               // keep appending to the segment while the shared workers query it
+};
+
+// WorkerReport - sent from each worker process over a pipe, small enough for an atomic pipe write
+struct WorkerReport
+{
+    unsigned worker = 0;
+    double rssMb = 0;
+    double pssMb = 0;
+    double setupMs = 0;
+    double lookupP50Ns = 0;
+    double lookupP99Ns = 0;
+    double column2ScanMs = 0;
+    double column1ScanMs = 0;
+    uint64_t checksum = 0;
+    uint64_t retries = 0;
+};
+
+db::QBRecord makeRecord(db::uint i)
+{
+    return {i, "testdata" + std::to_string(i), long(i % 100), std::to_string(i) + "testdata"};
+}
+
+/**
+    Resident and proportional set size of this process in MiB - shared pages count 1/n in the PSS of each of n mappers
+*/
+void measureMemory(WorkerReport &report)
+{
+    std::ifstream rollup("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(rollup, line))
+    {
+        std::istringstream fields(line);
+        std::string key;
+        double kb = 0;
+        fields >> key >> kb;
+        if (key == "Rss:")
+            report.rssMb = kb / 1024;
+        else if (key == "Pss:")
+            report.pssMb = kb / 1024;
+    }
+}
+
+/**
+    Same queries against either backend - random primary key lookups timed one by one, then column scans
+*/
+template <typename Lookup, typename Scan>
+void runWorkload(const ShmOptions &options, unsigned seed, Lookup &&lookup, Scan &&scan, WorkerReport &report)
+{
+    using namespace std::chrono;
+
+    std::mt19937 rng(seed);
+    std::vector<double> latencies;
+    latencies.reserve(options.lookups);
+    for (size_t i = 0; i < options.lookups; ++i)
+    {
+        const auto id = db::uint(rng() % options.records);
+        auto start = steady_clock::now();
+        report.checksum += lookup(id);
+        latencies.push_back(duration<double, std::nano>(steady_clock::now() - start).count());
+    }
+    std::sort(latencies.begin(), latencies.end());
+    report.lookupP50Ns = latencies[latencies.size() / 2];
+    report.lookupP99Ns = latencies[latencies.size() * 99 / 100];
+
+    auto start = steady_clock::now();
+    for (int i = 0; i < 5; ++i)
+        report.checksum += scan(db::ColumnType::COLUMN2, std::to_string(i * 7));
+    report.column2ScanMs = duration<double, std::milli>(steady_clock::now() - start).count() / 5;
+    start = steady_clock::now();
+    for (int i = 0; i < 2; ++i)
+        report.checksum += scan(db::ColumnType::COLUMN1, "testdata99" + std::to_string(i));
+    report.column1ScanMs = duration<double, std::milli>(steady_clock::now() - start).count() / 2;
+}
+
+/**
+    Wait until every worker finished its queries, then measure memory while all of them are still attached and report
+*/
+[[noreturn]] void finishWorker(WorkerReport &report, int readyFd, int goFd, int reportFd)
+{
+    char byte = 1;
+    if (::write(readyFd, &byte, 1) != 1 || ::read(goFd, &byte, 1) != 1)
+        std::_Exit(1);
+    measureMemory(report);
+    std::_Exit(::write(reportFd, &report, sizeof(report)) == ssize_t(sizeof(report)) ? 0 : 1);
+}
+
+/**
+    Worker process - loads its own table or attaches to the segment, then runs the workload
+*/
+[[noreturn]] void runWorker(const ShmOptions &options, const std::string &segment, unsigned index, int readyFd, int goFd, int reportFd)
+{
+    using namespace std::chrono;
+
+    WorkerReport report;
+    report.worker = index;
+    auto setupStart = steady_clock::now();
+    if (segment.empty())
+    {
+        // per-process copy, loaded the way an independent worker would build it
+        db::QBTable table;
+        for (db::uint i = 0; i < options.records; ++i)
+            table.addRecord(makeRecord(i));
+        report.setupMs = duration<double, std::milli>(steady_clock::now() - setupStart).count();
+        runWorkload(
+            options, index + 1,
+            [&](db::uint id)
+            {
+                uint64_t found = 0;
+                table.lookupBatch({&id, 1}, [&](size_t, const db::QBRecord *rec)
+                                  { found = rec ? rec->column0 + 1 : 0; });
+                return found;
+            },
+            [&](db::ColumnType column, const std::string &match)
+            { return table.forEachMatching(column, match, [](const db::QBRecord &) {}); },
+            report);
+        finishWorker(report, readyFd, goFd, reportFd);
+    }
+
+    db::shm::SharedTableReader reader(segment);
+    report.setupMs = duration<double, std::milli>(steady_clock::now() - setupStart).count();
+    runWorkload(
+        options, index + 1,
+        [&](db::uint id)
+        {
+            auto rec = reader.findByPrimaryKey(id);
+            return rec ? uint64_t(rec->column0) + 1 : 0;
+        },
+        [&](db::ColumnType column, const std::string &match)
+        { return reader.forEachMatching(column, match, [](const db::shm::RecordView &) {}); },
+        report);
+    report.retries = reader.retries();
+    finishWorker(report, readyFd, goFd, reportFd);
+}
+
+/**
+    Run one mode with all workers alive at the same time, optionally writing to the segment meanwhile
+*/
+std::vector<WorkerReport> runWorkers(const ShmOptions &options, const std::string &segment, db::shm::SharedTableWriter *writer)
+{
+    int ready[2], go[2], reports[2];
+    if (::pipe(ready) != 0 || ::pipe(go) != 0 || ::pipe(reports) != 0)
+        throw std::runtime_error("pipe failed");
+
+    std::vector<pid_t> children;
+    for (unsigned w = 0; w < options.workers; ++w)
+    {
+        pid_t child = ::fork();
+        if (child < 0)
+            throw std::runtime_error("fork failed");
+        if (child == 0)
+            runWorker(options, segment, w, ready[1], go[0], reports[1]);
+        children.push_back(child);
+    }
+
+    // wait until every worker finished its queries - appended records never match the workload's queries
+    db::uint nextId = options.records;
+    for (unsigned readyCount = 0; readyCount < options.workers;)
+    {
+        pollfd pfd{ready[0], POLLIN, 0};
+        if (::poll(&pfd, 1, writer ? 1 : 1000) > 0)
+        {
+            char byte;
+            readyCount += ::read(ready[0], &byte, 1) == 1 ? 1 : 0;
+        }
+        if (writer && nextId < options.records * 2)
+        {
+            std::vector<db::QBRecord> batch;
+            for (int i = 0; i < 64 && nextId < options.records * 2; ++i, ++nextId)
+                batch.push_back({nextId, "livedata" + std::to_string(nextId), -1, "livedata"});
+            writer->addRecords(batch);
+        }
+    }
+    std::string release(options.workers, '1');
+    if (::write(go[1], release.data(), release.size()) != ssize_t(release.size()))
+        throw std::runtime_error("pipe to workers closed");
+
+    std::vector<WorkerReport> results(options.workers);
+    for (unsigned w = 0; w < options.workers; ++w)
+    {
+        WorkerReport report;
+        if (::read(reports[0], &report, sizeof(report)) != ssize_t(sizeof(report)) || report.worker >= options.workers)
+            throw std::runtime_error("worker report missing");
+        results[report.worker] = report;
+    }
+    for (pid_t child : children)
+        ::waitpid(child, nullptr, 0);
+    for (int fd : {ready[0], ready[1], go[0], go[1], reports[0], reports[1]})
+        ::close(fd);
+    return results;
+}
+
+void printRow(const std::string &mode, const std::vector<WorkerReport> &reports)
+{
+    double rss = 0, pss = 0, setup = 0, p50 = 0, p99 = 0, column2 = 0, column1 = 0;
+    for (const auto &r : reports)
+    {
+        rss += r.rssMb;
+        pss += r.pssMb;
+        setup += r.setupMs;
+        p50 += r.lookupP50Ns;
+        p99 += r.lookupP99Ns;
+        column2 += r.column2ScanMs;
+        column1 += r.column1ScanMs;
+    }
+    const double n = double(reports.size());
+    std::cout << "  " << std::left << std::setw(18) << mode << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << rss / n << std::setw(10) << pss << std::setw(11) << setup / n
+              << std::setprecision(0) << std::setw(9) << p50 / n << std::setw(9) << p99 / n
+              << std::setprecision(2) << std::setw(11) << column2 / n << std::setw(11) << column1 / n << std::endl;
+}
+
+/**
+    Print command line usage
+*/
+void printUsage(const char *program)
+{
+    std::cout << "Usage:\n"
+              << "  " << program << " [--records <n>] [--workers <n>] [--lookups <n>] [--no-writer]\n"
+              << "\n"
+              << "  --records    records in the table (default " << DEFAULT_RECORDS << ")\n"
+              << "  --workers    reader processes per mode (default " << DEFAULT_WORKERS << ")\n"
+              << "  --lookups    primary key lookups per worker (default " << DEFAULT_LOOKUPS << ")\n"
+              << "  --no-writer  do not append to the segment while the shared workers run\n";
+}
+
+int main(int argc, char **argv)
+{
+    ShmOptions options;
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--records" && i + 1 < argc)
+            options.records = std::max(1000u, static_cast<db::uint>(std::atol(argv[++i])));
+        else if (arg == "--workers" && i + 1 < argc)
+            options.workers = std::max(1u, static_cast<unsigned>(std::atoi(argv[++i])));
+        else if (arg == "--lookups" && i + 1 < argc)
+            options.lookups = std::max<size_t>(100, static_cast<size_t>(std::atol(argv[++i])));
+        else if (arg == "--no-writer")
+            options.writer = false;
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    std::cout << "\n"
+              << std::string(80, '=') << std::endl;
+    std::cout << "SHARED MEMORY TABLE vs PER-PROCESS COPIES" << std::endl;
+    std::cout << std::string(80, '=') << std::endl;
+    std::cout << "  - Records: " << options.records << ", workers: " << options.workers << ", lookups per worker: " << options.lookups << std::endl;
+    std::cout.flush();
+
+    try
+    {
+        // copies first, so the workers do not inherit any mapping of the segment
+        auto copies = runWorkers(options, {}, nullptr);
+
+        const std::string segment = "/quickbase_shm_bench_" + std::to_string(::getpid());
+        db::shm::SharedTableWriter writer(segment, size_t(options.records) * 2, size_t(options.records) * 64);
+        auto loadStart = std::chrono::steady_clock::now();
+        std::vector<db::QBRecord> batch;
+        for (db::uint i = 0; i < options.records; ++i)
+        {
+            batch.push_back(makeRecord(i));
+            if (batch.size() == 4096 || i + 1 == options.records)
+            {
+                writer.addRecords(batch);
+                batch.clear();
+            }
+        }
+        const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+        auto shared = runWorkers(options, segment, options.writer ? &writer : nullptr);
+
+        std::cout << "  - Segment: " << writer.segmentSize() / (1024 * 1024) << " MiB reserved, loaded by the writer in "
+                  << std::fixed << std::setprecision(1) << loadMs << " ms" << (options.writer ? ", writer appending during the run" : "") << "\n"
+                  << std::endl;
+        std::cout << "  " << std::left << std::setw(18) << "Mode" << std::right << std::setw(10) << "RSS MB" << std::setw(10) << "PSS MB"
+                  << std::setw(11) << "Setup ms" << std::setw(9) << "PK p50" << std::setw(9) << "PK p99"
+                  << std::setw(11) << "col2 ms" << std::setw(11) << "col1 ms" << std::endl;
+        std::cout << "  " << std::left << std::setw(18) << "" << std::right << std::setw(10) << "/worker" << std::setw(10) << "total"
+                  << std::setw(11) << "/worker" << std::setw(9) << "ns" << std::setw(9) << "ns" << std::setw(11) << "scan" << std::setw(11) << "scan" << std::endl;
+        std::cout << "  " << std::string(78, '-') << std::endl;
+        printRow("per-process copy", copies);
+        printRow("shared segment", shared);
+
+        bool match = true;
+        uint64_t retries = 0;
+        for (unsigned w = 0; w < options.workers; ++w)
+        {
+            match = match && copies[w].checksum == shared[w].checksum;
+            retries += shared[w].retries;
+        }
+        double copiesPss = 0, sharedPss = 0;
+        for (unsigned w = 0; w < options.workers; ++w)
+        {
+            copiesPss += copies[w].pssMb;
+            sharedPss += shared[w].pssMb;
+        }
+        std::cout << "\n  - Memory saved by sharing: " << std::setprecision(1) << copiesPss - sharedPss << " MB of PSS ("
+                  << std::setprecision(0) << (copiesPss > 0 ? 100.0 * (copiesPss - sharedPss) / copiesPss : 0) << "%)" << std::endl;
+        std::cout << "  - Seqlock retries: " << retries << std::endl;
+        std::cout << "  " << (match ? "✓ Query results identical in both modes" : "✗ Query results differ between modes") << std::endl;
+        return match ? 0 : 1;
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << "Shared memory benchmark failed: " << e.what() << std::endl;
+        return 1;
+    }
+}
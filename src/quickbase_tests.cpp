@@ -5,8 +5,34 @@
 #include <chrono>
 #include <iostream>
 #include <iomanip>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <thread>
 #include "../include/Quickbase.hpp"
+#include "../include/Quickbase_advisor.hpp"
 #include "../include/Quickbase_dynamic.hpp"
+#include "../include/Quickbase_c.h"
+#include "../include/Quickbase_cdc.hpp"
+#include "../include/Quickbase_join.hpp"
+#include "../include/Quickbase_protocol.hpp"
+#include "../include/Quickbase_query.hpp"
+#include "../include/Quickbase_replica.hpp"
+#if defined(__linux__)
+#include "../include/Quickbase_client.hpp"
+#include "../include/Quickbase_server.hpp"
+#endif
+#include "../include/Quickbase_schema.hpp"
+#include "../include/Quickbase_expr.hpp"
+#include "../include/Quickbase_wal.hpp"
+#include "../include/Quickbase_bench.hpp"
+#include "../include/Quickbase_trace.hpp"
 
 #define DATA_SIZE 100000
 #define ITERATIONS 100
@@ -71,21 +97,56 @@ struct BenchmarkResult
 };
 
 /**
-    Run benchmarks comparing base vs optimized implementations
+    Benchmark run settings and collected samples for machine readable output
+*/
+struct BenchmarkContext
+{
+    int trials;
+    std::ostream &out;
+    std::vector<db::bench::BenchmarkStats> report;
+};
+
+/**
+    Time ITERATIONS calls of query, repeated for ctx.trials trials
+    Every trial is recorded as one sample, the mean over trials is returned in milliseconds
 */
-void runBenchmarks()
+template <typename Query>
+double timeQueries(BenchmarkContext &ctx, const std::string &test, const std::string &name, Query &&query)
 {
     using namespace std::chrono;
 
-    std::cout << "\n"
+    db::bench::BenchmarkStats stats{test, name, {}};
+    for (int trial = 0; trial < ctx.trials; ++trial)
+    {
+        auto startTimer = steady_clock::now();
+        for (int i = 0; i < ITERATIONS; ++i)
+        {
+            [[maybe_unused]] auto filtered = query();
+        }
+        auto elapsed = steady_clock::now() - startTimer;
+        stats.samplesMs.push_back(double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000);
+    }
+    ctx.report.push_back(stats);
+    return db::bench::summarize(stats.samplesMs).mean;
+}
+
+/**
+    Run benchmarks comparing base vs optimized implementations
+*/
+void runBenchmarks(BenchmarkContext &ctx)
+{
+    std::ostream &out = ctx.out;
+
+    out << "\n"
               << std::string(80, '=') << std::endl;
-    std::cout << "PERFORMANCE BENCHMARK: BASE vs QBTABLE vs QBTABLE DYNAMIC" << std::endl;
-    std::cout << std::string(80, '=') << std::endl;
+    out << "PERFORMANCE BENCHMARK: BASE vs QBTABLE vs QBTABLE DYNAMIC" << std::endl;
+    out << std::string(80, '=') << std::endl;
 
     // ========== Setup: Create test data ==========
-    std::cout << "\nDataset Configuration:" << std::endl;
-    std::cout << "  - Total Records: " << DATA_SIZE << std::endl;
-    std::cout << "  - ITERATIONS per test: " << ITERATIONS << std::endl;
+    out << "\nDataset Configuration:" << std::endl;
+    out << "  - Total Records: " << DATA_SIZE << std::endl;
+    out << "  - ITERATIONS per test: " << ITERATIONS << std::endl;
+    out << "  - Trials per test: " << ctx.trials << std::endl;
     // populate base data collection
     auto baseData = populateDummyData("testdata", DATA_SIZE);
 
@@ -112,177 +173,126 @@ void runBenchmarks()
     {
         qbTableDynamic.addRecord({rec.column0, {{"column1", rec.column1}, {"column2", rec.column2}, {"column3", rec.column3}}});
     }
-    std::cout << "  - Records in base QB database implementation: " << baseData.size() << std::endl;
-    std::cout << "  - QBTable Active Records: " << qbTable.activeRecordsCount() << std::endl;
-    std::cout << "  - QBTableDynamic Active Records: " << qbTableDynamic.activeRecordsCount() << std::endl;
-    std::cout << std::endl;
+    out << "  - Records in base QB database implementation: " << baseData.size() << std::endl;
+    out << "  - QBTable Active Records: " << qbTable.activeRecordsCount() << std::endl;
+    out << "  - QBTableDynamic Active Records: " << qbTableDynamic.activeRecordsCount() << std::endl;
+    out << std::endl;
 
     // ========== TEST 1: Exact Match on Numeric Column (column0) ==========
-    std::cout << "TEST 1: Exact Match Query on Primary Key (column0)" << std::endl;
-    std::cout << "-" << std::string(76, '-') << std::endl;
+    out << "TEST 1: Exact Match Query on Primary Key (column0)" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
     {
+        const std::string testName = "TEST 1";
         std::vector<BenchmarkResult> results;
 
         // base implementation
-        auto startTimer = steady_clock::now();
-        for (int i = 0; i < ITERATIONS; ++i)
-        {
-            auto filtered = QBFindMatchingRecords(baseData, "column0", "50000");
-        }
-        auto elapsed = steady_clock::now() - startTimer;
-        double timeMs = double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000;
-        results.push_back({"Base Implementation", timeMs, 1, "\t(queries: 100)"});
+        results.push_back({"Base Implementation", timeQueries(ctx, testName, "Base Implementation", [&]
+                                   { return QBFindMatchingRecords(baseData, "column0", "50000"); }), 1, "\t(queries: 100)"});
 
         // QBTable implementation (with dedicated primary key index)
-        startTimer = steady_clock::now();
-        for (int i = 0; i < ITERATIONS; ++i)
-        {
-            auto filtered = qbTable.findMatching(db::ColumnType::COLUMN0, "50000");
-        }
-        elapsed = steady_clock::now() - startTimer;
-        timeMs = double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000;
-        results.push_back({"QBTable", timeMs, 1, "\t(queries: 100)"});
+        results.push_back({"QBTable", timeQueries(ctx, testName, "QBTable", [&]
+                                   { return qbTable.findMatching(db::ColumnType::COLUMN0, "50000"); }), 1, "\t(queries: 100)"});
 
         // QBTableDynamic implementation (primary key)
-        startTimer = steady_clock::now();
-        for (int i = 0; i < ITERATIONS; ++i)
-        {
-            auto filtered = qbTableDynamic.findMatching("id", 50000u);
-        }
-        elapsed = steady_clock::now() - startTimer;
-        timeMs = double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000;
-        results.push_back({"QBTableDynamic", timeMs, 1, "\t(queries: 100)"});
+        results.push_back({"QBTableDynamic", timeQueries(ctx, testName, "QBTableDynamic", [&]
+                                   { return qbTableDynamic.findMatching("id", 50000u); }), 1, "\t(queries: 100)"});
         // print results
         for (const auto &r : results)
         {
-            std::cout << "  " << std::left << std::setw(30) << r.name
+            out << "  " << std::left << std::setw(30) << r.name
                       << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms"
                       << r.details << std::endl;
         }
 
         double speedupQBTable = results[0].timeMs / results[1].timeMs;
         double speedupQBTableDynamic = results[0].timeMs / results[2].timeMs;
-        std::cout << "  Speedup (QBTable): " << std::fixed << std::setprecision(2) << speedupQBTable << "x faster\n"
+        out << "  Speedup (QBTable): " << std::fixed << std::setprecision(2) << speedupQBTable << "x faster\n"
                   << "  Speedup (QBTableDynamic): " << std::fixed << std::setprecision(2) << speedupQBTableDynamic << "x faster\n"
                   << std::endl;
     }
 
     // ========== TEST 2: Exact Match on Another Numeric Column (column2) ==========
-    std::cout << "TEST 2: Exact Match Query on Secondary Indexed Numeric Column (column2)" << std::endl;
-    std::cout << "-" << std::string(76, '-') << std::endl;
+    out << "TEST 2: Exact Match Query on Secondary Indexed Numeric Column (column2)" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
 
     {
+        const std::string testName = "TEST 2";
         std::vector<BenchmarkResult> results;
 
         // base implementation (matching ~1000 records out of 100k)
-        auto startTimer = steady_clock::now();
-        for (int i = 0; i < ITERATIONS; ++i)
-        {
-            auto filtered = QBFindMatchingRecords(baseData, "column2", "42");
-        }
-        auto elapsed = steady_clock::now() - startTimer;
-        double timeMs = double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000;
-        results.push_back({"Base Implementation", timeMs, ITERATIONS, ""});
+        results.push_back({"Base Implementation", timeQueries(ctx, testName, "Base Implementation", [&]
+                                   { return QBFindMatchingRecords(baseData, "column2", "42"); }), ITERATIONS, ""});
 
         // QBTable implementation (with secondary index)
-        startTimer = steady_clock::now();
-        for (int i = 0; i < ITERATIONS; ++i)
-        {
-            auto filtered = qbTable.findMatching(db::ColumnType::COLUMN2, "42");
-        }
-        elapsed = steady_clock::now() - startTimer;
-        timeMs = double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000;
-        results.push_back({"QBTable", timeMs, ITERATIONS, ""});
+        results.push_back({"QBTable", timeQueries(ctx, testName, "QBTable", [&]
+                                   { return qbTable.findMatching(db::ColumnType::COLUMN2, "42"); }), ITERATIONS, ""});
 
         // QBTableDynamic implementation (secondary index)
-        startTimer = steady_clock::now();
-        for (int i = 0; i < ITERATIONS; ++i)
-        {
-            auto filtered = qbTableDynamic.findMatching("column2", 42);
-        }
-        elapsed = steady_clock::now() - startTimer;
-        timeMs = double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000;
-        results.push_back({"QBTableDynamic", timeMs, ITERATIONS, ""});
+        results.push_back({"QBTableDynamic", timeQueries(ctx, testName, "QBTableDynamic", [&]
+                                   { return qbTableDynamic.findMatching("column2", 42); }), ITERATIONS, ""});
 
         // print results
         for (const auto &r : results)
         {
-            std::cout << "  " << std::left << std::setw(30) << r.name
+            out << "  " << std::left << std::setw(30) << r.name
                       << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms"
                       << "  (queries: " << r.resultCount << r.details << ")" << std::endl;
         }
 
         double speedupQBTable = results[0].timeMs / results[1].timeMs;
         double speedupQBTableDynamic = results[0].timeMs / results[2].timeMs;
-        std::cout << "  Speedup (QBTable): " << std::fixed << std::setprecision(2) << speedupQBTable << "x faster\n"
+        out << "  Speedup (QBTable): " << std::fixed << std::setprecision(2) << speedupQBTable << "x faster\n"
                   << "  Speedup (QBTableDynamic): " << std::fixed << std::setprecision(2) << speedupQBTableDynamic << "x faster\n"
                   << std::endl;
     }
 
     // ========== TEST 3: Substring Match (column1) ==========
-    std::cout << "TEST 3: Substring Match Query (column1)" << std::endl;
-    std::cout << "-" << std::string(76, '-') << std::endl;
+    out << "TEST 3: Substring Match Query (column1)" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
 
     {
+        const std::string testName = "TEST 3";
         std::vector<BenchmarkResult> results;
 
         // base implementation
-        auto startTimer = steady_clock::now();
-        for (int i = 0; i < ITERATIONS; ++i)
-        {
-            auto filtered = QBFindMatchingRecords(baseData, "column1", "testdata50");
-        }
-        auto elapsed = steady_clock::now() - startTimer;
-        double timeMs = double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000;
-        results.push_back({"Base Implementation", timeMs, 100, ""});
+        results.push_back({"Base Implementation", timeQueries(ctx, testName, "Base Implementation", [&]
+                                   { return QBFindMatchingRecords(baseData, "column1", "testdata50"); }), 100, ""});
 
         // QBTable implementation (no index for substring search)
-        startTimer = steady_clock::now();
-        for (int i = 0; i < ITERATIONS; ++i)
-        {
-            auto filtered = qbTable.findMatching(db::ColumnType::COLUMN1, "testdata50");
-        }
-        elapsed = steady_clock::now() - startTimer;
-        timeMs = double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000;
-        results.push_back({"QBTable", timeMs, 100, ""});
+        results.push_back({"QBTable", timeQueries(ctx, testName, "QBTable", [&]
+                                   { return qbTable.findMatching(db::ColumnType::COLUMN1, "testdata50"); }), 100, ""});
 
         // QBTableDynamic implementation (no index for substring search)
-        startTimer = steady_clock::now();
-        for (int i = 0; i < ITERATIONS; ++i)
-        {
-            auto filtered = qbTableDynamic.findMatching("column1", std::string("testdata50"));
-        }
-        elapsed = steady_clock::now() - startTimer;
-        timeMs = double(elapsed.count()) * steady_clock::period::num / steady_clock::period::den * 1000;
-        results.push_back({"QBTableDynamic", timeMs, 100, ""});
+        results.push_back({"QBTableDynamic", timeQueries(ctx, testName, "QBTableDynamic", [&]
+                                   { return qbTableDynamic.findMatching("column1", std::string("testdata50")); }), 100, ""});
 
         // print results
         for (const auto &r : results)
         {
-            std::cout << "  " << std::left << std::setw(30) << r.name
+            out << "  " << std::left << std::setw(30) << r.name
                       << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms"
                       << "  (queries: " << r.resultCount << ")" << std::endl;
         }
-        std::cout << std::endl;
+        out << std::endl;
     }
 
     // ========== TEST 4: DeleteRecordByID and Requery ==========
-    std::cout << "TEST 4: Delete Records and Verify Correctness" << std::endl;
-    std::cout << "-" << std::string(76, '-') << std::endl;
+    out << "TEST 4: Delete Records and Verify Correctness" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
 
     {
         // delete on QBTable
-        std::cout << "  Initial state (QBTable):" << std::endl;
+        out << "  Initial state (QBTable):" << std::endl;
         auto beforeDeleteQB = qbTable.findMatching(db::ColumnType::COLUMN0, "100");
-        std::cout << "    Records with column0=100: " << beforeDeleteQB.size() << std::endl;
+        out << "    Records with column0=100: " << beforeDeleteQB.size() << std::endl;
         // perform a hard delete
         bool deletedQB = qbTable.deleteRecordByID(100, true);
-        std::cout << "  After deleteRecordByID(100):" << std::endl;
-        std::cout << "    QBTable: " << (deletedQB ? "SUCCESS" : "FAILED") << std::endl;
+        out << "  After deleteRecordByID(100):" << std::endl;
+        out << "    QBTable: " << (deletedQB ? "SUCCESS" : "FAILED") << std::endl;
 
         // try to find it again
         auto afterDeleteQB = qbTable.findMatching(db::ColumnType::COLUMN0, "100");
-        std::cout << "    QBTable - Records with column0=100: " << afterDeleteQB.size() << std::endl;
+        out << "    QBTable - Records with column0=100: " << afterDeleteQB.size() << std::endl;
 
         // verify
         assert(afterDeleteQB.size() == 0 && "Record should be deleted (QBTable)");
@@ -295,28 +305,28 @@ void runBenchmarks()
         }
 
         auto allDeletedQB = qbTable.findMatching(db::ColumnType::COLUMN2, "4");
-        std::cout << "  After deleting records with IDs 200-204:" << std::endl;
-        std::cout << "    QBTable - Records with column2=4: " << allDeletedQB.size() << std::endl;
-        std::cout << "    QBTable - Active count: " << qbTable.activeRecordsCount() << " / " << qbTable.totalRecordsCount() << std::endl;
+        out << "  After deleting records with IDs 200-204:" << std::endl;
+        out << "    QBTable - Records with column2=4: " << allDeletedQB.size() << std::endl;
+        out << "    QBTable - Active count: " << qbTable.activeRecordsCount() << " / " << qbTable.totalRecordsCount() << std::endl;
         // Test compaction
         size_t beforeCompactQB = qbTable.totalRecordsCount();
         qbTable.compactRecords();
-        std::cout << "  After compactRecords():" << std::endl;
-        std::cout << "    QBTable - Total records (before compact) -> (after compact): " << beforeCompactQB << " -> " << qbTable.totalRecordsCount() << std::endl;
-        std::cout << "    QBTable - Active records: " << qbTable.activeRecordsCount() << "\n" << std::endl;
+        out << "  After compactRecords():" << std::endl;
+        out << "    QBTable - Total records (before compact) -> (after compact): " << beforeCompactQB << " -> " << qbTable.totalRecordsCount() << std::endl;
+        out << "    QBTable - Active records: " << qbTable.activeRecordsCount() << "\n" << std::endl;
 
         // delete on QBTableDynamic
-        std::cout << "  Initial state (QBTableDynamic):" << std::endl;
+        out << "  Initial state (QBTableDynamic):" << std::endl;
         auto beforeDeleteQBD = qbTableDynamic.findMatching("id", 100u);
-        std::cout << "    Records with id=100: " << beforeDeleteQBD.size() << std::endl;
+        out << "    Records with id=100: " << beforeDeleteQBD.size() << std::endl;
         // perform a hard delete
         bool deletedQBD = qbTableDynamic.deleteRecordByID(100, true);
-        std::cout << "  After deleteRecordByID(100):" << std::endl;
-        std::cout << "    QBTableDynamic: " << (deletedQBD ? "SUCCESS" : "FAILED") << std::endl;
+        out << "  After deleteRecordByID(100):" << std::endl;
+        out << "    QBTableDynamic: " << (deletedQBD ? "SUCCESS" : "FAILED") << std::endl;
 
         // try to find it again
         auto afterDeleteQBD = qbTableDynamic.findMatching("id", 100u);
-        std::cout << "    QBTableDynamic - Records with id=100: " << afterDeleteQBD.size() << std::endl;
+        out << "    QBTableDynamic - Records with id=100: " << afterDeleteQBD.size() << std::endl;
 
         // verify
         assert(afterDeleteQBD.size() == 0 && "Record should be deleted (QBTableDynamic)");
@@ -328,36 +338,3051 @@ void runBenchmarks()
         }
 
         auto allDeletedQBD = qbTableDynamic.findMatching("column2", 4L);
-        std::cout << "  After deleting records with IDs 200-204:" << std::endl;
-        std::cout << "    QBTableDynamic - Records with column2=4: " << allDeletedQBD.size() << std::endl;
-        std::cout << "    QBTableDynamic - Active count: " << qbTableDynamic.activeRecordsCount() << " / " << qbTableDynamic.totalRecordsCount() << std::endl;
+        out << "  After deleting records with IDs 200-204:" << std::endl;
+        out << "    QBTableDynamic - Records with column2=4: " << allDeletedQBD.size() << std::endl;
+        out << "    QBTableDynamic - Active count: " << qbTableDynamic.activeRecordsCount() << " / " << qbTableDynamic.totalRecordsCount() << std::endl;
 
         // Test compaction
         size_t beforeCompactQBD = qbTableDynamic.totalRecordsCount();
         qbTableDynamic.compactRecords();
-        std::cout << "  After compactRecords():" << std::endl;
-        std::cout << "    QBTableDynamic - Total records (before compact) -> (after compact): " << beforeCompactQBD << " -> " << qbTableDynamic.totalRecordsCount() << std::endl;
-        std::cout << "    QBTableDynamic - Active records: " << qbTableDynamic.activeRecordsCount() << std::endl;
+        out << "  After compactRecords():" << std::endl;
+        out << "    QBTableDynamic - Total records (before compact) -> (after compact): " << beforeCompactQBD << " -> " << qbTableDynamic.totalRecordsCount() << std::endl;
+        out << "    QBTableDynamic - Active records: " << qbTableDynamic.activeRecordsCount() << std::endl;
 
-        std::cout << "\n  ✓ All deletion tests passed\n"
+        out << "\n  ✓ All deletion tests passed\n"
                   << std::endl;
     }
 
-    std::cout << std::string(80, '=') << std::endl;
-    std::cout << "TESTS COMPLETED SUCCESSFULLY" << std::endl;
-    std::cout << std::string(80, '=') << std::endl;
-}
+    // ========== TEST 5: Access Path Statistics ==========
+    out << "TEST 5: Access Path and Index Usage Statistics" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
 
-int main()
-{
-    using namespace std::chrono;
+    {
+        auto printCounters = [&](const std::string &label, const db::AccessPathCounters &c)
+        {
+            out << "    " << std::left << std::setw(10) << label
+                << " pk: " << c.pkLookups << "  index: " << c.secondaryIndexLookups << "  scans: " << c.linearScans
+                << "  examined: " << c.rowsExamined << "  returned: " << c.rowsReturned
+                << "  deleted filtered: " << c.deletedFiltered << std::endl;
+        };
 
-    // ========== Basic Correctness Tests ==========
-    std::cout << "RUNNING QBTable TESTS\n"
-              << std::endl;
+        qbTable.resetStats();
+        qbTable.findMatching(db::ColumnType::COLUMN0, "50000");
+        qbTable.findMatching(db::ColumnType::COLUMN2, "42");
+        qbTable.findMatching(db::ColumnType::COLUMN1, "testdata50");
+        db::QBTableStats qbStats = qbTable.stats();
+        out << "  QBTable:" << std::endl;
+        for (const auto &[columnID, counters] : qbStats.columns)
+            printCounters("column" + std::to_string(static_cast<int>(columnID)), counters);
+        printCounters("total", qbStats.table);
+        for (const auto &[columnID, usage] : qbStats.indexes)
+            out << "    index column" << static_cast<int>(columnID) << " hits: " << usage.hits << std::endl;
 
-    // Run comprehensive benchmarks
-    runBenchmarks();
+        assert(qbStats.table.pkLookups == 1 && qbStats.table.secondaryIndexLookups == 1 && qbStats.table.linearScans == 1);
+        assert(qbStats.indexes.at(db::ColumnType::COLUMN2).hits == 1);
+        assert(qbStats.columns.at(db::ColumnType::COLUMN1).rowsExamined == qbTable.totalRecordsCount());
 
-    return 0;
-}
\ No newline at end of file
+        qbTableDynamic.resetStats();
+        qbTableDynamic.findMatching("id", 50000u);
+        qbTableDynamic.findMatching("column2", 42L);
+        qbTableDynamic.findMatching("column2", 1000L);
+        qbTableDynamic.findMatching("column3", std::string("50testdata"));
+        db::QBTableDynamicStats qbdStats = qbTableDynamic.stats();
+        out << "  QBTableDynamic:" << std::endl;
+        for (const auto &[column, counters] : qbdStats.columns)
+            printCounters(column, counters);
+        printCounters("total", qbdStats.table);
+        for (const auto &[column, usage] : qbdStats.indexes)
+            out << "    index " << column << " hits: " << usage.hits << std::endl;
+
+        // an indexed column without a matching key must not fall back to a scan
+        assert(qbdStats.columns.at("column2").secondaryIndexLookups == 2 && qbdStats.columns.at("column2").linearScans == 0);
+        assert(qbdStats.columns.at("column3").linearScans == 1);
+        // names outside the schema are answered but never reported
+        qbTableDynamic.findMatching("colunm2", 42L);
+        assert(qbTableDynamic.stats().columns.size() == 3 && !qbTableDynamic.stats().columns.contains("colunm2"));
+
+        // queries running side by side count every lookup exactly once
+        {
+            qbTable.resetStats();
+            std::vector<std::thread> readers;
+            for (int t = 0; t < 4; ++t)
+                readers.emplace_back([&]
+                                     {
+                                         for (int i = 0; i < 1000; ++i)
+                                             qbTable.findMatching(db::ColumnType::COLUMN0, std::to_string(i)); });
+            for (auto &reader : readers)
+                reader.join();
+            [[maybe_unused]] const db::QBTableStats concurrent = qbTable.stats();
+            assert(concurrent.table.pkLookups == 4000 && concurrent.indexes.at(db::ColumnType::COLUMN0).hits == 4000);
+        }
+
+        out << "\n  ✓ All statistics tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 6: Query Shape Statistics and Slow Query Log ==========
+    out << "TEST 6: Query Shape Statistics and Slow Query Log" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        const std::string testName = "TEST 6";
+        std::vector<BenchmarkResult> results;
+
+        // overhead of timing and aggregating point lookups
+        results.push_back({"QBTable", timeQueries(ctx, testName, "QBTable", [&]
+                                                   { return qbTable.findMatching(db::ColumnType::COLUMN0, "50000"); }), 0, ""});
+        auto queryLog = std::make_shared<db::QueryLog>(db::QueryLogOptions{16, 8, std::chrono::microseconds(1000)});
+        qbTable.setQueryLog(queryLog, "static");
+        qbTableDynamic.setQueryLog(queryLog, "dynamic");
+        results.push_back({"QBTable + query log", timeQueries(ctx, testName, "QBTable + query log", [&]
+                                                               { return qbTable.findMatching(db::ColumnType::COLUMN0, "50000"); }), 0, ""});
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(30) << r.name
+                << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms" << std::endl;
+        }
+
+        // different literals of the same query collapse into one shape, scans exceed the 1ms threshold
+        for (int i = 0; i < 3; ++i)
+        {
+            qbTable.findMatching(db::ColumnType::COLUMN2, std::to_string(i));
+            qbTable.findMatching(db::ColumnType::COLUMN1, "testdata5" + std::to_string(i));
+            qbTableDynamic.findMatching("column3", std::to_string(i) + "testdata");
+        }
+        out << "\n  Query shapes (by total time):" << std::endl;
+        for (const auto &shape : queryLog->shapes())
+        {
+            out << "    " << std::left << std::setw(34) << shape.shape.toString()
+                << " calls: " << std::setw(5) << shape.calls
+                << " mean: " << std::setprecision(3) << shape.meanMs() << " ms"
+                << "  max: " << shape.maxMs << " ms"
+                << "  examined: " << shape.rowsExamined << std::endl;
+        }
+        auto slowQueries = queryLog->slowQueries();
+        out << "  Slow queries (> " << queryLog->slowThreshold().count() << " us): " << slowQueries.size() << std::endl;
+        for (const auto &entry : slowQueries)
+            out << "    " << std::setprecision(3) << entry.durationMs << " ms  " << entry.explain << std::endl;
+
+        auto shapes = queryLog->shapes();
+        assert(std::any_of(shapes.begin(), shapes.end(), [](const db::QueryShapeStats &q)
+                           { return q.shape.table == "static" && q.shape.column == "column1" && q.calls == 3; }));
+        assert(slowQueries.size() <= 8);
+
+        qbTable.setQueryLog(nullptr, {});
+        qbTableDynamic.setQueryLog(nullptr, {});
+        out << "\n  ✓ All query log tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 7: Batched Primary Key Lookups ==========
+    out << "TEST 7: Batched Primary Key Lookups" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        const std::string testName = "TEST 7";
+        std::vector<db::uint> ids;
+        for (db::uint i = 0; i < 1000; ++i)
+            ids.push_back(i * 97);
+        ids.push_back(std::numeric_limits<db::uint>::max()); // missing key
+
+        std::vector<BenchmarkResult> results;
+        results.push_back({"QBTable findMatching x1001", timeQueries(ctx, testName, "QBTable findMatching", [&]
+                                                                      {
+                                                                          size_t found = 0;
+                                                                          for (db::uint id : ids)
+                                                                              found += qbTable.findMatching(db::ColumnType::COLUMN0, std::to_string(id)).size();
+                                                                          return found; }),
+                           0, ""});
+        results.push_back({"QBTable lookupBatch", timeQueries(ctx, testName, "QBTable lookupBatch", [&]
+                                                              { return qbTable.lookupBatch(ids, [](size_t, const db::QBRecord *) {}); }),
+                           0, ""});
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(30) << r.name
+                << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms" << std::endl;
+        }
+
+        // visited in key order, nullptr exactly where findMatching has no result
+        [[maybe_unused]] size_t visited = 0;
+        qbTable.lookupBatch(ids, [&](size_t i, [[maybe_unused]] const db::QBRecord *rec)
+                            {
+                                assert(i == visited);
+                                ++visited;
+                                auto expected = qbTable.findMatching(db::ColumnType::COLUMN0, std::to_string(ids[i]));
+                                assert((rec != nullptr) == !expected.empty());
+                                assert(!rec || rec->column0 == ids[i]); });
+        assert(visited == ids.size());
+
+#if defined(__linux__)
+        // the server answers a pipelined run of primary key finds with one lookupBatch() probe - hits, misses
+        // and keys it cannot parse as a batch get the same responses, in the same order, as one request at a time
+        {
+            const std::string socketPath = (std::filesystem::temp_directory_path() / "quickbase_tests.sock").string();
+            db::QBTable hostedTable;
+            for (db::uint i = 0; i < 1000; ++i)
+                hostedTable.addRecord({i, "name" + std::to_string(i), long(i % 10), "note" + std::to_string(i)});
+            db::QBServer server({"", 0, socketPath, 1});
+            server.hostTable("pk", std::move(hostedTable));
+            server.start();
+
+            const std::vector<std::string> keys = {"0", "5", "999", "1000", "4294967295", "17", "abc", "18", "12x", "",
+                                                   "-1", "20", " 7", "4294967296", "007", "+3", "21", "22", "0x10", "23"};
+            auto encodeFind = [&](db::QBClient &client, std::vector<char> &frames, const std::string &key)
+            {
+                return client.encodeRequest(frames, db::wire::Opcode::Find, [&](db::wire::Writer &w)
+                                            {
+                                                w.putName("pk");
+                                                w.putU8(static_cast<uint8_t>(db::ColumnType::COLUMN0));
+                                                w.putString(key); });
+            };
+
+            db::QBClient client;
+            client.connectUnix(socketPath);
+            std::vector<db::ClientResponse> single;
+            for (const auto &key : keys)
+            {
+                std::vector<char> frame;
+                encodeFind(client, frame, key);
+                client.send(frame);
+                single.push_back(client.receive());
+            }
+
+            std::vector<char> pipelined;
+            std::vector<uint32_t> requestIds;
+            for (const auto &key : keys)
+                requestIds.push_back(encodeFind(client, pipelined, key));
+            client.send(pipelined);
+            for (size_t i = 0; i < keys.size(); ++i)
+            {
+                [[maybe_unused]] db::ClientResponse batched = client.receive();
+                assert(batched.requestId == requestIds[i]);
+                assert(batched.status == single[i].status && batched.payload == single[i].payload);
+            }
+            [[maybe_unused]] auto rows = [](const db::ClientResponse &response)
+            {
+                return response.status == db::wire::Status::Ok ? response.reader().getU32() : 0u;
+            };
+            assert(rows(single[0]) == 1 && rows(single[2]) == 1 && rows(single[3]) == 0 && rows(single[4]) == 0);
+
+            client.close();
+            server.stop();
+            server.wait();
+        }
+#endif
+
+        out << "\n  ✓ All batched lookup tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 8: SQL Subset Queries and Plan Cache ==========
+    out << "TEST 8: SQL Subset Queries and Plan Cache" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        const std::string testName = "TEST 8";
+        const std::string sql = "SELECT * FROM qb WHERE column2 = 42";
+        db::query::QueryEngine engine;
+        db::query::QueryEngine uncached(0);
+        for (auto *e : {&engine, &uncached})
+        {
+            e->registerTable("qb", qbTable);
+            e->registerTable("qbd", qbTableDynamic);
+        }
+
+        std::vector<BenchmarkResult> results;
+        results.push_back({"findMatching (direct API)", timeQueries(ctx, testName, "findMatching", [&]
+                                                                     { return qbTable.findMatching(db::ColumnType::COLUMN2, "42"); }),
+                           0, ""});
+        results.push_back({"parse", timeQueries(ctx, testName, "parse", [&]
+                                                 { return db::query::parse(sql); }),
+                           0, ""});
+        results.push_back({"parse + plan", timeQueries(ctx, testName, "parse + plan", [&]
+                                                        { return uncached.prepare(sql); }),
+                           0, ""});
+        results.push_back({"execute, uncached plan", timeQueries(ctx, testName, "execute uncached", [&]
+                                                                  { return uncached.execute(sql); }),
+                           0, ""});
+        results.push_back({"execute, cached plan", timeQueries(ctx, testName, "execute cached", [&]
+                                                                { return engine.execute(sql); }),
+                           0, ""});
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(30) << r.name
+                << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms" << std::endl;
+        }
+
+        const std::vector<std::string> queries = {
+            "SELECT column0 FROM qb WHERE column2 = 42 AND column1 LIKE '%data4%' LIMIT 50",
+            "select count(*) from qb where column3 like '5%testdata'",
+            "SELECT * FROM qb WHERE column0 = 50000",
+            "SELECT id, column1 FROM qbd WHERE column2 = 7 AND column3 = '1007testdata'",
+            "SELECT COUNT(*) FROM qbd WHERE column1 LIKE 'testdata9_'"};
+        out << "\n  Plans:" << std::endl;
+        for (const auto &q : queries)
+            out << "    " << q << "\n      " << engine.prepare(q)->explain() << std::endl;
+
+        // same rows as the direct API, in the same order
+        auto direct = qbTable.findMatching(db::ColumnType::COLUMN2, "42");
+        auto viaSql = engine.execute(sql);
+        assert(viaSql.rowCount() == direct.size());
+        for (size_t i = 0; i < direct.size(); ++i)
+            assert(std::get<db::uint>(*viaSql.at(i, 0)) == direct[i].column0 && std::get<std::string>(*viaSql.at(i, 3)) == direct[i].column3);
+
+        auto limited = engine.execute(queries[0]);
+        assert(limited.columns == std::vector<std::string>{"column0"} && limited.rowCount() <= 50);
+        for (size_t i = 0; i < limited.rowCount(); ++i)
+            assert(std::get<db::uint>(*limited.at(i, 0)) % 100 == 42);
+
+        size_t expectedCount = 0;
+        for (const auto &rec : baseData)
+            expectedCount += db::query::likeMatch(rec.column3, "5%testdata") ? 1 : 0;
+        [[maybe_unused]] auto counted = engine.execute(queries[1]);
+        assert(std::get<long>(*counted.at(0, 0)) == static_cast<long>(expectedCount));
+        [[maybe_unused]] auto single = engine.execute(queries[3]);
+        assert(single.rowCount() == 1);
+
+        // whitespace and reuse hit the cache, creating an index replans
+        [[maybe_unused]] auto cacheBefore = engine.cacheStats();
+        engine.execute("SELECT *   FROM qb\n WHERE column2 = 42");
+        assert(engine.cacheStats().hits == cacheBefore.hits + 1);
+        [[maybe_unused]] auto plan = engine.prepare(queries[1]);
+        assert(plan->access == db::query::AccessPath::ColumnScan);
+        qbTable.createIndex(db::ColumnType::COLUMN3);
+        plan = engine.prepare(queries[1]);
+        assert(plan->access == db::query::AccessPath::FullScan && engine.cacheStats().replans == 1);
+        counted = engine.execute(queries[1]);
+        assert(std::get<long>(*counted.at(0, 0)) == static_cast<long>(expectedCount));
+        qbTable.dropIndex(db::ColumnType::COLUMN3);
+
+        [[maybe_unused]] bool rejected = false;
+        try
+        {
+            engine.execute("SELECT * FROM qb WHERE column2 = 'x'");
+        }
+        catch (const db::query::QueryError &e)
+        {
+            rejected = true;
+            out << "  Rejected: " << e.what() << std::endl;
+        }
+        assert(rejected);
+
+        auto cache = engine.cacheStats();
+        out << "  Plan cache: " << cache.hits << " hits, " << cache.misses << " misses, " << cache.replans << " replans" << std::endl;
+        out << "\n  ✓ All query language tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 9: Change Data Capture ==========
+    out << "TEST 9: Change Data Capture Stream" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        const std::string testName = "TEST 9";
+        using namespace std::chrono;
+
+        // a mirror of storage positions rebuilt from the events matches the table after every kind of mutation
+        db::QBTable table;
+        auto stream = std::make_shared<db::QBChangeStream>();
+        table.setChangeStream(stream);
+        auto subscription = stream->subscribe(64);
+        for (size_t i = 0; i < 10; ++i)
+            table.addRecord(baseData[i]);
+        table.deleteRecordByID(3);
+        table.deleteRecordByID(5, true);
+        table.deleteRecordByID(8);
+        table.compactRecords();
+        table.deleteRecordByID(0, true);
+
+        std::vector<std::optional<db::uint>> mirror;
+        [[maybe_unused]] uint64_t expectedSequence = 1;
+        subscription->drain([&](const db::QBChangeEvent &event)
+                            {
+                                assert(event.sequence == expectedSequence);
+                                ++expectedSequence;
+                                switch (event.type)
+                                {
+                                case db::ChangeType::Insert:
+                                    assert(event.position == mirror.size() && event.record.column0 == event.id);
+                                    mirror.push_back(event.id);
+                                    break;
+                                case db::ChangeType::SoftDelete:
+                                    assert(mirror[event.position] == event.id);
+                                    mirror[event.position].reset();
+                                    break;
+                                case db::ChangeType::HardDelete:
+                                    assert(mirror[event.position] == event.id);
+                                    for (const auto &move : event.moves)
+                                        mirror[move.to] = mirror[move.from];
+                                    mirror.pop_back();
+                                    break;
+                                case db::ChangeType::Compaction:
+                                {
+                                    std::vector<std::optional<db::uint>> compacted(static_cast<size_t>(std::count_if(mirror.begin(), mirror.end(), [](const auto &id)
+                                                                                                                      { return id.has_value(); })));
+                                    for (size_t i = 0; i < compacted.size(); ++i)
+                                        compacted[i] = mirror[i];
+                                    for (const auto &move : event.moves)
+                                        compacted[move.to] = mirror[move.from];
+                                    mirror = std::move(compacted);
+                                    break;
+                                }
+                                case db::ChangeType::Update:
+                                    assert(mirror[event.position] == event.id && event.record.column0 == event.id);
+                                    break;
+                                case db::ChangeType::Resync:
+                                    assert(false);
+                                } });
+        assert(expectedSequence == stream->lastSequence() + 1);
+        std::vector<db::uint> storage;
+        table.forEachRecord([&](const db::QBRecord &rec)
+                            { storage.push_back(rec.column0); return true; });
+        assert(mirror.size() == storage.size());
+        for (size_t i = 0; i < storage.size(); ++i)
+            assert(mirror[i] == storage[i]);
+
+        // QBTableDynamic publishes accepted records only
+        db::QBTableDynamic dynamicTable;
+        dynamicTable.addColumn("column1", std::string{});
+        auto dynamicStream = std::make_shared<db::QBDynamicChangeStream>();
+        dynamicTable.setChangeStream(dynamicStream);
+        auto dynamicSubscription = dynamicStream->subscribe();
+        dynamicTable.addRecord({1, {{"column1", std::string("a")}}});
+        dynamicTable.addRecord({2, {{"unknown", std::string("b")}}});
+        dynamicTable.deleteRecordByID(1, true);
+        db::QBDynamicChangeEvent dynamicEvent;
+        [[maybe_unused]] bool polled = dynamicSubscription->poll(dynamicEvent);
+        assert(polled && dynamicEvent.type == db::ChangeType::Insert);
+        assert(std::get<std::string>(dynamicEvent.record.fields.at("column1")) == "a");
+        polled = dynamicSubscription->poll(dynamicEvent);
+        assert(polled && dynamicEvent.type == db::ChangeType::HardDelete && dynamicEvent.sequence == 2);
+        polled = dynamicSubscription->poll(dynamicEvent);
+        assert(!polled);
+
+        // a slow subscriber under OverflowPolicy::Resync keeps a bounded ring and is told where it lost events
+        auto slow = stream->subscribe(8, db::OverflowPolicy::Resync);
+        [[maybe_unused]] const uint64_t firstSequence = stream->lastSequence() + 1;
+        for (size_t i = 10; i < 30; ++i)
+            table.addRecord(baseData[i]);
+        std::vector<db::QBChangeEvent> received;
+        slow->drain([&](const db::QBChangeEvent &event)
+                    { received.push_back(event); });
+        assert(received.size() == 9 && received.back().type == db::ChangeType::Resync);
+        assert(received.back().sequence == firstSequence + 8 && slow->stats().dropped == 12);
+        table.addRecord(baseData[30]);
+        polled = slow->poll(received.front());
+        assert(polled && received.front().sequence == stream->lastSequence());
+        stream->unsubscribe(slow);
+        table.setChangeStream(nullptr);
+
+        // ingest overhead - detached, attached without subscribers, one subscriber drained by another thread
+        auto timeIngest = [&](const std::string &name, db::OverflowPolicy policy, int subscribers)
+        {
+            db::bench::BenchmarkStats stats{testName, name, {}};
+            for (int trial = 0; trial < ctx.trials; ++trial)
+            {
+                db::QBTable ingest;
+                auto ingestStream = std::make_shared<db::QBChangeStream>();
+                if (subscribers >= 0)
+                    ingest.setChangeStream(ingestStream);
+                std::shared_ptr<db::QBChangeStream::Subscription> consumerSubscription;
+                std::thread consumer;
+                if (subscribers > 0)
+                {
+                    consumerSubscription = ingestStream->subscribe(4096, policy);
+                    consumer = std::thread([&]
+                                           {
+                                               while (!consumerSubscription->closed())
+                                                   if (consumerSubscription->drain([](const db::QBChangeEvent &) {}) == 0)
+                                                       std::this_thread::yield(); });
+                }
+                auto startTimer = steady_clock::now();
+                for (const auto &rec : baseData)
+                    ingest.addRecord(rec);
+                auto elapsed = steady_clock::now() - startTimer;
+                if (consumer.joinable())
+                {
+                    while (consumerSubscription->pending() > 0)
+                        std::this_thread::yield();
+                    assert(consumerSubscription->stats().delivered + consumerSubscription->stats().dropped == baseData.size());
+                    ingestStream->unsubscribe(consumerSubscription);
+                    consumer.join();
+                }
+                stats.samplesMs.push_back(duration<double, std::milli>(elapsed).count());
+            }
+            ctx.report.push_back(stats);
+            return db::bench::summarize(stats.samplesMs).mean;
+        };
+
+        std::vector<BenchmarkResult> results;
+        results.push_back({"addRecord, no change stream", timeIngest("ingest no stream", db::OverflowPolicy::Block, -1), 0, ""});
+        results.push_back({"addRecord, no subscribers", timeIngest("ingest no subscribers", db::OverflowPolicy::Block, 0), 0, ""});
+        results.push_back({"addRecord, 1 subscriber (block)", timeIngest("ingest block subscriber", db::OverflowPolicy::Block, 1), 0, ""});
+        results.push_back({"addRecord, 1 subscriber (resync)", timeIngest("ingest resync subscriber", db::OverflowPolicy::Resync, 1), 0, ""});
+        out << "  Ingest of " << baseData.size() << " records (" << std::thread::hardware_concurrency() << " hardware threads):" << std::endl;
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(34) << r.name
+                << std::right << std::setw(10) << std::fixed << std::setprecision(3) << r.timeMs << " ms"
+                << std::setw(10) << std::setprecision(1) << r.timeMs * 1e6 / double(baseData.size()) << " ns/record" << std::endl;
+        }
+
+        out << "\n  ✓ All change data capture tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 10: Write-Ahead Log Replication ==========
+    out << "TEST 10: Write-Ahead Log Replication" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        const std::string walPath = (std::filesystem::temp_directory_path() / "quickbase_tests.wal").string();
+        {
+            // entries reach the follower only once flushed, the follower replays them into identical storage
+            auto wal = std::make_shared<db::wal::LogWriter>(walPath, db::wal::LogWriterOptions{1 << 20, seconds(60)});
+            db::QBTable primary;
+            primary.setWriteAheadLog(wal);
+            db::replica::Follower follower(walPath);
+
+            auto walStart = steady_clock::now();
+            for (const auto &rec : baseData)
+                primary.addRecord(rec);
+            const double appendMs = duration<double, std::milli>(steady_clock::now() - walStart).count();
+            primary.createIndex(db::ColumnType::COLUMN2);
+            [[maybe_unused]] const size_t beforeFlush = follower.poll();
+            assert(beforeFlush < baseData.size());
+            wal->flush();
+            walStart = steady_clock::now();
+            follower.poll();
+            const double replayMs = duration<double, std::milli>(steady_clock::now() - walStart).count();
+
+            for (db::uint id = 0; id < 1000; id += 3)
+                primary.deleteRecordByID(id);
+            primary.deleteRecordByID(500, true);
+            primary.deleteRecordByID(DATA_SIZE - 1, true);
+            primary.compactRecords();
+            primary.dropIndex(db::ColumnType::COLUMN2);
+            primary.createIndex(db::ColumnType::COLUMN3);
+            wal->flush();
+            follower.poll();
+
+            [[maybe_unused]] auto status = follower.status();
+            assert(status.appliedLsn == wal->lastLsn() && status.bytesApplied == wal->bytesWritten() && status.error.empty());
+            [[maybe_unused]] bool fresh = follower.read([&](const db::QBTable &replica)
+                                                        {
+                                                            assert(replica.totalRecordsCount() == primary.totalRecordsCount());
+                                                            assert(replica.isColumnIndexed(db::ColumnType::COLUMN3) && !replica.isColumnIndexed(db::ColumnType::COLUMN2));
+                                                            std::vector<db::uint> expected;
+                                                            primary.forEachRecord([&](const db::QBRecord &rec)
+                                                                                  { expected.push_back(rec.column0); return true; });
+                                                            [[maybe_unused]] size_t i = 0;
+                                                            replica.forEachRecord([&]([[maybe_unused]] const db::QBRecord &rec)
+                                                                                  { assert(rec.column0 == expected[i]); ++i; return true; });
+                                                            assert(i == expected.size()); },
+                                                        seconds(1));
+            assert(fresh);
+            // bounded staleness - a follower that has not caught up recently refuses reads
+            std::this_thread::sleep_for(milliseconds(20));
+            assert(!follower.read([](const db::QBTable &) {}, milliseconds(10)));
+
+            out << "  addRecord x" << baseData.size() << " with log:  " << std::fixed << std::setprecision(3) << appendMs << " ms ("
+                << wal->bytesWritten() / 1024 << " KiB log)" << std::endl;
+            out << "  Follower replay:            " << replayMs << " ms" << std::endl;
+        }
+
+        // a corrupted entry stops the follower with an error instead of applying it
+        {
+            std::FILE *file = std::fopen(walPath.c_str(), "r+b");
+            std::fseek(file, long(sizeof(db::wal::kMagic) + db::wal::kEntryHeaderSize + db::wal::kEntryFixedSize + 2), SEEK_SET);
+            std::fputc('#', file);
+            std::fclose(file);
+            db::replica::Follower corrupted(walPath);
+            [[maybe_unused]] bool rejected = false;
+            try
+            {
+                corrupted.poll();
+            }
+            catch (const db::wal::WalError &e)
+            {
+                rejected = true;
+                out << "  Rejected: " << e.what() << std::endl;
+            }
+            assert(rejected && corrupted.status().appliedLsn == 0);
+        }
+
+        // an entry the replica's table refuses stops it for good instead of serving a diverged table
+        {
+            {
+                db::wal::LogWriter diverging(walPath);
+                diverging.appendInsert(baseData[0]);
+                diverging.appendUpdate({99, "missing", 0, ""});
+                diverging.appendInsert(baseData[1]);
+            }
+            db::replica::Follower diverged(walPath);
+            [[maybe_unused]] bool stopped = false;
+            try
+            {
+                diverged.poll();
+            }
+            catch (const db::replica::ReplicationError &e)
+            {
+                stopped = true;
+                out << "  Stopped: " << e.what() << std::endl;
+            }
+            [[maybe_unused]] const size_t retried = diverged.poll();
+            [[maybe_unused]] const bool served = diverged.read([](const db::QBTable &) {}, seconds(1));
+            assert(stopped && retried == 0 && !served && !diverged.status().error.empty());
+        }
+
+        // staleness is measured against the flushed log - writes still buffered by an idle primary are not seen
+        {
+            db::wal::LogWriterOptions idle;
+            idle.flushInterval = hours(1);
+            auto idleWal = std::make_shared<db::wal::LogWriter>(walPath, idle);
+            db::QBTable idlePrimary;
+            idlePrimary.setWriteAheadLog(idleWal);
+            idlePrimary.addRecord(baseData[0]);
+            db::replica::Follower idleFollower(walPath);
+            idleFollower.poll();
+            [[maybe_unused]] size_t replicated = 1;
+            [[maybe_unused]] bool served = idleFollower.read([&](const db::QBTable &replica)
+                                                             { replicated = replica.totalRecordsCount(); },
+                                                             seconds(1));
+            assert(served && replicated == 0 && idleWal->flushedLsn() < idleWal->lastLsn());
+            idleWal->flush();
+            idleFollower.poll();
+            served = idleFollower.read([&](const db::QBTable &replica)
+                                       { replicated = replica.totalRecordsCount(); },
+                                       seconds(1));
+            assert(served && replicated == 1);
+        }
+        std::filesystem::remove(walPath);
+
+        out << "\n  ✓ All replication tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 11: Joins ==========
+    out << "TEST 11: Hash Join and Index Nested Loop Join" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        const std::string testName = "TEST 11";
+        // child rows reference a parent's column0 through their column2
+        db::QBTable children;
+        for (db::uint i = 0; i < 10000; ++i)
+            children.addRecord({i, "child" + std::to_string(i), long(i * 7 % (DATA_SIZE + 500)), i % 2 ? "odd" : "even"});
+
+        auto pairsChecksum = [](auto &&join)
+        {
+            size_t checksum = 0;
+            join.forEach([&](const db::QBRecord &child, const auto &parent)
+                         {
+                             size_t parentId = 0;
+                             if constexpr (std::is_same_v<std::decay_t<decltype(parent)>, db::QBRecord>)
+                                 parentId = parent.column0;
+                             else
+                                 parentId = parent.id;
+                             checksum += child.column0 * 31 + parentId; });
+            return checksum;
+        };
+        std::vector<BenchmarkResult> results;
+        results.push_back({"findMatching per child row", timeQueries(ctx, testName, "findMatching per child", [&]
+                                                                      {
+                                                                          size_t pairs = 0;
+                                                                          children.forEachRecord([&](const db::QBRecord &child)
+                                                                                                 { pairs += qbTable.findMatching(db::ColumnType::COLUMN0, std::to_string(child.column2)).size(); return true; });
+                                                                          return pairs; }),
+                           0, ""});
+        results.push_back({"join, index probe", timeQueries(ctx, testName, "join index probe", [&]
+                                                             { return db::join::Join(db::join::side(children, db::ColumnType::COLUMN2), db::join::side(qbTable, db::ColumnType::COLUMN0))
+                                                                   .forEach([](const db::QBRecord &, const db::QBRecord &) {}); }),
+                           0, ""});
+        results.push_back({"join, hash build children", timeQueries(ctx, testName, "join hash", [&]
+                                                                     { return db::join::Join(db::join::side(children, db::ColumnType::COLUMN2), db::join::side(qbTable, db::ColumnType::COLUMN0),
+                                                                                             db::join::Strategy::HashBuildLeft)
+                                                                        .forEach([](const db::QBRecord &, const db::QBRecord &) {}); }),
+                           0, ""});
+        results.push_back({"join, parent column2 = 42", timeQueries(ctx, testName, "join pushdown", [&]
+                                                                     { return db::join::Join(db::join::side(children, db::ColumnType::COLUMN2),
+                                                                                             db::join::side(qbTable, db::ColumnType::COLUMN0).where(db::ColumnType::COLUMN2, "42"))
+                                                                           .forEach([](const db::QBRecord &, const db::QBRecord &) {}); }),
+                           0, ""});
+        results.push_back({"join dynamic, index probe", timeQueries(ctx, testName, "join dynamic", [&]
+                                                                     { return db::join::Join(db::join::side(children, db::ColumnType::COLUMN2), db::join::side(qbTableDynamic, "id"))
+                                                                           .forEach([](const db::QBRecord &, const db::QBRecordDynamic &) {}); }),
+                           0, ""});
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(30) << r.name
+                << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms" << std::endl;
+        }
+
+        // every strategy returns the pairs of the per-row lookups
+        size_t expectedPairs = 0, expectedFiltered = 0;
+        children.forEachRecord([&](const db::QBRecord &child)
+                               {
+                                   auto parents = qbTable.findMatching(db::ColumnType::COLUMN0, std::to_string(child.column2));
+                                   expectedPairs += parents.size();
+                                   expectedFiltered += std::count_if(parents.begin(), parents.end(), [](const db::QBRecord &p)
+                                                                     { return p.column2 == 42; });
+                                   return true; });
+        db::join::Join probed(db::join::side(children, db::ColumnType::COLUMN2), db::join::side(qbTable, db::ColumnType::COLUMN0));
+        db::join::Join hashed(db::join::side(children, db::ColumnType::COLUMN2), db::join::side(qbTable, db::ColumnType::COLUMN0), db::join::Strategy::HashBuildRight);
+        db::join::Join hashedLeft(db::join::side(children, db::ColumnType::COLUMN2), db::join::side(qbTable, db::ColumnType::COLUMN0), db::join::Strategy::HashBuildLeft);
+        db::join::Join filtered(db::join::side(children, db::ColumnType::COLUMN2).where([](const db::QBRecord &c)
+                                                                                        { return c.column3 == "even"; }),
+                                db::join::side(qbTable, db::ColumnType::COLUMN0).where(db::ColumnType::COLUMN2, "42"));
+        db::join::Join dynamic(db::join::side(children, db::ColumnType::COLUMN2), db::join::side(qbTableDynamic, "id"));
+        assert(probed.strategy() == db::join::Strategy::IndexProbeRight);
+        [[maybe_unused]] const size_t probedChecksum = pairsChecksum(probed);
+        assert(probed.stats().pairs == expectedPairs && expectedPairs > 0);
+        assert(pairsChecksum(hashed) == probedChecksum && hashed.stats().pairs == expectedPairs);
+        assert(pairsChecksum(hashedLeft) == probedChecksum);
+        assert(pairsChecksum(dynamic) == probedChecksum);
+        [[maybe_unused]] size_t filteredPairs = 0;
+        filtered.forEach([&]([[maybe_unused]] const db::QBRecord &child, [[maybe_unused]] const db::QBRecord &parent)
+                         {
+                             assert(child.column3 == "even" && parent.column2 == 42 && parent.column0 == db::uint(child.column2));
+                             ++filteredPairs; });
+        // pushdown shrinks the parent side to its column2 index bucket, so the hash table is built on it
+        assert(filtered.strategy() == db::join::Strategy::HashBuildRight && filtered.stats().rightCandidates == qbTable.findMatching(db::ColumnType::COLUMN2, "42").size());
+        assert(filteredPairs > 0 && filteredPairs <= expectedFiltered);
+
+        // lazy - the first pair is available without producing the rest
+        db::join::Join lazy(db::join::side(qbTable, db::ColumnType::COLUMN2), db::join::side(children, db::ColumnType::COLUMN2));
+        const db::QBRecord *left = nullptr, *right = nullptr;
+        [[maybe_unused]] bool first = lazy.next(left, right);
+        assert(first && left->column2 == right->column2 && lazy.stats().pairs == 1);
+        out << "  " << lazy.explain() << std::endl;
+        out << "  " << filtered.explain() << std::endl;
+
+        out << "\n  ✓ All join tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 12: Materialized Views ==========
+    out << "TEST 12: Incrementally Maintained Materialized Views" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        const std::string testName = "TEST 12";
+        auto matches99 = [](const db::QBRecord &rec)
+        { return rec.column3.find("99") != std::string::npos; };
+        auto rows99 = std::make_shared<db::QBMaterializedView>(matches99, [](const db::QBRecord &rec)
+                                                               { return db::QBRecord{rec.column0, {}, rec.column2, rec.column3}; });
+        auto count99 = std::make_shared<db::QBMaterializedView>(matches99, db::ViewAggregate::Count);
+        auto sumColumn2 = std::make_shared<db::QBMaterializedView>(matches99, db::ViewAggregate::Sum, [](const db::QBRecord &rec)
+                                                                   { return rec.column2; });
+        auto maxId = std::make_shared<db::QBMaterializedView>(nullptr, db::ViewAggregate::Max, [](const db::QBRecord &rec)
+                                                              { return long(rec.column0); });
+
+        // write cost - the same load with and without the views attached
+        db::QBTable plain, viewed;
+        for (auto &view : {rows99, count99, sumColumn2, maxId})
+            viewed.addView(view);
+        auto loadStart = steady_clock::now();
+        for (const auto &rec : baseData)
+            plain.addRecord(rec);
+        const double plainMs = duration<double, std::milli>(steady_clock::now() - loadStart).count();
+        loadStart = steady_clock::now();
+        for (const auto &rec : baseData)
+            viewed.addRecord(rec);
+        const double viewedMs = duration<double, std::milli>(steady_clock::now() - loadStart).count();
+
+        std::vector<BenchmarkResult> results;
+        results.push_back({"re-query count", timeQueries(ctx, testName, "re-query count", [&]
+                                                          { return viewed.forEachMatching(db::ColumnType::COLUMN3, "99", [](const db::QBRecord &) {}); }),
+                           0, ""});
+        results.push_back({"view count", timeQueries(ctx, testName, "view count", [&]
+                                                      { return count99->count(); }),
+                           0, ""});
+        results.push_back({"re-query rows", timeQueries(ctx, testName, "re-query rows", [&]
+                                                         { return viewed.findMatching(db::ColumnType::COLUMN3, "99"); }),
+                           0, ""});
+        // copied out like findMatching() returns them
+        results.push_back({"view rows", timeQueries(ctx, testName, "view rows", [&]
+                                                     { return std::vector<db::QBRecord>(rows99->rows()); }),
+                           0, ""});
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(30) << r.name
+                << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms" << std::endl;
+        }
+        out << "  addRecord x" << baseData.size() << ": " << plainMs << " ms, with 4 views " << viewedMs << " ms" << std::endl;
+
+        // every kind of mutation keeps the views equal to a recomputation
+        auto check = [&]
+        {
+            size_t expectedCount = 0;
+            long expectedSum = 0;
+            std::optional<long> expectedMax;
+            std::vector<db::uint> expectedIds;
+            viewed.forEachRecord([&](const db::QBRecord &rec)
+                                 {
+                                     expectedMax = std::max(expectedMax.value_or(long(rec.column0)), long(rec.column0));
+                                     if (matches99(rec))
+                                     {
+                                         ++expectedCount;
+                                         expectedSum += rec.column2;
+                                         expectedIds.push_back(rec.column0);
+                                     }
+                                     return true; });
+            std::vector<db::uint> ids;
+            for (const auto &rec : rows99->rows())
+                ids.push_back(rec.column0);
+            std::sort(ids.begin(), ids.end());
+            std::sort(expectedIds.begin(), expectedIds.end());
+            assert(ids == expectedIds && rows99->count() == expectedCount);
+            assert(count99->count() == expectedCount && sumColumn2->sum() == expectedSum && maxId->max() == expectedMax);
+        };
+        check();
+        for (db::uint id = 0; id < 2000; id += 3)
+            viewed.deleteRecordByID(id);
+        viewed.deleteRecordByID(1999, true);
+        viewed.deleteRecordByID(DATA_SIZE - 1, true); // largest id - max falls back to the next value
+        check();
+        viewed.compactRecords();
+        check();
+        viewed.addRecord({DATA_SIZE + 99, "late", 7, "late99"});
+        check();
+        [[maybe_unused]] const bool removed = viewed.removeView(count99);
+        [[maybe_unused]] const bool removedAgain = viewed.removeView(count99);
+        assert(removed && !removedAgain);
+
+        // dynamic tables re-evaluate their views after schema changes
+        db::QBTableDynamic dynamic;
+        dynamic.addColumn("column2", 0L);
+        auto positive = std::make_shared<db::QBDynamicMaterializedView>([](const db::QBRecordDynamic &rec)
+                                                                        {
+                                                                            auto it = rec.fields.find("flag");
+                                                                            return it != rec.fields.end() && std::get<long>(it->second) > 0; },
+                                                                        db::ViewAggregate::Count);
+        dynamic.addView(positive);
+        for (db::uint i = 0; i < 100; ++i)
+            dynamic.addRecord({i, {{"column2", long(i)}}});
+        assert(positive->count() == 0);
+        dynamic.addColumn("flag", 1L);
+        assert(positive->count() == 100);
+        dynamic.deleteRecordByID(5);
+        dynamic.deleteRecordByID(99, true);
+        dynamic.compactRecords();
+        assert(positive->count() == 98);
+        dynamic.removeColumn("flag");
+        assert(positive->count() == 0 && positive->stats().rebuilds == 3);
+
+        out << "\n  ✓ All materialized view tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 13: In-place Updates ==========
+    out << "TEST 13: In-place Updates vs Delete + Insert" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        const size_t updates = 5000;
+        db::QBTable updated, reinserted;
+        for (auto *table : {&updated, &reinserted})
+        {
+            for (const auto &rec : baseData)
+                table->addRecord(rec);
+            table->createIndex(db::ColumnType::COLUMN2);
+        }
+        auto idFor = [](size_t i)
+        { return db::uint(i * 7919 % DATA_SIZE); };
+        auto changedRecord = [&](size_t i)
+        {
+            db::QBRecord rec = baseData[idFor(i)];
+            rec.column1 = "updated" + std::to_string(i);
+            rec.column2 = long(100 + i % 50);
+            return rec;
+        };
+
+        auto updateStart = steady_clock::now();
+        for (size_t i = 0; i < updates; ++i)
+        {
+            auto rec = changedRecord(i);
+            updated.updateRecord(rec.column0, {rec.column1, rec.column2, std::nullopt});
+        }
+        const double updateMs = duration<double, std::milli>(steady_clock::now() - updateStart).count();
+        auto reinsertStart = steady_clock::now();
+        for (size_t i = 0; i < updates; ++i)
+        {
+            auto rec = changedRecord(i);
+            reinserted.deleteRecordByID(rec.column0);
+            reinserted.addRecord(rec);
+        }
+        const double reinsertMs = duration<double, std::milli>(steady_clock::now() - reinsertStart).count();
+
+        out << "  " << std::left << std::setw(30) << "updateRecord" << std::setw(12) << std::fixed << std::setprecision(3) << updateMs
+            << " ms  (" << std::setprecision(0) << double(updates) / updateMs * 1000 << " updates/s, "
+            << updated.totalRecordsCount() - updated.activeRecordsCount() << " tombstones)" << std::endl;
+        out << "  " << std::left << std::setw(30) << "deleteRecordByID + addRecord" << std::setw(12) << std::setprecision(3) << reinsertMs
+            << " ms  (" << std::setprecision(0) << double(updates) / reinsertMs * 1000 << " updates/s, "
+            << reinserted.totalRecordsCount() - reinserted.activeRecordsCount() << " tombstones)" << std::endl;
+
+        // same content, no storage growth, and the index agrees with a scan after moving postings
+        assert(updated.totalRecordsCount() == DATA_SIZE && reinserted.totalRecordsCount() == DATA_SIZE + updates);
+        assert(updated.activeRecordsCount() == reinserted.activeRecordsCount());
+        for (long value : {0L, 42L, 100L, 149L})
+        {
+            [[maybe_unused]] auto viaIndex = updated.findMatching(db::ColumnType::COLUMN2, std::to_string(value));
+            [[maybe_unused]] auto viaOther = reinserted.findMatching(db::ColumnType::COLUMN2, std::to_string(value));
+            [[maybe_unused]] size_t scanned = 0;
+            updated.forEachRecord([&](const db::QBRecord &rec)
+                                  { scanned += rec.column2 == value; return true; });
+            assert(viaIndex.size() == scanned && viaOther.size() == scanned);
+            assert(std::is_sorted(viaIndex.begin(), viaIndex.end(), [&](const db::QBRecord &a, const db::QBRecord &b)
+                                  { return a.column0 < b.column0; }));
+        }
+        [[maybe_unused]] auto rec = updated.findMatching(db::ColumnType::COLUMN0, std::to_string(idFor(1)));
+        assert(rec.size() == 1 && rec[0].column1 == "updated1" && rec[0].column3 == baseData[idFor(1)].column3);
+        [[maybe_unused]] const bool updatedMissing = updated.updateRecord(DATA_SIZE + 1, {"missing", std::nullopt, std::nullopt});
+        assert(!updatedMissing);
+
+        // updates reach change streams, views and replicas
+        {
+            const std::string walPath = (std::filesystem::temp_directory_path() / "quickbase_update_tests.wal").string();
+            auto wal = std::make_shared<db::wal::LogWriter>(walPath);
+            auto stream = std::make_shared<db::QBChangeStream>();
+            auto subscription = stream->subscribe(16);
+            auto big = std::make_shared<db::QBMaterializedView>([](const db::QBRecord &r)
+                                                                { return r.column2 >= 100; },
+                                                                db::ViewAggregate::Count);
+            db::QBTable primary;
+            primary.setWriteAheadLog(wal);
+            for (size_t i = 0; i < 10; ++i)
+                primary.addRecord(baseData[i]);
+            primary.createIndex(db::ColumnType::COLUMN3);
+            primary.setChangeStream(stream);
+            primary.addView(big);
+            primary.updateRecord(4, {std::nullopt, 500L, "renamed"});
+            primary.updateRecord(5, {std::nullopt, baseData[5].column2, std::nullopt}); // unchanged, not published
+            assert(big->count() == 1);
+            db::QBChangeEvent event;
+            [[maybe_unused]] bool polled = subscription->poll(event);
+            assert(polled && event.type == db::ChangeType::Update && event.position == 4 && event.record.column3 == "renamed");
+            polled = subscription->poll(event);
+            assert(!polled);
+            wal->flush();
+            db::replica::Follower follower(walPath);
+            follower.poll();
+            follower.read([]([[maybe_unused]] const db::QBTable &replica)
+                          {
+                              [[maybe_unused]] auto found = replica.findMatching(db::ColumnType::COLUMN3, "renamed");
+                              assert(found.size() == 1 && found[0].column0 == 4 && found[0].column2 == 500); },
+                          seconds(1));
+            std::filesystem::remove(walPath);
+        }
+
+        // dynamic tables move postings of changed columns and of derived columns depending on them
+        {
+            db::QBTableDynamic dynamic;
+            dynamic.addColumn("column2", 0L);
+            dynamic.addDerivedColumn("double2", [](const db::QBRecordDynamic &r) -> db::FieldType
+                                     { return std::get<long>(r.fields.at("column2")) * 2; });
+            dynamic.createIndex("column2");
+            dynamic.createIndex("double2");
+            for (db::uint i = 0; i < 100; ++i)
+                dynamic.addRecord({i, {{"column2", long(i)}}});
+            [[maybe_unused]] const bool moved = dynamic.updateRecord(7, {{"column2", 1000L}});
+            [[maybe_unused]] const bool unknownColumn = dynamic.updateRecord(8, {{"unknown", 1L}});
+            [[maybe_unused]] const bool unknownId = dynamic.updateRecord(500, {{"column2", 1L}});
+            assert(moved && !unknownColumn && !unknownId);
+            assert(dynamic.findMatching("column2", 7L).empty() && dynamic.findMatching("double2", 14L).empty());
+            assert(dynamic.findMatching("column2", 1000L).size() == 1 && dynamic.findMatching("double2", 2000L).size() == 1);
+            assert(dynamic.totalRecordsCount() == 100);
+        }
+
+        out << "\n  ✓ All update tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 14: Bulk Upsert ==========
+    out << "TEST 14: Bulk Upsert vs Delete + Reinsert" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        const size_t batchSize = 10000;
+        for (double overlap : {0.1, 0.9})
+        {
+            // the first overlap share of the batch changes existing records, the rest is new
+            const size_t existing = size_t(double(batchSize) * overlap);
+            std::vector<db::QBRecord> batch;
+            batch.reserve(batchSize);
+            for (size_t i = 0; i < batchSize; ++i)
+            {
+                db::QBRecord rec = i < existing ? baseData[i * 7919 % DATA_SIZE] : db::QBRecord{db::uint(DATA_SIZE + i), "new", 0, "merged"};
+                rec.column1 = "merged" + std::to_string(i);
+                rec.column2 = long(200 + i % 50);
+                batch.push_back(std::move(rec));
+            }
+            db::QBTable upserted, reinserted;
+            for (auto *table : {&upserted, &reinserted})
+            {
+                for (const auto &rec : baseData)
+                    table->addRecord(rec);
+                table->createIndex(db::ColumnType::COLUMN2);
+            }
+
+            auto upsertStart = steady_clock::now();
+            [[maybe_unused]] auto result = upserted.upsertRecords(batch);
+            const double upsertMs = duration<double, std::milli>(steady_clock::now() - upsertStart).count();
+            auto reinsertStart = steady_clock::now();
+            for (const auto &rec : batch)
+            {
+                reinserted.deleteRecordByID(rec.column0);
+                reinserted.addRecord(rec);
+            }
+            const double reinsertMs = duration<double, std::milli>(steady_clock::now() - reinsertStart).count();
+
+            const std::string label = std::to_string(int(overlap * 100)) + "% overlap";
+            out << "  " << std::left << std::setw(34) << "upsertRecords, " + label << std::setw(12) << std::fixed << std::setprecision(3) << upsertMs
+                << " ms  (" << std::setprecision(0) << double(batchSize) / upsertMs * 1000 << " records/s, "
+                << upserted.totalRecordsCount() - upserted.activeRecordsCount() << " tombstones)" << std::endl;
+            out << "  " << std::left << std::setw(34) << "delete + reinsert, " + label << std::setw(12) << std::setprecision(3) << reinsertMs
+                << " ms  (" << std::setprecision(0) << double(batchSize) / reinsertMs * 1000 << " records/s, "
+                << reinserted.totalRecordsCount() - reinserted.activeRecordsCount() << " tombstones)" << std::endl;
+
+            assert(result.inserted == batchSize - existing && result.updated == existing && result.unchanged == 0);
+            assert(upserted.totalRecordsCount() == DATA_SIZE + batchSize - existing);
+            assert(upserted.activeRecordsCount() == reinserted.activeRecordsCount());
+            for (long value : {0L, 42L, 200L, 249L})
+            {
+                [[maybe_unused]] auto viaIndex = upserted.findMatching(db::ColumnType::COLUMN2, std::to_string(value));
+                [[maybe_unused]] auto viaOther = reinserted.findMatching(db::ColumnType::COLUMN2, std::to_string(value));
+                [[maybe_unused]] size_t scanned = 0;
+                upserted.forEachRecord([&](const db::QBRecord &rec)
+                                       { scanned += rec.column2 == value; return true; });
+                assert(viaIndex.size() == scanned && viaOther.size() == scanned);
+            }
+            // upserting the same batch again changes nothing
+            [[maybe_unused]] auto again = upserted.upsertRecords(batch);
+            assert(again.unchanged == batchSize && again.inserted == 0 && again.updated == 0);
+        }
+
+        // a key repeated in the batch ends with its last values, every change reaches streams, views and the log
+        {
+            const std::string walPath = (std::filesystem::temp_directory_path() / "quickbase_upsert_tests.wal").string();
+            auto wal = std::make_shared<db::wal::LogWriter>(walPath);
+            auto stream = std::make_shared<db::QBChangeStream>();
+            auto subscription = stream->subscribe(16);
+            auto merged = std::make_shared<db::QBMaterializedView>([](const db::QBRecord &r)
+                                                                   { return r.column3 == "merged"; },
+                                                                   db::ViewAggregate::Count);
+            db::QBTable primary;
+            primary.setWriteAheadLog(wal);
+            for (size_t i = 0; i < 10; ++i)
+                primary.addRecord(baseData[i]);
+            primary.createIndex(db::ColumnType::COLUMN3);
+            primary.setChangeStream(stream);
+            primary.addView(merged);
+            std::vector<db::QBRecord> batch = {{2, "a", 1, "merged"}, {50, "b", 2, "merged"}, {2, "c", 3, "merged"}, {50, "d", 4, "x"}, baseData[3]};
+            [[maybe_unused]] auto result = primary.upsertRecords(batch);
+            assert(result.inserted == 1 && result.updated == 3 && result.unchanged == 1);
+            assert(merged->count() == 1 && primary.totalRecordsCount() == 11);
+            [[maybe_unused]] auto found = primary.findMatching(db::ColumnType::COLUMN3, "merged");
+            assert(found.size() == 1 && found[0].column0 == 2 && found[0].column1 == "c");
+            assert(primary.findMatching(db::ColumnType::COLUMN3, "x").size() == 1);
+            db::QBChangeEvent event;
+            [[maybe_unused]] bool polled = false;
+            for ([[maybe_unused]] auto type : {db::ChangeType::Update, db::ChangeType::Insert, db::ChangeType::Update, db::ChangeType::Update})
+            {
+                polled = subscription->poll(event);
+                assert(polled && event.type == type);
+            }
+            polled = subscription->poll(event);
+            assert(!polled);
+            wal->flush();
+            db::replica::Follower follower(walPath);
+            follower.poll();
+            follower.read([]([[maybe_unused]] const db::QBTable &replica)
+                          {
+                              [[maybe_unused]] auto row = replica.findMatching(db::ColumnType::COLUMN0, "50");
+                              assert(row.size() == 1 && row[0].column1 == "d" && row[0].column3 == "x");
+                              assert(replica.findMatching(db::ColumnType::COLUMN3, "merged").size() == 1); },
+                          seconds(1));
+            std::filesystem::remove(walPath);
+        }
+
+        // dynamic tables keep fields missing from the incoming record and skip records outside the schema
+        {
+            db::QBTableDynamic dynamic;
+            dynamic.addColumn("column1", std::string{});
+            dynamic.addColumn("column2", 0L);
+            dynamic.createIndex("column2");
+            for (db::uint i = 0; i < 100; ++i)
+                dynamic.addRecord({i, {{"column1", "row" + std::to_string(i)}, {"column2", long(i % 10)}}});
+            std::vector<db::QBRecordDynamic> batch = {{5, {{"column2", 100L}}}, {500, {{"column1", std::string("new")}, {"column2", 100L}}}, {6, {{"unknown", 1L}}}};
+            [[maybe_unused]] auto result = dynamic.upsertRecords(batch);
+            assert(result.updated == 1 && result.inserted == 1 && result.rejected == 1);
+            [[maybe_unused]] auto found = dynamic.findMatching("column2", 100L);
+            assert(found.size() == 2 && found[0].id == 5 && std::get<std::string>(found[0].fields.at("column1")) == "row5");
+            assert(dynamic.findMatching("column2", 5L).size() == 9 && dynamic.totalRecordsCount() == 101);
+        }
+
+        out << "\n  ✓ All upsert tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 15: Time to Live ==========
+    out << "TEST 15: Time to Live Expiry - Timer Wheel vs Scan Purge" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        // every 20th record expires, deadlines spread over 40 ms; both tables are purged every 5 ms
+        const size_t expiring = DATA_SIZE / 20;
+        db::QBTable wheelTable, scanTable;
+        for (auto *table : {&wheelTable, &scanTable})
+        {
+            for (const auto &rec : baseData)
+                table->addRecord(rec);
+            table->createIndex(db::ColumnType::COLUMN2);
+        }
+        const auto start = db::TtlClock::now();
+        // scan purge keeps deadlines next to the records, as an expiry column would
+        std::vector<db::TtlClock::time_point> scanDeadlines(DATA_SIZE, db::TtlClock::time_point::max());
+        for (size_t k = 0; k < expiring; ++k)
+        {
+            const auto deadline = start + milliseconds(5 + k % 40);
+            wheelTable.expireRecordAt(db::uint(k * 20), deadline);
+            scanDeadlines[k * 20] = deadline;
+        }
+
+        double wheelMs = 0, wheelWorstMs = 0, scanMs = 0, scanWorstMs = 0;
+        size_t wheelPurged = 0, scanPurged = 0;
+        auto scanPurge = [&]
+        {
+            std::vector<db::uint> due;
+            const auto now = db::TtlClock::now();
+            scanTable.forEachRecord([&](const db::QBRecord &rec)
+                                    { if (scanDeadlines[rec.column0] <= now) due.push_back(rec.column0); return true; });
+            for (db::uint id : due)
+                scanTable.deleteRecordByID(id);
+            return due.size();
+        };
+        for (int round = 1; round <= 12; ++round)
+        {
+            std::this_thread::sleep_until(start + milliseconds(5 * round));
+            auto wheelStart = steady_clock::now();
+            wheelPurged += wheelTable.expireRecords();
+            const double wheelRoundMs = duration<double, std::milli>(steady_clock::now() - wheelStart).count();
+            auto scanStart = steady_clock::now();
+            scanPurged += scanPurge();
+            const double scanRoundMs = duration<double, std::milli>(steady_clock::now() - scanStart).count();
+            wheelMs += wheelRoundMs;
+            scanMs += scanRoundMs;
+            wheelWorstMs = std::max(wheelWorstMs, wheelRoundMs);
+            scanWorstMs = std::max(scanWorstMs, scanRoundMs);
+        }
+        // a slow round may leave due deadlines behind for the next tick
+        while (size_t purged = wheelTable.expireRecords())
+            wheelPurged += purged;
+        scanPurged += scanPurge();
+
+        out << "  " << std::left << std::setw(30) << "timer wheel expireRecords" << std::setw(12) << std::fixed << std::setprecision(3) << wheelMs
+            << " ms  (worst tick " << wheelWorstMs << " ms, " << wheelPurged << " purged)" << std::endl;
+        out << "  " << std::left << std::setw(30) << "scan + deleteRecordByID" << std::setw(12) << scanMs
+            << " ms  (worst tick " << scanWorstMs << " ms, " << scanPurged << " purged)" << std::endl;
+        assert(wheelPurged == expiring && scanPurged == expiring);
+        assert(wheelTable.activeRecordsCount() == DATA_SIZE - expiring && wheelTable.pendingExpiries() == 0);
+        assert(wheelTable.findMatching(db::ColumnType::COLUMN2, "0").size() == scanTable.findMatching(db::ColumnType::COLUMN2, "0").size());
+
+        // the wheel cascades far deadlines down its levels and only hands out what is due
+        {
+            db::TimerWheel wheel;
+            const auto t0 = db::TtlClock::now();
+            wheel.schedule(1, t0 + milliseconds(1));
+            wheel.schedule(2, t0 + milliseconds(100));
+            wheel.schedule(3, t0 + seconds(5));
+            wheel.schedule(4, t0 + hours(10));
+            wheel.schedule(5, t0 - seconds(1));
+            wheel.advance(t0);
+            assert(wheel.due() == 1);
+            wheel.advance(t0 + milliseconds(50));
+            assert(wheel.due() == 2);
+            wheel.advance(t0 + seconds(6));
+            assert(wheel.due() == 4);
+            wheel.advance(t0 + hours(11));
+            assert(wheel.due() == 5);
+            std::vector<db::uint> fired;
+            [[maybe_unused]] size_t first = wheel.drain(3, [&](db::uint id)
+                                                        { fired.push_back(id); });
+            wheel.drain(10, [&](db::uint id)
+                        { fired.push_back(id); });
+            assert(first == 3 && fired == std::vector<db::uint>({5, 1, 2, 3, 4}) && wheel.size() == 0);
+        }
+
+        // expired records are hidden at once, replaced on insert and keep their deadline through moves
+        {
+            auto stream = std::make_shared<db::QBChangeStream>();
+            auto subscription = stream->subscribe(16);
+            db::QBTable cache;
+            for (size_t i = 0; i < 100; ++i)
+                cache.addRecord(baseData[i]);
+            cache.createIndex(db::ColumnType::COLUMN3);
+            cache.setChangeStream(stream);
+            [[maybe_unused]] const auto past = db::TtlClock::now() - milliseconds(1);
+            [[maybe_unused]] const bool expiredOne = cache.expireRecordAt(1, past);
+            [[maybe_unused]] const bool expiredThree = cache.expireRecordAt(3, past);
+            [[maybe_unused]] const bool expiredSixty = cache.expireRecordAt(60, past);
+            assert(expiredOne && expiredThree && expiredSixty);
+            [[maybe_unused]] const bool scheduled = cache.expireRecordAfter(2, hours(1));
+            [[maybe_unused]] const bool cleared = cache.clearRecordExpiry(2);
+            assert(scheduled && cleared);
+            assert(cache.findMatching(db::ColumnType::COLUMN0, "1").empty());
+            assert(cache.findMatching(db::ColumnType::COLUMN3, baseData[1].column3).empty());
+            [[maybe_unused]] const bool updatedExpired = cache.updateRecord(1, {"x", std::nullopt, std::nullopt});
+            assert(cache.activeRecordsCount() == 97 && !updatedExpired);
+            cache.addRecord(baseData[3]);
+            assert(cache.findMatching(db::ColumnType::COLUMN0, "3").size() == 1 && cache.activeRecordsCount() == 98);
+            // deleting an expired record reports nothing to delete and purges it
+            [[maybe_unused]] const bool deletedExpired = cache.deleteRecordByID(60);
+            assert(!deletedExpired && cache.activeRecordsCount() == 98 && cache.findMatching(db::ColumnType::COLUMN0, "60").empty());
+            cache.deleteRecordByID(5, true);
+            cache.compactRecords();
+            assert(cache.findMatching(db::ColumnType::COLUMN0, "60").empty() && cache.findMatching(db::ColumnType::COLUMN0, "61").size() == 1);
+            assert(cache.findMatching(db::ColumnType::COLUMN0, "3").size() == 1 && cache.findMatching(db::ColumnType::COLUMN0, "2").size() == 1);
+            // the cleared deadline of id 2 stays in the wheel until it comes due and is skipped
+            [[maybe_unused]] const size_t purged = cache.expireRecords();
+            assert(purged == 1 && cache.activeRecordsCount() == 97 && cache.pendingExpiries() == 1);
+            db::QBChangeEvent event;
+            [[maybe_unused]] bool polled = subscription->poll(event);
+            assert(polled && event.type == db::ChangeType::SoftDelete && event.id == 3);
+            polled = subscription->poll(event);
+            assert(polled && event.type == db::ChangeType::Insert && event.id == 3);
+        }
+
+        // materialized views keep expired records until expireRecords() purges them
+        {
+            db::QBTable cache;
+            auto rows = std::make_shared<db::QBMaterializedView>(db::QBMaterializedView::Predicate{});
+            auto count = std::make_shared<db::QBMaterializedView>(db::QBMaterializedView::Predicate{}, db::ViewAggregate::Count);
+            cache.addView(rows);
+            cache.addView(count);
+            for (size_t i = 0; i < 10; ++i)
+                cache.addRecord(baseData[i]);
+            [[maybe_unused]] bool scheduled = cache.expireRecordAt(2, db::TtlClock::now() - milliseconds(1));
+            assert(scheduled && cache.findMatching(db::ColumnType::COLUMN0, "2").empty());
+            assert(rows->rows().size() == 10 && count->count() == 10);
+            [[maybe_unused]] size_t purged = cache.expireRecords();
+            assert(purged == 1 && rows->rows().size() == 9 && count->count() == 9);
+            assert(std::none_of(rows->rows().begin(), rows->rows().end(), [](const db::QBRecord &rec)
+                                { return rec.column0 == 2; }));
+        }
+
+        // dynamic tables
+        {
+            db::QBTableDynamic sessions;
+            sessions.addColumn("column2", 0L);
+            sessions.createIndex("column2");
+            for (db::uint i = 0; i < 10; ++i)
+                sessions.addRecord({i, {{"column2", long(i % 2)}}});
+            [[maybe_unused]] const bool scheduled = sessions.expireRecordAt(4, db::TtlClock::now() - milliseconds(1));
+            [[maybe_unused]] const bool scheduledSix = sessions.expireRecordAt(6, db::TtlClock::now() - milliseconds(1));
+            assert(scheduled && scheduledSix);
+            assert(sessions.findMatching("column2", 0L).size() == 3 && sessions.findMatching("id", db::uint(4)).empty());
+            [[maybe_unused]] const bool deletedExpired = sessions.deleteRecordByID(6);
+            assert(!deletedExpired && sessions.activeRecordsCount() == 8);
+            [[maybe_unused]] const size_t purged = sessions.expireRecords();
+            assert(purged == 1 && sessions.activeRecordsCount() == 8);
+            assert(sessions.findMatching("column2", 0L).size() == 3);
+        }
+
+        out << "\n  ✓ All time to live tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 16: Compile-time Schema Table ==========
+    out << "TEST 16: Compile-time Schema Table vs Runtime Column Dispatch" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        const std::string testName = "TEST 16";
+        db::QBSchemaTable schemaTable;
+        for (const auto &rec : baseData)
+            schemaTable.addRecord(rec);
+        schemaTable.createIndex<db::ColumnType::COLUMN2>();
+
+        // the same keys for both tables, QBTable's as the strings its interface takes
+        std::vector<db::uint> ids;
+        std::vector<std::string> idStrings;
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            ids.push_back(db::uint(i * 7919 % DATA_SIZE));
+            idStrings.push_back(std::to_string(ids.back()));
+        }
+        // the checksum keeps the inlined schema table visitors from being optimized away
+        size_t checksum = 0;
+        auto count = [&](const db::QBRecord &rec)
+        { checksum += rec.column0; };
+
+        std::vector<BenchmarkResult> results;
+        results.push_back({"QBTable, 1000 column0 lookups", timeQueries(ctx, testName, "QBTable column0 lookups", [&]
+                                                                         {
+                                                                             size_t found = 0;
+                                                                             for (const auto &id : idStrings)
+                                                                                 found += qbTable.forEachMatching(db::ColumnType::COLUMN0, id, count);
+                                                                             return found; }),
+                           0, ""});
+        results.push_back({"schema, 1000 column0 lookups", timeQueries(ctx, testName, "schema column0 lookups", [&]
+                                                                        {
+                                                                            size_t found = 0;
+                                                                            for (db::uint id : ids)
+                                                                                found += schemaTable.forEachMatching<db::ColumnType::COLUMN0>(id, count);
+                                                                            return found; }),
+                           0, ""});
+        results.push_back({"QBTable, column2 index", timeQueries(ctx, testName, "QBTable column2 index", [&]
+                                                                  { return qbTable.forEachMatching(db::ColumnType::COLUMN2, "42", count); }),
+                           0, ""});
+        results.push_back({"schema, column2 index", timeQueries(ctx, testName, "schema column2 index", [&]
+                                                                 { return schemaTable.forEachMatching<db::ColumnType::COLUMN2>(42L, count); }),
+                           0, ""});
+        results.push_back({"QBTable, column3 scan", timeQueries(ctx, testName, "QBTable column3 scan", [&]
+                                                                 { return qbTable.forEachMatching(db::ColumnType::COLUMN3, baseData[4242].column3, count); }),
+                           0, ""});
+        results.push_back({"schema, column3 scan", timeQueries(ctx, testName, "schema column3 scan", [&]
+                                                                { return schemaTable.forEachMatching<db::ColumnType::COLUMN3>(baseData[4242].column3, count); }),
+                           0, ""});
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(30) << r.name
+                << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms" << std::endl;
+        }
+
+        // loading with an index on column2
+        {
+            using namespace std::chrono;
+            db::QBTable loaded;
+            db::QBSchemaTable schemaLoaded;
+            loaded.createIndex(db::ColumnType::COLUMN2);
+            schemaLoaded.createIndex<db::ColumnType::COLUMN2>();
+            auto loadStart = steady_clock::now();
+            for (const auto &rec : baseData)
+                loaded.addRecord(rec);
+            const double loadMs = duration<double, std::milli>(steady_clock::now() - loadStart).count();
+            auto schemaStart = steady_clock::now();
+            for (const auto &rec : baseData)
+                schemaLoaded.addRecord(rec);
+            const double schemaMs = duration<double, std::milli>(steady_clock::now() - schemaStart).count();
+            out << "  " << std::left << std::setw(30) << "QBTable, load" << std::setw(12) << loadMs << " ms" << std::endl;
+            out << "  " << std::left << std::setw(30) << "schema, load" << std::setw(12) << schemaMs << " ms" << std::endl;
+        }
+
+        out << "  (visited id checksum " << checksum << ")" << std::endl;
+
+        // same answers as QBTable
+        for (size_t i = 0; i < 10; ++i)
+        {
+            [[maybe_unused]] auto expected = qbTable.findMatching(db::ColumnType::COLUMN0, idStrings[i]);
+            [[maybe_unused]] auto found = schemaTable.findMatching<db::ColumnType::COLUMN0>(ids[i]);
+            assert(found.size() == 1 && expected.size() == 1 && found[0].column1 == expected[0].column1);
+        }
+        assert(schemaTable.findMatching<db::ColumnType::COLUMN2>(42L).size() == qbTable.findMatching(db::ColumnType::COLUMN2, "42").size());
+        static_assert(db::QBSchemaTable::columnName<db::ColumnType::COLUMN3>() == "column3");
+        static_assert(std::is_same_v<db::QBSchemaTable::Key, db::uint>);
+
+        // deletes, compaction and index changes on a user schema with a string key
+        {
+            struct Session
+            {
+                std::string token;
+                long user;
+                double score;
+            };
+            struct SessionSchema
+            {
+                using Record = Session;
+                using Columns = std::tuple<db::Column<&Session::token, "token", db::ColumnRole::Key>,
+                                           db::Column<&Session::user, "user">,
+                                           db::Column<&Session::score, "score", db::ColumnRole::Plain>>;
+            };
+            db::SchemaTable<SessionSchema> sessions;
+            sessions.createIndex<1>();
+            for (long i = 0; i < 100; ++i)
+                sessions.addRecord({"t" + std::to_string(i), i % 10, double(i)});
+            [[maybe_unused]] const bool deleted = sessions.deleteRecordByID("t5");
+            [[maybe_unused]] const bool deletedAgain = sessions.deleteRecordByID("t5");
+            assert(deleted && !deletedAgain);
+            assert(sessions.findMatching<1>(5L).size() == 9 && sessions.findMatching<0>("t5").empty());
+            sessions.compactRecords();
+            assert(sessions.totalRecordsCount() == 99 && sessions.findMatching<1>(5L).size() == 9);
+            assert(sessions.findMatching<2>(15.0).size() == 1 && sessions.findMatching<0>("t99").size() == 1);
+            sessions.dropIndex<1>();
+            assert(!sessions.isColumnIndexed<1>() && sessions.findMatching<1>(5L).size() == 9);
+        }
+
+        out << "\n  ✓ All schema table tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 17: Expression Template Queries ==========
+    out << "TEST 17: Fused Expression Template Scans vs Interpreted Predicates" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using db::expr::col;
+        using db::expr::contains;
+        using Predicate = std::function<bool(const db::QBRecord &)>;
+        const std::string testName = "TEST 17";
+        db::QBSchemaTable schemaTable;
+        db::QBTable unindexed;
+        for (const auto &rec : baseData)
+        {
+            schemaTable.addRecord(rec);
+            unindexed.addRecord(rec);
+        }
+        db::query::QueryEngine engine;
+        engine.registerTable("qb", unindexed);
+
+        // runtime predicate tree - each node a closure, combined by AND nodes
+        auto conjunction = [](std::vector<Predicate> terms) -> Predicate
+        {
+            return [terms = std::move(terms)](const db::QBRecord &rec)
+            {
+                for (const auto &term : terms)
+                    if (!term(rec))
+                        return false;
+                return true;
+            };
+        };
+        auto treeCount = [&](const Predicate &predicate)
+        {
+            size_t matches = 0;
+            schemaTable.forEachRecord([&](const db::QBRecord &rec)
+                                      { matches += predicate(rec); return true; });
+            return matches;
+        };
+        const Predicate twoTerms = conjunction({[](const db::QBRecord &r)
+                                                { return r.column2 == 42; },
+                                                [](const db::QBRecord &r)
+                                                { return r.column1.find("99") != std::string::npos; }});
+        const Predicate threeTerms = conjunction({[](const db::QBRecord &r)
+                                                  { return r.column3.find('5') != std::string::npos; },
+                                                  [](const db::QBRecord &r)
+                                                  { return r.column2 >= 10; },
+                                                  [](const db::QBRecord &r)
+                                                  { return r.column2 < 20; }});
+        // written expensive term first - the fused loop still tests the column2 range before the substring
+        const auto twoExpr = col<db::ColumnType::COLUMN2> == 42 && contains(col<db::ColumnType::COLUMN1>, "99");
+        const auto threeExpr = contains(col<db::ColumnType::COLUMN3>, "5") && col<db::ColumnType::COLUMN2> >= 10 && col<db::ColumnType::COLUMN2> < 20;
+        const std::string twoSql = "SELECT COUNT(*) FROM qb WHERE column2 = 42 AND column1 LIKE '%99%'";
+
+        // counts are summed and printed so the inlined scans are not optimized away
+        size_t matched = 0;
+        std::vector<BenchmarkResult> results;
+        results.push_back({"2 terms, SQL engine", timeQueries(ctx, testName, "2 terms SQL", [&]
+                                                               { return engine.execute(twoSql); }),
+                           0, ""});
+        results.push_back({"2 terms, predicate tree", timeQueries(ctx, testName, "2 terms tree", [&]
+                                                                   { return matched += treeCount(twoTerms); }),
+                           0, ""});
+        results.push_back({"2 terms, expression template", timeQueries(ctx, testName, "2 terms expression", [&]
+                                                                        { return matched += db::expr::countWhere(schemaTable, twoExpr); }),
+                           0, ""});
+        results.push_back({"3 terms, predicate tree", timeQueries(ctx, testName, "3 terms tree", [&]
+                                                                   { return matched += treeCount(threeTerms); }),
+                           0, ""});
+        results.push_back({"3 terms, expression template", timeQueries(ctx, testName, "3 terms expression", [&]
+                                                                        { return matched += db::expr::countWhere(schemaTable, threeExpr); }),
+                           0, ""});
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(30) << r.name
+                << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms" << std::endl;
+        }
+
+        out << "  (rows matched " << matched << ")" << std::endl;
+
+        // every evaluation agrees with a hand written loop
+        size_t expectedTwo = 0, expectedThree = 0;
+        for (const auto &rec : baseData)
+        {
+            expectedTwo += rec.column2 == 42 && rec.column1.find("99") != std::string::npos;
+            expectedThree += rec.column2 >= 10 && rec.column2 < 20 && rec.column3.find('5') != std::string::npos;
+        }
+        assert(expectedTwo > 0 && expectedThree > 0);
+        assert(db::expr::countWhere(schemaTable, twoExpr) == expectedTwo && treeCount(twoTerms) == expectedTwo);
+        [[maybe_unused]] auto viaEngine = engine.execute("SELECT * FROM qb WHERE column2 = 42 AND column1 LIKE '%99%'");
+        assert(viaEngine.rowCount() == expectedTwo);
+        assert(db::expr::countWhere(schemaTable, threeExpr) == expectedThree && treeCount(threeTerms) == expectedThree);
+
+        // mirrored literals, negation, OR and compile-time constants
+        assert(db::expr::countWhere(schemaTable, 42 == col<2>) == DATA_SIZE / 100);
+        assert(db::expr::countWhere(schemaTable, !(col<2> < 50)) == DATA_SIZE / 2);
+        assert(db::expr::countWhere(schemaTable, !!(col<2> == 1) || col<2> == 2) == DATA_SIZE / 50);
+        assert(db::expr::countWhere(schemaTable, col<1> == "testdata7" || col<0> == 8u) == 2);
+        // integer literals compare by value - a negative literal never equals an unsigned id and is below all of them
+        assert(db::expr::countWhere(schemaTable, col<0> == -1) == 0 && db::expr::countWhere(schemaTable, col<0> != -1) == DATA_SIZE);
+        assert(db::expr::countWhere(schemaTable, col<0> > -5) == DATA_SIZE && db::expr::countWhere(schemaTable, -5 >= col<0>) == 0);
+        assert(db::expr::countWhere(schemaTable, col<0> < 10 && col<2> >= 5u) == 5);
+        static_assert(!db::expr::ConvertsWithoutNarrowing<long, double> && !db::expr::ConvertsWithoutNarrowing<std::string, int>);
+        static_assert(std::is_same_v<decltype(!(col<2> < 50)), db::expr::Compare<db::expr::Op::GreaterEqual, 2, int>>);
+        static_assert(std::is_same_v<decltype(db::expr::always && (col<2> == 1)), db::expr::Compare<db::expr::Op::Equal, 2, int>>);
+        static_assert(std::is_same_v<decltype((col<2> == 1) && db::expr::never), db::expr::Constant<false>>);
+        assert(db::expr::countWhere(schemaTable, db::expr::never) == 0 && db::expr::countWhere(schemaTable, db::expr::always) == DATA_SIZE);
+        [[maybe_unused]] auto found = db::expr::findWhere(schemaTable, col<0> == 4242u && contains(col<3>, "4242"));
+        assert(found.size() == 1 && found[0].column1 == "testdata4242");
+
+        out << "\n  ✓ All expression query tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 18: Transactions ==========
+    out << "TEST 18: Transactions - Batched Commit vs Individual Operations" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        const std::string walDir = std::filesystem::temp_directory_path().string();
+        const size_t operationCount = 2000;
+        // groups of four: insert a new record, update an existing one, delete an existing one and add it back
+        auto buildOperations = [&](size_t txnSize)
+        {
+            std::vector<db::QBTransaction> txns(1);
+            for (size_t i = 0; i < operationCount / 4; ++i)
+            {
+                if (txns.back().size() >= txnSize)
+                    txns.emplace_back();
+                auto &txn = txns.back();
+                const db::uint existing = db::uint(i * 37 % DATA_SIZE);
+                const db::uint readded = db::uint((i * 37 + 1) % DATA_SIZE);
+                txn.insert({db::uint(DATA_SIZE + i), "child" + std::to_string(i), long(i % 100), "txn"});
+                txn.update(existing, {std::nullopt, long(500 + i % 7), std::nullopt});
+                txn.erase(readded);
+                txn.insert({readded, "readded" + std::to_string(i), long(i % 100), "txn"});
+            }
+            return txns;
+        };
+
+        for (size_t txnSize : {size_t(8), size_t(1000)})
+        {
+            const auto txns = buildOperations(txnSize);
+            db::QBTable committed, individual;
+            for (auto *table : {&committed, &individual})
+            {
+                for (const auto &rec : baseData)
+                    table->addRecord(rec);
+                table->createIndex(db::ColumnType::COLUMN2);
+                table->createIndex(db::ColumnType::COLUMN3);
+            }
+            const std::string committedPath = walDir + "/quickbase_txn_commit.wal";
+            const std::string individualPath = walDir + "/quickbase_txn_single.wal";
+            committed.setWriteAheadLog(std::make_shared<db::wal::LogWriter>(committedPath));
+            individual.setWriteAheadLog(std::make_shared<db::wal::LogWriter>(individualPath));
+
+            auto commitStart = steady_clock::now();
+            [[maybe_unused]] size_t commits = 0;
+            for (const auto &txn : txns)
+                commits += committed.commit(txn).committed;
+            const double commitMs = duration<double, std::milli>(steady_clock::now() - commitStart).count();
+
+            auto individualStart = steady_clock::now();
+            for (const auto &txn : txns)
+            {
+                for (const auto &operation : txn.operations())
+                {
+                    if (operation.op == db::TransactionOp::Insert)
+                        individual.addRecord(operation.record);
+                    else if (operation.op == db::TransactionOp::Update)
+                        individual.updateRecord(operation.id, operation.changes);
+                    else
+                        individual.deleteRecordByID(operation.id);
+                }
+            }
+            const double individualMs = duration<double, std::milli>(steady_clock::now() - individualStart).count();
+
+            const std::string label = std::to_string(txnSize) + " ops per txn";
+            out << "  " << std::left << std::setw(34) << "commit, " + label << std::setw(12) << std::fixed << std::setprecision(3) << commitMs
+                << " ms  (" << std::setprecision(0) << double(operationCount) / commitMs * 1000 << " ops/s)" << std::endl;
+            out << "  " << std::left << std::setw(34) << "individual, " + label << std::setw(12) << std::setprecision(3) << individualMs
+                << " ms  (" << std::setprecision(0) << double(operationCount) / individualMs * 1000 << " ops/s)" << std::endl;
+
+            assert(commits == txns.size());
+            assert(committed.activeRecordsCount() == individual.activeRecordsCount());
+            assert(committed.totalRecordsCount() == individual.totalRecordsCount());
+            for (const std::string value : {"0", "42", "500", "506", "txn"})
+            {
+                const auto column = value == "txn" ? db::ColumnType::COLUMN3 : db::ColumnType::COLUMN2;
+                [[maybe_unused]] auto viaCommit = committed.findMatching(column, value);
+                [[maybe_unused]] auto viaSingle = individual.findMatching(column, value);
+                [[maybe_unused]] size_t scanned = 0;
+                committed.forEachRecord([&](const db::QBRecord &rec)
+                                        { scanned += column == db::ColumnType::COLUMN3 ? rec.column3 == value : std::to_string(rec.column2) == value; return true; });
+                assert(viaCommit.size() == scanned && viaSingle.size() == scanned);
+            }
+            committed.setWriteAheadLog(nullptr);
+            individual.setWriteAheadLog(nullptr);
+            std::filesystem::remove(committedPath);
+            std::filesystem::remove(individualPath);
+        }
+
+        // a failing operation leaves the table untouched - nothing reaches indexes, streams, views or the log
+        {
+            const std::string walPath = walDir + "/quickbase_txn_tests.wal";
+            auto wal = std::make_shared<db::wal::LogWriter>(walPath);
+            auto stream = std::make_shared<db::QBChangeStream>();
+            auto subscription = stream->subscribe(16);
+            auto tagged = std::make_shared<db::QBMaterializedView>([](const db::QBRecord &r)
+                                                                   { return r.column3 == "child"; },
+                                                                   db::ViewAggregate::Count);
+            db::QBTable primary;
+            primary.setWriteAheadLog(wal);
+            for (size_t i = 0; i < 10; ++i)
+                primary.addRecord(baseData[i]);
+            primary.createIndex(db::ColumnType::COLUMN3);
+            primary.setChangeStream(stream);
+            primary.addView(tagged);
+
+            db::QBTransaction failing;
+            failing.insert({100, "parent", 1, "parent"}).insert({101, "child", 1, "child"}).update(77, {std::string("missing"), std::nullopt, std::nullopt});
+            [[maybe_unused]] auto rejected = primary.commit(failing);
+            assert(!rejected && rejected.failedOperation == 2);
+            db::QBTransaction duplicate;
+            duplicate.insert({102, "child", 1, "child"}).insert(baseData[4]);
+            [[maybe_unused]] auto refused = primary.commit(duplicate);
+            [[maybe_unused]] auto refusedAgain = primary.commit(duplicate);
+            assert(!refused && !refusedAgain && refusedAgain.failedOperation == 1);
+            assert(primary.totalRecordsCount() == 10 && tagged->count() == 0);
+            assert(primary.findMatching(db::ColumnType::COLUMN3, "child").empty());
+            db::QBChangeEvent event;
+            [[maybe_unused]] bool polled = subscription->poll(event);
+            assert(!polled);
+
+            // parent and children together, a delete and re-add, and a record inserted and deleted again
+            db::QBTransaction txn;
+            txn.insert({100, "parent", 1, "parent"}).insert({101, "child", 1, "child"}).insert({102, "child", 1, "child"});
+            txn.erase(3).insert({3, "again", 3, "child"}).update(5, {std::nullopt, 55L, std::string("child")});
+            txn.insert({103, "temporary", 1, "child"}).erase(103);
+            [[maybe_unused]] auto result = primary.commit(txn);
+            assert(result && result.inserted == 5 && result.updated == 1 && result.deleted == 2);
+            assert(tagged->count() == 4 && primary.activeRecordsCount() == 13);
+            [[maybe_unused]] auto children = primary.findMatching(db::ColumnType::COLUMN3, "child");
+            assert(children.size() == 4 && children[0].column0 == 5 && children[1].column0 == 101 && children[3].column0 == 3);
+            assert(primary.findMatching(db::ColumnType::COLUMN0, "103").empty());
+            for ([[maybe_unused]] auto type : {db::ChangeType::Insert, db::ChangeType::Insert, db::ChangeType::Insert, db::ChangeType::SoftDelete, db::ChangeType::Insert,
+                                               db::ChangeType::Update, db::ChangeType::Insert, db::ChangeType::SoftDelete})
+            {
+                polled = subscription->poll(event);
+                assert(polled && event.type == type);
+            }
+
+            // the transaction is a single log entry, applied by the replica as a whole
+            wal->flush();
+            {
+                db::wal::LogReader reader(walPath);
+                db::wal::LogEntry entry;
+                [[maybe_unused]] size_t batches = 0, entries = 0;
+                while (reader.next(entry))
+                {
+                    ++entries;
+                    if (entry.type == db::wal::EntryType::Batch)
+                        batches += entry.batch.size() == txn.size();
+                }
+                assert(batches == 1 && entries == 12);
+            }
+            db::replica::Follower follower(walPath);
+            follower.poll();
+            follower.read([]([[maybe_unused]] const db::QBTable &replica)
+                          {
+                              assert(replica.activeRecordsCount() == 13 && replica.totalRecordsCount() == 15);
+                              [[maybe_unused]] auto row = replica.findMatching(db::ColumnType::COLUMN0, "3");
+                              assert(row.size() == 1 && row[0].column1 == "again");
+                              assert(replica.findMatching(db::ColumnType::COLUMN3, "child").size() == 4); },
+                          seconds(1));
+            std::filesystem::remove(walPath);
+        }
+
+        // dynamic tables check the schema of every operation before applying any
+        {
+            db::QBTableDynamic dynamic;
+            dynamic.addColumn("parent", 0L);
+            dynamic.addColumn("name", std::string{});
+            dynamic.createIndex("parent");
+            dynamic.addRecord({1, {{"parent", 0L}, {"name", std::string("root")}}});
+            db::QBDynamicTransaction failing;
+            failing.insert({2, {{"parent", 1L}}}).insert({3, {{"parent", 1L}, {"unknown", 1L}}});
+            [[maybe_unused]] auto rejected = dynamic.commit(failing);
+            assert(!rejected && rejected.failedOperation == 1 && dynamic.totalRecordsCount() == 1);
+
+            db::QBDynamicTransaction txn;
+            txn.insert({2, {{"parent", 1L}}}).insert({3, {{"parent", 1L}}}).update(1, {{"name", std::string("renamed")}}).erase(2).insert({2, {{"parent", 3L}}});
+            [[maybe_unused]] auto result = dynamic.commit(txn);
+            assert(result && result.inserted == 3 && result.updated == 1 && result.deleted == 1);
+            [[maybe_unused]] auto children = dynamic.findMatching("parent", 1L);
+            assert(children.size() == 1 && children[0].id == 3);
+            assert(dynamic.findMatching("parent", 3L).size() == 1 && dynamic.activeRecordsCount() == 3);
+        }
+
+        out << "\n  ✓ All transaction tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 19: Unique Indexes ==========
+    out << "TEST 19: Unique Index vs General Index on Unique Data" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        const std::string testName = "TEST 19";
+        db::QBTable general, unique;
+        for (auto *table : {&general, &unique})
+            for (const auto &rec : baseData)
+                table->addRecord(rec);
+        auto generalStart = steady_clock::now();
+        general.createIndex(db::ColumnType::COLUMN1);
+        const double generalBuildMs = duration<double, std::milli>(steady_clock::now() - generalStart).count();
+        auto uniqueStart = steady_clock::now();
+        unique.createIndex(db::ColumnType::COLUMN1, db::IndexKind::Unique);
+        const double uniqueBuildMs = duration<double, std::milli>(steady_clock::now() - uniqueStart).count();
+
+        std::vector<std::string> hits, misses;
+        for (size_t i = 0; i < 1000; ++i)
+        {
+            hits.push_back(baseData[i * 7919 % DATA_SIZE].column1);
+            misses.push_back("missing" + std::to_string(i));
+        }
+        size_t checksum = 0;
+        auto sum = [&](const db::QBRecord &rec)
+        { checksum += rec.column0; };
+        auto lookups = [&](const db::QBTable &table, const std::vector<std::string> &keys)
+        {
+            size_t found = 0;
+            for (const auto &key : keys)
+                found += table.forEachMatching(db::ColumnType::COLUMN1, key, sum);
+            return found;
+        };
+
+        std::vector<BenchmarkResult> results;
+        results.push_back({"general index, 1000 hits", timeQueries(ctx, testName, "general index hits", [&]
+                                                                   { return lookups(general, hits); }),
+                           0, ""});
+        results.push_back({"unique index, 1000 hits", timeQueries(ctx, testName, "unique index hits", [&]
+                                                                  { return lookups(unique, hits); }),
+                           0, ""});
+        results.push_back({"general index, 1000 misses", timeQueries(ctx, testName, "general index misses", [&]
+                                                                     { return lookups(general, misses); }),
+                           0, ""});
+        results.push_back({"unique index, 1000 misses", timeQueries(ctx, testName, "unique index misses", [&]
+                                                                    { return lookups(unique, misses); }),
+                           0, ""});
+        results.push_back({"general index, build", generalBuildMs, 0, ""});
+        results.push_back({"unique index, build", uniqueBuildMs, 0, ""});
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(30) << r.name
+                << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms" << std::endl;
+        }
+        // the same keys in a standalone unique index - quickbase_memory_bench measures both kinds in a table
+        {
+            db::UniqueIndex slots;
+            for (size_t i = 0; i < baseData.size(); ++i)
+                slots.insert(std::hash<std::string>{}(baseData[i].column1), i);
+            out << "  unique index slots: " << slots.memoryUsage() / 1024 << " KiB, " << std::setprecision(1)
+                << double(slots.memoryUsage()) / double(baseData.size()) << " bytes per row" << std::endl;
+        }
+        out << "  (checksum " << checksum << ")" << std::endl;
+        assert(lookups(unique, hits) == hits.size() && lookups(general, hits) == hits.size() && lookups(unique, misses) == 0);
+        assert(unique.isColumnIndexed(db::ColumnType::COLUMN1));
+        assert(unique.explain(db::ColumnType::COLUMN1, "testdata7").starts_with("UNIQUE INDEX LOOKUP"));
+
+        // the flat table against std::unordered_map under random inserts and erases
+        {
+            db::UniqueIndex index;
+            std::unordered_map<size_t, uint64_t> expected;
+            uint64_t state = 42;
+            auto next = [&]
+            { state = state * 6364136223846793005ULL + 1442695040888963407ULL; return state >> 33; };
+            auto hashOf = [](size_t row)
+            { return uint64_t(row % 97) * 0x9e3779b97f4a7c15ULL; }; // many collisions on purpose
+            for (int step = 0; step < 20000; ++step)
+            {
+                const size_t row = size_t(next() % 2000);
+                if (expected.contains(row))
+                {
+                    [[maybe_unused]] bool erased = index.erase(hashOf(row), row);
+                    assert(erased);
+                    expected.erase(row);
+                }
+                else
+                {
+                    index.insert(hashOf(row), row);
+                    expected.emplace(row, hashOf(row));
+                }
+            }
+            assert(index.size() == expected.size());
+            for (size_t row = 0; row < 2000; ++row)
+            {
+                [[maybe_unused]] size_t found = index.find(hashOf(row), [&](size_t idx)
+                                                           { return idx == row; });
+                assert((found == row) == expected.contains(row));
+            }
+        }
+
+        // uniqueness is enforced by every mutation path, deleted and expired records free their keys
+        {
+            db::QBTable table;
+            for (db::uint i = 0; i < 10; ++i)
+                table.addRecord({i, "key" + std::to_string(i), long(i % 3), "row"});
+            table.createIndex(db::ColumnType::COLUMN1, db::IndexKind::Unique);
+            [[maybe_unused]] bool refused = false;
+            try
+            {
+                table.createIndex(db::ColumnType::COLUMN2, db::IndexKind::Unique);
+            }
+            catch (const std::runtime_error &)
+            {
+                refused = true;
+            }
+            assert(refused && !table.isColumnIndexed(db::ColumnType::COLUMN2));
+
+            [[maybe_unused]] bool accepted = table.addRecord({10, "key3", 0, "dup"});
+            assert(!accepted && table.totalRecordsCount() == 10);
+            accepted = table.addRecord({10, "key10", 0, "row"});
+            assert(accepted);
+            accepted = table.updateRecord(4, {std::string("key5"), std::nullopt, std::nullopt});
+            assert(!accepted);
+            accepted = table.updateRecord(4, {std::string("key4b"), std::nullopt, std::nullopt});
+            assert(accepted);
+            assert(table.findMatching(db::ColumnType::COLUMN1, "key4").empty() && table.findMatching(db::ColumnType::COLUMN1, "key4b").size() == 1);
+            table.deleteRecordByID(5);
+            accepted = table.addRecord({11, "key5", 0, "row"});
+            assert(accepted);
+
+            std::vector<db::QBRecord> batch = {{1, "key2", 0, "clash"}, {12, "key12", 0, "row"}, {13, "key12", 0, "clash"}};
+            [[maybe_unused]] auto upserted = table.upsertRecords(batch);
+            assert(upserted.rejected == 2 && upserted.inserted == 1);
+
+            db::QBTransaction clash;
+            clash.erase(2).insert({14, "key2", 0, "row"}).insert({15, "key14", 0, "row"}).update(15, {std::string("key3"), std::nullopt, std::nullopt});
+            [[maybe_unused]] auto rejected = table.commit(clash);
+            assert(!rejected && rejected.failedOperation == 3 && table.findMatching(db::ColumnType::COLUMN1, "key2").size() == 1);
+            clash.clear();
+            clash.erase(2).insert({14, "key2", 0, "row"}).update(3, {std::string("key2b"), std::nullopt, std::nullopt}).insert({15, "key3", 0, "row"});
+            [[maybe_unused]] auto swapped = table.commit(clash);
+            assert(swapped);
+            [[maybe_unused]] auto moved = table.findMatching(db::ColumnType::COLUMN1, "key2");
+            assert(moved.size() == 1 && moved[0].column0 == 14 && table.findMatching(db::ColumnType::COLUMN1, "key3")[0].column0 == 15);
+
+            table.expireRecordAt(6, db::TtlClock::now() - seconds(1));
+            accepted = table.addRecord({16, "key6", 0, "row"});
+            assert(accepted && table.findMatching(db::ColumnType::COLUMN1, "key6")[0].column0 == 16);
+            table.deleteRecordByID(7, true);
+            table.compactRecords();
+            accepted = table.addRecord({17, "key8", 0, "dup"});
+            assert(!accepted);
+            accepted = table.addRecord({17, "key7", 0, "row"});
+            assert(accepted);
+            // an update that leaves the key alone keeps its entry
+            accepted = table.updateRecord(9, {std::nullopt, 5L, std::string("moved")});
+            assert(accepted && table.findMatching(db::ColumnType::COLUMN1, "key9").size() == 1);
+            size_t scanned = 0;
+            table.forEachRecord([&](const db::QBRecord &rec)
+                                { scanned += table.findMatching(db::ColumnType::COLUMN1, rec.column1).size() == 1; return true; });
+            assert(scanned == table.activeRecordsCount());
+        }
+
+        // replicas build the same kind of index
+        {
+            const std::string walPath = (std::filesystem::temp_directory_path() / "quickbase_unique_tests.wal").string();
+            auto wal = std::make_shared<db::wal::LogWriter>(walPath);
+            db::QBTable primary;
+            primary.setWriteAheadLog(wal);
+            primary.addRecord({1, "a", 0, ""});
+            primary.createIndex(db::ColumnType::COLUMN1, db::IndexKind::Unique);
+            primary.addRecord({2, "b", 0, ""});
+            wal->flush();
+            db::replica::Follower follower(walPath);
+            follower.poll();
+            follower.read([]([[maybe_unused]] const db::QBTable &replica)
+                          { assert(replica.explain(db::ColumnType::COLUMN1, "b").starts_with("UNIQUE INDEX LOOKUP") &&
+                                   replica.findMatching(db::ColumnType::COLUMN1, "b").size() == 1); },
+                          seconds(1));
+            std::filesystem::remove(walPath);
+        }
+
+        out << "\n  ✓ All unique index tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 20: Composite Indexes ==========
+    out << "TEST 20: Composite Index vs Single-Column Index Intersection" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        const std::string testName = "TEST 20";
+        // 100 values of column2 times 100 of column3 - every pair holds 10 records, every single value 1000
+        auto regionOf = [](size_t i)
+        { return "region" + std::to_string(i / 100 % 100); };
+        db::QBTable single, composite;
+        for (size_t i = 0; i < DATA_SIZE; ++i)
+        {
+            db::QBRecord rec{db::uint(i), "name" + std::to_string(i), long(i % 100), regionOf(i)};
+            single.addRecord(rec);
+            composite.addRecord(rec);
+        }
+        single.createIndex(db::ColumnType::COLUMN2);
+        single.createIndex(db::ColumnType::COLUMN3);
+        composite.createCompositeIndex({db::ColumnType::COLUMN2, db::ColumnType::COLUMN3});
+
+        std::vector<std::string> numbers, regions;
+        for (size_t i = 0; i < 100; ++i)
+        {
+            numbers.push_back(std::to_string(i * 37 % 100));
+            regions.push_back(regionOf(i * 100 * 61));
+        }
+        size_t checksum = 0;
+        auto sum = [&](const db::QBRecord &rec)
+        { checksum += rec.column0; };
+        auto fullKey = [&](const db::QBTable &table)
+        {
+            size_t found = 0;
+            for (size_t i = 0; i < numbers.size(); ++i)
+            {
+                const db::ColumnMatch conditions[] = {{db::ColumnType::COLUMN2, numbers[i]}, {db::ColumnType::COLUMN3, regions[i]}};
+                found += table.forEachMatchingAll(conditions, sum);
+            }
+            return found;
+        };
+        auto prefix = [&](const db::QBTable &table)
+        {
+            size_t found = 0;
+            for (size_t i = 0; i < 10; ++i)
+            {
+                const db::ColumnMatch conditions[] = {{db::ColumnType::COLUMN2, numbers[i]}};
+                found += table.forEachMatchingAll(conditions, sum);
+            }
+            return found;
+        };
+
+        std::vector<BenchmarkResult> results;
+        results.push_back({"intersection, 100 full keys", timeQueries(ctx, testName, "intersection full key", [&]
+                                                                      { return fullKey(single); }),
+                           0, ""});
+        results.push_back({"composite, 100 full keys", timeQueries(ctx, testName, "composite full key", [&]
+                                                                   { return fullKey(composite); }),
+                           0, ""});
+        results.push_back({"single index, 10 prefixes", timeQueries(ctx, testName, "single index prefix", [&]
+                                                                    { return prefix(single); }),
+                           0, ""});
+        results.push_back({"composite, 10 prefixes", timeQueries(ctx, testName, "composite prefix", [&]
+                                                                 { return prefix(composite); }),
+                           0, ""});
+        for (const auto &r : results)
+        {
+            out << "  " << std::left << std::setw(30) << r.name
+                << std::setw(12) << std::fixed << std::setprecision(3) << r.timeMs << " ms" << std::endl;
+        }
+        const db::ColumnMatch sample[] = {{db::ColumnType::COLUMN2, "7"}, {db::ColumnType::COLUMN3, "region7"}};
+        out << "  " << single.explain(sample) << "\n  " << composite.explain(sample) << std::endl;
+        out << "  (checksum " << checksum << ")" << std::endl;
+        assert(fullKey(single) == 1000 && fullKey(composite) == 1000 && prefix(single) == 10000 && prefix(composite) == 10000);
+        assert(composite.explain(sample).starts_with("COMPOSITE INDEX LOOKUP on (column2, column3) using 2 of 2"));
+        assert(single.explain(sample).starts_with("INDEX INTERSECTION"));
+        assert(composite.stats().columns.at(db::ColumnType::COLUMN2).secondaryIndexLookups > 0);
+
+        // every mutation path keeps the index in step with the records, checked against a scan of all pairs
+        {
+            [[maybe_unused]] auto agrees = [](const db::QBTable &table)
+            {
+                for (long number = 0; number < 4; ++number)
+                    for (int region = 0; region < 4; ++region)
+                    {
+                        const std::string numberText = std::to_string(number), regionText = "r" + std::to_string(region);
+                        size_t expected = 0;
+                        table.forEachRecord([&](const db::QBRecord &rec)
+                                            { expected += rec.column2 == number && rec.column3 == regionText; return true; });
+                        const db::ColumnMatch conditions[] = {{db::ColumnType::COLUMN3, regionText}, {db::ColumnType::COLUMN2, numberText}};
+                        if (table.findMatchingAll(conditions).size() != expected)
+                            return false;
+                    }
+                return true;
+            };
+            db::QBTable table;
+            for (db::uint i = 0; i < 40; ++i)
+                table.addRecord({i, "n" + std::to_string(i), long(i % 4), "r" + std::to_string(i / 4 % 4)});
+            table.createCompositeIndex({db::ColumnType::COLUMN2, db::ColumnType::COLUMN3});
+            for (const auto &invalid : std::vector<std::vector<db::ColumnType>>{{db::ColumnType::COLUMN2},
+                                                                                 {db::ColumnType::COLUMN2, db::ColumnType::COLUMN2},
+                                                                                 {db::ColumnType::COLUMN0, db::ColumnType::COLUMN2},
+                                                                                 {db::ColumnType::COLUMN2, db::ColumnType::COLUMN3}})
+            {
+                [[maybe_unused]] bool refused = false;
+                try
+                {
+                    table.createCompositeIndex(invalid);
+                }
+                catch (const std::runtime_error &)
+                {
+                    refused = true;
+                }
+                assert(refused);
+            }
+            assert(agrees(table));
+            table.addRecord({40, "n40", 1, "r2"});
+            table.deleteRecordByID(5);
+            table.updateRecord(6, {std::nullopt, 3L, std::string("r0")});
+            assert(agrees(table));
+            // changes outside the indexed columns, and changes to one of them only, through every update path
+            table.updateRecord(13, {std::string("renamed"), std::nullopt, std::nullopt});
+            table.updateRecord(14, {std::nullopt, 0L, std::nullopt});
+            const db::QBRecord renames[] = {{15, "renamed", 3, "r3"}, {16, "renamed", 1, "r3"}};
+            table.upsertRecords(renames);
+            db::QBTransaction renaming;
+            renaming.update(17, {std::string("renamed"), std::nullopt, std::nullopt}).update(18, {std::nullopt, std::nullopt, std::string("r1")});
+            [[maybe_unused]] auto renamed = table.commit(renaming);
+            assert(renamed && agrees(table));
+            std::vector<db::QBRecord> batch = {{7, "n7", 0, "r3"}, {41, "n41", 2, "r2"}, {8, "n8", 1, "r1"}};
+            table.upsertRecords(batch);
+            db::QBTransaction txn;
+            txn.insert({42, "n42", 3, "r3"}).update(9, {std::nullopt, 0L, std::nullopt}).erase(10).insert({43, "n43", 0, "r0"}).erase(43);
+            [[maybe_unused]] auto committed = table.commit(txn);
+            assert(committed && agrees(table));
+            table.deleteRecordByID(11, true);
+            assert(agrees(table));
+            table.expireRecordAt(12, db::TtlClock::now() - std::chrono::seconds(1));
+            assert(agrees(table));
+            table.expireRecords();
+            table.compactRecords();
+            assert(agrees(table));
+
+            // a leading prefix is served by the index, a condition on a later column alone is not
+            db::QBTable wide;
+            for (db::uint i = 0; i < 40; ++i)
+                wide.addRecord({i, "n" + std::to_string(i % 2), long(i % 4), "r" + std::to_string(i / 4 % 4)});
+            wide.createCompositeIndex({db::ColumnType::COLUMN1, db::ColumnType::COLUMN2, db::ColumnType::COLUMN3});
+            [[maybe_unused]] const db::ColumnMatch leading[] = {{db::ColumnType::COLUMN2, "1"}, {db::ColumnType::COLUMN1, "n1"}};
+            [[maybe_unused]] const db::ColumnMatch trailing[] = {{db::ColumnType::COLUMN3, "r1"}};
+            assert(wide.explain(leading).starts_with("COMPOSITE INDEX LOOKUP on (column1, column2, column3) using 2 of 3"));
+            assert(wide.findMatchingAll(leading).size() == 10 && wide.explain(trailing).starts_with("LINEAR SCAN"));
+            assert(wide.findMatchingAll(trailing).size() == 12);
+            [[maybe_unused]] const db::ColumnMatch exact[] = {{db::ColumnType::COLUMN1, "n"}};
+            [[maybe_unused]] const db::ColumnMatch invalidNumber[] = {{db::ColumnType::COLUMN2, "x"}};
+            assert(wide.findMatchingAll(exact).empty() && wide.findMatching(db::ColumnType::COLUMN1, "n").size() == 40);
+            assert(wide.findMatchingAll(invalidNumber).empty());
+            // composite lookups count as hits of that index, not of its columns
+            wide.resetStats();
+            wide.findMatchingAll(leading);
+            wide.findMatchingAll(leading);
+            wide.findMatchingAll(trailing);
+            [[maybe_unused]] const db::QBTableStats wideStats = wide.stats();
+            [[maybe_unused]] const db::IndexUsage &wideUsage = wideStats.compositeIndexes.at({db::ColumnType::COLUMN1, db::ColumnType::COLUMN2, db::ColumnType::COLUMN3});
+            assert(wideStats.compositeIndexes.size() == 1 && wideUsage.hits == 2 && wideUsage.lastUsed != std::chrono::system_clock::time_point{});
+            assert(wideStats.columns.at(db::ColumnType::COLUMN1).secondaryIndexLookups == 2);
+            wide.dropCompositeIndex({db::ColumnType::COLUMN1, db::ColumnType::COLUMN2, db::ColumnType::COLUMN3});
+            assert(wide.stats().compositeIndexes.empty());
+            assert(wide.explain(leading).starts_with("LINEAR SCAN") && wide.findMatchingAll(leading).size() == 10);
+        }
+
+        // dynamic tables index column names, derived columns included
+        {
+            db::QBTableDynamic table;
+            table.addColumn("region", std::string{});
+            table.addColumn("tier", 0L);
+            table.addDerivedColumn("premium", [](const db::QBRecordDynamic &rec)
+                                   { return db::FieldType{std::get<long>(rec.fields.at("tier")) > 1 ? 1L : 0L}; });
+            for (db::uint i = 0; i < 30; ++i)
+                table.addRecord({i, {{"region", "r" + std::to_string(i % 3)}, {"tier", long(i % 4)}}});
+            table.createCompositeIndex({"region", "premium", "tier"});
+            [[maybe_unused]] auto count = [&](std::vector<db::DynamicColumnMatch> conditions)
+            { return table.findMatchingAll(conditions).size(); };
+            assert(count({{"region", std::string("r1")}, {"premium", 1L}}) == 4);
+            assert(table.explain(std::vector<db::DynamicColumnMatch>{{"region", std::string("r1")}, {"premium", 1L}}).starts_with("COMPOSITE INDEX LOOKUP"));
+            table.updateRecord(1, {{"tier", 3L}});
+            table.deleteRecordByID(7);
+            table.deleteRecordByID(10, true);
+            db::QBDynamicTransaction txn;
+            txn.insert({30, {{"region", std::string("r1")}, {"tier", 2L}}}).update(4, {{"region", std::string("r1")}});
+            table.commit(txn);
+            table.compactRecords();
+            size_t expected = 0;
+            table.forEachRecord([&](const db::QBRecordDynamic &rec)
+                                { expected += std::get<std::string>(rec.fields.at("region")) == "r1" && std::get<long>(rec.fields.at("tier")) > 1; return true; });
+            assert(count({{"premium", 1L}, {"region", std::string("r1")}}) == expected);
+            assert(count({{"region", std::string("r1")}, {"premium", 1L}, {"tier", 3L}}) + count({{"region", std::string("r1")}, {"premium", 1L}, {"tier", 2L}}) == expected);
+            table.resetStats();
+            count({{"region", std::string("r2")}});
+            [[maybe_unused]] const uint64_t dynamicHits = table.stats().compositeIndexes.at({"region", "premium", "tier"}).hits;
+            assert(dynamicHits == 1);
+            table.removeColumn("tier");
+            assert(!table.hasCompositeIndex({"region", "premium", "tier"}) && table.stats().compositeIndexes.empty());
+        }
+
+        // replicas replay index creation and drop
+        {
+            const std::string walPath = (std::filesystem::temp_directory_path() / "quickbase_composite_tests.wal").string();
+            auto wal = std::make_shared<db::wal::LogWriter>(walPath);
+            db::QBTable primary;
+            primary.setWriteAheadLog(wal);
+            primary.addRecord({1, "a", 1, "x"});
+            primary.createCompositeIndex({db::ColumnType::COLUMN3, db::ColumnType::COLUMN2});
+            primary.createCompositeIndex({db::ColumnType::COLUMN1, db::ColumnType::COLUMN2});
+            primary.dropCompositeIndex({db::ColumnType::COLUMN1, db::ColumnType::COLUMN2});
+            primary.addRecord({2, "b", 1, "x"});
+            wal->flush();
+            db::replica::Follower follower(walPath);
+            follower.poll();
+            follower.read([]([[maybe_unused]] const db::QBTable &replica)
+                          {
+                              [[maybe_unused]] const db::ColumnMatch conditions[] = {{db::ColumnType::COLUMN2, "1"}, {db::ColumnType::COLUMN3, "x"}};
+                              assert(replica.hasCompositeIndex({db::ColumnType::COLUMN3, db::ColumnType::COLUMN2}) &&
+                                     !replica.hasCompositeIndex({db::ColumnType::COLUMN1, db::ColumnType::COLUMN2}) &&
+                                     replica.findMatchingAll(conditions).size() == 2); },
+                          std::chrono::seconds(1));
+            std::filesystem::remove(walPath);
+        }
+
+        out << "\n  ✓ All composite index tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 21: Index Advisor ==========
+    out << "TEST 21: Index Advisor Under a Shifting Workload" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        // the workload filters on column2 for four windows, then moves to column3; the budget holds one index
+        auto makeTable = [](db::QBTable &table)
+        {
+            for (size_t i = 0; i < DATA_SIZE; ++i)
+                table.addRecord({db::uint(i), "name" + std::to_string(i), long(i % 1000), "tag" + std::to_string(i % 500)});
+        };
+        db::QBTable fixed, advised;
+        makeTable(fixed);
+        makeTable(advised);
+        auto queryLog = std::make_shared<db::QueryLog>();
+        advised.setQueryLog(queryLog, "events");
+        db::IndexAdvisorOptions options;
+        options.memoryBudget = std::max(advised.estimateIndex(db::ColumnType::COLUMN2).memoryBytes,
+                                        advised.estimateIndex(db::ColumnType::COLUMN3).memoryBytes) * 3 / 2;
+        db::IndexAdvisor advisor(advised, options, queryLog, "events");
+
+        constexpr int windows = 8, queriesPerWindow = 100;
+        size_t checksum = 0;
+        auto sum = [&](const db::QBRecord &rec)
+        { checksum += rec.column0; };
+        auto runWindow = [&](db::QBTable &table, int window)
+        {
+            auto start = steady_clock::now();
+            for (int q = 0; q < queriesPerWindow; ++q)
+            {
+                const size_t key = size_t(window * queriesPerWindow + q) * 7919;
+                if (window < windows / 2)
+                    table.forEachMatching(db::ColumnType::COLUMN2, std::to_string(key % 1000), sum);
+                else
+                {
+                    const std::string tag = "tag" + std::to_string(key % 500);
+                    const db::ColumnMatch conditions[] = {{db::ColumnType::COLUMN3, tag}};
+                    table.forEachMatchingAll(conditions, sum);
+                }
+                table.updateRecord(db::uint(key % DATA_SIZE), {"renamed" + std::to_string(q), std::nullopt, std::nullopt});
+            }
+            return duration<double, std::milli>(steady_clock::now() - start).count();
+        };
+
+        double fixedTotal = 0, advisedTotal = 0;
+        out << "  window  workload  no indexes     advised  advisor actions" << std::endl;
+        for (int window = 0; window < windows; ++window)
+        {
+            const double fixedMs = runWindow(fixed, window);
+            const double advisedMs = runWindow(advised, window);
+            fixedTotal += fixedMs;
+            advisedTotal += advisedMs;
+            std::string actions;
+            for (const auto &recommendation : advisor.apply())
+                if (recommendation.advice != db::IndexAdvice::Keep)
+                    actions += std::string(recommendation.advice == db::IndexAdvice::Create ? " +column" : " -column") +
+                               std::to_string(static_cast<int>(recommendation.column));
+            out << "  " << std::left << std::setw(8) << window << std::setw(10) << (window < windows / 2 ? "column2" : "column3")
+                << std::right << std::fixed << std::setprecision(3) << std::setw(10) << fixedMs << " ms" << std::setw(9)
+                << advisedMs << " ms " << std::left << actions << std::endl;
+            if (window == 0)
+                assert(advised.isColumnIndexed(db::ColumnType::COLUMN2) && !advised.isColumnIndexed(db::ColumnType::COLUMN3));
+        }
+        out << "  total           " << std::right << std::setw(10) << fixedTotal << " ms" << std::setw(9) << advisedTotal << " ms" << std::left << std::endl;
+        out << "  (checksum " << checksum << ")" << std::endl;
+        assert(advised.isColumnIndexed(db::ColumnType::COLUMN3) && !advised.isColumnIndexed(db::ColumnType::COLUMN2));
+        ctx.report.push_back({"TEST 21", "no indexes", {fixedTotal}});
+        ctx.report.push_back({"TEST 21", "index advisor", {advisedTotal}});
+
+        // estimates of a missing index are close to the measured index
+        {
+            [[maybe_unused]] const auto estimated = fixed.estimateIndex(db::ColumnType::COLUMN3);
+            fixed.createIndex(db::ColumnType::COLUMN3);
+            [[maybe_unused]] const auto measured = fixed.estimateIndex(db::ColumnType::COLUMN3);
+            assert(!estimated.exists && measured.exists && measured.keys == 500 && estimated.postings == measured.postings);
+            assert(estimated.keys >= 400 && estimated.keys <= 600);
+            assert(estimated.memoryBytes * 2 > measured.memoryBytes && estimated.memoryBytes < measured.memoryBytes * 2);
+        }
+
+        // idle indexes are dropped, unique ones kept, string columns only indexed for logged equality queries
+        {
+            db::QBTable table;
+            for (db::uint i = 0; i < 5000; ++i)
+                table.addRecord({i, "n" + std::to_string(i), long(i % 50), "t" + std::to_string(i % 50)});
+            table.createIndex(db::ColumnType::COLUMN1, db::IndexKind::Unique);
+            table.createIndex(db::ColumnType::COLUMN2);
+            auto log = std::make_shared<db::QueryLog>();
+            table.setQueryLog(log, "t");
+            db::IndexAdvisorOptions small;
+            small.minBenefitRows = 1000;
+            db::IndexAdvisor blind(table, small), informed(table, small, log, "t");
+            for (db::uint i = 0; i < 100; ++i)
+            {
+                table.updateRecord(i, {std::nullopt, std::nullopt, "t" + std::to_string(i % 7)});
+                table.findMatching(db::ColumnType::COLUMN3, "t1"); // substring
+            }
+            [[maybe_unused]] auto verdicts = blind.recommend();
+            assert(verdicts.size() == 1 && verdicts[0].column == db::ColumnType::COLUMN2 && verdicts[0].advice == db::IndexAdvice::Drop);
+            assert(table.isColumnIndexed(db::ColumnType::COLUMN2));
+            [[maybe_unused]] auto applied = informed.apply();
+            assert(applied.size() == 1 && !table.isColumnIndexed(db::ColumnType::COLUMN2) && table.isColumnIndexed(db::ColumnType::COLUMN1));
+
+            const db::ColumnMatch exact[] = {{db::ColumnType::COLUMN3, "t2"}};
+            for (int i = 0; i < 100; ++i)
+                table.findMatchingAll(exact);
+            [[maybe_unused]] auto blindApplied = blind.apply();
+            applied = informed.apply();
+            assert(blindApplied.empty() && applied.empty()); // substring queries were seen on column3
+
+            db::QBTable fresh;
+            for (db::uint i = 0; i < 5000; ++i)
+                fresh.addRecord({i, "n" + std::to_string(i % 50), long(i), ""});
+            auto freshLog = std::make_shared<db::QueryLog>();
+            fresh.setQueryLog(freshLog, "fresh");
+            db::IndexAdvisor freshBlind(fresh, small), freshInformed(fresh, small, freshLog, "fresh");
+            const db::ColumnMatch byName[] = {{db::ColumnType::COLUMN1, "n3"}};
+            for (int i = 0; i < 100; ++i)
+                fresh.findMatchingAll(byName);
+            [[maybe_unused]] auto freshVerdicts = freshBlind.recommend();
+            assert(freshVerdicts.empty());
+            [[maybe_unused]] auto created = freshInformed.apply();
+            assert(created.size() == 1 && created[0].advice == db::IndexAdvice::Create && fresh.isColumnIndexed(db::ColumnType::COLUMN1));
+        }
+
+        out << "\n  ✓ All index advisor tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 22: Adaptive Indexing ==========
+    out << "TEST 22: Adaptive Indexing of column2 Range Queries" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        // random values, random ranges of about 0.1% of the domain - each query returns some 400 records
+        constexpr size_t rows = 4 * DATA_SIZE;
+        constexpr long domain = 10000000;
+        constexpr int queries = 1000;
+        std::mt19937_64 rng(20261018);
+        db::QBTable scanned, cracked, sorted;
+        for (size_t i = 0; i < rows; ++i)
+        {
+            db::QBRecord rec{db::uint(i), "name" + std::to_string(i), long(rng() % domain), "tag"};
+            scanned.addRecord(rec);
+            cracked.addRecord(rec);
+            sorted.addRecord(rec);
+        }
+        scanned.setAdaptiveIndexing(false);
+        std::vector<std::pair<long, long>> ranges;
+        for (int q = 0; q < queries; ++q)
+        {
+            const long low = long(rng() % domain);
+            ranges.emplace_back(low, low + domain / 1000);
+        }
+
+        // cumulative milliseconds after each checkpoint, the upfront sort pays for createIndex() before its first query
+        const int checkpoints[] = {1, 10, 100, 1000};
+        std::vector<std::pair<size_t, uint64_t>> expected;
+        auto run = [&](db::QBTable &table, double setupMs, bool record)
+        {
+            std::vector<double> cumulative;
+            double elapsed = setupMs;
+            size_t next = 0;
+            for (int q = 0; q < queries; ++q)
+            {
+                uint64_t checksum = 0;
+                auto start = steady_clock::now();
+                const size_t found = table.forEachInRange(ranges[size_t(q)].first, ranges[size_t(q)].second, [&](const db::QBRecord &rec)
+                                                          { checksum += rec.column0; });
+                elapsed += duration<double, std::milli>(steady_clock::now() - start).count();
+                if (record)
+                    expected.emplace_back(found, checksum);
+                else
+                    assert(expected[size_t(q)] == std::make_pair(found, checksum));
+                if (q + 1 == checkpoints[next])
+                {
+                    cumulative.push_back(elapsed);
+                    ++next;
+                }
+            }
+            return cumulative;
+        };
+        const auto scanTimes = run(scanned, 0, true);
+        const auto crackTimes = run(cracked, 0, false);
+        auto sortStart = steady_clock::now();
+        sorted.createIndex(db::ColumnType::COLUMN2);
+        const double sortMs = duration<double, std::milli>(steady_clock::now() - sortStart).count();
+        const auto sortTimes = run(sorted, sortMs, false);
+
+        out << "  queries   full scans   adaptive index   upfront sort (cumulative ms)" << std::endl;
+        for (size_t i = 0; i < std::size(checkpoints); ++i)
+            out << "  " << std::left << std::setw(8) << checkpoints[i] << std::right << std::fixed << std::setprecision(3)
+                << std::setw(12) << scanTimes[i] << std::setw(17) << crackTimes[i] << std::setw(15) << sortTimes[i] << std::left << std::endl;
+        out << "  (upfront sort includes " << sortMs << " ms of createIndex)" << std::endl;
+        ctx.report.push_back({"TEST 22", "full scans", {scanTimes.back()}});
+        ctx.report.push_back({"TEST 22", "adaptive index", {crackTimes.back()}});
+        ctx.report.push_back({"TEST 22", "upfront sort", {sortTimes.back()}});
+
+        // the column converges - late queries examine a small fraction of the rows a scan does
+        {
+            [[maybe_unused]] const auto before = cracked.stats().columns.at(db::ColumnType::COLUMN2);
+            for (int q = 0; q < 100; ++q)
+                cracked.forEachInRange(ranges[size_t(q)].first + 1, ranges[size_t(q)].second - 1, [](const db::QBRecord &) {});
+            [[maybe_unused]] const auto after = cracked.stats().columns.at(db::ColumnType::COLUMN2);
+            assert(after.crackerLookups == before.crackerLookups + 100 && after.linearScans == 0);
+            assert((after.rowsExamined - before.rowsExamined) * 20 < rows * 100);
+            assert(cracked.explainRange(0, 10).starts_with("ADAPTIVE INDEX") && sorted.explainRange(0, 10).starts_with("INDEX RANGE SCAN"));
+            assert(scanned.explainRange(0, 10).starts_with("LINEAR SCAN") && cracked.explainRange(10, 0).starts_with("NO ROWS"));
+        }
+
+        // results stay exact through appends, updates, deletes and compaction
+        {
+            db::QBTable reference, adaptive;
+            reference.setAdaptiveIndexing(false);
+            std::mt19937 ops(7);
+            db::uint nextId = 0;
+            [[maybe_unused]] auto same = [&](long low, long high)
+            {
+                auto ids = [](std::vector<db::QBRecord> records)
+                {
+                    std::vector<db::uint> keys;
+                    for (const auto &rec : records)
+                        keys.push_back(rec.column0);
+                    std::sort(keys.begin(), keys.end());
+                    return keys;
+                };
+                return ids(reference.findInRange(low, high)) == ids(adaptive.findInRange(low, high));
+            };
+            for (int step = 0; step < 5000; ++step)
+            {
+                const auto op = unsigned(ops() % 100);
+                const db::uint id = nextId ? db::uint(ops() % nextId) : 0;
+                if (op < 50)
+                {
+                    db::QBRecord rec{nextId++, "", long(ops() % 1000), ""};
+                    reference.addRecord(rec);
+                    adaptive.addRecord(rec);
+                }
+                else if (op < 60)
+                {
+                    // updates keep the copy - the old entry goes stale and the new value is pending
+                    const long value = long(ops() % 1000);
+                    for (auto *table : {&reference, &adaptive})
+                    {
+                        if (op < 54)
+                            table->updateRecord(id, {std::nullopt, value, std::nullopt});
+                        else if (op < 57)
+                        {
+                            std::vector<db::QBRecord> batch = {{id, "", value, ""}};
+                            table->upsertRecords(batch);
+                        }
+                        else
+                        {
+                            db::QBTransaction txn;
+                            txn.update(id, {std::nullopt, value, std::nullopt});
+                            table->commit(txn);
+                        }
+                    }
+                }
+                else if (op < 70)
+                {
+                    reference.deleteRecordByID(id, op < 62);
+                    adaptive.deleteRecordByID(id, op < 62);
+                }
+                else if (op == 70)
+                {
+                    reference.compactRecords();
+                    adaptive.compactRecords();
+                }
+                else
+                {
+                    const long low = long(ops() % 1100) - 50;
+                    [[maybe_unused]] const long high = low + long(ops() % 200);
+                    assert(same(low, high));
+                }
+            }
+            assert(same(std::numeric_limits<long>::min(), std::numeric_limits<long>::max()) && same(500, 499));
+            [[maybe_unused]] const bool moved = adaptive.updateRecord(adaptive.findInRange(0, 999).front().column0, {std::nullopt, 2000L, std::nullopt});
+            assert(moved && adaptive.explainRange(0, 10).ends_with(" pieces)") && adaptive.findInRange(2000, 2000).size() == 1);
+        }
+
+        out << "\n  ✓ All adaptive indexing tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 23: Full-Text Search ==========
+    out << "TEST 23: Full-Text Index with BM25 Top-k Retrieval" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        using namespace std::chrono;
+        // synthetic notes - word ranks follow Zipf's law over a vocabulary of 5000 pseudo words
+        constexpr size_t vocabulary = 5000;
+        auto word = [](size_t rank)
+        {
+            static const char *syllables[] = {"ka", "lo", "mi", "ne", "ru", "sa", "ti", "vo"};
+            std::string text;
+            for (size_t r = rank + 8; r > 0; r /= 8)
+                text += syllables[r % 8];
+            return text;
+        };
+        std::vector<double> weights;
+        for (size_t rank = 0; rank < vocabulary; ++rank)
+            weights.push_back(1.0 / double(rank + 1));
+        std::mt19937_64 rng(42);
+        std::discrete_distribution<size_t> zipf(weights.begin(), weights.end());
+        auto note = [&]
+        {
+            std::string text;
+            const size_t words = 10 + rng() % 30;
+            for (size_t w = 0; w < words; ++w)
+            {
+                if (w)
+                    text += ' ';
+                text += word(zipf(rng));
+            }
+            return text;
+        };
+
+        db::QBTable notes;
+        size_t corpusBytes = 0;
+        for (size_t i = 0; i < DATA_SIZE; ++i)
+        {
+            db::QBRecord rec{db::uint(i), "author" + std::to_string(i % 100), long(i), note()};
+            corpusBytes += rec.column3.size();
+            notes.addRecord(rec);
+        }
+        auto buildStart = steady_clock::now();
+        notes.createFullTextIndex();
+        const double buildMs = duration<double, std::milli>(steady_clock::now() - buildStart).count();
+        const db::FullTextIndex &index = *notes.fullTextIndex();
+
+        // a frequent, a medium and a rare word per query
+        std::vector<std::string> queries, rarest;
+        for (size_t q = 0; q < 100; ++q)
+        {
+            rarest.push_back(word(1000 + rng() % 4000));
+            queries.push_back(word(rng() % 50) + " " + word(100 + rng() % 900) + " " + rarest.back());
+        }
+        size_t scanned = 0, decodedExhaustive = 0, decodedMaxScore = 0;
+        auto timed = [&](auto &&run)
+        {
+            auto start = steady_clock::now();
+            for (size_t q = 0; q < queries.size(); ++q)
+                run(q);
+            return duration<double, std::milli>(steady_clock::now() - start).count();
+        };
+        const double scanMs = timed([&](size_t q)
+                                    { scanned += notes.findMatching(db::ColumnType::COLUMN3, rarest[q]).size(); });
+        std::vector<db::FullTextHits> exhaustive;
+        const double exhaustiveMs = timed([&](size_t q)
+                                          {
+                                              exhaustive.push_back(index.search(queries[q], 10, {}, false));
+                                              decodedExhaustive += exhaustive.back().postingsDecoded; });
+        std::vector<std::vector<db::TextMatch>> ranked;
+        const double maxScoreMs = timed([&](size_t q)
+                                        { ranked.push_back(notes.searchText(queries[q], 10)); });
+        for (size_t q = 0; q < queries.size(); ++q)
+        {
+            decodedMaxScore += index.search(queries[q], 10).postingsDecoded;
+            assert(ranked[q].size() == 10 && exhaustive[q].rows.size() == 10);
+            for (size_t i = 0; i < ranked[q].size(); ++i)
+                assert(ranked[q][i].record.column0 == exhaustive[q].rows[i].row && ranked[q][i].score == exhaustive[q].rows[i].score);
+        }
+        assert(decodedMaxScore * 2 < decodedExhaustive);
+
+        out << "  100 queries of 3 words over " << DATA_SIZE << " notes, top 10" << std::endl;
+        out << "  " << std::left << std::setw(44) << "substring scan of the rarest word (unranked)" << std::right << std::fixed << std::setprecision(3)
+            << std::setw(10) << scanMs << " ms" << std::endl;
+        out << "  " << std::left << std::setw(44) << "BM25, every posting scored" << std::right << std::setw(10) << exhaustiveMs << " ms  "
+            << decodedExhaustive / queries.size() << " postings/query" << std::endl;
+        out << "  " << std::left << std::setw(44) << "BM25 with MaxScore early termination" << std::right << std::setw(10) << maxScoreMs << " ms  "
+            << decodedMaxScore / queries.size() << " postings/query" << std::endl;
+        out << "  index: " << index.termCount() << " terms, " << index.postingCount() << " postings in " << index.postingBytes()
+            << " bytes (" << std::setprecision(2) << double(index.postingBytes()) / double(index.postingCount())
+            << " bytes/posting), " << index.memoryUsage() / 1024 << " KiB in total for " << corpusBytes / 1024
+            << " KiB of text, built in " << std::setprecision(3) << buildMs << " ms" << std::endl;
+        out << "  (" << scanned << " substring matches)" << std::endl;
+        ctx.report.push_back({"TEST 23", "substring scan", {scanMs}});
+        ctx.report.push_back({"TEST 23", "bm25 exhaustive", {exhaustiveMs}});
+        ctx.report.push_back({"TEST 23", "bm25 maxscore", {maxScoreMs}});
+
+        // tokenizer normalization
+        {
+            db::TokenizerOptions options;
+            options.stopWords = {"The", "a"};
+            options.minLength = 2;
+            options.keepDigits = false;
+            options.maxLength = 6;
+            db::Tokenizer tokenizer(options);
+            assert(tokenizer.tokenize("The QUICK, brown fox42 a b 1234 jumped-over... ünïcødé") == (std::vector<std::string>{"quick", "brown", "fox42", "jumped", "over", "ünïc"}));
+            options = {};
+            options.lowercase = false;
+            assert(db::Tokenizer(options).tokenize("Mixed case") == (std::vector<std::string>{"Mixed", "case"}));
+        }
+
+        // incremental maintenance ranks like an index built from scratch over the surviving records
+        {
+            db::QBTable live;
+            live.createFullTextIndex();
+            for (db::uint i = 0; i < 5000; ++i)
+                live.addRecord({i, "", long(i), note()});
+            for (db::uint i = 0; i < 5000; i += 7)
+                live.deleteRecordByID(i);
+            for (db::uint i = 3; i < 5000; i += 11)
+                live.updateRecord(i, {std::nullopt, std::nullopt, note()});
+            db::QBTransaction txn;
+            txn.insert({5000, "", 0, note()}).erase(1).update(2, {std::nullopt, std::nullopt, "kaka kaka lolo"});
+            [[maybe_unused]] auto committed = live.commit(txn);
+            assert(committed.committed);
+            const db::QBRecord batch[] = {{4, "", 0, note()}, {5001, "", 0, note()}};
+            live.upsertRecords(batch);
+            live.deleteRecordByID(5, true);
+
+            [[maybe_unused]] auto fresh = [&]
+            {
+                db::QBTable rebuilt;
+                live.forEachRecord([&](const db::QBRecord &rec)
+                                   { return rebuilt.addRecord(rec); });
+                rebuilt.createFullTextIndex();
+                return rebuilt;
+            };
+            [[maybe_unused]] auto sameRanking = [&](const db::QBTable &a, const db::QBTable &b)
+            {
+                for (const auto &query : queries)
+                {
+                    const auto left = a.searchText(query, 20), right = b.searchText(query, 20);
+                    if (left.size() != right.size())
+                        return false;
+                    for (size_t i = 0; i < left.size(); ++i)
+                        if (left[i].score != right[i].score ||
+                            (left[i].score > left.back().score && left[i].record.column0 != right[i].record.column0))
+                            return false;
+                }
+                return true;
+            };
+            assert(sameRanking(live, fresh()));
+            assert(live.searchText("kaka lolo", 1).front().record.column0 == 2);
+            live.compactRecords();
+            assert(sameRanking(live, fresh()));
+            assert(live.fullTextIndex()->documentCount() == live.activeRecordsCount());
+
+            live.dropFullTextIndex();
+            [[maybe_unused]] bool threw = false;
+            try
+            {
+                live.searchText("kaka");
+            }
+            catch (const std::runtime_error &)
+            {
+                threw = true;
+            }
+            assert(threw && notes.explainText("kaka lolo").starts_with("FULL TEXT SEARCH"));
+        }
+
+        out << "\n  ✓ All full-text search tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 24: Wire Protocol ==========
+    out << "TEST 24: Table Server Wire Protocol Encoding" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        // every value type survives a Writer -> Reader round trip inside a frame
+        std::vector<char> buf;
+        db::wire::Writer writer(buf);
+        const db::QBRecord rec{42, "kaka", -7, std::string("lo\0lo", 5)};
+        const db::QBRecordDynamic dynamicRec{9, {{"name", std::string("x")}, {"count", db::uint{3}}, {"delta", -5L}}};
+        size_t frameStart = writer.beginFrame(static_cast<uint8_t>(db::wire::Opcode::Add), 77);
+        writer.putU8(0xFE);
+        writer.putU16(0xBEEF);
+        writer.putU32(0xDEADBEEF);
+        writer.putU64(std::numeric_limits<uint64_t>::max());
+        writer.putI64(std::numeric_limits<int64_t>::min());
+        writer.putName("table");
+        writer.putString("");
+        size_t countPos = writer.reserveU32();
+        writer.putField(db::uint{5});
+        writer.putField(-3L);
+        writer.putField(std::string("text"));
+        writer.putRecord(rec);
+        writer.putDynamicRecord(dynamicRec);
+        writer.patchU32(countPos, 3);
+        writer.endFrame(frameStart);
+
+        db::wire::FrameHeader header{};
+        [[maybe_unused]] bool complete = db::wire::peekFrame(buf.data(), buf.size(), header);
+        assert(complete && header.frameSize() == buf.size());
+        assert(header.code == static_cast<uint8_t>(db::wire::Opcode::Add) && header.requestId == 77);
+
+        db::wire::Reader reader(buf.data() + db::wire::kHeaderSize, buf.size() - db::wire::kHeaderSize);
+        [[maybe_unused]] uint8_t u8 = reader.getU8();
+        [[maybe_unused]] uint16_t u16 = reader.getU16();
+        [[maybe_unused]] uint32_t u32 = reader.getU32();
+        [[maybe_unused]] uint64_t u64 = reader.getU64();
+        [[maybe_unused]] int64_t i64 = reader.getI64();
+        assert(u8 == 0xFE && u16 == 0xBEEF && u32 == 0xDEADBEEF);
+        assert(u64 == std::numeric_limits<uint64_t>::max() && i64 == std::numeric_limits<int64_t>::min());
+        [[maybe_unused]] std::string_view name = reader.getName(), empty = reader.getString();
+        assert(name == "table" && empty.empty());
+        [[maybe_unused]] uint32_t count = reader.getU32();
+        assert(count == 3);
+        [[maybe_unused]] db::FieldType fields[] = {reader.getField(), reader.getField(), reader.getField()};
+        assert(fields[0] == db::FieldType(db::uint{5}) && fields[1] == db::FieldType(-3L) && fields[2] == db::FieldType(std::string("text")));
+        [[maybe_unused]] db::QBRecord decoded = reader.getRecord();
+        assert(decoded.column0 == rec.column0 && decoded.column1 == rec.column1 && decoded.column2 == rec.column2 && decoded.column3 == rec.column3);
+        [[maybe_unused]] db::QBRecordDynamic decodedDynamic = reader.getDynamicRecord();
+        assert(decodedDynamic.id == dynamicRec.id && decodedDynamic.fields == dynamicRec.fields);
+        assert(reader.empty());
+
+        // a name over the u16 length is cut instead of corrupting the stream
+        {
+            std::vector<char> longName;
+            db::wire::Writer longWriter(longName);
+            longWriter.putName("Column already exists: " + std::string(db::wire::kMaxNameSize, 'c'));
+            longWriter.putU8(7);
+            db::wire::Reader longReader(longName.data(), longName.size());
+            [[maybe_unused]] std::string_view cut = longReader.getName();
+            [[maybe_unused]] uint8_t after = longReader.getU8();
+            assert(cut.size() == db::wire::kMaxNameSize && cut.starts_with("Column already exists: ") && after == 7 && longReader.empty());
+        }
+
+        [[maybe_unused]] auto throwsProtocolError = [](auto &&decode)
+        {
+            try
+            {
+                decode();
+            }
+            catch (const db::wire::ProtocolError &)
+            {
+                return true;
+            }
+            return false;
+        };
+
+        // a partially received frame is not complete yet, at any split point
+        for (size_t size = 0; size < buf.size(); ++size)
+            assert(!db::wire::peekFrame(buf.data(), size, header));
+
+        // truncated payloads throw instead of reading past the frame
+        for (size_t size = 0; size < buf.size() - db::wire::kHeaderSize; ++size)
+            assert(throwsProtocolError([&]
+                                       {
+                                           db::wire::Reader truncated(buf.data() + db::wire::kHeaderSize, size);
+                                           truncated.getU8();
+                                           truncated.getU16();
+                                           truncated.getU32();
+                                           truncated.getU64();
+                                           truncated.getI64();
+                                           truncated.getName();
+                                           truncated.getString();
+                                           truncated.getU32();
+                                           for (int i = 0; i < 3; ++i)
+                                               truncated.getField();
+                                           truncated.getRecord();
+                                           truncated.getDynamicRecord(); }));
+        std::vector<char> lying;
+        db::wire::Writer(lying).putU32(1000); // string length beyond the payload
+        assert(throwsProtocolError([&]
+                                   { db::wire::Reader(lying.data(), lying.size()).getString(); }));
+        std::vector<char> badTag{char(9)};
+        assert(throwsProtocolError([&]
+                                   { db::wire::Reader(badTag.data(), badTag.size()).getField(); }));
+
+        // oversized and undersized frame lengths are rejected from the header alone
+        for (uint32_t length : {db::wire::kMaxFrameSize + 1, std::numeric_limits<uint32_t>::max(), uint32_t(db::wire::kHeaderSize - sizeof(uint32_t) - 1)})
+        {
+            std::vector<char> frame(buf.begin(), buf.begin() + db::wire::kHeaderSize);
+            std::memcpy(frame.data(), &length, sizeof(length));
+            assert(throwsProtocolError([&]
+                                       { db::wire::peekFrame(frame.data(), frame.size(), header); }));
+        }
+        std::vector<char> maxFrame(db::wire::kHeaderSize);
+        std::memcpy(maxFrame.data(), &db::wire::kMaxFrameSize, sizeof(uint32_t));
+        assert(!db::wire::peekFrame(maxFrame.data(), maxFrame.size(), header) && header.frameSize() == sizeof(uint32_t) + db::wire::kMaxFrameSize);
+
+        out << "  ✓ All wire protocol tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 25: C API ==========
+    out << "TEST 25: C API Result Buffers and Status Codes" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+        [[maybe_unused]] auto hasError = [](qb_status status, qb_status expected, std::string_view message)
+        {
+            return status == expected && qb_last_error() == message;
+        };
+        [[maybe_unused]] auto text = [](const qb_column *column, size_t row)
+        {
+            const char *bytes = static_cast<const char *>(column->values);
+            return std::string_view(bytes + column->offsets[row], size_t(column->offsets[row + 1] - column->offsets[row]));
+        };
+        [[maybe_unused]] auto validity = [](const qb_column *column, size_t rows)
+        {
+            return std::vector<uint8_t>(column->validity, column->validity + rows);
+        };
+
+        // QBTable results - fixed width columns, strings as concatenated bytes with rows + 1 offsets
+        {
+            qb_table *table = qb_table_create();
+            const qb_record records[] = {{1, "ab", 2, 10, "", 0}, {2, "", 0, 20, "xyz", 3}, {3, "cde", 3, 10, "q", 1}};
+            [[maybe_unused]] qb_status status = qb_add_records(table, records, 3);
+            assert(status == QB_OK && qb_table_active_count(table) == 3);
+
+            qb_result *result = nullptr;
+            status = qb_find(table, 2, "10", 2, &result);
+            assert(status == QB_OK && qb_result_rows(result) == 2 && qb_result_column_count(result) == 4);
+            [[maybe_unused]] const qb_column *c0 = qb_result_column(result, 0), *c1 = qb_result_column(result, 1),
+                                             *c2 = qb_result_column(result, 2), *c3 = qb_result_column(result, 3);
+            assert(std::string_view(c0->name) == "column0" && c0->type == QB_FIELD_UINT && !c0->offsets && !c0->validity);
+            assert(static_cast<const uint32_t *>(c0->values)[0] == 1 && static_cast<const uint32_t *>(c0->values)[1] == 3);
+            assert(c1->type == QB_FIELD_STRING && !c1->validity);
+            assert(c1->offsets[0] == 0 && c1->offsets[1] == 2 && c1->offsets[2] == 5);
+            assert(std::string_view(static_cast<const char *>(c1->values), 5) == "abcde");
+            assert(text(c1, 0) == "ab" && text(c1, 1) == "cde");
+            assert(c2->type == QB_FIELD_LONG && static_cast<const int64_t *>(c2->values)[1] == 10);
+            assert(c3->offsets[0] == 0 && c3->offsets[1] == 0 && c3->offsets[2] == 1 && text(c3, 1) == "q");
+            assert(qb_result_column(result, 4) == nullptr);
+            qb_result_free(result);
+
+            // no match is an empty result, not an error
+            status = qb_find(table, 0, "99", 2, &result);
+            assert(status == QB_OK && qb_result_rows(result) == 0 && qb_result_column(result, 1)->offsets[0] == 0);
+            qb_result_free(result);
+
+            status = qb_delete_record(table, 99, 0);
+            assert(hasError(status, QB_NOT_FOUND, "No record with id 99"));
+            status = qb_find(table, 4, "1", 1, &result);
+            assert(hasError(status, QB_INVALID_ARGUMENT, "Null argument or column outside 0..3"));
+            status = qb_find(table, 0, nullptr, 1, &result);
+            assert(hasError(status, QB_INVALID_ARGUMENT, "Null argument or column outside 0..3"));
+            status = qb_create_index(table, -1);
+            assert(hasError(status, QB_INVALID_ARGUMENT, "Null table or column outside 0..3"));
+            status = qb_dynamic_create_index(table, "name");
+            assert(hasError(status, QB_INVALID_ARGUMENT, "Operation needs a QBTableDynamic handle"));
+
+            // unique keys - a batch with a duplicate is rejected as a whole
+            status = qb_create_unique_index(table, 2);
+            assert(hasError(status, QB_ERROR, "Cannot create unique index on column with duplicate values"));
+            status = qb_create_unique_index(table, 1);
+            assert(status == QB_OK);
+            const qb_record batch[] = {{4, "new", 3, 30, "", 0}, {5, "cde", 3, 40, "", 0}, {6, "last", 4, 50, "", 0}};
+            status = qb_add_records(table, batch, 3);
+            assert(hasError(status, QB_CONSTRAINT_VIOLATION, "Record 1 duplicates an id or a unique index key"));
+            assert(qb_table_active_count(table) == 3);
+            const qb_record sameBatch[] = {{4, "new", 3, 30, "", 0}, {5, "new", 3, 40, "", 0}};
+            status = qb_add_records(table, sameBatch, 2);
+            assert(hasError(status, QB_CONSTRAINT_VIOLATION, "Record 1 duplicates an id or a unique index key"));
+            status = qb_add_record(table, &records[0]);
+            assert(hasError(status, QB_CONSTRAINT_VIOLATION, "Record 0 duplicates an id or a unique index key"));
+            status = qb_add_records(table, batch, 1);
+            assert(status == QB_OK && qb_table_active_count(table) == 4);
+            status = qb_delete_record(table, 4, 1);
+            assert(status == QB_OK && qb_table_active_count(table) == 3);
+            qb_table_destroy(table);
+        }
+
+        // QBTableDynamic results - validity marks missing fields and fields whose type differs from the column
+        {
+            qb_table *table = qb_table_create_dynamic();
+            qb_value emptyString{};
+            emptyString.type = QB_FIELD_STRING;
+            qb_value zero{};
+            zero.type = QB_FIELD_LONG;
+            for (const char *column : {"name", "tag", "unused"})
+                qb_dynamic_add_column(table, column, emptyString);
+            [[maybe_unused]] qb_status status = qb_dynamic_add_column(table, "grp", zero);
+            assert(status == QB_OK);
+            status = qb_dynamic_add_column(table, "grp", zero);
+            assert(hasError(status, QB_INVALID_ARGUMENT, "Column already exists: grp"));
+
+            auto longValue = [](int64_t v)
+            {
+                qb_value value{};
+                value.type = QB_FIELD_LONG;
+                value.as.l = v;
+                return value;
+            };
+            auto uintValue = [](uint32_t v)
+            {
+                qb_value value{};
+                value.type = QB_FIELD_UINT;
+                value.as.u = v;
+                return value;
+            };
+            auto stringValue = [](const char *v)
+            {
+                qb_value value{};
+                value.type = QB_FIELD_STRING;
+                value.as.s.data = v;
+                value.as.s.length = std::strlen(v);
+                return value;
+            };
+            // name and tag are first seen in the second row, row 0 is back-filled as missing
+            const qb_field row1[] = {{"grp", longValue(1)}};
+            const qb_field row2[] = {{"grp", longValue(1)}, {"name", stringValue("bob")}, {"tag", uintValue(7)}};
+            const qb_field row3[] = {{"grp", longValue(1)}, {"name", uintValue(5)}, {"tag", uintValue(8)}};
+            const qb_field row4[] = {{"grp", longValue(1)}, {"name", stringValue("al")}};
+            const qb_field row5[] = {{"grp", longValue(2)}, {"name", stringValue("zz")}};
+            const qb_dynamic_record records[] = {{1, row1, 1}, {2, row2, 3}, {3, row3, 3}, {4, row4, 2}, {5, row5, 2}};
+            status = qb_dynamic_add_records(table, records, 5);
+            assert(status == QB_OK && qb_table_active_count(table) == 5);
+
+            qb_result *result = nullptr;
+            status = qb_dynamic_find(table, "grp", longValue(1), &result);
+            assert(status == QB_OK && qb_result_rows(result) == 4 && qb_result_column_count(result) == 5);
+            [[maybe_unused]] auto column = [&](std::string_view name) -> const qb_column *
+            {
+                for (size_t i = 0; i < qb_result_column_count(result); ++i)
+                    if (qb_result_column(result, i)->name == name)
+                        return qb_result_column(result, i);
+                return nullptr;
+            };
+            [[maybe_unused]] const qb_column *id = column("id"), *grp = column("grp"), *name = column("name"), *tag = column("tag"), *unused = column("unused");
+            assert(id == qb_result_column(result, 0) && id->type == QB_FIELD_UINT && !id->validity);
+            assert(static_cast<const uint32_t *>(id->values)[0] == 1 && static_cast<const uint32_t *>(id->values)[3] == 4);
+            assert(grp->type == QB_FIELD_LONG && !grp->validity && static_cast<const int64_t *>(grp->values)[2] == 1);
+
+            assert(name->type == QB_FIELD_STRING && validity(name, 4) == (std::vector<uint8_t>{0, 1, 0, 1}));
+            assert(name->offsets[0] == 0 && name->offsets[1] == 0 && name->offsets[2] == 3 && name->offsets[3] == 3 && name->offsets[4] == 5);
+            assert(text(name, 1) == "bob" && text(name, 3) == "al");
+
+            assert(tag->type == QB_FIELD_UINT && validity(tag, 4) == (std::vector<uint8_t>{0, 1, 1, 0}));
+            assert(static_cast<const uint32_t *>(tag->values)[1] == 7 && static_cast<const uint32_t *>(tag->values)[2] == 8);
+
+            // a column without any value in the result is still one entry per row, all missing
+            assert(unused->type == QB_FIELD_STRING && validity(unused, 4) == (std::vector<uint8_t>(4, 0)));
+            assert(unused->offsets[4] == 0);
+            qb_result_free(result);
+
+            status = qb_dynamic_find(table, "id", longValue(1), &result);
+            assert(hasError(status, QB_INVALID_ARGUMENT, "Primary key lookups need a QB_FIELD_UINT value") && result == nullptr);
+            status = qb_dynamic_find(table, "id", uintValue(3), &result);
+            assert(status == QB_OK && qb_result_rows(result) == 1);
+            qb_result_free(result);
+
+            const qb_field unknown[] = {{"missing", longValue(1)}};
+            const qb_dynamic_record rejected[] = {{6, row1, 1}, {7, unknown, 1}};
+            status = qb_dynamic_add_records(table, rejected, 2);
+            assert(hasError(status, QB_INVALID_ARGUMENT, "Record 1 does not match the table schema"));
+            assert(qb_table_active_count(table) == 5);
+            const qb_record staticRecord{};
+            status = qb_add_record(table, &staticRecord);
+            assert(hasError(status, QB_INVALID_ARGUMENT, "Operation needs a QBTable handle"));
+            status = qb_delete_record(table, 42, 0);
+            assert(hasError(status, QB_NOT_FOUND, "No record with id 42"));
+            qb_table_destroy(table);
+        }
+
+        out << "  ✓ All C API tests passed\n"
+            << std::endl;
+    }
+
+    // ========== TEST 26: Tracing ==========
+    out << "TEST 26: Tracing Spans in Chrome Trace Format" << std::endl;
+    out << "-" << std::string(76, '-') << std::endl;
+
+    {
+#ifdef QB_ENABLE_TRACING
+        // a --trace run keeps the events recorded so far, otherwise the test starts from empty buffers
+        const bool tracing = db::trace::enabled();
+        if (!tracing)
+            db::trace::clear();
+        db::trace::setEnabled(true);
+        db::QBTable traced;
+        for (size_t i = 0; i < 1000; ++i)
+            traced.addRecord(baseData[i]);
+        traced.createIndex(db::ColumnType::COLUMN2);
+        traced.deleteRecordByID(3);
+        traced.compactRecords();
+        traced.deleteRecordByID(5, true);
+        db::trace::setEnabled(tracing);
+
+        std::stringstream dump;
+        db::trace::writeChromeTrace(dump);
+        const std::string trace = dump.str();
+        out << "  " << std::count(trace.begin(), trace.end(), '\n') - 2 << " spans dumped" << std::endl;
+        // one complete event per span inside a single object, names as recorded and rows as an argument
+        assert(trace.starts_with("{\"displayTimeUnit\": \"ns\", \"traceEvents\": [") && trace.ends_with("\n]}\n"));
+        assert(std::count(trace.begin(), trace.end(), '{') == std::count(trace.begin(), trace.end(), '}'));
+        assert(std::count(trace.begin(), trace.end(), '[') == 1 && std::count(trace.begin(), trace.end(), ']') == 1);
+        for ([[maybe_unused]] const char *span : {"QBTable::createIndex", "QBTable::softDelete index scan", "QBTable::compactRecords",
+                                                   "QBTable::compactRecords index rebuild", "QBTable::hardDelete index rebuild"})
+            assert(trace.find("{\"name\": \"" + std::string(span) + "\", \"cat\": \"qbtable\", \"ph\": \"X\"") != std::string::npos);
+        assert(trace.find("\"args\": {\"rows\": 1000}}") != std::string::npos);
+
+        if (!tracing)
+        {
+            // disabled tracing records nothing
+            db::trace::clear();
+            traced.createIndex(db::ColumnType::COLUMN1);
+            std::stringstream empty;
+            db::trace::writeChromeTrace(empty);
+            assert(empty.str() == "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n]}\n");
+        }
+
+        out << "\n  ✓ All tracing tests passed\n"
+            << std::endl;
+#else
+        out << "  Built without QB_ENABLE_TRACING, skipped\n"
+            << std::endl;
+#endif
+    }
+
+    out << std::string(80, '=') << std::endl;
+    out << "TESTS COMPLETED SUCCESSFULLY" << std::endl;
+    out << std::string(80, '=') << std::endl;
+}
+
+/**
+    Print command line usage
+*/
+void printUsage(const char *program)
+{
+    std::cout << "Usage:\n"
+              << "  " << program << " [--format text|json|csv] [--output <file>] [--trials <n>] [--trace <file>]\n"
+              << "  " << program << " --compare <baseline.json> <current.json> [--threshold <percent>]\n"
+              << "\n"
+              << "  --format     machine readable report format (text report goes to stderr when writing to stdout)\n"
+              << "  --output     write the report to a file instead of stdout\n"
+              << "  --trials     repeat every timed test n times (default 1 for text, 5 otherwise)\n"
+              << "  --trace      record spans of long-running table operations as Chrome trace-event JSON\n"
+              << "  --compare    diff two JSON reports, exit code 1 on a significant regression\n"
+              << "  --threshold  minimal slowdown in percent counted as regression (default 5)\n";
+}
+
+/**
+    Compare two JSON reports and return the process exit code
+*/
+int compareReports(const std::string &baselinePath, const std::string &currentPath, double thresholdPct)
+{
+    std::ifstream baselineFile(baselinePath), currentFile(currentPath);
+    if (!baselineFile || !currentFile)
+    {
+        std::cerr << "Cannot open benchmark reports " << baselinePath << ", " << currentPath << std::endl;
+        return 2;
+    }
+
+    db::bench::RunMetadata baselineMeta, currentMeta;
+    auto baseline = db::bench::readJson(baselineFile, &baselineMeta);
+    auto current = db::bench::readJson(currentFile, &currentMeta);
+    std::cout << "  Baseline: " << baselineMeta.commit << " (" << baselineMeta.compiler << ", " << baselineMeta.timestamp << ")" << std::endl;
+    std::cout << "  Current:  " << currentMeta.commit << " (" << currentMeta.compiler << ", " << currentMeta.timestamp << ")\n"
+              << std::endl;
+
+    auto comparisons = db::bench::compareRuns(baseline, current, thresholdPct);
+    db::bench::printComparison(std::cout, comparisons, thresholdPct);
+
+    bool regressed = std::any_of(comparisons.begin(), comparisons.end(), [](const db::bench::Comparison &c)
+                                 { return c.regression; });
+    std::cout << "\n  " << (regressed ? "✗ Significant regression detected" : "✓ No significant regression") << std::endl;
+    return regressed ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+    std::string format = "text";
+    std::string outputPath;
+    std::string tracePath;
+    std::string comparePaths[2];
+    double thresholdPct = 5.0;
+    int trials = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "--format" && i + 1 < argc)
+            format = argv[++i];
+        else if (arg == "--output" && i + 1 < argc)
+            outputPath = argv[++i];
+        else if (arg == "--trace" && i + 1 < argc)
+            tracePath = argv[++i];
+        else if (arg == "--trials" && i + 1 < argc)
+            trials = std::max(1, std::atoi(argv[++i]));
+        else if (arg == "--threshold" && i + 1 < argc)
+            thresholdPct = std::atof(argv[++i]);
+        else if (arg == "--compare" && i + 2 < argc)
+        {
+            comparePaths[0] = argv[++i];
+            comparePaths[1] = argv[++i];
+        }
+        else
+        {
+            printUsage(argv[0]);
+            return arg == "--help" ? 0 : 2;
+        }
+    }
+
+    if (!comparePaths[0].empty())
+        return compareReports(comparePaths[0], comparePaths[1], thresholdPct);
+
+    if (format != "text" && format != "json" && format != "csv")
+    {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    // a single trial keeps the interactive run fast, machine readable runs need samples for confidence intervals
+    if (trials == 0)
+        trials = (format == "text") ? 1 : 5;
+
+    // keep stdout clean for the machine readable report
+    const bool reportToStdout = format != "text" && outputPath.empty();
+    BenchmarkContext ctx{trials, reportToStdout ? std::cerr : std::cout, {}};
+
+    // ========== Basic Correctness Tests ==========
+    ctx.out << "RUNNING QBTable TESTS\n"
+            << std::endl;
+
+    db::trace::setEnabled(!tracePath.empty());
+
+    // Run comprehensive benchmarks
+    runBenchmarks(ctx);
+
+    if (!tracePath.empty())
+    {
+        db::trace::setEnabled(false);
+        std::ofstream traceFile(tracePath);
+        db::trace::writeChromeTrace(traceFile);
+        ctx.out << "Trace written to " << tracePath << std::endl;
+    }
+
+    if (format == "text")
+        return 0;
+
+    db::bench::RunMetadata meta = db::bench::collectMetadata();
+    meta.dataSize = DATA_SIZE;
+    meta.iterations = ITERATIONS;
+    meta.trials = size_t(trials);
+
+    std::ofstream outputFile;
+    if (!outputPath.empty())
+        outputFile.open(outputPath);
+    std::ostream &report = outputPath.empty() ? std::cout : outputFile;
+    if (format == "json")
+        db::bench::writeJson(report, meta, ctx.report);
+    else
+        db::bench::writeCsv(report, meta, ctx.report);
+
+    return 0;
+}